@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_engine.dir/src/engine/engine.cpp.o"
+  "CMakeFiles/bedrock_engine.dir/src/engine/engine.cpp.o.d"
+  "libbedrock_engine.a"
+  "libbedrock_engine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_engine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_plugin.dir/src/plugin/plugin_interface.cpp.o"
+  "CMakeFiles/bedrock_plugin.dir/src/plugin/plugin_interface.cpp.o.d"
+  "libbedrock_plugin.a"
+  "libbedrock_plugin.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_plugin.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
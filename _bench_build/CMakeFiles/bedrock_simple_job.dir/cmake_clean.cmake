@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_simple_job.dir/experiments/simple_job.cpp.o"
+  "CMakeFiles/bedrock_simple_job.dir/experiments/simple_job.cpp.o.d"
+  "bedrock_simple_job"
+  "bedrock_simple_job.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_simple_job.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
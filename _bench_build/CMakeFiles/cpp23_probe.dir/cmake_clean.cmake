@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpp23_probe.dir/experiments/cpp23_probe.cpp.o"
+  "CMakeFiles/cpp23_probe.dir/experiments/cpp23_probe.cpp.o.d"
+  "cpp23_probe"
+  "cpp23_probe.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpp23_probe.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/bench/deterministic_reduce_bench.cpp" "bench/CMakeFiles/bedrock_bench.dir/deterministic_reduce_bench.cpp.o" "gcc" "bench/CMakeFiles/bedrock_bench.dir/deterministic_reduce_bench.cpp.o.d"
+  "/root/repo/bench/mpsc_queue_bench.cpp" "bench/CMakeFiles/bedrock_bench.dir/mpsc_queue_bench.cpp.o" "gcc" "bench/CMakeFiles/bedrock_bench.dir/mpsc_queue_bench.cpp.o.d"
+  "/root/repo/bench/profiler_bench.cpp" "bench/CMakeFiles/bedrock_bench.dir/profiler_bench.cpp.o" "gcc" "bench/CMakeFiles/bedrock_bench.dir/profiler_bench.cpp.o.d"
+  "/root/repo/bench/task_scheduler_bench.cpp" "bench/CMakeFiles/bedrock_bench.dir/task_scheduler_bench.cpp.o" "gcc" "bench/CMakeFiles/bedrock_bench.dir/task_scheduler_bench.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench_build/core/CMakeFiles/bedrock_core.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
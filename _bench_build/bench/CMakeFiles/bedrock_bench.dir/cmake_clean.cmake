@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_bench.dir/deterministic_reduce_bench.cpp.o"
+  "CMakeFiles/bedrock_bench.dir/deterministic_reduce_bench.cpp.o.d"
+  "CMakeFiles/bedrock_bench.dir/mpsc_queue_bench.cpp.o"
+  "CMakeFiles/bedrock_bench.dir/mpsc_queue_bench.cpp.o.d"
+  "CMakeFiles/bedrock_bench.dir/profiler_bench.cpp.o"
+  "CMakeFiles/bedrock_bench.dir/profiler_bench.cpp.o.d"
+  "CMakeFiles/bedrock_bench.dir/task_scheduler_bench.cpp.o"
+  "CMakeFiles/bedrock_bench.dir/task_scheduler_bench.cpp.o.d"
+  "bedrock_bench"
+  "bedrock_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
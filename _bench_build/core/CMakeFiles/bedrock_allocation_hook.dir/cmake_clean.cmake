@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_allocation_hook.dir/src/allocation_hook.cpp.o"
+  "CMakeFiles/bedrock_allocation_hook.dir/src/allocation_hook.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_allocation_hook.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
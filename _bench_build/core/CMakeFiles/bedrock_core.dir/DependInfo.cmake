@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/core/src/adaptive_grain.cpp" "core/CMakeFiles/bedrock_core.dir/src/adaptive_grain.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/adaptive_grain.cpp.o.d"
+  "/root/repo/core/src/bedrock_math.cpp" "core/CMakeFiles/bedrock_core.dir/src/bedrock_math.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/bedrock_math.cpp.o.d"
+  "/root/repo/core/src/cpu_topology.cpp" "core/CMakeFiles/bedrock_core.dir/src/cpu_topology.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/cpu_topology.cpp.o.d"
+  "/root/repo/core/src/deterministic_reduce.cpp" "core/CMakeFiles/bedrock_core.dir/src/deterministic_reduce.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/deterministic_reduce.cpp.o.d"
+  "/root/repo/core/src/memory_tracking.cpp" "core/CMakeFiles/bedrock_core.dir/src/memory_tracking.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/memory_tracking.cpp.o.d"
+  "/root/repo/core/src/perf_counters.cpp" "core/CMakeFiles/bedrock_core.dir/src/perf_counters.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/perf_counters.cpp.o.d"
+  "/root/repo/core/src/profiler.cpp" "core/CMakeFiles/bedrock_core.dir/src/profiler.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/profiler.cpp.o.d"
+  "/root/repo/core/src/task_scheduler.cpp" "core/CMakeFiles/bedrock_core.dir/src/task_scheduler.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/task_scheduler.cpp.o.d"
+  "/root/repo/core/src/thread_budget.cpp" "core/CMakeFiles/bedrock_core.dir/src/thread_budget.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/thread_budget.cpp.o.d"
+  "/root/repo/core/src/threading.cpp" "core/CMakeFiles/bedrock_core.dir/src/threading.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/threading.cpp.o.d"
+  "/root/repo/core/src/trace.cpp" "core/CMakeFiles/bedrock_core.dir/src/trace.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/trace.cpp.o.d"
+  "/root/repo/core/src/tuning_profile.cpp" "core/CMakeFiles/bedrock_core.dir/src/tuning_profile.cpp.o" "gcc" "core/CMakeFiles/bedrock_core.dir/src/tuning_profile.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
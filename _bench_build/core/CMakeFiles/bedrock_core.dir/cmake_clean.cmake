@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_core.dir/src/adaptive_grain.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/adaptive_grain.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/bedrock_math.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/bedrock_math.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/cpu_topology.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/cpu_topology.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/deterministic_reduce.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/deterministic_reduce.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/memory_tracking.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/memory_tracking.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/perf_counters.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/perf_counters.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/profiler.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/profiler.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/task_scheduler.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/task_scheduler.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/thread_budget.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/thread_budget.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/threading.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/threading.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/trace.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/trace.cpp.o.d"
+  "CMakeFiles/bedrock_core.dir/src/tuning_profile.cpp.o"
+  "CMakeFiles/bedrock_core.dir/src/tuning_profile.cpp.o.d"
+  "libbedrock_core.a"
+  "libbedrock_core.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
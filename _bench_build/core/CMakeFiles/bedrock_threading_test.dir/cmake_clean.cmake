@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_threading_test.dir/src/threading_test.cpp.o"
+  "CMakeFiles/bedrock_threading_test.dir/src/threading_test.cpp.o.d"
+  "bedrock_threading_test"
+  "bedrock_threading_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_threading_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
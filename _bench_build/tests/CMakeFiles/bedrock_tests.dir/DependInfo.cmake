@@ -0,0 +1,34 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/core/adaptive_grain_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/adaptive_grain_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/adaptive_grain_test.cpp.o.d"
+  "/root/repo/tests/core/cpu_topology_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/cpu_topology_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/cpu_topology_test.cpp.o.d"
+  "/root/repo/tests/core/deterministic_reduce_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/deterministic_reduce_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/deterministic_reduce_test.cpp.o.d"
+  "/root/repo/tests/core/memory_tracking_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/memory_tracking_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/memory_tracking_test.cpp.o.d"
+  "/root/repo/tests/core/mpsc_queue_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/mpsc_queue_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/mpsc_queue_test.cpp.o.d"
+  "/root/repo/tests/core/perf_counters_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/perf_counters_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/perf_counters_test.cpp.o.d"
+  "/root/repo/tests/core/profiler_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/profiler_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/profiler_test.cpp.o.d"
+  "/root/repo/tests/core/task_scheduler_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/task_scheduler_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/task_scheduler_test.cpp.o.d"
+  "/root/repo/tests/core/thread_budget_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/thread_budget_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/thread_budget_test.cpp.o.d"
+  "/root/repo/tests/core/trace_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/trace_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/trace_test.cpp.o.d"
+  "/root/repo/tests/core/tuning_profile_test.cpp" "tests/CMakeFiles/bedrock_tests.dir/core/tuning_profile_test.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/core/tuning_profile_test.cpp.o.d"
+  "/root/repo/tests/test_math.cpp" "tests/CMakeFiles/bedrock_tests.dir/test_math.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/test_math.cpp.o.d"
+  "/root/repo/tests/test_som_delta.cpp" "tests/CMakeFiles/bedrock_tests.dir/test_som_delta.cpp.o" "gcc" "tests/CMakeFiles/bedrock_tests.dir/test_som_delta.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench_build/core/CMakeFiles/bedrock_core.dir/DependInfo.cmake"
+  "/root/repo/_bench_build/_deps/googletest-build/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "/root/repo/_bench_build/_deps/googletest-build/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,36 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bedrock_tests.dir/core/adaptive_grain_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/adaptive_grain_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/cpu_topology_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/cpu_topology_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/deterministic_reduce_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/deterministic_reduce_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/memory_tracking_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/memory_tracking_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/mpsc_queue_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/mpsc_queue_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/perf_counters_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/perf_counters_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/profiler_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/profiler_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/task_scheduler_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/task_scheduler_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/thread_budget_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/thread_budget_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/trace_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/trace_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/core/tuning_profile_test.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/core/tuning_profile_test.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/test_math.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/test_math.cpp.o.d"
+  "CMakeFiles/bedrock_tests.dir/test_som_delta.cpp.o"
+  "CMakeFiles/bedrock_tests.dir/test_som_delta.cpp.o.d"
+  "bedrock_tests"
+  "bedrock_tests.pdb"
+  "bedrock_tests[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bedrock_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
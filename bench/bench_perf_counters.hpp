@@ -0,0 +1,69 @@
+#pragma once
+
+// Hardware counters for benchmark runs
+//
+// Opt-in with BEDROCK_PERF_COUNTERS=1: a BenchPerfCounters constructed before
+// the timing loop adds IPC, L1D / LLC / branch misses per 1000 instructions and
+// instructions per iteration to the benchmark's counters (JSON output
+// included), for whichever events perf_event_open permits here. Counts are for
+// the benchmark's own thread; in parallel loops that thread runs a share of
+// the chunks, so the rates are representative but the totals are not.
+
+#include <benchmark/benchmark.h>
+
+#include "bedrock/perf_counters.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace bedrock_bench {
+
+class BenchPerfCounters {
+public:
+    explicit BenchPerfCounters(benchmark::State& state)
+        : m_state(state) {
+        if (enabled()) {
+            m_counting = bedrock::PerfCounters::this_thread().read(m_start);
+        }
+    }
+
+    ~BenchPerfCounters() {
+        bedrock::PerfCounterValues end;
+        if (!m_counting || !bedrock::PerfCounters::this_thread().read(end)) {
+            return;
+        }
+        const bedrock::PerfCounterValues delta = end.since(m_start);
+        set("IPC", delta.ipc());
+        set("L1D_MPKI", delta.per_kilo_instruction(bedrock::PerfEvent::L1DMisses));
+        set("LLC_MPKI", delta.per_kilo_instruction(bedrock::PerfEvent::LLCMisses));
+        set("BR_MPKI", delta.per_kilo_instruction(bedrock::PerfEvent::BranchMisses));
+        if (delta.has(bedrock::PerfEvent::Instructions)) {
+            m_state.counters["insn_per_iter"] = benchmark::Counter(
+                static_cast<double>(delta[bedrock::PerfEvent::Instructions]), benchmark::Counter::kAvgIterations);
+        }
+    }
+
+    BenchPerfCounters(const BenchPerfCounters&) = delete;
+    BenchPerfCounters& operator=(const BenchPerfCounters&) = delete;
+
+    static bool enabled() {
+        static const bool value = [] {
+            const char* env = std::getenv("BEDROCK_PERF_COUNTERS");
+            return env && *env && std::strcmp(env, "0") != 0;
+        }();
+        return value;
+    }
+
+private:
+    void set(const char* name, double value) {
+        if (value >= 0.0) {
+            m_state.counters[name] = value;
+        }
+    }
+
+    benchmark::State& m_state;
+    bedrock::PerfCounterValues m_start;
+    bool m_counting = false;
+};
+
+} // namespace bedrock_bench
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Compare a bedrock_bench JSON run against a stored baseline.
+
+Usage:
+    python3 bench/compare_baseline.py baseline.json current.json [--threshold 0.10] [--metric real_time]
+
+Prints the per-benchmark ratio current/baseline and exits non-zero if any
+benchmark present in both files regressed by more than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for bench in data.get("benchmarks", []):
+        # Skip aggregate rows unless the run only has aggregates (--benchmark_repetitions)
+        if bench.get("run_type") == "aggregate" and bench.get("aggregate_name") != "median":
+            continue
+        name = bench.get("run_name", bench["name"])
+        results[name] = float(bench[metric])
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed slowdown as a fraction (default 0.10)")
+    parser.add_argument("--metric", default="real_time", choices=["real_time", "cpu_time"])
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    regressions = 0
+    width = max((len(n) for n in current), default=10)
+    for name in sorted(current):
+        if name not in baseline:
+            print(f"{name:<{width}}  (new)")
+            continue
+        ratio = current[name] / baseline[name] if baseline[name] > 0 else float("inf")
+        flag = ""
+        if ratio > 1.0 + args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{name:<{width}}  {ratio:6.3f}x{flag}")
+
+    missing = sorted(set(baseline) - set(current))
+    for name in missing:
+        print(f"{name:<{width}}  (missing from current run)")
+
+    if regressions:
+        print(f"\n{regressions} benchmark(s) slower than baseline by more than {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
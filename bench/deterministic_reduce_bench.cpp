@@ -0,0 +1,107 @@
+// Deterministic reductions vs naive sums
+//
+// A serial running sum and parallel_reduce (default grain, so its tree changes
+// with the thread count) against deterministic_sum in both accuracies and
+// deterministic_min. Arrays of 64 Ki (L2-resident) and 4 Mi doubles (memory
+// bound). BEDROCK_PERF_COUNTERS=1 adds IPC and miss rates (see bench_perf_counters.hpp).
+
+#include <benchmark/benchmark.h>
+
+#include "bench_perf_counters.hpp"
+
+#include "bedrock/deterministic_reduce.hpp"
+#include "bedrock/task_scheduler.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+const std::vector<double>& values(int64_t count) {
+    static std::vector<double> data;
+    if (static_cast<int64_t>(data.size()) != count) {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        data.resize(static_cast<size_t>(count));
+        for (double& v : data) {
+            v = dist(rng);
+        }
+    }
+    return data;
+}
+
+void set_bytes(benchmark::State& state) {
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(double)));
+}
+
+void BM_SerialSum(benchmark::State& state) {
+    const std::vector<double>& data = values(state.range(0));
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (double v : data) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state);
+}
+
+void BM_ParallelReduceSum(benchmark::State& state) {
+    const std::vector<double>& data = values(state.range(0));
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        double sum = bedrock::parallel_reduce<double>(
+            0, static_cast<int64_t>(data.size()), 0.0,
+            [&data](int64_t begin, int64_t end) {
+                double partial = 0.0;
+                for (int64_t i = begin; i < end; ++i) {
+                    partial += data[static_cast<size_t>(i)];
+                }
+                return partial;
+            },
+            [](double a, double b) { return a + b; });
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state);
+}
+
+void BM_DeterministicSum(benchmark::State& state) {
+    const std::vector<double>& data = values(state.range(0));
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        double sum = bedrock::deterministic_sum(data, bedrock::SumAccuracy::Pairwise);
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state);
+}
+
+void BM_DeterministicSumCompensated(benchmark::State& state) {
+    const std::vector<double>& data = values(state.range(0));
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        double sum = bedrock::deterministic_sum(data, bedrock::SumAccuracy::Compensated);
+        benchmark::DoNotOptimize(sum);
+    }
+    set_bytes(state);
+}
+
+void BM_DeterministicMin(benchmark::State& state) {
+    const std::vector<double>& data = values(state.range(0));
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        bedrock::ValueIndex min = bedrock::deterministic_min(data.data(), static_cast<int64_t>(data.size()));
+        benchmark::DoNotOptimize(min);
+    }
+    set_bytes(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_SerialSum)->Arg(1 << 16)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(BM_ParallelReduceSum)->Arg(1 << 16)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(BM_DeterministicSum)->Arg(1 << 16)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(BM_DeterministicSumCompensated)->Arg(1 << 16)->Arg(1 << 22)->UseRealTime();
+BENCHMARK(BM_DeterministicMin)->Arg(1 << 16)->Arg(1 << 22)->UseRealTime();
@@ -0,0 +1,87 @@
+// Worker -> I/O thread completion handoff micro-benchmarks
+//
+// N benchmark threads act as producers (compute workers) while one background
+// thread drains, as PalantirServer's event loop does. MpscQueue is compared with
+// a mutex-protected deque, the cost model of a queued cross-thread signal.
+
+#include <benchmark/benchmark.h>
+
+#include "bedrock/mpsc_queue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct MpscHandoff {
+    bedrock::MpscQueue<uint64_t> queue;
+
+    void push(uint64_t value) { queue.push(value); }
+    bool drain() {
+        bool any = false;
+        while (queue.try_pop()) {
+            any = true;
+        }
+        return any;
+    }
+};
+
+struct MutexHandoff {
+    std::mutex mutex;
+    std::deque<uint64_t> queue;
+
+    void push(uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(value);
+    }
+    bool drain() {
+        std::deque<uint64_t> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(queue);
+        }
+        return !batch.empty();
+    }
+};
+
+template <typename Handoff>
+void BM_CompletionHandoff(benchmark::State& state) {
+    static Handoff* handoff = nullptr;
+    static std::atomic<bool> stop{false};
+    static std::thread consumer;
+
+    if (state.thread_index() == 0) {
+        handoff = new Handoff();
+        stop = false;
+        consumer = std::thread([] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!handoff->drain()) {
+                    std::this_thread::yield();
+                }
+            }
+            handoff->drain();
+        });
+    }
+
+    // Setup above completes before any thread enters the timed loop
+    uint64_t value = 0;
+    for (auto _ : state) {
+        handoff->push(++value);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        stop = true;
+        consumer.join();
+        delete handoff;
+        handoff = nullptr;
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_CompletionHandoff, MpscHandoff)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_CompletionHandoff, MutexHandoff)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,174 @@
+// Palantir codec micro-benchmarks
+//
+// Covers the per-message path of PalantirServer:
+//   - makeEnvelope():  wrap an inner message (serializes the payload)
+//   - parseEnvelope(): decode and validate an envelope
+//   - extractMessage:  peekFrame() + parseEnvelope() + payload copy, as done per received frame
+//   - sendMessage:     makeEnvelope() + appendFrame(), as done per sent frame
+//
+// Each benchmark is parameterized by approximate payload size (16 B .. 100 MB)
+// and message type. Run with --benchmark_out_format=json to compare against a baseline.
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <benchmark/benchmark.h>
+
+#include "palantir/EnvelopeHelpers.hpp"
+#include "palantir/capabilities.pb.h"
+#include "palantir/error.pb.h"
+#include "palantir/xysine.pb.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace {
+
+using bedrock::palantir::FrameStatus;
+
+// Benchmarks measure the codec, not the transport limit (MAX_MESSAGE_SIZE)
+constexpr uint32_t kNoSizeLimit = std::numeric_limits<uint32_t>::max();
+
+// XYSineResponse: two packed repeated doubles, ~16 bytes per sample
+struct XYSineResponsePayload {
+    using Message = palantir::XYSineResponse;
+    static constexpr palantir::MessageType kType = palantir::MessageType::XY_SINE_RESPONSE;
+
+    static Message build(int64_t bytes) {
+        Message message;
+        int samples = static_cast<int>(std::max<int64_t>(1, bytes / 16));
+        message.mutable_x()->Reserve(samples);
+        message.mutable_y()->Reserve(samples);
+        for (int i = 0; i < samples; ++i) {
+            message.add_x(i * 0.001);
+            message.add_y(i * 0.002);
+        }
+        message.set_status("OK");
+        return message;
+    }
+};
+
+// ErrorResponse: dominated by a single string field
+struct ErrorResponsePayload {
+    using Message = palantir::ErrorResponse;
+    static constexpr palantir::MessageType kType = palantir::MessageType::ERROR_RESPONSE;
+
+    static Message build(int64_t bytes) {
+        Message message;
+        message.set_error_code(palantir::ErrorCode::INTERNAL_ERROR);
+        message.set_message("benchmark");
+        message.set_details(std::string(static_cast<size_t>(bytes), 'x'));
+        return message;
+    }
+};
+
+// CapabilitiesResponse: small fixed-size control message
+struct CapabilitiesResponsePayload {
+    using Message = palantir::CapabilitiesResponse;
+    static constexpr palantir::MessageType kType = palantir::MessageType::CAPABILITIES_RESPONSE;
+
+    static Message build(int64_t) {
+        Message message;
+        message.mutable_capabilities()->set_server_version("bedrock-bench");
+        message.mutable_capabilities()->add_supported_features("xy_sine");
+        return message;
+    }
+};
+
+std::string serializedEnvelope(palantir::MessageType type, const google::protobuf::Message& message) {
+    auto envelope = bedrock::palantir::makeEnvelope(type, message);
+    std::string serialized;
+    envelope->SerializeToString(&serialized);
+    return serialized;
+}
+
+template <typename P>
+void BM_MakeEnvelope(benchmark::State& state) {
+    auto message = P::build(state.range(0));
+    for (auto _ : state) {
+        auto envelope = bedrock::palantir::makeEnvelope(P::kType, message);
+        benchmark::DoNotOptimize(envelope);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message.ByteSizeLong()));
+}
+
+template <typename P>
+void BM_ParseEnvelope(benchmark::State& state) {
+    std::string serialized = serializedEnvelope(P::kType, P::build(state.range(0)));
+    for (auto _ : state) {
+        palantir::MessageEnvelope envelope;
+        bool ok = bedrock::palantir::parseEnvelope(serialized.data(), serialized.size(), envelope);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(envelope);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(serialized.size()));
+}
+
+// Mirrors PalantirServer::extractMessage(): locate frame, parse envelope, copy payload out
+template <typename P>
+void BM_ExtractMessage(benchmark::State& state) {
+    auto envelope = bedrock::palantir::makeEnvelope(P::kType, P::build(state.range(0)));
+    std::string frame;
+    bedrock::palantir::appendFrame(*envelope, frame, kNoSizeLimit);
+    for (auto _ : state) {
+        size_t frameSize = 0;
+        if (bedrock::palantir::peekFrame(frame.data(), frame.size(), kNoSizeLimit, frameSize) != FrameStatus::Complete) {
+            state.SkipWithError("peekFrame failed");
+            break;
+        }
+        palantir::MessageEnvelope parsed;
+        bedrock::palantir::parseEnvelope(frame.data() + bedrock::palantir::FRAME_HEADER_SIZE,
+                                         frameSize - bedrock::palantir::FRAME_HEADER_SIZE, parsed);
+        std::string payload(parsed.payload());
+        benchmark::DoNotOptimize(payload);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+
+// Mirrors PalantirServer::sendMessage(): wrap inner message, serialize into a length-prefixed frame
+template <typename P>
+void BM_SendMessageFraming(benchmark::State& state) {
+    auto message = P::build(state.range(0));
+    std::string frame;
+    for (auto _ : state) {
+        frame.clear();
+        auto envelope = bedrock::palantir::makeEnvelope(P::kType, message);
+        bedrock::palantir::appendFrame(*envelope, frame, kNoSizeLimit);
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+
+// 16 B .. 100 MB payloads
+void PayloadSizes(benchmark::internal::Benchmark* b) {
+    for (int64_t bytes : {int64_t{16}, int64_t{256}, int64_t{4} << 10, int64_t{64} << 10,
+                          int64_t{1} << 20, int64_t{16} << 20, int64_t{100} << 20}) {
+        b->Arg(bytes);
+    }
+    b->ArgName("bytes")->Unit(benchmark::kMicrosecond);
+}
+
+void SmallOnly(benchmark::internal::Benchmark* b) {
+    b->Arg(16)->ArgName("bytes")->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MakeEnvelope, XYSineResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_MakeEnvelope, ErrorResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_MakeEnvelope, CapabilitiesResponsePayload)->Apply(SmallOnly);
+
+BENCHMARK_TEMPLATE(BM_ParseEnvelope, XYSineResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_ParseEnvelope, ErrorResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_ParseEnvelope, CapabilitiesResponsePayload)->Apply(SmallOnly);
+
+BENCHMARK_TEMPLATE(BM_ExtractMessage, XYSineResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_ExtractMessage, ErrorResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_ExtractMessage, CapabilitiesResponsePayload)->Apply(SmallOnly);
+
+BENCHMARK_TEMPLATE(BM_SendMessageFraming, XYSineResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_SendMessageFraming, ErrorResponsePayload)->Apply(PayloadSizes);
+BENCHMARK_TEMPLATE(BM_SendMessageFraming, CapabilitiesResponsePayload)->Apply(SmallOnly);
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
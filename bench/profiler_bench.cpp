@@ -0,0 +1,93 @@
+// Cost of an instrumented scope
+//
+// BEDROCK_TIMER is meant to stay in production builds, so its per-scope cost
+// has to be small against the kernels it wraps: compare an enabled profiler
+// zone, a nested zone, a disabled zone and a disabled trace span against an
+// empty loop body. With hardware counters on, a zone adds two reads of the
+// thread's perf_event group (system calls).
+
+#include <benchmark/benchmark.h>
+
+#include "bedrock/profiler.hpp"
+#include "bedrock/threading.hpp"
+#include "bedrock/trace.hpp"
+
+namespace {
+
+void BM_EmptyScope(benchmark::State& state) {
+    int value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(++value);
+    }
+}
+
+void BM_ProfileZone(benchmark::State& state) {
+    bedrock::Profiler::set_enabled(true);
+    int value = 0;
+    for (auto _ : state) {
+        BEDROCK_PROFILE_ZONE("bench_zone");
+        benchmark::DoNotOptimize(++value);
+    }
+}
+
+void BM_ProfileZoneNested(benchmark::State& state) {
+    bedrock::Profiler::set_enabled(true);
+    int value = 0;
+    BEDROCK_PROFILE_ZONE("bench_outer");
+    for (auto _ : state) {
+        BEDROCK_PROFILE_ZONE("bench_inner");
+        benchmark::DoNotOptimize(++value);
+    }
+}
+
+void BM_ProfileZoneDisabled(benchmark::State& state) {
+    bedrock::Profiler::set_enabled(false);
+    int value = 0;
+    for (auto _ : state) {
+        BEDROCK_PROFILE_ZONE("bench_disabled");
+        benchmark::DoNotOptimize(++value);
+    }
+    bedrock::Profiler::set_enabled(true);
+}
+
+void BM_ProfileZoneCounters(benchmark::State& state) {
+    bedrock::Profiler::set_enabled(true);
+    bedrock::Profiler::set_hardware_counters(true);
+    if (!bedrock::PerfCounters::this_thread().ok()) {
+        state.SkipWithError(bedrock::PerfCounters::this_thread().error().c_str());
+    }
+    int value = 0;
+    for (auto _ : state) {
+        BEDROCK_PROFILE_ZONE("bench_counted");
+        benchmark::DoNotOptimize(++value);
+    }
+    bedrock::Profiler::set_hardware_counters(false);
+}
+
+void BM_Timer(benchmark::State& state) {
+    bedrock::Profiler::set_enabled(true);
+    int value = 0;
+    for (auto _ : state) {
+        BEDROCK_TIMER("bench_timer");  // Profiler zone plus the (disabled) tracer check
+        benchmark::DoNotOptimize(++value);
+    }
+}
+
+void BM_TraceSpanDisabled(benchmark::State& state) {
+    bedrock::Tracer::set_enabled(false);
+    int value = 0;
+    for (auto _ : state) {
+        BEDROCK_TRACE_SPAN("bench", "span");
+        benchmark::DoNotOptimize(++value);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_EmptyScope);
+BENCHMARK(BM_ProfileZone);
+BENCHMARK(BM_ProfileZoneNested);
+BENCHMARK(BM_ProfileZoneDisabled);
+BENCHMARK(BM_ProfileZoneCounters);
+BENCHMARK(BM_Timer);
+BENCHMARK(BM_TraceSpanDisabled);
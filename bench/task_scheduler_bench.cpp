@@ -0,0 +1,143 @@
+// Work-stealing scheduler vs OpenMP loops on skewed workloads
+//
+// Iteration cost varies the way ray paths and Monte-Carlo trials do: a linear
+// ramp (cost grows with the index) and a heavy tail (1 in 64 iterations is 100x
+// the rest). BEDROCK_PARALLEL_FOR's static schedule leaves threads idle behind
+// the expensive partition; dynamic scheduling and work stealing rebalance.
+// The adaptive loop learns its chunk size per workload instead of using the
+// default grain. All variants use ThreadingConfig's thread count.
+// BEDROCK_PERF_COUNTERS=1 adds IPC and miss rates (see bench_perf_counters.hpp).
+
+#include <benchmark/benchmark.h>
+
+#include "bench_perf_counters.hpp"
+
+#include "bedrock/adaptive_grain.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/threading.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+enum Skew : int64_t {
+    Uniform = 0,
+    Ramp = 1,
+    HeavyTail = 2,
+};
+
+constexpr int64_t ITERATIONS = 4096;
+constexpr int BASE_COST = 200;
+
+int cost_of(int64_t i, int64_t skew) {
+    switch (skew) {
+        case Ramp:      return BASE_COST * static_cast<int>(1 + (8 * i) / ITERATIONS);
+        case HeavyTail: return (i % 64 == 0) ? BASE_COST * 100 : BASE_COST;
+        default:        return BASE_COST;
+    }
+}
+
+double work(int64_t i, int cost) {
+    double x = static_cast<double>(i) * 1e-3;
+    for (int k = 0; k < cost; ++k) {
+        x = std::sin(x) + 1.0;
+    }
+    return x;
+}
+
+void set_skew_label(benchmark::State& state) {
+    static const char* names[] = {"uniform", "ramp", "heavy_tail"};
+    state.SetLabel(names[state.range(0)]);
+    state.SetItemsProcessed(state.iterations() * ITERATIONS);
+}
+
+void BM_OpenMPStatic(benchmark::State& state) {
+    const int64_t skew = state.range(0);
+    std::vector<double> out(ITERATIONS);
+    bedrock::ThreadingConfig::initialize();
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        BEDROCK_PARALLEL_FOR(static_cast<int>(ITERATIONS)) {
+            out[static_cast<size_t>(i)] = work(i, cost_of(i, skew));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_skew_label(state);
+}
+
+void BM_OpenMPDynamic(benchmark::State& state) {
+    const int64_t skew = state.range(0);
+    std::vector<double> out(ITERATIONS);
+    bedrock::ThreadingConfig::initialize();
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int64_t i = 0; i < ITERATIONS; ++i) {
+            out[static_cast<size_t>(i)] = work(i, cost_of(i, skew));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_skew_label(state);
+}
+
+void BM_TaskSchedulerFor(benchmark::State& state) {
+    const int64_t skew = state.range(0);
+    std::vector<double> out(ITERATIONS);
+    bedrock::TaskScheduler& scheduler = bedrock::TaskScheduler::global();
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        bedrock::parallel_for(0, ITERATIONS, [&](int64_t i) {
+            out[static_cast<size_t>(i)] = work(i, cost_of(i, skew));
+        }, 0, scheduler);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_skew_label(state);
+}
+
+void BM_TaskSchedulerAdaptive(benchmark::State& state) {
+    const int64_t skew = state.range(0);
+    std::vector<double> out(ITERATIONS);
+    bedrock::TaskScheduler& scheduler = bedrock::TaskScheduler::global();
+    bedrock::AdaptiveGrain control;  // Converges during the first iterations
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        bedrock::parallel_for_adaptive(0, ITERATIONS, [&](int64_t i) {
+            out[static_cast<size_t>(i)] = work(i, cost_of(i, skew));
+        }, control, scheduler);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_skew_label(state);
+    const auto stats = control.stats();
+    state.counters["grain"] = static_cast<double>(stats.grain);
+    state.counters["idle_ratio"] = stats.idle_ratio;
+}
+
+void BM_TaskSchedulerReduce(benchmark::State& state) {
+    const int64_t skew = state.range(0);
+    bedrock::TaskScheduler& scheduler = bedrock::TaskScheduler::global();
+    bedrock_bench::BenchPerfCounters perf(state);
+    for (auto _ : state) {
+        double sum = bedrock::parallel_reduce<double>(
+            0, ITERATIONS, 0.0,
+            [skew](int64_t begin, int64_t end) {
+                double partial = 0.0;
+                for (int64_t i = begin; i < end; ++i) {
+                    partial += work(i, cost_of(i, skew));
+                }
+                return partial;
+            },
+            [](double a, double b) { return a + b; }, 0, scheduler);
+        benchmark::DoNotOptimize(sum);
+    }
+    set_skew_label(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_OpenMPStatic)->Arg(Uniform)->Arg(Ramp)->Arg(HeavyTail)->UseRealTime();
+BENCHMARK(BM_OpenMPDynamic)->Arg(Uniform)->Arg(Ramp)->Arg(HeavyTail)->UseRealTime();
+BENCHMARK(BM_TaskSchedulerFor)->Arg(Uniform)->Arg(Ramp)->Arg(HeavyTail)->UseRealTime();
+BENCHMARK(BM_TaskSchedulerAdaptive)->Arg(Uniform)->Arg(Ramp)->Arg(HeavyTail)->UseRealTime();
+BENCHMARK(BM_TaskSchedulerReduce)->Arg(Uniform)->Arg(Ramp)->Arg(HeavyTail)->UseRealTime();
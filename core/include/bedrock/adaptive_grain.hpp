@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include "bedrock/task_scheduler.hpp"
+
+namespace bedrock {
+
+namespace detail {
+struct AdaptiveLoop;
+}
+
+/**
+ * @brief Chunk size that adapts to a kernel's measured cost while it runs
+ *
+ * A fixed grain is right for one input only: the same kernel may cost 50 ns or
+ * 50 us per index depending on the prescription and ray count. parallel_for_adaptive()
+ * times every chunk and moves the grain toward target_chunk() worth of work
+ * (geometric steps, so a bad first guess converges in a few chunks). Chunks long
+ * enough to amortize scheduling, short enough to balance.
+ *
+ * The end of a loop is where imbalance shows: threads that finish early wait for
+ * the last chunk. Chunks shrink toward the end (remaining / (threads * tail divisor)),
+ * and the divisor follows the measured idle ratio: doubled when more than 5% of
+ * the threads' time went to waiting, halved below 1%.
+ *
+ * Keep one controller per kernel (e.g. a function-local static) so each loop
+ * starts from the grain the previous one converged to. Thread-safe: concurrent
+ * loops may share a controller.
+ */
+class AdaptiveGrain {
+public:
+    struct Stats {
+        int64_t loops = 0;
+        int64_t chunks = 0;
+        int64_t items = 0;
+        int64_t grain = 0;           ///< Grain the next loop starts with (0 before the first loop)
+        double ns_per_item = 0.0;    ///< Cost estimate from the last loop
+        double mean_chunk_us = 0.0;  ///< Mean chunk duration over all loops
+        double idle_ratio = 0.0;     ///< Last loop: share of thread time spent waiting for the slowest strand
+        int64_t helper_joins = 0;    ///< Helper strands that took at least one chunk, over all loops
+        int tail_divisor = 0;
+    };
+
+    /**
+     * @param target_chunk Work per chunk to aim for
+     * @param min_grain Smallest chunk (indices)
+     * @param max_grain Largest chunk (indices)
+     */
+    explicit AdaptiveGrain(std::chrono::nanoseconds target_chunk = std::chrono::microseconds(100),
+                           int64_t min_grain = 1, int64_t max_grain = int64_t{1} << 24);
+
+    AdaptiveGrain(const AdaptiveGrain&) = delete;
+    AdaptiveGrain& operator=(const AdaptiveGrain&) = delete;
+
+    std::chrono::nanoseconds target_chunk() const { return m_target; }
+    int64_t min_grain() const { return m_min_grain; }
+    int64_t max_grain() const { return m_max_grain; }
+
+    /**
+     * @brief Grain the next loop starts with (0 before the first loop)
+     */
+    int64_t grain() const { return m_grain.load(std::memory_order_relaxed); }
+
+    int tail_divisor() const { return m_tail_divisor.load(std::memory_order_relaxed); }
+
+    Stats stats() const;
+
+private:
+    friend struct detail::AdaptiveLoop;
+
+    int64_t initial_grain(int64_t count, int threads) const;
+    int64_t clamp(double grain) const;
+    void finish_loop(const detail::AdaptiveLoop& loop, int64_t count);
+
+    const std::chrono::nanoseconds m_target;
+    const int64_t m_min_grain;
+    const int64_t m_max_grain;
+    std::atomic<int64_t> m_grain{0};
+    std::atomic<int> m_tail_divisor{2};
+
+    mutable std::mutex m_stats_mutex;
+    Stats m_stats;
+    int64_t m_busy_ns = 0;
+};
+
+namespace detail {
+
+// Shared state of one parallel_for_adaptive call
+struct AdaptiveLoop {
+    AdaptiveLoop(AdaptiveGrain& control, int64_t begin, int64_t count, int threads);
+
+    // Steer the grain toward the target from one chunk's timing
+    void record_chunk(int64_t items, int64_t elapsed_ns);
+    // Strand done: finish_ns is relative to the loop start
+    void finish_strand(bool ran, bool helper, int64_t finish_ns);
+    // Hand the converged grain and the loop's idle ratio back to the controller
+    void finish(int64_t count);
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    AdaptiveGrain& control;
+    std::atomic<int64_t> next;          // First unclaimed index
+    std::atomic<int64_t> grain;
+    std::atomic<int64_t> chunks{0};
+    std::atomic<int64_t> busy_ns{0};
+    std::atomic<int> strands{0};        // Strands that ran at least one chunk
+    std::atomic<int> helper_joins{0};
+    std::atomic<int64_t> finish_sum_ns{0};
+    std::atomic<int64_t> finish_max_ns{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief Parallel loop over [begin, end) whose chunk size adapts at runtime
+ *
+ * The calling thread and up to thread_count() - 1 helpers (the ThreadBudget's
+ * helpers inside a budget scope) claim chunks from a shared cursor; each chunk's
+ * size is the controller's current grain, shrunk near the end of the range.
+ *
+ * @param body Called as body(i) for every index, or body(chunk_begin, chunk_end) per chunk
+ * @param control Per-kernel controller; carries the learned grain between calls
+ */
+template<typename Body>
+void parallel_for_adaptive(int64_t begin, int64_t end, Body&& body, AdaptiveGrain& control,
+                           TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (end <= begin) {
+        return;
+    }
+    ThreadBudget* budget = ThreadBudget::current();
+    const int threads = budget ? budget->threads() : scheduler.thread_count();
+    const int64_t tail_divisor = control.tail_divisor();
+    detail::AdaptiveLoop loop(control, begin, end - begin, threads);
+    const int64_t start_ns = detail::AdaptiveLoop::now_ns();
+
+    auto strand = [&](bool helper) {
+        bool ran = false;
+        while (true) {
+            int64_t claimed = loop.next.load(std::memory_order_relaxed);
+            int64_t size = 0;
+            do {
+                const int64_t remaining = end - claimed;
+                if (remaining <= 0) {
+                    size = 0;
+                    break;
+                }
+                const int64_t tail = remaining / (threads * tail_divisor);
+                size = std::min(remaining, std::clamp(tail, control.min_grain(),
+                                                      std::max(control.min_grain(), loop.grain.load(std::memory_order_relaxed))));
+            } while (!loop.next.compare_exchange_weak(claimed, claimed + size, std::memory_order_relaxed));
+            if (size == 0) {
+                break;
+            }
+
+            const int64_t chunk_start = detail::AdaptiveLoop::now_ns();
+            if constexpr (std::is_invocable_v<Body&, int64_t, int64_t>) {
+                body(claimed, claimed + size);
+            } else {
+                for (int64_t i = claimed; i < claimed + size; ++i) {
+                    body(i);
+                }
+            }
+            loop.record_chunk(size, detail::AdaptiveLoop::now_ns() - chunk_start);
+            ran = true;
+        }
+        loop.finish_strand(ran, helper, detail::AdaptiveLoop::now_ns() - start_ns);
+    };
+
+    const int wanted = threads - 1;
+    const int helpers = budget ? budget->try_acquire(wanted) : wanted;
+    {
+        TaskGroup group(scheduler);
+        for (int h = 0; h < helpers; ++h) {
+            group.run([budget, &strand]() {
+                struct Release {
+                    ThreadBudget* budget;
+                    ~Release() {
+                        if (budget) {
+                            budget->release(1);
+                        }
+                    }
+                } release{budget};
+                strand(true);
+            });
+        }
+        strand(false);
+        group.wait();
+    }
+    loop.finish(end - begin);
+}
+
+} // namespace bedrock
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bedrock/mpsc_queue.hpp"
+#include "bedrock/task_scheduler.hpp"
+
+namespace bedrock {
+
+/**
+ * @brief Where a coroutine continues after co_await resume_on(executor)
+ */
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    /**
+     * @brief Run @p work on this executor's thread(s) (any thread may call)
+     */
+    virtual void post(std::function<void()> work) = 0;
+};
+
+/**
+ * @brief Executor over a TaskScheduler's workers (the compute pool)
+ */
+class SchedulerExecutor final : public Executor {
+public:
+    explicit SchedulerExecutor(TaskScheduler& scheduler = TaskScheduler::global())
+        : m_scheduler(scheduler) {}
+
+    void post(std::function<void()> work) override { m_scheduler.post(std::move(work)); }
+
+    TaskScheduler& scheduler() const { return m_scheduler; }
+
+private:
+    TaskScheduler& m_scheduler;
+};
+
+/**
+ * @brief SchedulerExecutor over TaskScheduler::global()
+ */
+Executor& compute_executor();
+
+/**
+ * @brief Executor drained by one owner thread (e.g. a transport event loop)
+ *
+ * post() is lock-free (MpscQueue) and calls @p wake so the owner knows to call
+ * run_pending(); Palantir's EventLoopExecutor wires wake to its event loop.
+ * Work still queued when the executor is destroyed is dropped.
+ */
+class QueueExecutor final : public Executor {
+public:
+    explicit QueueExecutor(std::function<void()> wake = {});
+
+    void post(std::function<void()> work) override;
+
+    /**
+     * @brief Run everything queued, including work posted meanwhile (owner thread only)
+     * @return Work items run
+     */
+    size_t run_pending();
+
+private:
+    MpscQueue<std::function<void()>> m_queue;
+    std::function<void()> m_wake;
+};
+
+/**
+ * @brief Thrown where a coroutine observes a cancelled CancellationToken
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled()
+        : std::runtime_error("operation cancelled") {}
+};
+
+/**
+ * @brief Read side of a cancellation flag; copies share the flag
+ *
+ * Cancellation is cooperative: stages poll is_cancelled() between batches, and
+ * resume_on(executor, token) checks it at every hop. Wraps the same
+ * shared_ptr<atomic<bool>> that Palantir's RequestControl carries, so a
+ * superseded or disconnected request cancels its pipeline.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;  ///< Never cancelled
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> flag)
+        : m_flag(std::move(flag)) {}
+
+    bool can_be_cancelled() const { return m_flag != nullptr; }
+    bool is_cancelled() const { return m_flag && m_flag->load(std::memory_order_relaxed); }
+
+    void throw_if_cancelled() const {
+        if (is_cancelled()) {
+            throw OperationCancelled();
+        }
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+/**
+ * @brief Owner side of a cancellation flag
+ */
+class CancellationSource {
+public:
+    CancellationSource()
+        : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken token() const { return CancellationToken(m_flag); }
+    void cancel() const { m_flag->store(true, std::memory_order_relaxed); }
+    bool is_cancelled() const { return m_flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+// The awaiter and the finishing task race on `handoff`: whoever arrives second
+// resumes the awaiting coroutine. A task that completes synchronously therefore
+// returns to its awaiter without a nested resume, so long loops over immediate
+// tasks keep a flat stack at any optimization level (GCC only turns symmetric
+// transfer into a tail call when optimizing).
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::atomic<bool> handoff{false};
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            TaskPromiseBase& promise = self.promise();
+            if (promise.handoff.exchange(true, std::memory_order_acq_rel)) {
+                promise.continuation.resume();  // The awaiter already suspended; it may destroy this frame
+            }
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    void rethrow_if_failed() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T take() {
+        rethrow_if_failed();
+        return std::move(*value);
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void take() const { rethrow_if_failed(); }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T
+ *
+ *   Task<Spot> trace_spot(Executor& transport, CancellationToken token) {
+ *       co_await resume_on(compute_executor(), token);   // Hop to the compute pool
+ *       auto rays = co_await trace(token);               // Nested stage, same thread
+ *       co_await resume_on(transport);                   // Continue on the event loop
+ *       co_return summarize(rays);
+ *   }
+ *
+ * Nothing runs until the task is awaited (co_await std::move(task)), passed to
+ * when_all(), start_detached() or sync_wait(). The awaiting coroutine resumes
+ * on whichever thread the task finished on; an exception thrown in the task is
+ * rethrown at the co_await. Move-only; destroying an unfinished, unstarted task
+ * destroys its frame.
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using value_type = T;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle) {}
+
+    Task(Task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    ~Task() { destroy(); }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool valid() const { return static_cast<bool>(m_handle); }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return handle.done(); }
+
+            bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                handle.resume();
+                // False: the task already finished, continue without suspending
+                return !handle.promise().handoff.exchange(true, std::memory_order_acq_rel);
+            }
+
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    void destroy() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief Fire-and-forget driver: started by resuming handle, frees itself at the end
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept {
+            return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+inline void post_resume(Executor& executor, std::coroutine_handle<> handle) {
+    executor.post([handle]() { handle.resume(); });
+}
+
+inline DetachedTask run_detached(Task<void> task) {
+    co_await std::move(task);
+}
+
+// Shared by the children of one when_all(); lives in the when_all frame
+struct WhenAllState {
+    explicit WhenAllState(size_t children)
+        : remaining(children + 1)
+        , errors(children) {}
+
+    std::atomic<size_t> remaining;  // Children plus the parent's own arrival
+    std::coroutine_handle<> parent;
+    std::vector<std::exception_ptr> errors;  // By child index: the lowest failing index is rethrown
+
+    void arrive() {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            parent.resume();
+        }
+    }
+
+    void rethrow_if_failed() const {
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
+
+template<typename Start>
+struct WhenAllAwaiter {
+    WhenAllState& state;
+    Start start;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> parent) {
+        state.parent = parent;
+        start();
+        // Children done before this point leave the parent to continue without suspending
+        return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+template<typename T>
+DetachedTask when_all_child(Task<T> task, std::optional<T>& slot, WhenAllState& state, size_t index) {
+    try {
+        slot.emplace(co_await std::move(task));
+    } catch (...) {
+        state.errors[index] = std::current_exception();
+    }
+    state.arrive();  // May resume and finish the parent; touch nothing afterwards
+}
+
+inline DetachedTask when_all_child(Task<void> task, WhenAllState& state, size_t index) {
+    try {
+        co_await std::move(task);
+    } catch (...) {
+        state.errors[index] = std::current_exception();
+    }
+    state.arrive();
+}
+
+// Signals completion from final_suspend, once the frame is suspended and safe to destroy
+struct SyncWaitTask {
+    struct promise_type {
+        std::atomic<bool> done{false};
+
+        SyncWaitTask get_return_object() noexcept {
+            return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct Signal {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> self) const noexcept {
+                    self.promise().done.store(true, std::memory_order_release);
+                }
+                void await_resume() const noexcept {}
+            };
+            return Signal{};
+        }
+
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+SyncWaitTask sync_wait_driver(Task<T> task, std::optional<T>& result, std::exception_ptr& error) {
+    try {
+        result.emplace(co_await std::move(task));
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+inline SyncWaitTask sync_wait_driver(Task<void> task, std::exception_ptr& error) {
+    try {
+        co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+inline void run_until_done(SyncWaitTask driver, TaskScheduler& scheduler) {
+    driver.handle.resume();
+    // Help the pool instead of blocking, as TaskGroup::wait() does
+    while (!driver.handle.promise().done.load(std::memory_order_acquire)) {
+        if (!scheduler.try_run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    driver.handle.destroy();
+}
+
+} // namespace detail
+
+/**
+ * @brief Awaitable that continues the coroutine on @p executor
+ *
+ * With a token, a cancelled pipeline stops at the hop: co_await throws
+ * OperationCancelled (before posting if already cancelled, else on arrival).
+ */
+class ResumeOn {
+public:
+    ResumeOn(Executor& executor, CancellationToken token)
+        : m_executor(executor)
+        , m_token(std::move(token)) {}
+
+    bool await_ready() const noexcept { return m_token.is_cancelled(); }
+    void await_suspend(std::coroutine_handle<> awaiting) { detail::post_resume(m_executor, awaiting); }
+    void await_resume() const { m_token.throw_if_cancelled(); }
+
+private:
+    Executor& m_executor;
+    CancellationToken m_token;
+};
+
+inline ResumeOn resume_on(Executor& executor, CancellationToken token = {}) {
+    return ResumeOn(executor, std::move(token));
+}
+
+/**
+ * @brief Run every task concurrently on @p executor; results in input order
+ *
+ * Each task is started by a post() to @p executor, so a fan-out over the
+ * compute pool runs its stages in parallel. Completes when all have finished,
+ * on the thread that finished last. If any failed, the exception of the
+ * lowest-index failure is rethrown (the others still ran to completion; pass
+ * them a CancellationToken to stop siblings early).
+ */
+template<typename T>
+Task<std::vector<T>> when_all(std::vector<Task<T>> tasks, Executor& executor = compute_executor()) {
+    detail::WhenAllState state(tasks.size());
+    std::vector<std::optional<T>> outcomes(tasks.size());
+    co_await detail::WhenAllAwaiter{state, [&]() {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            detail::post_resume(executor, detail::when_all_child(std::move(tasks[i]), outcomes[i], state, i).handle);
+        }
+    }};
+    state.rethrow_if_failed();
+    std::vector<T> results;
+    results.reserve(outcomes.size());
+    for (std::optional<T>& outcome : outcomes) {
+        results.push_back(std::move(*outcome));
+    }
+    co_return results;
+}
+
+inline Task<void> when_all(std::vector<Task<void>> tasks, Executor& executor = compute_executor()) {
+    detail::WhenAllState state(tasks.size());
+    co_await detail::WhenAllAwaiter{state, [&]() {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            detail::post_resume(executor, detail::when_all_child(std::move(tasks[i]), state, i).handle);
+        }
+    }};
+    state.rethrow_if_failed();
+}
+
+/**
+ * @brief Start @p task on @p executor without waiting for it
+ *
+ * For top-level pipelines launched from the transport thread: report results
+ * and errors from inside the task (an escaping exception terminates).
+ */
+inline void start_detached(Task<void> task, Executor& executor = compute_executor()) {
+    detail::post_resume(executor, detail::run_detached(std::move(task)).handle);
+}
+
+/**
+ * @brief Run @p task to completion on the calling thread and return its result
+ *
+ * The caller helps @p scheduler while waiting (so a 1-thread scheduler still
+ * makes progress). For tests, tools and synchronous entry points; never call it
+ * on a thread whose QueueExecutor the task continues on.
+ */
+template<typename T>
+T sync_wait(Task<T> task, TaskScheduler& scheduler = TaskScheduler::global()) {
+    std::exception_ptr error;
+    if constexpr (std::is_void_v<T>) {
+        detail::run_until_done(detail::sync_wait_driver(std::move(task), error), scheduler);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    } else {
+        std::optional<T> result;
+        detail::run_until_done(detail::sync_wait_driver(std::move(task), result, error), scheduler);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*result);
+    }
+}
+
+} // namespace bedrock
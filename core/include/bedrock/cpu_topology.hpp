@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bedrock {
+
+/**
+ * @brief CPUs this process can actually run on, and how many threads to start
+ *
+ * Processor counts from the OS (omp_get_num_procs, hardware_concurrency) report
+ * the machine, not the container: a pod limited to 2 CPUs on a 64-core host
+ * would start 64 threads and spend its quota being throttled. This probe combines
+ *   - the scheduler affinity mask (sched_getaffinity; taskset, cpusets),
+ *   - the CFS bandwidth quota (cgroup v2 cpu.max, or v1 cpu.cfs_quota_us /
+ *     cpu.cfs_period_us), taking the tightest limit on the path to the root,
+ *   - SMT siblings among the allowed CPUs (physical core count),
+ * into usable_threads, which ThreadingConfig and every worker pool size from.
+ *
+ * On platforms without these interfaces the counts fall back to
+ * std::thread::hardware_concurrency() and no quota.
+ */
+struct CpuResources {
+    int online_cpus = 1;         ///< Processors the OS reports online
+    std::vector<int> allowed;    ///< CPU ids in the affinity mask
+    int physical_cores = 1;      ///< Allowed CPUs with SMT siblings counted once
+    double quota_cpus = 0.0;     ///< CFS quota in CPUs (quota / period), 0 = unlimited
+    std::string quota_source;    ///< File the quota came from, empty when unlimited
+    int usable_threads = 1;      ///< min(allowed CPUs, ceil(quota)), at least 1
+
+    /**
+     * @brief Probe once per process and cache the result (thread-safe)
+     */
+    static const CpuResources& detect();
+
+    /**
+     * @brief Probe now, reading cgroup, proc and sysfs files below @p root
+     *
+     * @p root replaces "/" so tests can point the probe at a fake file tree;
+     * the affinity mask is only queried from the OS when @p root is "/".
+     */
+    static CpuResources probe(const std::string& root = "/");
+
+    /**
+     * @brief Human-readable summary (for logs and ThreadingConfig::get_system_info)
+     */
+    std::string describe() const;
+};
+
+/**
+ * @brief Where one allowed CPU sits in the machine
+ *
+ * Cache groups are identified by the lowest CPU id sharing that cache, so two
+ * CPUs with equal l3_group share an L3. -1 when sysfs does not say.
+ */
+struct CpuInfo {
+    int id = 0;
+    int package = 0;     ///< Physical socket
+    int core = 0;        ///< Core id within the package (SMT siblings share it)
+    int numa_node = 0;
+    int l2_group = -1;
+    int l3_group = -1;
+};
+
+/**
+ * @brief Package / NUMA / cache / SMT layout of the CPUs this process may use
+ *
+ * Read from /sys/devices/system/cpu/cpuN/{topology,cache} and
+ * /sys/devices/system/node; machines without sysfs report one package, one node
+ * and no cache sharing.
+ */
+struct CpuTopology {
+    std::vector<CpuInfo> cpus;  ///< Allowed CPUs, ascending id
+    int packages = 1;
+    int numa_nodes = 1;
+    int physical_cores = 1;
+    int l3_domains = 1;         ///< Distinct L3 caches among the allowed CPUs
+
+    /**
+     * @brief Probe the allowed CPUs (CpuResources::detect) once and cache the result
+     */
+    static const CpuTopology& detect();
+
+    /**
+     * @brief Probe @p allowed CPUs reading sysfs below @p root (tests use a fake tree)
+     */
+    static CpuTopology probe(const std::vector<int>& allowed, const std::string& root = "/");
+
+    /**
+     * @brief Human-readable summary (for logs and ThreadingConfig::get_system_info)
+     */
+    std::string describe() const;
+};
+
+/**
+ * @brief How worker threads are placed on CPUs
+ *
+ *   None:          leave placement to the OS scheduler
+ *   Compact:       fill one core's SMT siblings, then neighbouring cores of the same
+ *                  L3 / NUMA node / package; workers share caches (small working sets
+ *                  handed between threads)
+ *   Scatter:       round-robin over packages, NUMA nodes and L3 domains; maximizes
+ *                  cache and memory bandwidth per thread (large independent ray bundles)
+ *   PhysicalCores: one worker per physical core in compact order, siblings used
+ *                  only once every core has a worker (avoids SMT contention)
+ */
+enum class PinningPolicy {
+    None,
+    Compact,
+    Scatter,
+    PhysicalCores,
+};
+
+/**
+ * @brief Parse "none", "compact", "scatter" or "cores" (case-sensitive)
+ */
+std::optional<PinningPolicy> parse_pinning_policy(const std::string& name);
+const char* pinning_policy_name(PinningPolicy policy);
+
+/**
+ * @brief CPU id for each of @p threads workers under @p policy
+ * @return One CPU per worker (wrapping when threads exceed CPUs); empty for None
+ */
+std::vector<int> pinning_plan(const CpuTopology& topology, PinningPolicy policy, int threads);
+
+/**
+ * @brief Restrict the calling thread to one CPU
+ * @return False where unsupported or refused (the thread keeps running unpinned)
+ */
+bool pin_current_thread(int cpu);
+
+/**
+ * @brief Buffer whose pages live on the NUMA node of the thread that creates it
+ *
+ * Linux places a page on the node of the thread that first writes it. The
+ * constructor zeroes every page, so create per-worker buffers on the (pinned)
+ * worker that will use them, e.g. lazily on first use inside a task.
+ */
+class NumaLocalBuffer {
+public:
+    explicit NumaLocalBuffer(size_t bytes);
+
+    void* data() { return m_data.get(); }
+    const void* data() const { return m_data.get(); }
+    size_t size() const { return m_size; }
+
+    template<typename T>
+    T* as() { return static_cast<T*>(data()); }
+
+private:
+    struct Free {
+        void operator()(void* ptr) const;
+    };
+
+    std::unique_ptr<void, Free> m_data;
+    size_t m_size;
+};
+
+namespace cpu_detail {
+
+/**
+ * @brief Parse a kernel CPU list such as "0-3,8,10-11"
+ * @return CPU ids in ascending order; empty on malformed input
+ */
+std::vector<int> parse_cpu_list(const std::string& text);
+
+/**
+ * @brief Parse cgroup v2 cpu.max ("max 100000" or "<quota> <period>")
+ * @return Quota in CPUs, or std::nullopt when unlimited or malformed
+ */
+std::optional<double> parse_cpu_max(const std::string& text);
+
+/**
+ * @brief Quota in CPUs from cgroup v1 cfs_quota_us / cfs_period_us contents
+ * @return std::nullopt when unlimited (quota -1) or malformed
+ */
+std::optional<double> parse_cfs_quota(const std::string& quota_us, const std::string& period_us);
+
+} // namespace cpu_detail
+
+} // namespace bedrock
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "bedrock/task_scheduler.hpp"
+
+namespace bedrock {
+
+/**
+ * @brief Rounding behaviour of the deterministic sums
+ */
+enum class SumAccuracy {
+    Pairwise,     ///< Fixed pairwise tree: error grows with log(n), naive speed
+    Compensated,  ///< Pairwise tree with an error term carried alongside (TwoSum): close to exact, ~2x the arithmetic
+};
+
+/**
+ * @brief Elements per leaf block of the deterministic reductions
+ *
+ * The shape of the summation tree depends only on this and the element count:
+ * leaves are fixed blocks of [begin + k * DETERMINISTIC_BLOCK, ...), each summed
+ * in DETERMINISTIC_LANES interleaved lanes (lane = index % lanes, which the
+ * compiler vectorizes without reassociating), lanes and blocks are then combined
+ * by pairwise trees. Threads only decide who computes which block, never the
+ * order of additions, so results are bit-identical for any thread count, grain,
+ * ThreadBudget or steal pattern. (Within one build: compiler flags such as
+ * -ffast-math or FMA contraction may change the last bits between builds.)
+ */
+constexpr int64_t DETERMINISTIC_BLOCK = 4096;
+constexpr int DETERMINISTIC_LANES = 8;
+
+/**
+ * @brief Value with the index it was found at (min / max reductions)
+ */
+struct ValueIndex {
+    double value = std::numeric_limits<double>::quiet_NaN();
+    int64_t index = -1;  ///< -1 when nothing was found (empty range or all NaN)
+
+    bool found() const { return index >= 0; }
+};
+
+namespace detail {
+
+/**
+ * @brief Sum with the rounding error of its additions (unused by SumAccuracy::Pairwise)
+ */
+struct CompensatedSum {
+    double sum = 0.0;
+    double error = 0.0;
+
+    double value() const { return sum + error; }
+};
+
+// Knuth's TwoSum: a + b == sum + error exactly, with no branch so lanes vectorize
+inline void two_sum(double a, double b, double& sum, double& error) {
+    sum = a + b;
+    const double b_virtual = sum - a;
+    error = (a - (sum - b_virtual)) + (b - b_virtual);
+}
+
+inline CompensatedSum combine_sums(const CompensatedSum& left, const CompensatedSum& right) {
+    CompensatedSum result;
+    double error;
+    two_sum(left.sum, right.sum, result.sum, error);
+    result.error = (left.error + right.error) + error;
+    return result;
+}
+
+/**
+ * @brief Fixed-shape pairwise combination of partials[first, last)
+ */
+template<typename T, typename Combine>
+T pairwise_combine(const T* partials, size_t first, size_t last, const Combine& combine) {
+    if (last - first == 1) {
+        return partials[first];
+    }
+    const size_t mid = first + (last - first + 1) / 2;
+    return combine(pairwise_combine(partials, first, mid, combine), pairwise_combine(partials, mid, last, combine));
+}
+
+template<SumAccuracy Accuracy, typename Map>
+CompensatedSum sum_block(int64_t begin, int64_t end, const Map& map) {
+    constexpr int L = DETERMINISTIC_LANES;
+    double sums[L] = {};
+    double errors[L] = {};
+    int64_t i = begin;
+    for (; i + L <= end; i += L) {
+        for (int lane = 0; lane < L; ++lane) {
+            const double x = map(i + lane);
+            if constexpr (Accuracy == SumAccuracy::Compensated) {
+                double error;
+                two_sum(sums[lane], x, sums[lane], error);
+                errors[lane] += error;
+            } else {
+                sums[lane] += x;
+            }
+        }
+    }
+    for (int lane = 0; i < end; ++i, ++lane) {
+        const double x = map(i);
+        if constexpr (Accuracy == SumAccuracy::Compensated) {
+            double error;
+            two_sum(sums[lane], x, sums[lane], error);
+            errors[lane] += error;
+        } else {
+            sums[lane] += x;
+        }
+    }
+
+    CompensatedSum lanes[L];
+    for (int lane = 0; lane < L; ++lane) {
+        lanes[lane] = {sums[lane], errors[lane]};
+    }
+    if constexpr (Accuracy == SumAccuracy::Compensated) {
+        return pairwise_combine(lanes, 0, L, combine_sums);
+    } else {
+        return pairwise_combine(lanes, 0, L, [](const CompensatedSum& a, const CompensatedSum& b) {
+            return CompensatedSum{a.sum + b.sum, 0.0};
+        });
+    }
+}
+
+template<SumAccuracy Accuracy, typename Map>
+double deterministic_sum_impl(int64_t begin, int64_t end, const Map& map, TaskScheduler& scheduler) {
+    if (end <= begin) {
+        return 0.0;
+    }
+    const int64_t blocks = (end - begin + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    auto block_sum = [&](int64_t block) {
+        const int64_t block_begin = begin + block * DETERMINISTIC_BLOCK;
+        return sum_block<Accuracy>(block_begin, std::min(end, block_begin + DETERMINISTIC_BLOCK), map);
+    };
+    if (blocks == 1) {
+        return block_sum(0).value();
+    }
+
+    std::vector<CompensatedSum> partials(static_cast<size_t>(blocks));
+    parallel_for(0, blocks, [&](int64_t block) { partials[static_cast<size_t>(block)] = block_sum(block); }, 0,
+                 scheduler);
+    if constexpr (Accuracy == SumAccuracy::Compensated) {
+        return pairwise_combine(partials.data(), 0, partials.size(), combine_sums).value();
+    } else {
+        return pairwise_combine(partials.data(), 0, partials.size(), [](const CompensatedSum& a, const CompensatedSum& b) {
+                   return CompensatedSum{a.sum + b.sum, 0.0};
+               }).sum;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Sum of map(i) over [begin, end), bit-identical for any thread count
+ *
+ *   double energy = deterministic_sum_of(0, rays, [&](int64_t i) { return weight[i] * weight[i]; });
+ *
+ * @param map Called as map(i) -> double; may run on any thread, in any block order
+ */
+template<typename Map>
+double deterministic_sum_of(int64_t begin, int64_t end, Map&& map, SumAccuracy accuracy = SumAccuracy::Pairwise,
+                            TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (accuracy == SumAccuracy::Compensated) {
+        return detail::deterministic_sum_impl<SumAccuracy::Compensated>(begin, end, map, scheduler);
+    }
+    return detail::deterministic_sum_impl<SumAccuracy::Pairwise>(begin, end, map, scheduler);
+}
+
+/**
+ * @brief Sum of values[0, count), bit-identical for any thread count
+ */
+double deterministic_sum(const double* values, int64_t count, SumAccuracy accuracy = SumAccuracy::Pairwise,
+                         TaskScheduler& scheduler = TaskScheduler::global());
+
+inline double deterministic_sum(std::span<const double> values, SumAccuracy accuracy = SumAccuracy::Pairwise,
+                                TaskScheduler& scheduler = TaskScheduler::global()) {
+    return deterministic_sum(values.data(), static_cast<int64_t>(values.size()), accuracy, scheduler);
+}
+
+/**
+ * @brief Dot product of a[0, count) and b[0, count), bit-identical for any thread count
+ */
+double deterministic_dot(const double* a, const double* b, int64_t count, SumAccuracy accuracy = SumAccuracy::Pairwise,
+                         TaskScheduler& scheduler = TaskScheduler::global());
+
+/**
+ * @brief Smallest value and its index; ties go to the lowest index, NaN is skipped
+ */
+ValueIndex deterministic_min(const double* values, int64_t count, TaskScheduler& scheduler = TaskScheduler::global());
+
+/**
+ * @brief Largest value and its index; ties go to the lowest index, NaN is skipped
+ */
+ValueIndex deterministic_max(const double* values, int64_t count, TaskScheduler& scheduler = TaskScheduler::global());
+
+} // namespace bedrock
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace bedrock {
+
+/**
+ * @brief Owners that memory is attributed to
+ */
+enum class MemorySubsystem : uint8_t {
+    Other = 0,       ///< Untagged allocations (global hook only)
+    Transport,       ///< Socket and framing buffers
+    Protobuf,        ///< Parsed and serialized messages
+    ComputeScratch,  ///< Working memory of compute kernels
+    Cache,           ///< Resident models, prepared systems, profiles
+    Count
+};
+
+constexpr size_t MEMORY_SUBSYSTEM_COUNT = static_cast<size_t>(MemorySubsystem::Count);
+
+/**
+ * @brief Bytes attributed to one subsystem
+ */
+struct MemoryUsage {
+    MemorySubsystem subsystem = MemorySubsystem::Other;
+    const char* name = "";
+    int64_t current_bytes = 0;
+    int64_t peak_bytes = 0;      ///< Highest current_bytes since start (or reset_peaks())
+    uint64_t allocations = 0;    ///< Allocations since start
+};
+
+/**
+ * @brief Process-wide current and peak bytes per subsystem
+ *
+ * Two ways to feed it:
+ *   - TaggedMemoryResource: std::pmr containers built on resource(subsystem)
+ *     are counted exactly, in any build.
+ *   - The global allocation hook (CMake BEDROCK_TRACK_ALLOCATIONS, which links
+ *     bedrock_allocation_hook into the executable): every operator new is
+ *     charged to the calling thread's MemoryTagScope, or to Other, and its
+ *     delete is credited back to the same subsystem whichever thread frees it.
+ *
+ * Counts are the sizes requested, not allocator overhead or RSS. Counters are
+ * relaxed atomics (one cache line per subsystem). Everything is thread-safe;
+ * record_*() and current_tag() never allocate, so the hook can call them.
+ */
+class MemoryTracker {
+public:
+    static void record_allocation(MemorySubsystem subsystem, size_t bytes);
+    static void record_deallocation(MemorySubsystem subsystem, size_t bytes);
+
+    static int64_t current_bytes(MemorySubsystem subsystem);
+    static int64_t peak_bytes(MemorySubsystem subsystem);
+
+    /**
+     * @brief Every subsystem, in enum order
+     */
+    static std::vector<MemoryUsage> snapshot();
+
+    /**
+     * @brief Restart peak tracking from the current bytes
+     */
+    static void reset_peaks();
+
+    /**
+     * @brief snapshot() as a text table
+     */
+    static std::string report();
+
+    static const char* subsystem_name(MemorySubsystem subsystem);
+
+    /**
+     * @brief Subsystem the calling thread's allocations are charged to (see MemoryTagScope)
+     */
+    static MemorySubsystem current_tag();
+
+    /**
+     * @brief Shared TaggedMemoryResource over std::pmr::new_delete_resource() (valid for the process lifetime)
+     */
+    static std::pmr::memory_resource* resource(MemorySubsystem subsystem);
+
+    /**
+     * @brief True when the global operator new hook is linked in
+     */
+    static bool allocation_hook_installed();
+
+    /**
+     * @brief Called once by the hook's translation unit
+     */
+    static void mark_allocation_hook_installed();
+
+private:
+    friend class MemoryTagScope;
+
+    static MemorySubsystem exchange_tag(MemorySubsystem subsystem);
+};
+
+/**
+ * @brief Charges the calling thread's allocations to @p subsystem until destroyed
+ *
+ * Only the global hook reads the tag; nests, restoring the outer tag. Work
+ * handed to other threads is not covered; tag it there.
+ */
+class MemoryTagScope {
+public:
+    explicit MemoryTagScope(MemorySubsystem subsystem)
+        : m_previous(MemoryTracker::exchange_tag(subsystem)) {}
+
+    ~MemoryTagScope() {
+        MemoryTracker::exchange_tag(m_previous);
+    }
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+private:
+    MemorySubsystem m_previous;
+};
+
+/**
+ * @brief std::pmr resource that charges its allocations to one subsystem
+ *
+ *   std::pmr::vector<double> scratch(MemoryTracker::resource(MemorySubsystem::ComputeScratch));
+ *
+ * With the global hook installed and the default upstream, the upstream
+ * allocation runs under a MemoryTagScope instead, so the hook counts it once.
+ */
+class TaggedMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit TaggedMemoryResource(MemorySubsystem subsystem,
+                                  std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    MemorySubsystem subsystem() const { return m_subsystem; }
+    std::pmr::memory_resource* upstream() const { return m_upstream; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    MemorySubsystem m_subsystem;
+    std::pmr::memory_resource* m_upstream;
+};
+
+} // namespace bedrock
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace bedrock {
+
+/**
+ * @brief Unbounded lock-free multi-producer / single-consumer queue
+ *
+ * Vyukov's intrusive MPSC design: push() is wait-free (one atomic exchange),
+ * try_pop() is lock-free and must only be called from the single consumer
+ * thread. FIFO per producer; ordering between producers is the order in which
+ * their exchanges on the head pointer happened.
+ *
+ * try_pop() can transiently report empty while a producer is between its
+ * exchange and its link store; callers that need to observe every element
+ * must re-check after the producer's wake-up signal (see CompletionQueue).
+ *
+ * @tparam T Element type (move-constructible)
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : m_head(&m_stub)
+        , m_tail(&m_stub) {}
+
+    ~MpscQueue() {
+        while (try_pop()) {
+        }
+        if (m_tail != &m_stub) {
+            delete m_tail;  // Last popped node serves as the dummy
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Enqueue a value (any thread)
+     */
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Dequeue the oldest value (consumer thread only)
+     * @return The value, or std::nullopt if no completely-linked element is available
+     */
+    std::optional<T> try_pop() {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(next->value));
+        next->value.reset();
+        m_tail = next;
+        if (tail != &m_stub) {
+            delete tail;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Check for a completely-linked element (consumer thread only)
+     */
+    bool empty() const {
+        return m_tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T&& v) : value(std::move(v)) {}
+
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    Node m_stub;
+    alignas(64) std::atomic<Node*> m_head;  // Producers
+    alignas(64) Node* m_tail;               // Consumer
+};
+
+} // namespace bedrock
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bedrock {
+
+/**
+ * @brief Events a PerfCounters set can count
+ *
+ * Hardware events come from the PMU; TaskClock is the kernel's on-CPU time of
+ * the thread (a software event, so it counts in VMs without a virtual PMU).
+ */
+enum class PerfEvent : int {
+    Cycles = 0,
+    Instructions,
+    L1DMisses,     ///< L1 data cache read misses
+    LLCMisses,     ///< Last-level cache misses
+    BranchMisses,
+    TaskClock,     ///< On-CPU nanoseconds
+    Count
+};
+
+constexpr size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::Count);
+
+/**
+ * @brief Bit of @p event in a PerfCounters event mask
+ */
+constexpr uint32_t perf_event_bit(PerfEvent event) {
+    return uint32_t{1} << static_cast<int>(event);
+}
+
+constexpr uint32_t ALL_PERF_EVENTS = (uint32_t{1} << PERF_EVENT_COUNT) - 1;
+
+/**
+ * @brief Counter values (running totals from read(), or differences of two reads)
+ */
+struct PerfCounterValues {
+    std::array<uint64_t, PERF_EVENT_COUNT> values{};
+    uint32_t mask = 0;  ///< Events actually counted (perf_event_bit)
+
+    bool has(PerfEvent event) const { return (mask & perf_event_bit(event)) != 0; }
+    uint64_t operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+    uint64_t& operator[](PerfEvent event) { return values[static_cast<size_t>(event)]; }
+
+    /**
+     * @brief Counts since @p start (events counted in both)
+     */
+    PerfCounterValues since(const PerfCounterValues& start) const;
+
+    /**
+     * @brief Instructions per cycle, or -1 when either event is missing
+     */
+    double ipc() const;
+
+    /**
+     * @brief @p event per 1000 instructions (MPKI for the miss events), or -1 when missing
+     */
+    double per_kilo_instruction(PerfEvent event) const;
+};
+
+/**
+ * @brief perf_event_open counters of the calling thread
+ *
+ * Opens one event group (a single read() returns every event) counting user
+ * space only. Each event that cannot be opened is left out: in containers,
+ * VMs without a PMU, with kernel.perf_event_paranoid > 2 or on non-Linux
+ * platforms the set may count some events or none, and error() says why.
+ * Values are scaled by time_enabled / time_running when the kernel multiplexes
+ * the group with other users of the PMU.
+ *
+ * A read() is a system call (about a microsecond), so counters are opt-in:
+ * Profiler::set_hardware_counters() for profiler zones, BEDROCK_PERF_COUNTERS=1
+ * for bedrock_bench.
+ *
+ * Counts only the thread that constructed it; not thread-safe.
+ */
+class PerfCounters {
+public:
+    explicit PerfCounters(uint32_t events = ALL_PERF_EVENTS);
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief True when at least one event is counting
+     */
+    bool ok() const { return m_mask != 0; }
+
+    /**
+     * @brief Events that opened (perf_event_bit)
+     */
+    uint32_t events() const { return m_mask; }
+
+    /**
+     * @brief Why requested events are missing (empty when all opened)
+     */
+    const std::string& error() const { return m_error; }
+
+    /**
+     * @brief Running totals since construction
+     * @return False when nothing is counting or the read failed
+     */
+    bool read(PerfCounterValues& out) const;
+
+    /**
+     * @brief Counters of the calling thread, opened on first use and kept for the thread's life
+     */
+    static PerfCounters& this_thread();
+
+    static const char* event_name(PerfEvent event);
+
+    /**
+     * @brief One line per event: counting, or the reason it is unavailable here
+     */
+    static std::string describe_support();
+
+private:
+    int m_leader = -1;
+    std::array<int, PERF_EVENT_COUNT> m_fds;
+    std::array<int, PERF_EVENT_COUNT> m_slot;  ///< Position of each event in the group read, -1 if not open
+    uint32_t m_mask = 0;
+    int m_open = 0;
+    std::string m_error;
+};
+
+} // namespace bedrock
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bedrock/perf_counters.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define BEDROCK_PROFILER_HAS_TSC 1
+#endif
+
+namespace bedrock {
+
+/**
+ * @brief Aggregated timings of one zone path, merged over all threads
+ */
+struct ProfileZoneStats {
+    static constexpr size_t HISTOGRAM_BUCKETS = 40;  ///< Bucket b holds durations in [2^b, 2^(b+1)) ns
+
+    std::string name;   ///< Zone name
+    std::string path;   ///< Names from the outermost zone, joined with '/'
+    int depth = 0;      ///< 0 for outermost zones
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t min_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, HISTOGRAM_BUCKETS> histogram{};
+    uint64_t counted = 0;          ///< Samples with hardware counters (see Profiler::set_hardware_counters)
+    PerfCounterValues counters;    ///< Counter totals over those samples
+
+    double mean_ns() const { return count > 0 ? static_cast<double>(total_ns) / static_cast<double>(count) : 0.0; }
+
+    /**
+     * @brief Upper bound of the histogram bucket holding the @p fraction quantile (e.g. 0.99)
+     */
+    uint64_t percentile_ns(double fraction) const;
+};
+
+/**
+ * @brief Hierarchical zone profiler, cheap enough to leave on in production
+ *
+ * Each thread keeps its own tree of zones: a zone entered inside another becomes
+ * its child, so "compute" under "xy_sine" and "compute" under "trace_rays" are
+ * aggregated separately. A node holds count, total, min, max and a log2 duration
+ * histogram. Only the owning thread writes a node (relaxed stores, no locks, no
+ * allocation after the node exists); snapshot() may run at any time from any
+ * thread and merges the trees by path. When a thread exits, its tree is folded
+ * into one shared tree of exited threads and freed, so thread churn does not
+ * grow memory.
+ *
+ * Zones are identified by ids from register_zone(); BEDROCK_PROFILE_ZONE and
+ * BEDROCK_TIMER register once per call site, so a scope costs two clock reads
+ * and a short walk of the current node's children. With profiling disabled it
+ * costs one relaxed atomic load.
+ *
+ * The clock is the TSC on x86-64 when the CPU reports it invariant
+ * (constant_tsc and nonstop_tsc), calibrated against steady_clock when the
+ * first zone is registered; steady_clock everywhere else.
+ *
+ * With set_hardware_counters(true) each zone also reads the thread's
+ * PerfCounters on entry and exit, and report() adds IPC, cache and branch
+ * misses per 1000 instructions and the on-CPU share of wall time. That adds two
+ * system calls per zone, so it is off by default; threads whose counters cannot
+ * be opened simply record no counters.
+ *
+ * reset() starts a new generation: each thread clears its own tree the next time
+ * it enters a zone, and trees not yet cleared are left out of snapshots.
+ */
+class Profiler {
+public:
+    /// Tree nodes kept per thread; zones beyond it are counted as dropped
+    static constexpr size_t MAX_NODES_PER_THREAD = 4096;
+
+    /// Distinct zone names; further names share one "(overflow)" zone
+    static constexpr uint32_t MAX_ZONES = 1 << 14;
+
+    /// enter() result when nothing was opened (node 0 is each thread's root)
+    static constexpr uint32_t NO_NODE = 0;
+
+    static void set_enabled(bool enabled);
+
+    static bool is_enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void set_hardware_counters(bool enabled);
+
+    static bool hardware_counters_enabled() {
+        return s_counters.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Id for a zone name; the same name always yields the same id (thread-safe)
+     */
+    static uint32_t register_zone(std::string_view name);
+
+    /**
+     * @brief Name of a registered zone (lock-free; valid for the life of the process)
+     */
+    static std::string_view zone_name(uint32_t zone);
+
+    static uint64_t now_ns();
+
+    /**
+     * @brief Zone clock: TSC ticks or steady_clock nanoseconds (see class comment)
+     */
+    static uint64_t now_ticks() {
+#ifdef BEDROCK_PROFILER_HAS_TSC
+        if (s_use_tsc) {
+            return __rdtsc();
+        }
+#endif
+        return now_ns();
+    }
+
+    /**
+     * @brief Open @p zone under the calling thread's current zone (reads the thread's counters when enabled)
+     * @return Node to pass to leave(), or NO_NODE when the thread's tree is full
+     */
+    static uint32_t enter(uint32_t zone);
+
+    /**
+     * @brief Close the node returned by enter(), adding one sample of @p elapsed_ticks (now_ticks() units)
+     */
+    static void leave(uint32_t node, uint64_t elapsed_ticks);
+
+    /**
+     * @brief Zones of every thread merged by path, depth-first, children by total time
+     */
+    static std::vector<ProfileZoneStats> snapshot();
+
+    /**
+     * @brief snapshot() as an indented text table
+     */
+    static std::string report();
+
+    /**
+     * @brief Write report() to a file
+     * @return True on success
+     */
+    static bool write_report(const std::string& path);
+
+    /**
+     * @brief Discard all samples (threads clear their trees lazily, see class comment)
+     */
+    static void reset();
+
+    /**
+     * @brief Zones not recorded because a thread's tree was full
+     */
+    static size_t dropped_count();
+
+    /**
+     * @brief Number of per-thread trees held (threads that profiled and are still running)
+     */
+    static size_t tree_count();
+
+private:
+    friend struct ProfilerClock;
+
+    static std::atomic<bool> s_enabled;
+    static std::atomic<bool> s_counters;
+    // Set once, before the first zone id is handed out
+    static bool s_use_tsc;
+    static double s_ns_per_tick;
+};
+
+/**
+ * @brief RAII zone: one sample of [construction, destruction) when profiling is enabled
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(uint32_t zone)
+        : m_node(Profiler::is_enabled() ? Profiler::enter(zone) : Profiler::NO_NODE)
+        , m_start_ticks(m_node != Profiler::NO_NODE ? Profiler::now_ticks() : 0) {}
+
+    ~ProfileZone() {
+        // Closed even if profiling was disabled meanwhile, so the thread's current zone stays right
+        if (m_node != Profiler::NO_NODE) {
+            Profiler::leave(m_node, Profiler::now_ticks() - m_start_ticks);
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    uint32_t m_node;
+    uint64_t m_start_ticks;
+};
+
+#define BEDROCK_PROFILE_CONCAT_INNER(a, b) a##b
+#define BEDROCK_PROFILE_CONCAT(a, b) BEDROCK_PROFILE_CONCAT_INNER(a, b)
+
+// Profile the enclosing scope; the name is registered once per call site, so it
+// must be the same on every pass (a literal or other constant)
+#define BEDROCK_PROFILE_ZONE(name)                                                          \
+    static const uint32_t BEDROCK_PROFILE_CONCAT(_bedrock_zone_id_, __LINE__) =             \
+        bedrock::Profiler::register_zone(name);                                             \
+    bedrock::ProfileZone BEDROCK_PROFILE_CONCAT(_bedrock_zone_, __LINE__)(                  \
+        BEDROCK_PROFILE_CONCAT(_bedrock_zone_id_, __LINE__))
+
+} // namespace bedrock
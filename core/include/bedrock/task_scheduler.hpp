@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bedrock/cpu_topology.hpp"
+#include "bedrock/thread_budget.hpp"
+
+namespace bedrock {
+
+class TaskGroup;
+
+/**
+ * @brief Work-stealing task scheduler for fork-join parallelism
+ *
+ * Each worker owns a deque: it pushes and pops its own tasks at the back (LIFO,
+ * cache-warm) while idle workers steal from the front of a random victim (FIFO,
+ * the largest pending pieces of a recursive split). Threads that wait on a
+ * TaskGroup execute pending tasks instead of blocking, so nested parallel_for /
+ * parallel_reduce calls from inside tasks do not deadlock or oversubscribe.
+ *
+ * Unlike BEDROCK_PARALLEL_FOR (static OpenMP schedule), irregular iterations
+ * (variable-length ray paths, Monte-Carlo trials of uneven cost) are balanced
+ * by stealing rather than by the initial partition.
+ *
+ * The calling thread participates in the work, so a scheduler of N threads
+ * starts N - 1 workers.
+ *
+ * TaskGroup tasks run under the ThreadBudget of the thread that spawned them
+ * (post()ed tasks run without one). Loops started under a budget use at most
+ * that many threads (see ThreadBudget), so concurrent jobs sharing the
+ * scheduler divide its workers instead of each taking all of them.
+ *
+ * An optional PinningPolicy binds worker i to pinning_plan(...)[i + 1], leaving
+ * slot 0 to the (unpinned) caller.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Start a scheduler
+     * @param num_threads Threads including the caller (0 = ThreadingConfig::get_optimal_thread_count())
+     * @param pinning Worker placement over CpuTopology::detect() (None = OS scheduler)
+     */
+    explicit TaskScheduler(int num_threads = 0, PinningPolicy pinning = PinningPolicy::None);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Process-wide scheduler, sized from ThreadingConfig and pinned per global_pinning() on first use
+     */
+    static TaskScheduler& global();
+
+    /**
+     * @brief Pinning policy of the global scheduler
+     *
+     * Set by set_global_pinning(), else read from $BEDROCK_PINNING ("none",
+     * "compact", "scatter" or "cores"; other values mean None).
+     */
+    static PinningPolicy global_pinning();
+
+    /**
+     * @brief Choose the global scheduler's pinning policy
+     * @return false if global() already started its workers (the policy is not applied)
+     */
+    static bool set_global_pinning(PinningPolicy pinning);
+
+    /**
+     * @brief Threads that execute tasks, including the waiting caller
+     */
+    int thread_count() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    /**
+     * @brief Index of the calling worker (0 .. thread_count() - 2), -1 on other threads
+     *
+     * Keys per-worker state such as NumaLocalBuffer scratch created on first use.
+     */
+    static int worker_index();
+
+    /**
+     * @brief Workers successfully bound to a CPU (0 without a pinning policy)
+     */
+    int pinned_workers() const { return m_pinned.load(); }
+
+    /**
+     * @brief Grain used when a loop passes 0: about 8 chunks per thread
+     *
+     * Enough chunks for stealing to even out skewed iterations while keeping
+     * per-chunk overhead (one task) small against the chunk's work.
+     */
+    int64_t default_grain(int64_t count) const {
+        return std::max<int64_t>(1, count / (static_cast<int64_t>(thread_count()) * 8));
+    }
+
+    /**
+     * @brief Queue a task that nobody joins (coroutine resumptions, see coroutine.hpp)
+     *
+     * Runs without a ThreadBudget: the poster's budget belongs to a job that may
+     * have finished by the time the task runs. An exception escaping @p task
+     * terminates the process, as with std::thread. Workers drain posted tasks
+     * before the scheduler is destroyed. A 1-thread scheduler has no workers, so
+     * its posted tasks run on one extra thread started by the first post().
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Run one queued task on the calling thread, if any
+     * @return False when nothing was queued (or another thread took it first)
+     */
+    bool try_run_one();
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group = nullptr;      // Null for post()ed tasks
+        ThreadBudget* budget = nullptr;  // Spawner's budget, installed while the task runs (null for post()ed tasks)
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;  // Owner uses the back, thieves the front
+    };
+
+    void push(Task task);
+    bool pop_own(Task& task);
+    bool steal(Task& task, size_t start);
+    void execute(Task& task);
+    void worker_loop(size_t index, int cpu);
+    void post_loop();
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;  // One per worker, last one for external threads
+    std::vector<std::thread> m_workers;
+
+    // 1-thread schedulers only: post()ed tasks and the thread that runs them
+    std::mutex m_post_mutex;
+    std::condition_variable m_post_wake;
+    std::deque<std::function<void()>> m_posted;
+    std::thread m_post_thread;
+    bool m_post_stop = false;
+
+    std::atomic<int> m_pinned{0};
+    std::atomic<int64_t> m_queued{0};   // Pushed but not yet taken
+    std::atomic<int> m_sleepers{0};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_stop{false};
+};
+
+/**
+ * @brief Fork-join group: run() forks tasks, wait() joins them
+ *
+ * wait() executes pending tasks (of any group) until every task of this group
+ * finished, then rethrows the first exception a task threw. The destructor waits
+ * too, so tasks never outlive the data they captured by reference.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::global())
+        : m_scheduler(scheduler) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    friend class TaskScheduler;
+
+    void finished(std::exception_ptr error);
+
+    TaskScheduler& m_scheduler;
+    std::atomic<int> m_pending{0};
+    std::mutex m_error_mutex;
+    std::exception_ptr m_error;
+};
+
+namespace detail {
+
+template<typename Body>
+void parallel_for_split(TaskScheduler& scheduler, int64_t begin, int64_t end, int64_t grain, const Body& body) {
+    if (end - begin <= grain) {
+        body(begin, end);
+        return;
+    }
+    const int64_t mid = begin + (end - begin) / 2;
+    TaskGroup group(scheduler);
+    group.run([&scheduler, mid, end, grain, &body]() {
+        parallel_for_split(scheduler, mid, end, grain, body);
+    });
+    parallel_for_split(scheduler, begin, mid, grain, body);
+    group.wait();
+}
+
+// Budgeted loops: the caller plus the helpers the budget grants pull fixed chunks
+// from a shared counter; chunk(chunk_begin, chunk_end, chunk_index) runs each one
+template<typename Chunk>
+void run_budgeted(TaskScheduler& scheduler, ThreadBudget& budget, int64_t begin, int64_t end, int64_t grain,
+                  int64_t chunks, const Chunk& chunk) {
+    std::atomic<int64_t> next{0};
+    auto strand = [&]() {
+        for (int64_t index = next.fetch_add(1); index < chunks; index = next.fetch_add(1)) {
+            const int64_t chunk_begin = begin + index * grain;
+            chunk(chunk_begin, std::min(end, chunk_begin + grain), index);
+        }
+    };
+
+    const int wanted = static_cast<int>(std::min<int64_t>(chunks - 1, budget.threads() - 1));
+    const int helpers = budget.try_acquire(wanted);
+    TaskGroup group(scheduler);
+    for (int h = 0; h < helpers; ++h) {
+        group.run([&budget, &strand]() {
+            struct Release {
+                ThreadBudget& budget;
+                ~Release() { budget.release(1); }
+            } release{budget};
+            strand();
+        });
+    }
+    strand();
+    group.wait();
+}
+
+template<typename T, typename Map, typename Combine>
+T parallel_reduce_split(TaskScheduler& scheduler, int64_t begin, int64_t end, int64_t grain,
+                        const Map& map, const Combine& combine) {
+    if (end - begin <= grain) {
+        return map(begin, end);
+    }
+    const int64_t mid = begin + (end - begin) / 2;
+    T right{};
+    TaskGroup group(scheduler);
+    group.run([&scheduler, &right, mid, end, grain, &map, &combine]() {
+        right = parallel_reduce_split<T>(scheduler, mid, end, grain, map, combine);
+    });
+    T left = parallel_reduce_split<T>(scheduler, begin, mid, grain, map, combine);
+    group.wait();
+    return combine(std::move(left), std::move(right));
+}
+
+} // namespace detail
+
+/**
+ * @brief Parallel loop over [begin, end) on the work-stealing scheduler
+ *
+ * The range is split recursively down to chunks of at most @p grain indices; idle
+ * threads steal the larger unsplit halves, so uneven iteration costs are balanced.
+ * Under a ThreadBudget, the calling thread and the helpers the budget grants take
+ * chunks from a shared counter instead.
+ *
+ * @param body Called as body(i) for every index, or body(chunk_begin, chunk_end) per chunk
+ * @param grain Maximum indices per chunk (0 = scheduler.default_grain())
+ */
+template<typename Body>
+void parallel_for(int64_t begin, int64_t end, Body&& body, int64_t grain = 0,
+                  TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (end <= begin) {
+        return;
+    }
+    if (grain <= 0) {
+        grain = scheduler.default_grain(end - begin);
+    }
+    auto chunk = [&body](int64_t chunk_begin, int64_t chunk_end) {
+        if constexpr (std::is_invocable_v<Body&, int64_t, int64_t>) {
+            body(chunk_begin, chunk_end);
+        } else {
+            for (int64_t i = chunk_begin; i < chunk_end; ++i) {
+                body(i);
+            }
+        }
+    };
+    if (ThreadBudget* budget = ThreadBudget::current()) {
+        const int64_t chunks = (end - begin + grain - 1) / grain;
+        detail::run_budgeted(scheduler, *budget, begin, end, grain, chunks,
+                             [&chunk](int64_t chunk_begin, int64_t chunk_end, int64_t) { chunk(chunk_begin, chunk_end); });
+        return;
+    }
+    detail::parallel_for_split(scheduler, begin, end, grain, chunk);
+}
+
+/**
+ * @brief Parallel map-reduce over [begin, end) on the work-stealing scheduler
+ *
+ * Partial results are combined along the split tree, so for a given grain the
+ * combination order is fixed regardless of which thread ran which chunk.
+ *
+ * @param identity Result for an empty range
+ * @param map Called as map(chunk_begin, chunk_end) -> T for each chunk
+ * @param combine Called as combine(left, right) -> T; must be associative
+ * @param grain Maximum indices per chunk (0 = scheduler.default_grain())
+ */
+template<typename T, typename Map, typename Combine>
+T parallel_reduce(int64_t begin, int64_t end, T identity, Map&& map, Combine&& combine, int64_t grain = 0,
+                  TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (end <= begin) {
+        return identity;
+    }
+    if (grain <= 0) {
+        grain = scheduler.default_grain(end - begin);
+    }
+    if (ThreadBudget* budget = ThreadBudget::current()) {
+        // Chunk results are combined left to right, so the order does not depend on the helpers
+        const int64_t chunks = (end - begin + grain - 1) / grain;
+        std::vector<T> partials(static_cast<size_t>(chunks));
+        detail::run_budgeted(scheduler, *budget, begin, end, grain, chunks,
+                             [&partials, &map](int64_t chunk_begin, int64_t chunk_end, int64_t index) {
+                                 partials[static_cast<size_t>(index)] = map(chunk_begin, chunk_end);
+                             });
+        T result = std::move(partials[0]);
+        for (size_t i = 1; i < partials.size(); ++i) {
+            result = combine(std::move(result), std::move(partials[i]));
+        }
+        return result;
+    }
+    return detail::parallel_reduce_split<T>(scheduler, begin, end, grain, map, combine);
+}
+
+} // namespace bedrock
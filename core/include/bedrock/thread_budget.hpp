@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bedrock {
+
+/**
+ * @brief Number of threads one job may keep busy at once
+ *
+ * A budget of N lets the job's thread plus up to N - 1 helpers run its parallel
+ * work. Helpers are taken as tokens (try_acquire) by each parallel loop and
+ * returned when the loop's helper finishes, so nested loops share the job's
+ * budget instead of multiplying it: a nested loop that finds no free token runs
+ * serially on its own thread.
+ *
+ * The size may change while the job runs (CoreAllocator rebalancing); loops that
+ * start afterwards see the new size, loops already running keep their helpers.
+ *
+ * Install a budget on a thread with ThreadBudget::Scope. TaskScheduler tasks
+ * inherit the budget of the thread that spawned them, and OpenMP regions started
+ * inside the scope use at most threads() threads (omp_set_num_threads only
+ * affects the calling thread's ICV, not the process).
+ *
+ * Tasks of the job that run on other threads add their thread CPU time to the
+ * budget (helper_cpu_ns), so the job's CPU time is its own thread's plus that.
+ */
+class ThreadBudget {
+public:
+    /**
+     * @param threads Threads the job may use, including its own (clamped to >= 1)
+     */
+    explicit ThreadBudget(int threads);
+
+    ThreadBudget(const ThreadBudget&) = delete;
+    ThreadBudget& operator=(const ThreadBudget&) = delete;
+
+    int threads() const { return m_threads.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Resize the budget; helpers above the new size are not handed out again
+     */
+    void set_threads(int threads);
+
+    /**
+     * @brief Helpers not currently taken by a loop of this job
+     */
+    int available() const { return m_available.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Take up to @p wanted helper tokens
+     * @return Tokens granted (0 .. wanted); give them back with release()
+     */
+    int try_acquire(int wanted);
+
+    void release(int count);
+
+    /**
+     * @brief CPU time spent by other threads running this job's tasks, nanoseconds
+     *
+     * Covers TaskScheduler tasks (parallel_for, TaskGroup) that ran on a thread
+     * without this budget installed; work on the job's own thread is not counted
+     * here, and threads of OpenMP regions are not counted at all.
+     */
+    uint64_t helper_cpu_ns() const { return m_helper_cpu_ns.load(std::memory_order_relaxed); }
+
+    void add_helper_cpu_ns(uint64_t ns) { m_helper_cpu_ns.fetch_add(ns, std::memory_order_relaxed); }
+
+    /**
+     * @brief CPU time consumed so far by the calling thread (0 where the platform cannot tell)
+     */
+    static uint64_t thread_cpu_ns();
+
+    /**
+     * @brief Budget installed on the calling thread, or nullptr
+     */
+    static ThreadBudget* current();
+
+    /**
+     * @brief Threads the calling thread may use: its budget, else ThreadingConfig's count
+     */
+    static int current_threads();
+
+    /**
+     * @brief RAII: installs a budget on the calling thread, restores the previous one on exit
+     *
+     * Scopes nest; a nullptr budget removes any budget for the scope's duration.
+     */
+    class Scope {
+    public:
+        explicit Scope(ThreadBudget* budget);
+        explicit Scope(ThreadBudget& budget) : Scope(&budget) {}
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ThreadBudget* m_previous;
+        int m_previous_omp_threads;
+    };
+
+private:
+    std::atomic<int> m_threads;
+    std::atomic<int> m_available;  // Negative after shrinking until helpers come back
+    std::atomic<uint64_t> m_helper_cpu_ns{0};
+};
+
+/**
+ * @brief Divides a machine's cores among concurrently running jobs
+ *
+ * Every running job holds a budget; whenever a job starts or finishes, the cores
+ * are shared out again (water-filling: jobs asking for less than an equal share
+ * get what they asked for, the rest split what remains), never below 1 per job
+ * since the job's own thread always runs. A lone job gets every core and shrinks
+ * as others arrive. Thread-safe.
+ */
+class CoreAllocator {
+public:
+    /**
+     * @param total_threads Cores to divide (0 = ThreadingConfig::get_optimal_thread_count())
+     */
+    explicit CoreAllocator(int total_threads = 0);
+
+    /**
+     * @brief Budget for one job; its cores return when the last reference is dropped
+     * @param requested Threads the job would like (0 = as many as its fair share allows)
+     */
+    std::shared_ptr<ThreadBudget> acquire(int requested = 0);
+
+    int total() const { return m_total; }
+    int in_use() const;
+    int active_jobs() const;
+
+private:
+    struct Job {
+        ThreadBudget* budget;
+        int requested;
+    };
+    struct State {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+    };
+
+    static void rebalance(State& state, int total);
+
+    int m_total;
+    std::shared_ptr<State> m_state;  // Shared with outstanding budgets
+};
+
+} // namespace bedrock
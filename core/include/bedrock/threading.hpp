@@ -1,6 +1,7 @@
 #pragma once
 
 #include <omp.h>
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -10,6 +11,10 @@
 #include <cmath>
 #include <limits>
 
+#include "bedrock/profiler.hpp"
+#include "bedrock/trace.hpp"
+#include "bedrock/tuning_profile.hpp"
+
 namespace bedrock {
 
 /**
@@ -22,7 +27,7 @@ class ThreadingConfig {
 public:
     /**
      * @brief Initialize threading configuration
-     * @param max_threads Maximum number of threads to use (0 = auto-detect)
+     * @param max_threads Maximum number of threads to use (0 = auto-detect; clamped to CpuResources::usable_threads)
      */
     static void initialize(int max_threads = 0);
     
@@ -34,13 +39,17 @@ public:
     
     /**
      * @brief Set the number of threads for OpenMP
-     * @param num_threads Number of threads (0 = auto-detect)
+     *
+     * Inside a ThreadBudget scope this only bounds the calling thread's regions,
+     * clamped to the budget; the process-wide default is left alone.
+     *
+     * @param num_threads Number of threads (0 = auto-detect, or the whole budget)
      */
     static void set_thread_count(int num_threads);
     
     /**
      * @brief Get current thread count
-     * @return Current number of threads
+     * @return Threads the calling thread's next OpenMP region uses (within its ThreadBudget)
      */
     static int get_thread_count();
     
@@ -68,26 +77,129 @@ private:
     static int s_max_threads;
 };
 
+/**
+ * @brief Summary of repeated timings of one configuration
+ */
+struct SampleStats {
+    int count = 0;
+    double median_ms = 0.0;
+    double mean_ms = 0.0;
+    double stddev_ms = 0.0;   ///< Sample standard deviation
+    double min_ms = 0.0;
+    double max_ms = 0.0;
+    double ci_low_ms = 0.0;   ///< 95% confidence interval of the median (order statistics)
+    double ci_high_ms = 0.0;
+
+    /**
+     * @brief Summarize timings; the median's interval is distribution-free, so outliers do not widen it much
+     *
+     * With fewer than 6 samples no order statistics give 95% coverage and the
+     * interval is [min, max].
+     */
+    static SampleStats from_samples(std::vector<double> samples_ms);
+};
+
+/**
+ * @brief One thread count of a scaling curve
+ */
+struct ScalingPoint {
+    int threads = 0;
+    SampleStats time;
+    double speedup = 0.0;      ///< 1-thread median / this median
+    double efficiency = 0.0;   ///< speedup / threads
+};
+
+/**
+ * @brief How measure_scaling() samples
+ */
+struct ScalingOptions {
+    std::vector<int> thread_counts;  ///< Empty = 1, 2, 4, ... and the maximum; 1 is always added as the baseline
+    int warmup_runs = 2;             ///< Untimed runs per thread count before sampling
+    int samples = 15;                ///< Timed samples per thread count
+    int iterations = 1;              ///< Kernel calls per sample (for kernels shorter than ~1 ms)
+};
+
+/**
+ * @brief Scaling curve of one kernel
+ */
+struct ScalingResult {
+    std::string name;
+    std::vector<ScalingPoint> points;  ///< By ascending thread count, starting at 1
+
+    /**
+     * @brief Text table: median, CI, speedup and efficiency per thread count
+     */
+    std::string report() const;
+};
+
 /**
  * @brief Performance measurement utilities for threading optimization
  */
 class ThreadingBenchmark {
 public:
     /**
-     * @brief Benchmark a function with different thread counts
+     * @brief Median time per call of @p func at each thread count
+     *
+     * Shorthand for measure_scaling() with @p iterations calls per sample.
+     *
      * @tparam Func Function type
      * @param func Function to benchmark
-     * @param iterations Number of iterations to run
-     * @return Vector of (thread_count, time_ms) pairs
+     * @param iterations Calls per timed sample
+     * @return Vector of (thread_count, median time_ms) pairs
      */
     template<typename Func>
     static std::vector<std::pair<int, double>> benchmark_thread_scaling(
         Func&& func, 
         int iterations = 10
-    );
+    ) {
+        ScalingOptions options;
+        options.iterations = std::max(1, iterations);
+        const ScalingResult result = measure_scaling("benchmark", std::function<void()>(std::forward<Func>(func)), options);
+        std::vector<std::pair<int, double>> times;
+        for (const ScalingPoint& point : result.points) {
+            times.push_back({point.threads, point.time.median_ms});
+        }
+        return times;
+    }
+
+    /**
+     * @brief Measure how @p kernel's run time scales with the thread count
+     *
+     * Each thread count runs under a ThreadBudget of that size, which bounds
+     * both OpenMP regions and TaskScheduler loops; counts stay within the usable
+     * threads and the caller's own budget. After the warm-ups, samples are taken
+     * round-robin over the thread counts so that clock or thermal drift spreads
+     * over all of them instead of biasing one.
+     */
+    static ScalingResult measure_scaling(const std::string& name, const std::function<void()>& kernel,
+                                         const ScalingOptions& options = {});
+
+    /**
+     * @brief measure_scaling() for every registered kernel (tunable_kernels(), default grain)
+     */
+    static std::vector<ScalingResult> measure_registered_scaling(const ScalingOptions& options = {});
+
+    /**
+     * @brief Scaling results as JSON, with the CPU model and usable threads
+     */
+    static std::string scaling_to_json(const std::vector<ScalingResult>& results);
+
+    /**
+     * @brief Scaling results as CSV, one row per kernel and thread count
+     */
+    static std::string scaling_to_csv(const std::vector<ScalingResult>& results);
+
+    /**
+     * @brief Write scaling_to_csv() for a ".csv" path, scaling_to_json() otherwise
+     */
+    static bool save_scaling(const std::string& path, const std::vector<ScalingResult>& results);
     
     /**
      * @brief Measure optimal batch size for ray tracing
+     *
+     * Times a synthetic loop; for a real kernel register it with
+     * register_tunable_kernel() and read its grain from TuningProfile::lookup().
+     *
      * @param total_rays Total number of rays to process
      * @param min_batch_size Minimum batch size to test
      * @param max_batch_size Maximum batch size to test
@@ -100,17 +212,32 @@ public:
     );
     
     /**
-     * @brief Calibrate threading for the current system
-     * @return Calibration results
+     * @brief Find each kernel's fastest thread count and grain
+     *
+     * Sweeps thread counts (powers of two up to the usable threads, each bounded
+     * with a ThreadBudget) and, per count, grains of 1 to 32 chunks per thread,
+     * keeping the best of @p repetitions runs after a warm-up. A higher thread
+     * count must be at least 3% faster to win, leaving spare cores to concurrent jobs.
+     */
+    static TuningProfile calibrate_kernels(const std::vector<TunableKernel>& kernels, int repetitions = 3);
+
+    /**
+     * @brief Calibrate the registered kernels (tunable_kernels()) and install the profile
+     * @param profile_path Also save the profile here when not empty
+     * @return Calibration report
      */
-    static std::string calibrate_system();
+    static std::string calibrate_system(const std::string& profile_path = "");
 
 private:
     static double measure_execution_time(std::function<void()> func, int iterations);
 };
 
 /**
- * @brief Thread-safe performance counter
+ * @brief Stopwatch for one owner thread
+ *
+ * Accumulates the time between start() and stop() pairs; get_elapsed_ms()
+ * includes the running interval while started. For per-zone statistics across
+ * threads use bedrock::Profiler (BEDROCK_TIMER / BEDROCK_PROFILE_ZONE).
  */
 class PerformanceCounter {
 public:
@@ -119,29 +246,59 @@ public:
     
     void start();
     void stop();
+    void reset();
     double get_elapsed_ms() const;
     double get_elapsed_seconds() const;
+    const std::string& name() const { return m_name; }
     
 private:
     std::string m_name;
-    std::chrono::high_resolution_clock::time_point m_start_time;
+    std::chrono::steady_clock::time_point m_start_time;
+    std::chrono::steady_clock::duration m_elapsed{0};
     bool m_running;
 };
 
 /**
- * @brief RAII performance timer
+ * @brief RAII performance timer: a bedrock::Profiler zone
+ *
+ * Nothing is allocated or printed; timings are aggregated per zone path and
+ * read with Profiler::report(). Also records a "kernel" span when
+ * bedrock::Tracer is enabled, so BEDROCK_TIMER scopes nest under request spans
+ * in exported traces.
  */
 class ScopedTimer {
 public:
-    ScopedTimer(const std::string& name);
-    ~ScopedTimer();
-    
+    explicit ScopedTimer(uint32_t zone)
+        : m_zone(zone)
+        , m_trace_start_ns(Tracer::is_enabled() ? Tracer::now_ns() : 0)
+        , m_profile(zone) {}
+
+    /// Names built at runtime; registers the name on every construction, so prefer BEDROCK_TIMER
+    explicit ScopedTimer(const std::string& name)
+        : ScopedTimer(Profiler::register_zone(name)) {}
+
+    ~ScopedTimer() {
+        if (m_trace_start_ns != 0 && Tracer::is_enabled()) {
+            Tracer::record("kernel", Profiler::zone_name(m_zone), m_trace_start_ns, Tracer::now_ns());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
 private:
-    std::unique_ptr<PerformanceCounter> m_counter;
+    uint32_t m_zone;
+    uint64_t m_trace_start_ns;
+    ProfileZone m_profile;
 };
 
 // Convenience macros for performance measurement
-#define BEDROCK_TIMER(name) bedrock::ScopedTimer _timer(name)
+// BEDROCK_TIMER registers its name once per call site: pass a literal (or other constant)
+#define BEDROCK_TIMER(name)                                                                 \
+    static const uint32_t BEDROCK_PROFILE_CONCAT(_bedrock_timer_id_, __LINE__) =            \
+        bedrock::Profiler::register_zone(name);                                             \
+    bedrock::ScopedTimer BEDROCK_PROFILE_CONCAT(_bedrock_timer_, __LINE__)(                 \
+        BEDROCK_PROFILE_CONCAT(_bedrock_timer_id_, __LINE__))
 #define BEDROCK_PARALLEL_FOR(iterations) _Pragma("omp parallel for") for(int i = 0; i < (iterations); ++i)
 
 } // namespace bedrock
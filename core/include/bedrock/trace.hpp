@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bedrock {
+
+/**
+ * @brief Span tracer with Chrome trace (Perfetto-compatible) JSON export
+ *
+ * Tracing is off by default; when disabled a span costs one relaxed atomic load.
+ * When enabled, each thread appends completed spans to its own buffer without
+ * locks (the buffer is registered once per thread). Export may run at any time
+ * from any thread and sees every span published before it started. clear()
+ * starts a new window: full buffers record again, and buffers of exited threads
+ * are released (a new thread reuses an exited thread's emptied buffer).
+ *
+ * Load the output in chrome://tracing or https://ui.perfetto.dev.
+ */
+class Tracer {
+public:
+    /// Maximum stored span name length (longer names are truncated)
+    static constexpr size_t MAX_NAME_LENGTH = 47;
+
+    /// Spans kept per thread between clear() calls; further spans are counted as dropped
+    static constexpr size_t MAX_SPANS_PER_THREAD = 1 << 18;
+
+    /**
+     * @brief Enable or disable span recording
+     */
+    static void set_enabled(bool enabled);
+
+    /**
+     * @brief Check whether spans are being recorded
+     */
+    static bool is_enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Monotonic timestamp used for all spans, in nanoseconds
+     */
+    static uint64_t now_ns();
+
+    /**
+     * @brief Record a completed span on the calling thread
+     * @param category Static category string (e.g. "palantir", "kernel")
+     * @param name Span name (copied, truncated to MAX_NAME_LENGTH)
+     * @param start_ns Start time from now_ns()
+     * @param end_ns End time from now_ns()
+     * @param id Optional correlation id (e.g. request sequence number), 0 = none
+     */
+    static void record(const char* category, std::string_view name,
+                       uint64_t start_ns, uint64_t end_ns, uint64_t id = 0);
+
+    /**
+     * @brief Name the calling thread in exported traces
+     */
+    static void set_thread_name(std::string_view name);
+
+    /**
+     * @brief Discard all spans recorded so far and free the buffers of exited threads
+     */
+    static void clear();
+
+    /**
+     * @brief Number of per-thread buffers held (live threads plus exited ones with spans)
+     */
+    static size_t buffer_count();
+
+    /**
+     * @brief Number of spans currently held across all threads
+     */
+    static size_t span_count();
+
+    /**
+     * @brief Number of spans dropped because a thread buffer was full
+     */
+    static size_t dropped_count();
+
+    /**
+     * @brief Render all recorded spans as Chrome trace JSON
+     */
+    static std::string chrome_trace_json();
+
+    /**
+     * @brief Write Chrome trace JSON to a file
+     * @return True on success
+     */
+    static bool write_chrome_trace(const std::string& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @brief RAII span: records [construction, destruction) when tracing is enabled
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* category, std::string_view name, uint64_t id = 0)
+        : m_category(category), m_name(name), m_id(id),
+          m_start_ns(Tracer::is_enabled() ? Tracer::now_ns() : 0) {}
+
+    ~TraceSpan() {
+        if (m_start_ns != 0 && Tracer::is_enabled()) {
+            Tracer::record(m_category, m_name, m_start_ns, Tracer::now_ns(), m_id);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_category;
+    std::string_view m_name;
+    uint64_t m_id;
+    uint64_t m_start_ns;
+};
+
+#define BEDROCK_TRACE_CONCAT_INNER(a, b) a##b
+#define BEDROCK_TRACE_CONCAT(a, b) BEDROCK_TRACE_CONCAT_INNER(a, b)
+
+// Trace the enclosing scope; name must outlive the scope (literals are fine)
+#define BEDROCK_TRACE_SPAN(category, name) \
+    bedrock::TraceSpan BEDROCK_TRACE_CONCAT(_bedrock_trace_span_, __LINE__)(category, name)
+
+} // namespace bedrock
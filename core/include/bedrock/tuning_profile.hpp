@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bedrock {
+
+/**
+ * @brief Measured best settings for one kernel
+ */
+struct KernelTuning {
+    int threads = 0;        ///< Thread count that ran it fastest (0 = untuned)
+    int64_t grain = 0;      ///< Loop grain (indices per chunk) at that thread count (0 = untuned)
+    int64_t items = 0;      ///< Problem size it was tuned at
+    double time_ms = 0.0;   ///< Best time per run at the tuned setting
+};
+
+/**
+ * @brief Per-kernel thread counts and grain sizes measured on this machine
+ *
+ * Produced by ThreadingBenchmark::calibrate_kernels() and saved as a small
+ * versioned text file:
+ *
+ *   # bedrock tuning profile
+ *   version 1
+ *   cpu_model Intel(R) Xeon(R) Gold 6338 CPU @ 2.00GHz
+ *   usable_threads 16
+ *   kernel xy_sine threads 8 grain 32768 items 1000000 time_ms 2.41
+ *
+ * A profile is only loaded on the CPU model it was measured on. The server
+ * installs it at start (install()); kernels read their settings with lookup()
+ * and fall back to their own defaults when a kernel is untuned.
+ */
+struct TuningProfile {
+    static constexpr int FORMAT_VERSION = 1;
+
+    std::string cpu_model;
+    int usable_threads = 0;                       ///< CpuResources::usable_threads when measured
+    std::map<std::string, KernelTuning> kernels;  ///< By kernel name
+
+    /**
+     * @brief Tuning for @p kernel, or nullptr
+     */
+    const KernelTuning* find(const std::string& kernel) const;
+
+    std::string serialize() const;
+
+    /**
+     * @brief Parse serialize() output
+     * @return std::nullopt (and a reason in @p error) on malformed text or another format version
+     */
+    static std::optional<TuningProfile> parse(const std::string& text, std::string* error = nullptr);
+
+    /**
+     * @brief Write the profile, creating parent directories; replaces the file atomically
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Read a profile measured on this CPU model
+     * @return std::nullopt (and a reason in @p error) when missing, malformed or from another CPU
+     */
+    static std::optional<TuningProfile> load(const std::string& path, std::string* error = nullptr);
+
+    /**
+     * @brief "model name" from /proc/cpuinfo ("unknown" where unavailable)
+     */
+    static std::string current_cpu_model();
+
+    /**
+     * @brief $BEDROCK_TUNING_PROFILE, else $XDG_CACHE_HOME or ~/.cache /bedrock/tuning_profile.txt
+     */
+    static std::string default_path();
+
+    /**
+     * @brief Make @p profile the process-wide profile read by lookup() (thread-safe)
+     */
+    static void install(TuningProfile profile);
+
+    /**
+     * @brief Installed profile, or nullptr
+     */
+    static std::shared_ptr<const TuningProfile> active();
+
+    /**
+     * @brief Installed tuning for @p kernel, threads clamped to the usable threads
+     * @return Zeroed KernelTuning when no profile is installed or the kernel is untuned
+     */
+    static KernelTuning lookup(const std::string& kernel);
+};
+
+/**
+ * @brief A real kernel that calibration can run at a given grain
+ *
+ * run(grain) executes one representative problem of @p items loop indices with
+ * parallel_for(..., grain); calibration bounds its threads with a ThreadBudget.
+ */
+struct TunableKernel {
+    std::string name;
+    int64_t items = 0;
+    std::function<void(int64_t grain)> run;
+};
+
+/**
+ * @brief Add a kernel to the calibration set (replaces a kernel of the same name)
+ */
+void register_tunable_kernel(TunableKernel kernel);
+
+/**
+ * @brief Registered kernels, by name
+ */
+std::vector<TunableKernel> tunable_kernels();
+
+} // namespace bedrock
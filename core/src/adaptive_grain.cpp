@@ -0,0 +1,119 @@
+#include "bedrock/adaptive_grain.hpp"
+
+#include <cmath>
+
+namespace bedrock {
+
+namespace {
+
+// Tail divisor bounds and the idle ratios that move it
+constexpr int MIN_TAIL_DIVISOR = 1;
+constexpr int MAX_TAIL_DIVISOR = 16;
+constexpr double IDLE_HIGH = 0.05;
+constexpr double IDLE_LOW = 0.01;
+
+// Chunks per thread for the very first loop, before any cost is known
+constexpr int64_t FIRST_LOOP_CHUNKS_PER_THREAD = 64;
+
+} // namespace
+
+AdaptiveGrain::AdaptiveGrain(std::chrono::nanoseconds target_chunk, int64_t min_grain, int64_t max_grain)
+    : m_target(std::max(target_chunk, std::chrono::nanoseconds(1)))
+    , m_min_grain(std::max<int64_t>(1, min_grain))
+    , m_max_grain(std::max(std::max<int64_t>(1, min_grain), max_grain)) {
+}
+
+AdaptiveGrain::Stats AdaptiveGrain::stats() const {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    Stats stats = m_stats;
+    stats.grain = grain();
+    stats.tail_divisor = tail_divisor();
+    stats.mean_chunk_us = stats.chunks > 0 ? static_cast<double>(m_busy_ns) / static_cast<double>(stats.chunks) / 1000.0 : 0.0;
+    return stats;
+}
+
+int64_t AdaptiveGrain::initial_grain(int64_t count, int threads) const {
+    if (const int64_t learned = grain(); learned > 0) {
+        return learned;
+    }
+    return clamp(static_cast<double>(count) / (static_cast<double>(std::max(1, threads)) * FIRST_LOOP_CHUNKS_PER_THREAD));
+}
+
+int64_t AdaptiveGrain::clamp(double grain) const {
+    if (!(grain >= 1.0)) {
+        return m_min_grain;
+    }
+    return std::clamp(static_cast<int64_t>(std::llround(std::min(grain, 9.0e18))), m_min_grain, m_max_grain);
+}
+
+void AdaptiveGrain::finish_loop(const detail::AdaptiveLoop& loop, int64_t count) {
+    const int strands = loop.strands.load();
+    const int64_t end_ns = std::max(loop.finish_max_ns.load(), int64_t{1});
+    // Thread time between each strand running out of chunks and the last one finishing
+    const double idle = strands > 1
+        ? static_cast<double>(strands * end_ns - loop.finish_sum_ns.load()) / (static_cast<double>(strands) * end_ns)
+        : 0.0;
+
+    m_grain.store(loop.grain.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if (strands > 1) {
+        int divisor = tail_divisor();
+        if (idle > IDLE_HIGH) {
+            divisor = std::min(divisor * 2, MAX_TAIL_DIVISOR);
+        } else if (idle < IDLE_LOW) {
+            divisor = std::max(divisor / 2, MIN_TAIL_DIVISOR);
+        }
+        m_tail_divisor.store(divisor, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    const int64_t busy = loop.busy_ns.load();
+    m_stats.loops += 1;
+    m_stats.chunks += loop.chunks.load();
+    m_stats.items += count;
+    m_stats.ns_per_item = count > 0 ? static_cast<double>(busy) / static_cast<double>(count) : 0.0;
+    m_stats.idle_ratio = idle;
+    m_stats.helper_joins += loop.helper_joins.load();
+    m_busy_ns += busy;
+}
+
+namespace detail {
+
+AdaptiveLoop::AdaptiveLoop(AdaptiveGrain& control, int64_t begin, int64_t count, int threads)
+    : control(control)
+    , next(begin)
+    , grain(control.initial_grain(count, threads)) {
+}
+
+void AdaptiveLoop::record_chunk(int64_t items, int64_t elapsed_ns) {
+    chunks.fetch_add(1, std::memory_order_relaxed);
+    busy_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+
+    // Geometric step toward the grain that would take the target: halves the
+    // (log) error per chunk, so noise in one timing cannot swing it far
+    const double per_item = static_cast<double>(std::max<int64_t>(elapsed_ns, 1)) / static_cast<double>(items);
+    const double wanted = static_cast<double>(control.target_chunk().count()) / per_item;
+    const double current = static_cast<double>(grain.load(std::memory_order_relaxed));
+    grain.store(control.clamp(std::sqrt(current * wanted)), std::memory_order_relaxed);
+}
+
+void AdaptiveLoop::finish_strand(bool ran, bool helper, int64_t finish_ns) {
+    if (!ran) {
+        return;  // Arrived after the range was taken: cost nothing, waited for nothing
+    }
+    strands.fetch_add(1, std::memory_order_relaxed);
+    if (helper) {
+        helper_joins.fetch_add(1, std::memory_order_relaxed);
+    }
+    finish_sum_ns.fetch_add(finish_ns, std::memory_order_relaxed);
+    int64_t seen = finish_max_ns.load(std::memory_order_relaxed);
+    while (finish_ns > seen && !finish_max_ns.compare_exchange_weak(seen, finish_ns, std::memory_order_relaxed)) {
+    }
+}
+
+void AdaptiveLoop::finish(int64_t count) {
+    control.finish_loop(*this, count);
+}
+
+} // namespace detail
+
+} // namespace bedrock
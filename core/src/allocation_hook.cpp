@@ -0,0 +1,165 @@
+// Global operator new / delete that charge every allocation to the calling
+// thread's MemoryTagScope (see memory_tracking.hpp). Built as an object library
+// so that linking it always replaces the allocation functions; only executables
+// that opt in link it (CMake BEDROCK_TRACK_ALLOCATIONS for bedrock_server).
+
+#include "bedrock/memory_tracking.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+using bedrock::MemorySubsystem;
+using bedrock::MemoryTracker;
+
+// Sits directly before each block, so a delete on any thread credits the subsystem that allocated
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    MemorySubsystem subsystem;
+};
+static_assert(sizeof(BlockHeader) == 16, "header must keep malloc's 16-byte alignment");
+
+size_t header_offset(size_t alignment) {
+    return std::max(sizeof(BlockHeader), alignment);
+}
+
+void* allocate(size_t size, size_t alignment) noexcept {
+    const size_t offset = header_offset(alignment);
+    void* base = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        base = std::malloc(size + offset);
+    } else {
+        // aligned_alloc wants a multiple of the alignment
+        base = std::aligned_alloc(alignment, (size + offset + alignment - 1) / alignment * alignment);
+    }
+    if (!base) {
+        return nullptr;
+    }
+    char* block = static_cast<char*>(base) + offset;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block) - 1;
+    header->size = size;
+    header->subsystem = MemoryTracker::current_tag();
+    MemoryTracker::record_allocation(header->subsystem, size);
+    return block;
+}
+
+void release(void* pointer, size_t alignment) noexcept {
+    if (!pointer) {
+        return;
+    }
+    const BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+    MemoryTracker::record_deallocation(header->subsystem, header->size);
+    std::free(static_cast<char*>(pointer) - header_offset(alignment));
+}
+
+void* allocate_or_throw(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* block = allocate(size, alignment)) {
+            return block;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocate_or_null(size_t size, size_t alignment) noexcept {
+    try {
+        return allocate_or_throw(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+constexpr size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+[[maybe_unused]] const bool g_installed = (MemoryTracker::mark_allocation_hook_installed(), true);
+
+} // namespace
+
+void* operator new(size_t size) {
+    return allocate_or_throw(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](size_t size) {
+    return allocate_or_throw(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_or_null(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    release(pointer, static_cast<size_t>(alignment));
+}
@@ -0,0 +1,29 @@
+#include "bedrock/coroutine.hpp"
+
+namespace bedrock {
+
+Executor& compute_executor() {
+    static SchedulerExecutor executor(TaskScheduler::global());
+    return executor;
+}
+
+QueueExecutor::QueueExecutor(std::function<void()> wake)
+    : m_wake(std::move(wake)) {}
+
+void QueueExecutor::post(std::function<void()> work) {
+    m_queue.push(std::move(work));
+    if (m_wake) {
+        m_wake();
+    }
+}
+
+size_t QueueExecutor::run_pending() {
+    size_t ran = 0;
+    while (auto work = m_queue.try_pop()) {
+        (*work)();
+        ++ran;
+    }
+    return ran;
+}
+
+} // namespace bedrock
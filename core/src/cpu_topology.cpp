@@ -0,0 +1,487 @@
+#include "bedrock/cpu_topology.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <tuple>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace bedrock {
+
+namespace {
+
+std::optional<std::string> read_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.pop_back();
+    }
+    return text;
+}
+
+std::string join_path(const std::string& root, const std::string& path) {
+    if (root.empty() || root == "/") {
+        return path;
+    }
+    return (root.back() == '/' ? root.substr(0, root.size() - 1) : root) + path;
+}
+
+std::string parent_of(const std::string& cgroup_path) {
+    const size_t slash = cgroup_path.find_last_of('/');
+    return slash == 0 || slash == std::string::npos ? "/" : cgroup_path.substr(0, slash);
+}
+
+// Tightest quota on the way from the process's cgroup up to the hierarchy root
+template<typename ReadQuota>
+std::optional<double> tightest_quota(const std::string& mount, std::string cgroup_path, ReadQuota read_quota,
+                                     std::string& source) {
+    std::optional<double> tightest;
+    while (true) {
+        const std::string dir = mount + (cgroup_path == "/" ? "" : cgroup_path);
+        if (auto quota = read_quota(dir)) {
+            if (!tightest || *quota < *tightest) {
+                tightest = quota;
+                source = dir;
+            }
+        }
+        if (cgroup_path == "/") {
+            return tightest;
+        }
+        cgroup_path = parent_of(cgroup_path);
+    }
+}
+
+void detect_quota(const std::string& root, CpuResources& resources) {
+    const auto cgroups = read_file(join_path(root, "/proc/self/cgroup"));
+    if (!cgroups) {
+        return;
+    }
+
+    std::string v2_path;
+    std::string v1_path;
+    std::istringstream lines(*cgroups);
+    std::string line;
+    while (std::getline(lines, line)) {
+        // "<id>:<controllers>:<path>"; v2 has id 0 and no controllers
+        const size_t first = line.find(':');
+        const size_t second = line.find(':', first == std::string::npos ? first : first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+        const std::string controllers = line.substr(first + 1, second - first - 1);
+        const std::string path = line.substr(second + 1);
+        if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+            v2_path = path;
+            continue;
+        }
+        std::istringstream names(controllers);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (name == "cpu") {
+                v1_path = path;
+            }
+        }
+    }
+
+    std::string source;
+    std::optional<double> quota;
+    if (!v1_path.empty()) {
+        for (const char* mount : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"}) {
+            quota = tightest_quota(join_path(root, mount), v1_path, [](const std::string& dir) -> std::optional<double> {
+                auto quota_us = read_file(dir + "/cpu.cfs_quota_us");
+                auto period_us = read_file(dir + "/cpu.cfs_period_us");
+                if (!quota_us || !period_us) {
+                    return std::nullopt;
+                }
+                return cpu_detail::parse_cfs_quota(*quota_us, *period_us);
+            }, source);
+            if (quota) {
+                source += "/cpu.cfs_quota_us";
+                break;
+            }
+        }
+    }
+    if (!quota && !v2_path.empty()) {
+        quota = tightest_quota(join_path(root, "/sys/fs/cgroup"), v2_path, [](const std::string& dir) -> std::optional<double> {
+            auto cpu_max = read_file(dir + "/cpu.max");
+            return cpu_max ? cpu_detail::parse_cpu_max(*cpu_max) : std::nullopt;
+        }, source);
+        if (quota) {
+            source += "/cpu.max";
+        }
+    }
+    if (quota) {
+        resources.quota_cpus = *quota;
+        resources.quota_source = source;
+    }
+}
+
+std::vector<int> detect_allowed(const std::string& root) {
+#ifdef __linux__
+    if (root == "/") {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            std::vector<int> allowed;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    allowed.push_back(cpu);
+                }
+            }
+            return allowed;
+        }
+    }
+#endif
+    if (auto status = read_file(join_path(root, "/proc/self/status"))) {
+        std::istringstream lines(*status);
+        std::string line;
+        const std::string key = "Cpus_allowed_list:";
+        while (std::getline(lines, line)) {
+            if (line.compare(0, key.size(), key) == 0) {
+                std::string list = line.substr(key.size());
+                list.erase(0, list.find_first_not_of(" \t"));
+                return cpu_detail::parse_cpu_list(list);
+            }
+        }
+    }
+    return {};
+}
+
+int count_physical_cores(const std::string& root, const std::vector<int>& allowed) {
+    std::set<std::vector<int>> cores;
+    for (int cpu : allowed) {
+        const auto siblings = read_file(join_path(root, "/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                                                        "/topology/thread_siblings_list"));
+        if (!siblings) {
+            return static_cast<int>(allowed.size());  // No topology: assume no SMT
+        }
+        cores.insert(cpu_detail::parse_cpu_list(*siblings));
+    }
+    return static_cast<int>(cores.size());
+}
+
+int read_int(const std::string& path, int fallback) {
+    if (auto text = read_file(path)) {
+        try {
+            return std::stoi(*text);
+        } catch (const std::exception&) {
+        }
+    }
+    return fallback;
+}
+
+// Position of a CPU among its core's SMT siblings (0 for the first thread of each core)
+std::map<int, int> smt_ranks(const std::vector<CpuInfo>& cpus) {
+    std::map<std::pair<int, int>, int> seen;
+    std::map<int, int> ranks;
+    for (const CpuInfo& cpu : cpus) {  // Ascending id
+        ranks[cpu.id] = seen[{cpu.package, cpu.core}]++;
+    }
+    return ranks;
+}
+
+// Siblings adjacent, then cores sharing an L3, NUMA node and package
+std::vector<CpuInfo> compact_order(std::vector<CpuInfo> cpus) {
+    std::stable_sort(cpus.begin(), cpus.end(), [](const CpuInfo& a, const CpuInfo& b) {
+        return std::tie(a.package, a.numa_node, a.l3_group, a.core, a.id) <
+               std::tie(b.package, b.numa_node, b.l3_group, b.core, b.id);
+    });
+    return cpus;
+}
+
+constexpr size_t PAGE_SIZE_BYTES = 4096;
+
+} // namespace
+
+namespace cpu_detail {
+
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            const size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return {};
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::optional<double> parse_cpu_max(const std::string& text) {
+    std::istringstream in(text);
+    std::string quota;
+    double period = 0.0;
+    if (!(in >> quota >> period) || quota == "max" || period <= 0.0) {
+        return std::nullopt;
+    }
+    try {
+        const double value = std::stod(quota);
+        return value > 0.0 ? std::optional<double>(value / period) : std::nullopt;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<double> parse_cfs_quota(const std::string& quota_us, const std::string& period_us) {
+    try {
+        const double quota = std::stod(quota_us);
+        const double period = std::stod(period_us);
+        if (quota <= 0.0 || period <= 0.0) {
+            return std::nullopt;  // -1: unlimited
+        }
+        return quota / period;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace cpu_detail
+
+const CpuResources& CpuResources::detect() {
+    static const CpuResources resources = probe("/");
+    return resources;
+}
+
+CpuResources CpuResources::probe(const std::string& root) {
+    CpuResources resources;
+
+    const unsigned hardware = std::thread::hardware_concurrency();
+    resources.online_cpus = hardware > 0 ? static_cast<int>(hardware) : 1;
+    if (auto online = read_file(join_path(root, "/sys/devices/system/cpu/online"))) {
+        const auto cpus = cpu_detail::parse_cpu_list(*online);
+        if (!cpus.empty()) {
+            resources.online_cpus = static_cast<int>(cpus.size());
+        }
+    }
+
+    resources.allowed = detect_allowed(root);
+    if (resources.allowed.empty()) {
+        for (int cpu = 0; cpu < resources.online_cpus; ++cpu) {
+            resources.allowed.push_back(cpu);
+        }
+    }
+    resources.physical_cores = std::max(1, count_physical_cores(root, resources.allowed));
+
+    detect_quota(root, resources);
+
+    double limit = static_cast<double>(resources.allowed.size());
+    if (resources.quota_cpus > 0.0) {
+        // A fractional quota still lets the last thread run part of the time
+        limit = std::min(limit, std::ceil(resources.quota_cpus));
+    }
+    resources.usable_threads = std::max(1, static_cast<int>(limit));
+    return resources;
+}
+
+const CpuTopology& CpuTopology::detect() {
+    static const CpuTopology topology = probe(CpuResources::detect().allowed, "/");
+    return topology;
+}
+
+CpuTopology CpuTopology::probe(const std::vector<int>& allowed, const std::string& root) {
+    CpuTopology topology;
+    const std::string cpu_root = join_path(root, "/sys/devices/system/cpu/cpu");
+
+    // NUMA node of each CPU, from the nodes' cpulists
+    std::map<int, int> node_of;
+    const auto nodes = read_file(join_path(root, "/sys/devices/system/node/online"));
+    for (int node : nodes ? cpu_detail::parse_cpu_list(*nodes) : std::vector<int>{}) {
+        const auto list = read_file(join_path(root, "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+        for (int cpu : list ? cpu_detail::parse_cpu_list(*list) : std::vector<int>{}) {
+            node_of[cpu] = node;
+        }
+    }
+
+    for (int id : allowed) {
+        CpuInfo cpu;
+        cpu.id = id;
+        const std::string dir = cpu_root + std::to_string(id);
+        cpu.package = read_int(dir + "/topology/physical_package_id", 0);
+        cpu.core = read_int(dir + "/topology/core_id", id);
+        cpu.numa_node = node_of.count(id) ? node_of[id] : 0;
+        for (int index = 0; ; ++index) {
+            const std::string cache = dir + "/cache/index" + std::to_string(index);
+            const int level = read_int(cache + "/level", -1);
+            if (level < 0) {
+                break;
+            }
+            const auto type = read_file(cache + "/type");
+            const auto shared = read_file(cache + "/shared_cpu_list");
+            if (!type || *type == "Instruction" || !shared) {
+                continue;
+            }
+            const auto sharing = cpu_detail::parse_cpu_list(*shared);
+            const int group = sharing.empty() ? id : sharing.front();
+            if (level == 2) {
+                cpu.l2_group = group;
+            } else if (level == 3) {
+                cpu.l3_group = group;
+            }
+        }
+        topology.cpus.push_back(cpu);
+    }
+    std::sort(topology.cpus.begin(), topology.cpus.end(), [](const CpuInfo& a, const CpuInfo& b) { return a.id < b.id; });
+
+    std::set<int> packages, nodes_seen, l3;
+    std::set<std::pair<int, int>> cores;
+    for (const CpuInfo& cpu : topology.cpus) {
+        packages.insert(cpu.package);
+        nodes_seen.insert(cpu.numa_node);
+        l3.insert(cpu.l3_group);
+        cores.insert({cpu.package, cpu.core});
+    }
+    topology.packages = std::max<int>(1, static_cast<int>(packages.size()));
+    topology.numa_nodes = std::max<int>(1, static_cast<int>(nodes_seen.size()));
+    topology.physical_cores = std::max<int>(1, static_cast<int>(cores.size()));
+    topology.l3_domains = std::max<int>(1, static_cast<int>(l3.size()));
+    return topology;
+}
+
+std::string CpuTopology::describe() const {
+    std::ostringstream out;
+    out << "Topology: " << packages << " package(s), " << numa_nodes << " NUMA node(s), " << l3_domains
+        << " L3 domain(s), " << physical_cores << " physical cores, " << cpus.size() << " CPUs\n";
+    return out.str();
+}
+
+std::optional<PinningPolicy> parse_pinning_policy(const std::string& name) {
+    if (name == "none") {
+        return PinningPolicy::None;
+    }
+    if (name == "compact") {
+        return PinningPolicy::Compact;
+    }
+    if (name == "scatter") {
+        return PinningPolicy::Scatter;
+    }
+    if (name == "cores") {
+        return PinningPolicy::PhysicalCores;
+    }
+    return std::nullopt;
+}
+
+const char* pinning_policy_name(PinningPolicy policy) {
+    switch (policy) {
+        case PinningPolicy::None:          return "none";
+        case PinningPolicy::Compact:       return "compact";
+        case PinningPolicy::Scatter:       return "scatter";
+        case PinningPolicy::PhysicalCores: return "cores";
+    }
+    return "none";
+}
+
+std::vector<int> pinning_plan(const CpuTopology& topology, PinningPolicy policy, int threads) {
+    if (policy == PinningPolicy::None || topology.cpus.empty() || threads <= 0) {
+        return {};
+    }
+    const std::map<int, int> ranks = smt_ranks(topology.cpus);
+    std::vector<CpuInfo> ordered = compact_order(topology.cpus);
+
+    if (policy == PinningPolicy::PhysicalCores || policy == PinningPolicy::Scatter) {
+        // First thread of every core before any second sibling
+        std::stable_sort(ordered.begin(), ordered.end(), [&ranks](const CpuInfo& a, const CpuInfo& b) {
+            return ranks.at(a.id) < ranks.at(b.id);
+        });
+    }
+    if (policy == PinningPolicy::Scatter) {
+        // Deal CPUs round-robin over (package, NUMA node, L3) domains
+        std::map<std::tuple<int, int, int>, std::vector<int>> domains;
+        for (const CpuInfo& cpu : ordered) {
+            domains[{cpu.package, cpu.numa_node, cpu.l3_group}].push_back(cpu.id);
+        }
+        std::vector<int> dealt;
+        for (size_t round = 0; dealt.size() < ordered.size(); ++round) {
+            for (const auto& [domain, ids] : domains) {
+                if (round < ids.size()) {
+                    dealt.push_back(ids[round]);
+                }
+            }
+        }
+        std::vector<int> plan;
+        for (int i = 0; i < threads; ++i) {
+            plan.push_back(dealt[static_cast<size_t>(i) % dealt.size()]);
+        }
+        return plan;
+    }
+
+    std::vector<int> plan;
+    for (int i = 0; i < threads; ++i) {
+        plan.push_back(ordered[static_cast<size_t>(i) % ordered.size()].id);
+    }
+    return plan;
+}
+
+bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;  // 0: the calling thread
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+NumaLocalBuffer::NumaLocalBuffer(size_t bytes)
+    : m_data(nullptr)
+    , m_size(bytes) {
+    const size_t rounded = std::max(PAGE_SIZE_BYTES, (bytes + PAGE_SIZE_BYTES - 1) / PAGE_SIZE_BYTES * PAGE_SIZE_BYTES);
+    void* memory = std::aligned_alloc(PAGE_SIZE_BYTES, rounded);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    std::memset(memory, 0, rounded);  // First touch: pages land on this thread's node
+    m_data.reset(memory);
+}
+
+void NumaLocalBuffer::Free::operator()(void* ptr) const {
+    std::free(ptr);
+}
+
+std::string CpuResources::describe() const {
+    std::ostringstream out;
+    out << "Online CPUs: " << online_cpus << "\n";
+    out << "Allowed CPUs: " << allowed.size() << " (" << physical_cores << " physical cores)\n";
+    if (quota_cpus > 0.0) {
+        out << "CPU Quota: " << quota_cpus << " CPUs (" << quota_source << ")\n";
+    } else {
+        out << "CPU Quota: none\n";
+    }
+    out << "Usable Threads: " << usable_threads << "\n";
+    return out.str();
+}
+
+} // namespace bedrock
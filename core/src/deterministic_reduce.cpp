@@ -0,0 +1,105 @@
+#include "bedrock/deterministic_reduce.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace bedrock {
+
+namespace {
+
+// Lanes as in the sums: lane-wise selects vectorize where a running "if" does not.
+// Strict comparison keeps the first of equal values in a lane; NaN never compares,
+// so it is skipped.
+template<typename Better>
+ValueIndex scan_block(const double* values, int64_t begin, int64_t end, double sentinel, const Better& better) {
+    constexpr int L = DETERMINISTIC_LANES;
+    double best[L];
+    int64_t index[L];
+    for (int lane = 0; lane < L; ++lane) {
+        best[lane] = sentinel;
+        index[lane] = -1;
+    }
+    int64_t i = begin;
+    for (; i + L <= end; i += L) {
+        for (int lane = 0; lane < L; ++lane) {
+            const double x = values[i + lane];
+            const bool take = better(x, best[lane]);
+            best[lane] = take ? x : best[lane];
+            index[lane] = take ? i + lane : index[lane];
+        }
+    }
+    for (int lane = 0; i < end; ++i, ++lane) {
+        if (better(values[i], best[lane])) {
+            best[lane] = values[i];
+            index[lane] = i;
+        }
+    }
+
+    ValueIndex result;
+    for (int lane = 0; lane < L; ++lane) {
+        if (index[lane] >= 0 && (!result.found() || better(best[lane], result.value) ||
+                                 (best[lane] == result.value && index[lane] < result.index))) {
+            result = {best[lane], index[lane]};
+        }
+    }
+    if (!result.found()) {
+        // Nothing beat the sentinel: the block is NaN and values equal to it
+        for (i = begin; i < end; ++i) {
+            if (!std::isnan(values[i])) {
+                return {values[i], i};
+            }
+        }
+    }
+    return result;
+}
+
+template<typename Better>
+ValueIndex deterministic_extreme(const double* values, int64_t count, double sentinel, TaskScheduler& scheduler,
+                                 const Better& better) {
+    if (count <= 0) {
+        return {};
+    }
+    const int64_t blocks = (count + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    auto block_scan = [&](int64_t block) {
+        const int64_t begin = block * DETERMINISTIC_BLOCK;
+        return scan_block(values, begin, std::min(count, begin + DETERMINISTIC_BLOCK), sentinel, better);
+    };
+    if (blocks == 1) {
+        return block_scan(0);
+    }
+
+    std::vector<ValueIndex> partials(static_cast<size_t>(blocks));
+    parallel_for(0, blocks, [&](int64_t block) { partials[static_cast<size_t>(block)] = block_scan(block); }, 0,
+                 scheduler);
+    // Blocks in index order: a later block only wins when strictly better
+    ValueIndex best;
+    for (const ValueIndex& partial : partials) {
+        if (partial.found() && (!best.found() || better(partial.value, best.value))) {
+            best = partial;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+double deterministic_sum(const double* values, int64_t count, SumAccuracy accuracy, TaskScheduler& scheduler) {
+    return deterministic_sum_of(0, count, [values](int64_t i) { return values[i]; }, accuracy, scheduler);
+}
+
+double deterministic_dot(const double* a, const double* b, int64_t count, SumAccuracy accuracy,
+                         TaskScheduler& scheduler) {
+    return deterministic_sum_of(0, count, [a, b](int64_t i) { return a[i] * b[i]; }, accuracy, scheduler);
+}
+
+ValueIndex deterministic_min(const double* values, int64_t count, TaskScheduler& scheduler) {
+    return deterministic_extreme(values, count, std::numeric_limits<double>::infinity(), scheduler,
+                                 [](double candidate, double best) { return candidate < best; });
+}
+
+ValueIndex deterministic_max(const double* values, int64_t count, TaskScheduler& scheduler) {
+    return deterministic_extreme(values, count, -std::numeric_limits<double>::infinity(), scheduler,
+                                 [](double candidate, double best) { return candidate > best; });
+}
+
+} // namespace bedrock
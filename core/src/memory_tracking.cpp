@@ -0,0 +1,152 @@
+#include "bedrock/memory_tracking.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+
+namespace bedrock {
+
+namespace {
+
+// Constant-initialized: the hook may count allocations made before any dynamic initializer runs
+struct alignas(64) SubsystemCounters {
+    std::atomic<int64_t> current{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<uint64_t> allocations{0};
+};
+
+SubsystemCounters g_counters[MEMORY_SUBSYSTEM_COUNT];
+std::atomic<bool> g_hook_installed{false};
+thread_local MemorySubsystem t_tag = MemorySubsystem::Other;
+
+SubsystemCounters& counters(MemorySubsystem subsystem) {
+    const size_t index = static_cast<size_t>(subsystem);
+    return g_counters[index < MEMORY_SUBSYSTEM_COUNT ? index : 0];
+}
+
+} // namespace
+
+void MemoryTracker::record_allocation(MemorySubsystem subsystem, size_t bytes) {
+    SubsystemCounters& c = counters(subsystem);
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    const int64_t current = c.current.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+                            static_cast<int64_t>(bytes);
+    int64_t peak = c.peak.load(std::memory_order_relaxed);
+    while (current > peak && !c.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryTracker::record_deallocation(MemorySubsystem subsystem, size_t bytes) {
+    counters(subsystem).current.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+int64_t MemoryTracker::current_bytes(MemorySubsystem subsystem) {
+    return counters(subsystem).current.load(std::memory_order_relaxed);
+}
+
+int64_t MemoryTracker::peak_bytes(MemorySubsystem subsystem) {
+    return counters(subsystem).peak.load(std::memory_order_relaxed);
+}
+
+std::vector<MemoryUsage> MemoryTracker::snapshot() {
+    std::vector<MemoryUsage> usage;
+    usage.reserve(MEMORY_SUBSYSTEM_COUNT);
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        const auto subsystem = static_cast<MemorySubsystem>(i);
+        const SubsystemCounters& c = g_counters[i];
+        usage.push_back({subsystem, subsystem_name(subsystem), c.current.load(std::memory_order_relaxed),
+                         c.peak.load(std::memory_order_relaxed), c.allocations.load(std::memory_order_relaxed)});
+    }
+    return usage;
+}
+
+void MemoryTracker::reset_peaks() {
+    for (SubsystemCounters& c : g_counters) {
+        c.peak.store(c.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+std::string MemoryTracker::report() {
+    std::string out = "=== Bedrock Memory ===\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %14s %14s %14s\n", "Subsystem", "Current KiB", "Peak KiB", "Allocations");
+    out += line;
+    for (const MemoryUsage& usage : snapshot()) {
+        std::snprintf(line, sizeof(line), "%-16s %14.1f %14.1f %14llu\n", usage.name, usage.current_bytes / 1024.0,
+                      usage.peak_bytes / 1024.0, static_cast<unsigned long long>(usage.allocations));
+        out += line;
+    }
+    if (!allocation_hook_installed()) {
+        out += "(global allocation hook not linked: only std::pmr resources are counted)\n";
+    }
+    return out;
+}
+
+const char* MemoryTracker::subsystem_name(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MemorySubsystem::Transport:      return "transport";
+        case MemorySubsystem::Protobuf:       return "protobuf";
+        case MemorySubsystem::ComputeScratch: return "compute_scratch";
+        case MemorySubsystem::Cache:          return "cache";
+        default:                              return "other";
+    }
+}
+
+MemorySubsystem MemoryTracker::current_tag() {
+    return t_tag;
+}
+
+MemorySubsystem MemoryTracker::exchange_tag(MemorySubsystem subsystem) {
+    const MemorySubsystem previous = t_tag;
+    t_tag = subsystem;
+    return previous;
+}
+
+std::pmr::memory_resource* MemoryTracker::resource(MemorySubsystem subsystem) {
+    // Leaked: containers in static objects may release memory during static destruction
+    static std::array<TaggedMemoryResource*, MEMORY_SUBSYSTEM_COUNT>* resources = [] {
+        auto* all = new std::array<TaggedMemoryResource*, MEMORY_SUBSYSTEM_COUNT>();
+        for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+            (*all)[i] = new TaggedMemoryResource(static_cast<MemorySubsystem>(i));
+        }
+        return all;
+    }();
+    const size_t index = static_cast<size_t>(subsystem);
+    return (*resources)[index < MEMORY_SUBSYSTEM_COUNT ? index : 0];
+}
+
+bool MemoryTracker::allocation_hook_installed() {
+    return g_hook_installed.load(std::memory_order_relaxed);
+}
+
+void MemoryTracker::mark_allocation_hook_installed() {
+    g_hook_installed.store(true, std::memory_order_relaxed);
+}
+
+TaggedMemoryResource::TaggedMemoryResource(MemorySubsystem subsystem, std::pmr::memory_resource* upstream)
+    : m_subsystem(subsystem)
+    , m_upstream(upstream ? upstream : std::pmr::new_delete_resource()) {}
+
+void* TaggedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    if (MemoryTracker::allocation_hook_installed() && m_upstream == std::pmr::new_delete_resource()) {
+        // The hook sees this operator new; tag it rather than counting twice
+        MemoryTagScope scope(m_subsystem);
+        return m_upstream->allocate(bytes, alignment);
+    }
+    void* pointer = m_upstream->allocate(bytes, alignment);
+    MemoryTracker::record_allocation(m_subsystem, bytes);
+    return pointer;
+}
+
+void TaggedMemoryResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    m_upstream->deallocate(pointer, bytes, alignment);
+    if (!(MemoryTracker::allocation_hook_installed() && m_upstream == std::pmr::new_delete_resource())) {
+        MemoryTracker::record_deallocation(m_subsystem, bytes);
+    }
+}
+
+bool TaggedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace bedrock
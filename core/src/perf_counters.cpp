@@ -0,0 +1,200 @@
+#include "bedrock/perf_counters.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bedrock {
+
+namespace {
+
+#ifdef __linux__
+
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+EventConfig config_of(PerfEvent event) {
+    constexpr uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (event) {
+        case PerfEvent::Cycles:       return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+        case PerfEvent::Instructions: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+        case PerfEvent::L1DMisses:    return {PERF_TYPE_HW_CACHE, L1D_READ_MISS};
+        case PerfEvent::LLCMisses:    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+        case PerfEvent::BranchMisses: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+        default:                      return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK};
+    }
+}
+
+int paranoid_level() {
+    std::ifstream in("/proc/sys/kernel/perf_event_paranoid");
+    int level = 2;
+    in >> level;
+    return level;
+}
+
+std::string reason(int error) {
+    switch (error) {
+        case EACCES:
+        case EPERM:
+            return "not permitted (kernel.perf_event_paranoid=" + std::to_string(paranoid_level()) + ")";
+        case ENOENT:
+        case EOPNOTSUPP:
+        case EINVAL:
+            return "not supported by this CPU, VM or kernel";
+        case ENOSYS:
+            return "perf_event_open not available";
+        default:
+            return std::strerror(error);
+    }
+}
+
+#endif
+
+} // namespace
+
+PerfCounterValues PerfCounterValues::since(const PerfCounterValues& start) const {
+    PerfCounterValues delta;
+    delta.mask = mask & start.mask;
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        // Scaled values of a multiplexed group can step back slightly
+        if ((delta.mask >> e) & 1u) {
+            delta.values[e] = values[e] > start.values[e] ? values[e] - start.values[e] : 0;
+        }
+    }
+    return delta;
+}
+
+double PerfCounterValues::ipc() const {
+    if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) || (*this)[PerfEvent::Cycles] == 0) {
+        return -1.0;
+    }
+    return static_cast<double>((*this)[PerfEvent::Instructions]) / static_cast<double>((*this)[PerfEvent::Cycles]);
+}
+
+double PerfCounterValues::per_kilo_instruction(PerfEvent event) const {
+    if (!has(event) || !has(PerfEvent::Instructions) || (*this)[PerfEvent::Instructions] == 0) {
+        return -1.0;
+    }
+    return 1000.0 * static_cast<double>((*this)[event]) / static_cast<double>((*this)[PerfEvent::Instructions]);
+}
+
+PerfCounters::PerfCounters(uint32_t events) {
+    m_fds.fill(-1);
+    m_slot.fill(-1);
+#ifdef __linux__
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        const PerfEvent event = static_cast<PerfEvent>(e);
+        if (!(events & perf_event_bit(event))) {
+            continue;
+        }
+        const EventConfig config = config_of(event);
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = config.type;
+        attr.config = config.config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // The first event that opens leads the group; a software leader cannot take hardware members,
+        // which only happens when the hardware events failed anyway
+        const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+        if (fd < 0) {
+            if (!m_error.empty()) {
+                m_error += "; ";
+            }
+            m_error += std::string(event_name(event)) + ": " + reason(errno);
+            continue;
+        }
+        if (m_leader < 0) {
+            m_leader = fd;
+        }
+        m_fds[e] = fd;
+        m_slot[e] = m_open++;
+        m_mask |= perf_event_bit(event);
+    }
+#else
+    if (events != 0) {
+        m_error = "perf_event_open is Linux-only";
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : m_fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::read(PerfCounterValues& out) const {
+    out.mask = 0;
+    if (m_leader < 0) {
+        return false;
+    }
+#ifdef __linux__
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr]
+    uint64_t buffer[3 + PERF_EVENT_COUNT];
+    const ssize_t bytes = ::read(m_leader, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != static_cast<uint64_t>(m_open)) {
+        return false;
+    }
+    const uint64_t enabled = buffer[1];
+    const uint64_t running = buffer[2];
+    if (running == 0) {
+        return false;  // Group never got onto the PMU
+    }
+    const double scale = running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (m_slot[e] >= 0) {
+            const uint64_t raw = buffer[3 + m_slot[e]];
+            out.values[e] = scale == 1.0 ? raw : static_cast<uint64_t>(static_cast<double>(raw) * scale);
+        }
+    }
+    out.mask = m_mask;
+    return true;
+#else
+    return false;
+#endif
+}
+
+PerfCounters& PerfCounters::this_thread() {
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+const char* PerfCounters::event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles:       return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1DMisses:    return "l1d_misses";
+        case PerfEvent::LLCMisses:    return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::TaskClock:    return "task_clock";
+        default:                      return "unknown";
+    }
+}
+
+std::string PerfCounters::describe_support() {
+    std::string out;
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        const PerfEvent event = static_cast<PerfEvent>(e);
+        // Opened alone, so a missing event does not hide the others' status
+        const PerfCounters probe(perf_event_bit(event));
+        out += (probe.ok() ? std::string(event_name(event)) + ": counting" : probe.error()) + "\n";
+    }
+    return out;
+}
+
+} // namespace bedrock
@@ -0,0 +1,525 @@
+#include "bedrock/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace bedrock {
+
+std::atomic<bool> Profiler::s_enabled{true};
+std::atomic<bool> Profiler::s_counters{false};
+bool Profiler::s_use_tsc = false;
+double Profiler::s_ns_per_tick = 1.0;
+
+// Chooses the zone clock; runs once, when the registry is created
+struct ProfilerClock {
+    static void calibrate() {
+#ifdef BEDROCK_PROFILER_HAS_TSC
+        if (!invariant_tsc()) {
+            return;
+        }
+        // 2 ms against steady_clock: well below 0.1% error for a GHz counter
+        const uint64_t start_ns = Profiler::now_ns();
+        const uint64_t start_ticks = __rdtsc();
+        uint64_t now = start_ns;
+        while (now - start_ns < 2000000) {
+            now = Profiler::now_ns();
+        }
+        const uint64_t ticks = __rdtsc() - start_ticks;
+        if (ticks > 0) {
+            Profiler::s_ns_per_tick = static_cast<double>(now - start_ns) / static_cast<double>(ticks);
+            Profiler::s_use_tsc = true;
+        }
+#endif
+    }
+
+#ifdef BEDROCK_PROFILER_HAS_TSC
+    // The TSC counts at a fixed rate across frequency changes and idle states
+    static bool invariant_tsc() {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("flags", 0) == 0) {
+                return line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+            }
+        }
+        return false;
+    }
+#endif
+};
+
+namespace {
+
+constexpr size_t BUCKETS = ProfileZoneStats::HISTOGRAM_BUCKETS;
+constexpr uint32_t ROOT_ZONE = std::numeric_limits<uint32_t>::max();
+constexpr uint64_t NO_MIN = std::numeric_limits<uint64_t>::max();
+
+// One zone path on one thread. zone/parent are written before the node is
+// published; the statistics are written only by the owning thread. A node is
+// open at most once at a time (re-entering a zone inside itself makes a child),
+// so the counter reading taken at entry can live here.
+struct Node {
+    uint32_t zone = ROOT_ZONE;
+    uint32_t parent = 0;
+    uint32_t first_child = 0;   // Owner only
+    uint32_t next_sibling = 0;  // Owner only
+    bool counting = false;      // Owner only: start_counters was read at entry
+    PerfCounterValues start_counters;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> min_ns{NO_MIN};
+    std::atomic<uint64_t> max_ns{0};
+    std::array<std::atomic<uint64_t>, BUCKETS> histogram{};
+    std::atomic<uint64_t> counted{0};
+    std::atomic<uint32_t> counter_mask{0};
+    std::array<std::atomic<uint64_t>, PERF_EVENT_COUNT> counters{};
+};
+
+constexpr size_t CHUNK_NODES = 256;
+constexpr size_t MAX_CHUNKS = Profiler::MAX_NODES_PER_THREAD / CHUNK_NODES;
+
+struct ThreadTree {
+    std::array<std::atomic<Node*>, MAX_CHUNKS> chunks{};
+    std::atomic<uint32_t> size{0};        // Published nodes
+    std::atomic<uint32_t> generation{0};  // reset() generation the statistics belong to
+    std::atomic<size_t> dropped{0};
+    uint32_t current = 0;                 // Innermost open zone (owner only)
+
+    Node& node(uint32_t index) {
+        return chunks[index / CHUNK_NODES].load(std::memory_order_acquire)[index % CHUNK_NODES];
+    }
+
+    ~ThreadTree() {
+        for (auto& chunk : chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// A zone path merged over threads; index 0 of a merged tree is the root
+struct MergedNode {
+    uint32_t zone = ROOT_ZONE;
+    ProfileZoneStats stats;
+    std::vector<size_t> children;
+};
+
+// Zone names live until process exit: threads may still profile during static destruction.
+// A thread's tree lives until the thread exits, then its statistics move to retired.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTree>> trees;
+    std::vector<MergedNode> retired = std::vector<MergedNode>(1);  // Exited threads, current generation
+    size_t retired_dropped = 0;
+    std::unordered_map<std::string, uint32_t> zone_ids;
+    std::array<std::atomic<const std::string*>, Profiler::MAX_ZONES> names{};
+    uint32_t zone_count = 0;
+    std::atomic<uint32_t> generation{0};
+};
+
+Registry& registry() {
+    static Registry* instance = [] {
+        ProfilerClock::calibrate();
+        return new Registry();
+    }();
+    return *instance;
+}
+
+thread_local ThreadTree* t_tree = nullptr;
+
+void merge_tree(ThreadTree& tree, std::vector<MergedNode>& merged);
+
+// Folds the calling thread's statistics into the registry's retired tree when
+// the thread exits and frees its tree, so short-lived threads do not accumulate
+struct TreeRetirer {
+    ~TreeRetirer() {
+        if (!t_tree) {
+            return;
+        }
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (t_tree->generation.load(std::memory_order_relaxed) == reg.generation.load(std::memory_order_relaxed)) {
+            merge_tree(*t_tree, reg.retired);
+            reg.retired_dropped += t_tree->dropped.load(std::memory_order_relaxed);
+        }
+        std::erase_if(reg.trees, [](const std::unique_ptr<ThreadTree>& tree) { return tree.get() == t_tree; });
+        t_tree = nullptr;  // A zone entered later in thread teardown registers afresh
+    }
+};
+
+thread_local TreeRetirer t_retirer;
+
+ThreadTree& thread_tree() {
+    if (!t_tree) {
+        auto tree = std::make_unique<ThreadTree>();
+        tree->chunks[0].store(new Node[CHUNK_NODES], std::memory_order_release);
+        tree->size.store(1, std::memory_order_release);  // Root
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        tree->generation.store(reg.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        t_tree = tree.get();
+        reg.trees.push_back(std::move(tree));
+        (void)&t_retirer;  // Odr-use constructs the thread's retirer
+    }
+    return *t_tree;
+}
+
+// Owner thread only: drop the statistics of an older generation, keep the tree shape
+void clear_tree(ThreadTree& tree, uint32_t generation) {
+    const uint32_t size = tree.size.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < size; ++i) {
+        Node& node = tree.node(i);
+        node.count.store(0, std::memory_order_relaxed);
+        node.total_ns.store(0, std::memory_order_relaxed);
+        node.min_ns.store(NO_MIN, std::memory_order_relaxed);
+        node.max_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : node.histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        node.counted.store(0, std::memory_order_relaxed);
+        node.counter_mask.store(0, std::memory_order_relaxed);
+        for (auto& counter : node.counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+    tree.generation.store(generation, std::memory_order_release);
+}
+
+// Single writer: a load and a store are enough, and cheaper than a read-modify-write
+void add_relaxed(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Owner thread, at zone entry
+void start_counters(Node& node) {
+    node.counting = Profiler::hardware_counters_enabled() && PerfCounters::this_thread().read(node.start_counters);
+}
+
+size_t bucket_of(uint64_t ns) {
+    size_t bucket = 0;
+    while (ns > 1 && bucket + 1 < BUCKETS) {
+        ns >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Adds one thread's statistics to a merged tree (caller holds the registry mutex)
+void merge_tree(ThreadTree& tree, std::vector<MergedNode>& merged) {
+    const uint32_t size = tree.size.load(std::memory_order_acquire);
+    std::vector<size_t> to_merged(size, 0);
+    for (uint32_t i = 1; i < size; ++i) {
+        Node& node = tree.node(i);
+        const size_t parent = to_merged[node.parent];  // Parents precede children
+        size_t target = 0;
+        for (size_t child : merged[parent].children) {
+            if (merged[child].zone == node.zone) {
+                target = child;
+                break;
+            }
+        }
+        if (target == 0) {
+            target = merged.size();
+            merged.push_back(MergedNode{node.zone, {}, {}});
+            merged[parent].children.push_back(target);
+        }
+        to_merged[i] = target;
+
+        ProfileZoneStats& stats = merged[target].stats;
+        const uint64_t count = node.count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        const uint64_t min_ns = node.min_ns.load(std::memory_order_relaxed);
+        stats.min_ns = stats.count == 0 ? min_ns : std::min(stats.min_ns, min_ns);
+        stats.max_ns = std::max(stats.max_ns, node.max_ns.load(std::memory_order_relaxed));
+        stats.count += count;
+        stats.total_ns += node.total_ns.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            stats.histogram[b] += node.histogram[b].load(std::memory_order_relaxed);
+        }
+        stats.counted += node.counted.load(std::memory_order_relaxed);
+        stats.counters.mask |= node.counter_mask.load(std::memory_order_relaxed);
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            stats.counters.values[e] += node.counters[e].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Depth-first, children by total time; zones without samples below them are left out
+bool emit(const std::vector<MergedNode>& merged, size_t index, const std::string& path, int depth,
+          std::vector<ProfileZoneStats>& out) {
+    const MergedNode& node = merged[index];
+    std::vector<size_t> children = node.children;
+    std::sort(children.begin(), children.end(), [&merged](size_t a, size_t b) {
+        return merged[a].stats.total_ns > merged[b].stats.total_ns;
+    });
+
+    const size_t position = out.size();
+    std::string own_path = path;
+    if (node.zone != ROOT_ZONE) {
+        ProfileZoneStats stats = node.stats;
+        stats.name = std::string(Profiler::zone_name(node.zone));
+        stats.path = path.empty() ? stats.name : path + "/" + stats.name;
+        stats.depth = depth;
+        own_path = stats.path;
+        out.push_back(std::move(stats));
+    }
+    bool any = node.stats.count > 0;
+    for (size_t child : children) {
+        any |= emit(merged, child, own_path, node.zone == ROOT_ZONE ? 0 : depth + 1, out);
+    }
+    if (!any && node.zone != ROOT_ZONE) {
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(position));
+    }
+    return any;
+}
+
+// Counter columns of report(); "-" where the event was not counted
+std::string counter_columns(const ProfileZoneStats& zone) {
+    const PerfCounterValues& c = zone.counters;
+    double cpu_share = -1.0;
+    if (zone.counted > 0 && c.has(PerfEvent::TaskClock) && zone.total_ns > 0) {
+        // Counted samples' share of the wall time, assuming they are typical
+        const double wall_ns = static_cast<double>(zone.total_ns) * static_cast<double>(zone.counted) /
+                               static_cast<double>(zone.count);
+        cpu_share = 100.0 * static_cast<double>(c[PerfEvent::TaskClock]) / wall_ns;
+    }
+    const double columns[] = {c.ipc(), c.per_kilo_instruction(PerfEvent::L1DMisses),
+                              c.per_kilo_instruction(PerfEvent::LLCMisses),
+                              c.per_kilo_instruction(PerfEvent::BranchMisses), cpu_share};
+    std::string out;
+    char cell[32];
+    for (double value : columns) {
+        if (zone.counted > 0 && value >= 0.0) {
+            std::snprintf(cell, sizeof(cell), " %9.2f", value);
+        } else {
+            std::snprintf(cell, sizeof(cell), " %9s", "-");
+        }
+        out += cell;
+    }
+    return out;
+}
+
+} // namespace
+
+uint64_t ProfileZoneStats::percentile_ns(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    const double wanted = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        seen += histogram[b];
+        if (static_cast<double>(seen) >= wanted && seen > 0) {
+            const uint64_t upper = b + 1 < 64 ? (uint64_t{1} << (b + 1)) : max_ns;
+            return std::min(upper, max_ns);
+        }
+    }
+    return max_ns;
+}
+
+void Profiler::set_enabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::set_hardware_counters(bool enabled) {
+    s_counters.store(enabled, std::memory_order_relaxed);
+}
+
+uint32_t Profiler::register_zone(std::string_view name) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    const std::string key(name);
+    if (auto it = reg.zone_ids.find(key); it != reg.zone_ids.end()) {
+        return it->second;
+    }
+    if (reg.zone_count + 1 >= MAX_ZONES) {
+        // Last slot is the shared overflow zone
+        if (!reg.names[MAX_ZONES - 1].load(std::memory_order_relaxed)) {
+            reg.names[MAX_ZONES - 1].store(new std::string("(overflow)"), std::memory_order_release);
+        }
+        return MAX_ZONES - 1;
+    }
+    const uint32_t id = reg.zone_count++;
+    reg.names[id].store(new std::string(key), std::memory_order_release);
+    reg.zone_ids.emplace(key, id);
+    return id;
+}
+
+std::string_view Profiler::zone_name(uint32_t zone) {
+    if (zone >= MAX_ZONES) {
+        return {};
+    }
+    const std::string* name = registry().names[zone].load(std::memory_order_acquire);
+    return name ? std::string_view(*name) : std::string_view();
+}
+
+uint64_t Profiler::now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t Profiler::enter(uint32_t zone) {
+    ThreadTree& tree = thread_tree();
+    const uint32_t generation = registry().generation.load(std::memory_order_relaxed);
+    if (tree.generation.load(std::memory_order_relaxed) != generation) {
+        clear_tree(tree, generation);
+    }
+
+    Node& parent = tree.node(tree.current);
+    for (uint32_t child = parent.first_child; child != 0; child = tree.node(child).next_sibling) {
+        if (tree.node(child).zone == zone) {
+            tree.current = child;
+            start_counters(tree.node(child));
+            return child;
+        }
+    }
+
+    // First time this zone opens here: append a node
+    const uint32_t index = tree.size.load(std::memory_order_relaxed);
+    if (index >= MAX_NODES_PER_THREAD) {
+        tree.dropped.fetch_add(1, std::memory_order_relaxed);
+        return NO_NODE;
+    }
+    auto& chunk_slot = tree.chunks[index / CHUNK_NODES];
+    if (!chunk_slot.load(std::memory_order_relaxed)) {
+        chunk_slot.store(new Node[CHUNK_NODES], std::memory_order_release);
+    }
+    Node& node = tree.node(index);
+    node.zone = zone;
+    node.parent = tree.current;
+    node.next_sibling = parent.first_child;
+    parent.first_child = index;
+    tree.size.store(index + 1, std::memory_order_release);
+    tree.current = index;
+    start_counters(node);
+    return index;
+}
+
+void Profiler::leave(uint32_t index, uint64_t elapsed_ticks) {
+    if (!t_tree) {
+        return;  // The thread's tree was retired while the zone was open (thread teardown)
+    }
+    ThreadTree& tree = *t_tree;  // enter() created it
+    const uint64_t elapsed_ns = s_use_tsc ? static_cast<uint64_t>(static_cast<double>(elapsed_ticks) * s_ns_per_tick)
+                                          : elapsed_ticks;
+    Node& node = tree.node(index);
+    add_relaxed(node.count, 1);
+    add_relaxed(node.total_ns, elapsed_ns);
+    if (elapsed_ns < node.min_ns.load(std::memory_order_relaxed)) {
+        node.min_ns.store(elapsed_ns, std::memory_order_relaxed);
+    }
+    if (elapsed_ns > node.max_ns.load(std::memory_order_relaxed)) {
+        node.max_ns.store(elapsed_ns, std::memory_order_relaxed);
+    }
+    add_relaxed(node.histogram[bucket_of(elapsed_ns)], 1);
+    if (node.counting) {
+        PerfCounterValues end;
+        if (PerfCounters::this_thread().read(end)) {
+            const PerfCounterValues delta = end.since(node.start_counters);
+            add_relaxed(node.counted, 1);
+            node.counter_mask.store(node.counter_mask.load(std::memory_order_relaxed) | delta.mask,
+                                    std::memory_order_relaxed);
+            for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+                add_relaxed(node.counters[e], delta.values[e]);
+            }
+        }
+        node.counting = false;
+    }
+    tree.current = node.parent;
+}
+
+std::vector<ProfileZoneStats> Profiler::snapshot() {
+    std::vector<MergedNode> merged;
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        merged = reg.retired;
+        const uint32_t generation = reg.generation.load(std::memory_order_relaxed);
+        for (auto& tree : reg.trees) {
+            if (tree->generation.load(std::memory_order_acquire) != generation) {
+                continue;  // Reset since this thread last profiled
+            }
+            merge_tree(*tree, merged);
+        }
+    }
+
+    std::vector<ProfileZoneStats> out;
+    emit(merged, 0, "", 0, out);
+    return out;
+}
+
+std::string Profiler::report() {
+    const std::vector<ProfileZoneStats> zones = snapshot();
+    const bool counters = std::any_of(zones.begin(), zones.end(),
+                                      [](const ProfileZoneStats& zone) { return zone.counted > 0; });
+    std::string out = "=== Bedrock Profile ===\n";
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-40s %10s %12s %10s %10s %10s %10s %10s", "Zone", "Count", "Total ms",
+                  "Mean us", "Min us", "p50 us", "p99 us", "Max us");
+    out += line;
+    if (counters) {
+        std::snprintf(line, sizeof(line), " %9s %9s %9s %9s %9s", "IPC", "L1D MPKI", "LLC MPKI", "Br MPKI", "CPU %");
+        out += line;
+    }
+    out += "\n";
+    for (const ProfileZoneStats& zone : zones) {
+        const std::string label = std::string(static_cast<size_t>(zone.depth) * 2, ' ') + zone.name;
+        std::snprintf(line, sizeof(line), "%-40s %10llu %12.3f %10.2f %10.2f %10.2f %10.2f %10.2f", label.c_str(),
+                      static_cast<unsigned long long>(zone.count), zone.total_ns / 1e6, zone.mean_ns() / 1e3,
+                      zone.min_ns / 1e3, zone.percentile_ns(0.5) / 1e3, zone.percentile_ns(0.99) / 1e3,
+                      zone.max_ns / 1e3);
+        out += line;
+        if (counters) {
+            out += counter_columns(zone);
+        }
+        out += "\n";
+    }
+    if (const size_t dropped = dropped_count(); dropped > 0) {
+        out += "Dropped zones (tree full): " + std::to_string(dropped) + "\n";
+    }
+    return out;
+}
+
+bool Profiler::write_report(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << report();
+    return static_cast<bool>(out.flush());
+}
+
+void Profiler::reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.generation.fetch_add(1, std::memory_order_relaxed);
+    reg.retired.assign(1, MergedNode{});
+    reg.retired_dropped = 0;
+    for (auto& tree : reg.trees) {
+        tree->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t Profiler::dropped_count() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t dropped = reg.retired_dropped;
+    for (auto& tree : reg.trees) {
+        dropped += tree->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+size_t Profiler::tree_count() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.trees.size();
+}
+
+} // namespace bedrock
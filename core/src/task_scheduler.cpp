@@ -0,0 +1,317 @@
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/threading.hpp"
+#include "bedrock/trace.hpp"
+
+#include <cstdlib>
+#include <optional>
+
+namespace bedrock {
+
+namespace {
+
+// Scheduler the calling thread works for and its queue index (unset on external threads)
+thread_local TaskScheduler* t_scheduler = nullptr;
+thread_local size_t t_index = 0;
+
+// Victim selection; xorshift keeps it cheap and uncorrelated between threads
+thread_local uint32_t t_rng = 0;
+
+uint32_t next_random() {
+    if (t_rng == 0) {
+        t_rng = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+    }
+    t_rng ^= t_rng << 13;
+    t_rng ^= t_rng >> 17;
+    t_rng ^= t_rng << 5;
+    return t_rng;
+}
+
+// Failed steal rounds before a worker sleeps; short, since push() wakes sleepers
+constexpr int SPIN_ROUNDS = 64;
+
+// Pinning of the global scheduler; fixed once global() creates it
+struct GlobalPinning {
+    std::mutex mutex;
+    std::optional<PinningPolicy> chosen;  // Applied policy once started
+    bool started = false;
+};
+
+GlobalPinning& global_pinning_state() {
+    static GlobalPinning state;
+    return state;
+}
+
+PinningPolicy resolve_global_pinning(const GlobalPinning& state) {
+    if (state.chosen) {
+        return *state.chosen;
+    }
+    if (const char* name = std::getenv("BEDROCK_PINNING"); name && *name) {
+        return parse_pinning_policy(name).value_or(PinningPolicy::None);
+    }
+    return PinningPolicy::None;
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler(int num_threads, PinningPolicy pinning) {
+    if (num_threads <= 0) {
+        num_threads = ThreadingConfig::get_optimal_thread_count();
+    }
+    num_threads = std::max(1, num_threads);
+
+    const size_t workers = static_cast<size_t>(num_threads - 1);
+    for (size_t i = 0; i <= workers; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    const std::vector<int> plan = pinning_plan(CpuTopology::detect(), pinning, num_threads);
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        const int cpu = plan.empty() ? -1 : plan[i + 1];
+        m_workers.emplace_back([this, i, cpu]() { worker_loop(i, cpu); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_post_stop = true;
+    }
+    m_post_wake.notify_all();
+    if (m_post_thread.joinable()) {
+        m_post_thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    static TaskScheduler scheduler(ThreadingConfig::get_optimal_thread_count(), []() {
+        GlobalPinning& state = global_pinning_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.chosen = resolve_global_pinning(state);
+        state.started = true;
+        return *state.chosen;
+    }());
+    return scheduler;
+}
+
+PinningPolicy TaskScheduler::global_pinning() {
+    GlobalPinning& state = global_pinning_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return resolve_global_pinning(state);
+}
+
+bool TaskScheduler::set_global_pinning(PinningPolicy pinning) {
+    GlobalPinning& state = global_pinning_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.started) {
+        return false;
+    }
+    state.chosen = pinning;
+    return true;
+}
+
+int TaskScheduler::worker_index() {
+    return t_scheduler ? static_cast<int>(t_index) : -1;
+}
+
+void TaskScheduler::push(Task task) {
+    // Workers push to their own deque; any other thread to the shared external queue
+    const size_t index = t_scheduler == this ? t_index : m_queues.size() - 1;
+    {
+        WorkQueue& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    // Pairs with the sleeper's check of m_queued after it registered in m_sleepers
+    m_queued.fetch_add(1);
+    if (m_sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_wake.notify_one();
+    }
+}
+
+void TaskScheduler::post(std::function<void()> task) {
+    if (!m_workers.empty()) {
+        push(Task{std::move(task), nullptr, nullptr});
+        return;
+    }
+    // No workers: a thread of its own runs posted work, so it never waits for a helper
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_posted.push_back(std::move(task));
+        if (!m_post_thread.joinable()) {
+            m_post_thread = std::thread([this]() { post_loop(); });
+        }
+    }
+    m_post_wake.notify_one();
+}
+
+void TaskScheduler::post_loop() {
+    Tracer::set_thread_name("task-post");
+    std::unique_lock<std::mutex> lock(m_post_mutex);
+    while (true) {
+        m_post_wake.wait(lock, [this]() { return m_post_stop || !m_posted.empty(); });
+        if (m_posted.empty()) {
+            return;  // Stopping and drained
+        }
+        Task task{std::move(m_posted.front()), nullptr, nullptr};
+        m_posted.pop_front();
+        lock.unlock();
+        execute(task);
+        lock.lock();
+    }
+}
+
+bool TaskScheduler::pop_own(Task& task) {
+    const size_t index = t_scheduler == this ? t_index : m_queues.size() - 1;
+    WorkQueue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queued.fetch_sub(1);
+    return true;
+}
+
+bool TaskScheduler::steal(Task& task, size_t start) {
+    const size_t count = m_queues.size();
+    const size_t own = t_scheduler == this ? t_index : count - 1;
+    for (size_t n = 0; n < count; ++n) {
+        const size_t victim = (start + n) % count;
+        if (victim == own) {
+            continue;
+        }
+        WorkQueue& queue = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::try_run_one() {
+    if (m_queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    Task task;
+    if (pop_own(task) || steal(task, next_random() % m_queues.size())) {
+        execute(task);
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::execute(Task& task) {
+    std::exception_ptr error;
+    // A helper's CPU time is charged to the job; on a thread already inside the
+    // job's scope it is part of that thread's own CPU time
+    const bool helper = task.budget && task.budget != ThreadBudget::current();
+    const uint64_t start_cpu_ns = helper ? ThreadBudget::thread_cpu_ns() : 0;
+    try {
+        ThreadBudget::Scope budget(task.budget);
+        task.fn();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (helper) {
+        const uint64_t end_cpu_ns = ThreadBudget::thread_cpu_ns();
+        task.budget->add_helper_cpu_ns(end_cpu_ns > start_cpu_ns ? end_cpu_ns - start_cpu_ns : 0);
+    }
+    task.fn = nullptr;  // Release captures before the group can be joined
+    if (!task.group) {
+        if (error) {
+            std::terminate();  // Nobody joins a posted task to observe it
+        }
+        return;
+    }
+    task.group->finished(error);
+}
+
+void TaskScheduler::worker_loop(size_t index, int cpu) {
+    t_scheduler = this;
+    t_index = index;
+    Tracer::set_thread_name("task-worker");
+    if (cpu >= 0 && pin_current_thread(cpu)) {
+        m_pinned.fetch_add(1);
+    }
+
+    int idle_rounds = 0;
+    while (true) {
+        Task task;
+        if (pop_own(task) || steal(task, next_random() % m_queues.size())) {
+            execute(task);
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleepers.fetch_add(1);
+        m_wake.wait(lock, [this]() { return m_stop.load() || m_queued.load() > 0; });
+        m_sleepers.fetch_sub(1);
+        if (m_stop.load() && m_queued.load() == 0) {
+            return;
+        }
+        idle_rounds = 0;
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    if (m_pending.load(std::memory_order_acquire) > 0) {
+        try {
+            wait();
+        } catch (...) {
+            // Destructors must not throw; call wait() to observe task exceptions
+        }
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    m_scheduler.push(TaskScheduler::Task{std::move(task), this, ThreadBudget::current()});
+}
+
+void TaskGroup::wait() {
+    // Help instead of blocking: run queued tasks until this group's tasks are done
+    while (m_pending.load(std::memory_order_acquire) > 0) {
+        if (!m_scheduler.try_run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_error_mutex);
+        error = std::exchange(m_error, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::finished(std::exception_ptr error) {
+    if (error) {
+        std::lock_guard<std::mutex> lock(m_error_mutex);
+        if (!m_error) {
+            m_error = std::move(error);
+        }
+    }
+    m_pending.fetch_sub(1, std::memory_order_release);  // The group may be destroyed after this
+}
+
+} // namespace bedrock
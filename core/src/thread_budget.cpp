@@ -0,0 +1,148 @@
+#include "bedrock/thread_budget.hpp"
+#include "bedrock/threading.hpp"
+
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+namespace bedrock {
+
+namespace {
+
+thread_local ThreadBudget* t_budget = nullptr;
+
+} // namespace
+
+ThreadBudget::ThreadBudget(int threads)
+    : m_threads(std::max(1, threads))
+    , m_available(std::max(1, threads) - 1) {
+}
+
+void ThreadBudget::set_threads(int threads) {
+    threads = std::max(1, threads);
+    const int previous = m_threads.exchange(threads, std::memory_order_acq_rel);
+    m_available.fetch_add(threads - previous, std::memory_order_acq_rel);
+}
+
+int ThreadBudget::try_acquire(int wanted) {
+    if (wanted <= 0) {
+        return 0;
+    }
+    int available = m_available.load(std::memory_order_relaxed);
+    while (available > 0) {
+        const int granted = std::min(wanted, available);
+        if (m_available.compare_exchange_weak(available, available - granted, std::memory_order_acq_rel)) {
+            return granted;
+        }
+    }
+    return 0;
+}
+
+void ThreadBudget::release(int count) {
+    if (count > 0) {
+        m_available.fetch_add(count, std::memory_order_acq_rel);
+    }
+}
+
+uint64_t ThreadBudget::thread_cpu_ns() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+    return 0;
+}
+
+ThreadBudget* ThreadBudget::current() {
+    return t_budget;
+}
+
+int ThreadBudget::current_threads() {
+    return t_budget ? t_budget->threads() : ThreadingConfig::get_optimal_thread_count();
+}
+
+ThreadBudget::Scope::Scope(ThreadBudget* budget)
+    : m_previous(t_budget)
+    , m_previous_omp_threads(0) {
+    t_budget = budget;
+#ifdef _OPENMP
+    // Per-thread ICV: bounds OpenMP regions this thread starts, leaves other jobs alone
+    if (budget && budget != m_previous) {
+        m_previous_omp_threads = omp_get_max_threads();
+        omp_set_num_threads(budget->threads());
+    }
+#endif
+}
+
+ThreadBudget::Scope::~Scope() {
+#ifdef _OPENMP
+    if (m_previous_omp_threads > 0) {
+        omp_set_num_threads(m_previous_omp_threads);
+    }
+#endif
+    t_budget = m_previous;
+}
+
+CoreAllocator::CoreAllocator(int total_threads)
+    : m_total(total_threads > 0 ? total_threads : ThreadingConfig::get_optimal_thread_count())
+    , m_state(std::make_shared<State>()) {
+}
+
+std::shared_ptr<ThreadBudget> CoreAllocator::acquire(int requested) {
+    auto* budget = new ThreadBudget(1);
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->jobs.push_back(Job{budget, requested > 0 ? std::min(requested, m_total) : m_total});
+        rebalance(*m_state, m_total);
+    }
+    // The deleter holds the state, so budgets may outlive the allocator
+    std::shared_ptr<State> state = m_state;
+    const int total = m_total;
+    return std::shared_ptr<ThreadBudget>(budget, [state, total](ThreadBudget* released) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            auto& jobs = state->jobs;
+            jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [released](const Job& job) { return job.budget == released; }),
+                       jobs.end());
+            rebalance(*state, total);
+        }
+        delete released;
+    });
+}
+
+void CoreAllocator::rebalance(State& state, int total) {
+    // Smallest requests first: each job gets min(request, equal share of what is left)
+    std::vector<Job*> order;
+    order.reserve(state.jobs.size());
+    for (Job& job : state.jobs) {
+        order.push_back(&job);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Job* a, const Job* b) { return a->requested < b->requested; });
+
+    int remaining = total;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const int left = static_cast<int>(order.size() - i);
+        const int share = std::max(1, std::min(order[i]->requested, remaining / left));
+        order[i]->budget->set_threads(share);
+        remaining = std::max(0, remaining - share);
+    }
+}
+
+int CoreAllocator::in_use() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    int threads = 0;
+    for (const Job& job : m_state->jobs) {
+        threads += job.budget->threads();
+    }
+    return threads;
+}
+
+int CoreAllocator::active_jobs() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return static_cast<int>(m_state->jobs.size());
+}
+
+} // namespace bedrock
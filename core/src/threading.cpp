@@ -1,9 +1,16 @@
 #include "bedrock/threading.hpp"
+#include "bedrock/cpu_topology.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/thread_budget.hpp"
+#include "bedrock/trace.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <thread>
 #include <functional>
 #include <cmath>
+#include <sstream>
 
 namespace bedrock {
 
@@ -20,23 +27,22 @@ void ThreadingConfig::initialize(int max_threads) {
     s_max_threads = max_threads;
     
     if (is_openmp_available()) {
-        // Get system capabilities
-        int num_procs = omp_get_num_procs();
-        int max_threads_available = omp_get_max_threads();
+        // Get system capabilities: affinity mask and container CPU quota, not the host's processors
+        int usable_threads = CpuResources::detect().usable_threads;
         
-        // Determine optimal thread count
+        // Determine optimal thread count; a requested count never exceeds what the process may use
         if (max_threads > 0) {
-            s_optimal_threads = std::min(max_threads, max_threads_available);
+            s_optimal_threads = std::min(max_threads, usable_threads);
         } else {
-            // Use all available processors by default
-            s_optimal_threads = num_procs;
+            // Use every CPU this process may run on by default
+            s_optimal_threads = usable_threads;
         }
         
         // Set OpenMP thread count
         omp_set_num_threads(s_optimal_threads);
         
         std::cout << "ThreadingConfig initialized: " << s_optimal_threads 
-                  << " threads (max available: " << max_threads_available << ")" << std::endl;
+                  << " threads (usable: " << usable_threads << ")" << std::endl;
     } else {
         s_optimal_threads = 1;
         std::cout << "OpenMP not available, using single-threaded mode" << std::endl;
@@ -54,6 +60,12 @@ int ThreadingConfig::get_optimal_thread_count() {
 
 void ThreadingConfig::set_thread_count(int num_threads) {
     if (is_openmp_available()) {
+        if (ThreadBudget* budget = ThreadBudget::current()) {
+            // Inside a job: only this thread's regions change, within the job's budget
+            const int limit = budget->threads();
+            omp_set_num_threads(num_threads <= 0 ? limit : std::min(num_threads, limit));
+            return;
+        }
         if (num_threads <= 0) {
             num_threads = get_optimal_thread_count();
         }
@@ -64,6 +76,9 @@ void ThreadingConfig::set_thread_count(int num_threads) {
 
 int ThreadingConfig::get_thread_count() {
     if (is_openmp_available()) {
+        if (ThreadBudget* budget = ThreadBudget::current()) {
+            return std::min(omp_get_max_threads(), budget->threads());
+        }
         return omp_get_max_threads();
     }
     return 1;
@@ -90,6 +105,8 @@ std::string ThreadingConfig::get_system_info() {
     if (is_openmp_available()) {
         info += "OpenMP Version: " + get_openmp_version() + "\n";
         info += "Available Processors: " + std::to_string(omp_get_num_procs()) + "\n";
+        info += CpuResources::detect().describe();
+        info += CpuTopology::detect().describe();
         info += "Max Threads: " + std::to_string(omp_get_max_threads()) + "\n";
         info += "Current Threads: " + std::to_string(omp_get_num_threads()) + "\n";
     } else {
@@ -100,32 +117,212 @@ std::string ThreadingConfig::get_system_info() {
 }
 
 // ThreadingBenchmark implementation
-template<typename Func>
-std::vector<std::pair<int, double>> ThreadingBenchmark::benchmark_thread_scaling(
-    Func&& func, 
-    int iterations
-) {
-    std::vector<std::pair<int, double>> results;
-    
-    if (!ThreadingConfig::is_openmp_available()) {
-        results.push_back({1, measure_execution_time(func, iterations)});
-        return results;
+namespace {
+
+void append_json_string(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
     }
-    
-    int max_threads = omp_get_num_procs();
-    
-    for (int threads = 1; threads <= max_threads; ++threads) {
-        omp_set_num_threads(threads);
-        
-        double time_ms = measure_execution_time(func, iterations);
-        results.push_back({threads, time_ms});
-        
-        std::cout << "Threads: " << threads << ", Time: " << time_ms << " ms" << std::endl;
+    out += '"';
+}
+
+// Thread counts to sweep: within the usable threads and the caller's budget, 1 first
+std::vector<int> scaling_thread_counts(const std::vector<int>& requested) {
+    const int max_threads = std::max(1, std::min(CpuResources::detect().usable_threads, ThreadBudget::current_threads()));
+    std::vector<int> counts{1};
+    if (requested.empty()) {
+        for (int threads = 2; threads < max_threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(max_threads);
+    } else {
+        for (int threads : requested) {
+            counts.push_back(std::clamp(threads, 1, max_threads));
+        }
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+} // namespace
+
+SampleStats SampleStats::from_samples(std::vector<double> samples_ms) {
+    SampleStats stats;
+    stats.count = static_cast<int>(samples_ms.size());
+    if (samples_ms.empty()) {
+        return stats;
+    }
+    std::sort(samples_ms.begin(), samples_ms.end());
+    const size_t n = samples_ms.size();
+    stats.min_ms = samples_ms.front();
+    stats.max_ms = samples_ms.back();
+    stats.median_ms = n % 2 ? samples_ms[n / 2] : (samples_ms[n / 2 - 1] + samples_ms[n / 2]) / 2.0;
+
+    double sum = 0.0;
+    for (double sample : samples_ms) {
+        sum += sample;
+    }
+    stats.mean_ms = sum / static_cast<double>(n);
+    double squares = 0.0;
+    for (double sample : samples_ms) {
+        squares += (sample - stats.mean_ms) * (sample - stats.mean_ms);
+    }
+    stats.stddev_ms = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0.0;
+
+    // Ranks j..k (1-based) cover the median with ~95% probability for any distribution
+    stats.ci_low_ms = stats.min_ms;
+    stats.ci_high_ms = stats.max_ms;
+    if (n >= 6) {
+        const double half_width = 1.96 * std::sqrt(static_cast<double>(n)) / 2.0;
+        const long j = std::lround(static_cast<double>(n) / 2.0 - half_width);
+        const long k = std::lround(1.0 + static_cast<double>(n) / 2.0 + half_width);
+        stats.ci_low_ms = samples_ms[static_cast<size_t>(std::clamp<long>(j, 1, static_cast<long>(n)) - 1)];
+        stats.ci_high_ms = samples_ms[static_cast<size_t>(std::clamp<long>(k, 1, static_cast<long>(n)) - 1)];
+    }
+    return stats;
+}
+
+std::string ScalingResult::report() const {
+    std::string out = "=== Scaling: " + name + " ===\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "%7s %12s %25s %9s %10s\n", "Threads", "Median ms", "95% CI ms", "Speedup",
+                  "Efficiency");
+    out += line;
+    for (const ScalingPoint& point : points) {
+        char interval[64];
+        std::snprintf(interval, sizeof(interval), "[%.4g, %.4g]", point.time.ci_low_ms, point.time.ci_high_ms);
+        std::snprintf(line, sizeof(line), "%7d %12.4g %25s %9.2f %9.0f%%\n", point.threads, point.time.median_ms,
+                      interval, point.speedup, point.efficiency * 100.0);
+        out += line;
+    }
+    return out;
+}
+
+ScalingResult ThreadingBenchmark::measure_scaling(const std::string& name, const std::function<void()>& kernel,
+                                                  const ScalingOptions& options) {
+    ScalingResult result;
+    result.name = name;
+    const std::vector<int> counts = scaling_thread_counts(options.thread_counts);
+    const int iterations = std::max(1, options.iterations);
+    const int samples = std::max(1, options.samples);
+
+    for (int threads : counts) {
+        ThreadBudget budget(threads);
+        ThreadBudget::Scope scope(budget);
+        for (int i = 0; i < options.warmup_runs; ++i) {
+            kernel();
+        }
+    }
+
+    std::vector<std::vector<double>> times(counts.size());
+    for (int sample = 0; sample < samples; ++sample) {
+        for (size_t c = 0; c < counts.size(); ++c) {
+            ThreadBudget budget(counts[c]);
+            ThreadBudget::Scope scope(budget);
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                kernel();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            times[c].push_back(std::chrono::duration<double, std::milli>(end - start).count() / iterations);
+        }
+    }
+
+    for (size_t c = 0; c < counts.size(); ++c) {
+        ScalingPoint point;
+        point.threads = counts[c];
+        point.time = SampleStats::from_samples(std::move(times[c]));
+        result.points.push_back(point);
+    }
+    const double baseline_ms = result.points.front().time.median_ms;
+    for (ScalingPoint& point : result.points) {
+        point.speedup = point.time.median_ms > 0.0 ? baseline_ms / point.time.median_ms : 0.0;
+        point.efficiency = point.speedup / point.threads;
+    }
+    return result;
+}
+
+std::vector<ScalingResult> ThreadingBenchmark::measure_registered_scaling(const ScalingOptions& options) {
+    std::vector<ScalingResult> results;
+    for (const TunableKernel& kernel : tunable_kernels()) {
+        if (!kernel.run || kernel.items <= 0) {
+            continue;
+        }
+        results.push_back(measure_scaling(kernel.name, [&kernel]() { kernel.run(0); }, options));
     }
-    
     return results;
 }
 
+std::string ThreadingBenchmark::scaling_to_json(const std::vector<ScalingResult>& results) {
+    std::string out = "{\n  \"cpu_model\": ";
+    append_json_string(out, TuningProfile::current_cpu_model());
+    out += ",\n  \"usable_threads\": " + std::to_string(CpuResources::detect().usable_threads);
+    out += ",\n  \"kernels\": [";
+    char number[512];
+    for (size_t r = 0; r < results.size(); ++r) {
+        out += r ? ",\n    {\"name\": " : "\n    {\"name\": ";
+        append_json_string(out, results[r].name);
+        out += ", \"points\": [";
+        for (size_t p = 0; p < results[r].points.size(); ++p) {
+            const ScalingPoint& point = results[r].points[p];
+            std::snprintf(number, sizeof(number),
+                          "%s\n      {\"threads\": %d, \"samples\": %d, \"median_ms\": %.6g, \"ci_low_ms\": %.6g, "
+                          "\"ci_high_ms\": %.6g, \"mean_ms\": %.6g, \"stddev_ms\": %.6g, \"min_ms\": %.6g, "
+                          "\"max_ms\": %.6g, \"speedup\": %.6g, \"efficiency\": %.6g}",
+                          p ? "," : "", point.threads, point.time.count, point.time.median_ms, point.time.ci_low_ms,
+                          point.time.ci_high_ms, point.time.mean_ms, point.time.stddev_ms, point.time.min_ms,
+                          point.time.max_ms, point.speedup, point.efficiency);
+            out += number;
+        }
+        out += "\n    ]}";
+    }
+    out += results.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+std::string ThreadingBenchmark::scaling_to_csv(const std::vector<ScalingResult>& results) {
+    std::string out = "kernel,threads,samples,median_ms,ci_low_ms,ci_high_ms,mean_ms,stddev_ms,min_ms,max_ms,speedup,efficiency\n";
+    char line[512];
+    for (const ScalingResult& result : results) {
+        std::string name = result.name;
+        if (name.find_first_of(",\"\n") != std::string::npos) {
+            std::string quoted = "\"";
+            for (char c : name) {
+                quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+            }
+            name = quoted + "\"";
+        }
+        for (const ScalingPoint& point : result.points) {
+            std::snprintf(line, sizeof(line), ",%d,%d,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n", point.threads,
+                          point.time.count, point.time.median_ms, point.time.ci_low_ms, point.time.ci_high_ms,
+                          point.time.mean_ms, point.time.stddev_ms, point.time.min_ms, point.time.max_ms,
+                          point.speedup, point.efficiency);
+            out += name + line;
+        }
+    }
+    return out;
+}
+
+bool ThreadingBenchmark::save_scaling(const std::string& path, const std::vector<ScalingResult>& results) {
+    const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    std::ofstream out(path, std::ios::trunc);
+    out << (csv ? scaling_to_csv(results) : scaling_to_json(results));
+    return static_cast<bool>(out);
+}
+
 int ThreadingBenchmark::find_optimal_batch_size(
     int total_rays, 
     int min_batch_size, 
@@ -171,47 +368,87 @@ int ThreadingBenchmark::find_optimal_batch_size(
     return optimal_batch_size;
 }
 
-std::string ThreadingBenchmark::calibrate_system() {
+TuningProfile ThreadingBenchmark::calibrate_kernels(const std::vector<TunableKernel>& kernels, int repetitions) {
+    TuningProfile profile;
+    profile.cpu_model = TuningProfile::current_cpu_model();
+    profile.usable_threads = CpuResources::detect().usable_threads;
+    repetitions = std::max(1, repetitions);
+
+    // Budgets above the scheduler's size would not add workers
+    const int max_threads = std::min(profile.usable_threads, TaskScheduler::global().thread_count());
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    auto best_time_ms = [repetitions](const TunableKernel& kernel, int64_t grain) {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < repetitions; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            kernel.run(grain);
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    };
+
+    for (const TunableKernel& kernel : kernels) {
+        if (!kernel.run || kernel.items <= 0) {
+            continue;
+        }
+        KernelTuning best;
+        for (int threads : thread_counts) {
+            ThreadBudget budget(threads);
+            ThreadBudget::Scope scope(budget);
+
+            // One block per thread (static split) down to 32 chunks per thread (fine stealing)
+            std::vector<int64_t> grains;
+            for (int64_t per_thread = 1; per_thread <= 32; per_thread *= 2) {
+                const int64_t grain = std::max<int64_t>(1, kernel.items / (threads * per_thread));
+                if (grains.empty() || grains.back() != grain) {
+                    grains.push_back(grain);
+                }
+            }
+
+            kernel.run(grains.front());  // Warm-up: page in buffers, wake workers
+            for (int64_t grain : grains) {
+                const double time_ms = best_time_ms(kernel, grain);
+                const double to_beat = threads > best.threads ? best.time_ms * 0.97 : best.time_ms;
+                if (best.threads == 0 || time_ms < to_beat) {
+                    best = KernelTuning{threads, grain, kernel.items, time_ms};
+                }
+            }
+        }
+        profile.kernels[kernel.name] = best;
+    }
+    return profile;
+}
+
+std::string ThreadingBenchmark::calibrate_system(const std::string& profile_path) {
     std::string results = "=== Bedrock Threading Calibration ===\n\n";
     
     results += ThreadingConfig::get_system_info() + "\n";
     
-    if (!ThreadingConfig::is_openmp_available()) {
-        results += "OpenMP not available - using single-threaded mode\n";
+    const std::vector<TunableKernel> kernels = tunable_kernels();
+    if (kernels.empty()) {
+        results += "No tunable kernels registered - nothing to calibrate\n";
         return results;
     }
     
-    // Test with a compute-intensive workload
-    auto test_workload = []() {
-        const int size = 1000000;
-        std::vector<double> data(size);
-        
-        #pragma omp parallel for
-        for (int i = 0; i < size; ++i) {
-            data[i] = sin(i * 0.001) * cos(i * 0.001);
-        }
-        
-        // Prevent optimization
-        double sum = 0;
-        for (double val : data) {
-            sum += val;
-        }
-    };
-    
-    results += "Benchmarking thread scaling...\n";
-    auto scaling_results = benchmark_thread_scaling(test_workload, 5);
-    
-    // Find optimal thread count
-    auto best_result = std::min_element(scaling_results.begin(), scaling_results.end(),
-        [](const auto& a, const auto& b) { return a.second < b.second; });
-    
-    results += "Optimal thread count: " + std::to_string(best_result->first) + "\n";
-    results += "Best performance: " + std::to_string(best_result->second) + " ms\n\n";
+    TuningProfile profile = calibrate_kernels(kernels);
+    for (const auto& [name, tuning] : profile.kernels) {
+        std::ostringstream line;
+        line << "Kernel " << name << ": " << tuning.threads << " threads, grain " << tuning.grain << " ("
+             << tuning.time_ms << " ms for " << tuning.items << " items)\n";
+        results += line.str();
+    }
     
-    // Test ray tracing batch size
-    results += "Testing ray tracing batch sizes...\n";
-    int optimal_batch = find_optimal_batch_size(50000, 1000, 50000);
-    results += "Optimal batch size for 50,000 rays: " + std::to_string(optimal_batch) + "\n";
+    if (!profile_path.empty()) {
+        results += profile.save(profile_path) ? "Saved tuning profile to " + profile_path + "\n"
+                                              : "Failed to save tuning profile to " + profile_path + "\n";
+    }
+    TuningProfile::install(std::move(profile));
     
     return results;
 }
@@ -239,38 +476,32 @@ PerformanceCounter::~PerformanceCounter() {
 }
 
 void PerformanceCounter::start() {
-    m_start_time = std::chrono::high_resolution_clock::now();
+    m_start_time = std::chrono::steady_clock::now();
     m_running = true;
 }
 
 void PerformanceCounter::stop() {
     if (m_running) {
+        m_elapsed += std::chrono::steady_clock::now() - m_start_time;
         m_running = false;
     }
 }
 
+void PerformanceCounter::reset() {
+    m_elapsed = std::chrono::steady_clock::duration{0};
+    m_running = false;
+}
+
 double PerformanceCounter::get_elapsed_ms() const {
+    auto elapsed = m_elapsed;
     if (m_running) {
-        auto now = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - m_start_time);
-        return duration.count() / 1000.0;
+        elapsed += std::chrono::steady_clock::now() - m_start_time;
     }
-    return 0.0;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
 }
 
 double PerformanceCounter::get_elapsed_seconds() const {
     return get_elapsed_ms() / 1000.0;
 }
 
-// ScopedTimer implementation
-ScopedTimer::ScopedTimer(const std::string& name) 
-    : m_counter(std::make_unique<PerformanceCounter>(name)) {
-    m_counter->start();
-}
-
-ScopedTimer::~ScopedTimer() {
-    m_counter->stop();
-    std::cout << "Timer: " << m_counter->get_elapsed_ms() << " ms" << std::endl;
-}
-
 } // namespace bedrock
@@ -92,6 +92,8 @@ int main() {
         test_ray_tracing_simulation();
         test_system_calibration();
         
+        std::cout << "\n" << bedrock::Profiler::report();
+        
         std::cout << "\n✅ All threading tests passed!" << std::endl;
         return 0;
         
@@ -0,0 +1,293 @@
+#include "bedrock/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace bedrock {
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+struct SpanEvent {
+    char name[Tracer::MAX_NAME_LENGTH + 1];
+    const char* category;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t id;
+};
+
+constexpr size_t CHUNK_SIZE = 4096;
+constexpr size_t MAX_CHUNKS = Tracer::MAX_SPANS_PER_THREAD / CHUNK_SIZE;
+
+// Bumped by clear(); a thread that sees a new generation rewinds its buffer before
+// its next span, so a full buffer records again after every clear()
+std::atomic<uint64_t> g_generation{0};
+
+// Single-writer buffer owned by one thread. Chunks are allocated by the owner and
+// published before the size that makes them visible, so readers only need acquire loads.
+// The owner only rewinds size under the registry mutex, which every reader holds.
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    std::string name;                       // Guarded by registry mutex
+    size_t begin = 0;                       // Guarded by registry mutex (advanced by clear())
+    uint64_t generation = 0;                // Owner thread only (set under registry mutex)
+    bool retired = false;                   // Guarded by registry mutex; owner thread has exited
+    std::atomic<size_t> size{0};
+    std::atomic<size_t> dropped{0};
+    std::array<std::atomic<SpanEvent*>, MAX_CHUNKS> chunks{};
+
+    ~ThreadBuffer() {
+        for (auto& chunk : chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// A finished thread's buffer stays until its spans are cleared, so they can still be
+// exported; after that it is handed to the next new thread (keeping its chunks) or freed
+// by clear(). Pool threads that expire and respawn therefore do not grow the registry.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    uint32_t next_tid = 1;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();  // Leaked: threads may record during static destruction
+    return *instance;
+}
+
+// Rewind to empty for the current generation (registry mutex held)
+void rewind(ThreadBuffer& buffer) {
+    buffer.generation = g_generation.load(std::memory_order_relaxed);
+    buffer.begin = 0;
+    buffer.size.store(0, std::memory_order_relaxed);
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+// Retires the calling thread's buffer when the thread exits
+struct BufferRetirer {
+    ~BufferRetirer() {
+        if (!t_buffer) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        t_buffer->retired = true;
+        t_buffer = nullptr;  // A span recorded later in thread teardown registers afresh
+    }
+};
+
+thread_local BufferRetirer t_retirer;
+
+ThreadBuffer& thread_buffer() {
+    if (!t_buffer) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        ThreadBuffer* buffer = nullptr;
+        for (auto& candidate : reg.buffers) {
+            if (candidate->retired && candidate->begin == candidate->size.load(std::memory_order_relaxed)) {
+                buffer = candidate.get();  // Nothing left to export: reuse
+                break;
+            }
+        }
+        if (!buffer) {
+            reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = reg.buffers.back().get();
+        }
+        buffer->tid = reg.next_tid++;
+        buffer->name.clear();
+        buffer->retired = false;
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        rewind(*buffer);
+        t_buffer = buffer;
+        (void)&t_retirer;  // Odr-use constructs the thread's retirer
+    }
+    return *t_buffer;
+}
+
+void append_json_string(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+long process_id() {
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<long>(::getpid());
+#else
+    return 1;
+#endif
+}
+
+} // namespace
+
+void Tracer::set_enabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Tracer::record(const char* category, std::string_view name,
+                    uint64_t start_ns, uint64_t end_ns, uint64_t id) {
+    ThreadBuffer& buffer = thread_buffer();
+    if (buffer.generation != g_generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(registry().mutex);  // Once per clear(), not per span
+        rewind(buffer);
+    }
+    size_t index = buffer.size.load(std::memory_order_relaxed);
+    if (index >= MAX_SPANS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& chunk_slot = buffer.chunks[index / CHUNK_SIZE];
+    SpanEvent* chunk = chunk_slot.load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new SpanEvent[CHUNK_SIZE];
+        chunk_slot.store(chunk, std::memory_order_release);
+    }
+
+    SpanEvent& event = chunk[index % CHUNK_SIZE];
+    size_t length = std::min(name.size(), MAX_NAME_LENGTH);
+    std::memcpy(event.name, name.data(), length);
+    event.name[length] = '\0';
+    event.category = category;
+    event.start_ns = start_ns;
+    event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    event.id = id;
+
+    buffer.size.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(std::string_view name) {
+    ThreadBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = std::string(name);
+}
+
+void Tracer::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    g_generation.fetch_add(1, std::memory_order_release);
+    std::erase_if(reg.buffers, [](const std::unique_ptr<ThreadBuffer>& buffer) { return buffer->retired; });
+    for (auto& buffer : reg.buffers) {
+        buffer->begin = buffer->size.load(std::memory_order_acquire);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t Tracer::buffer_count() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.buffers.size();
+}
+
+size_t Tracer::span_count() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t count = 0;
+    for (auto& buffer : reg.buffers) {
+        count += buffer->size.load(std::memory_order_acquire) - buffer->begin;
+    }
+    return count;
+}
+
+size_t Tracer::dropped_count() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t count = 0;
+    for (auto& buffer : reg.buffers) {
+        count += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::string Tracer::chrome_trace_json() {
+    const long pid = process_id();
+    std::string out;
+    out.reserve(1 << 16);
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    char number[160];
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto& buffer : reg.buffers) {
+        if (!buffer->name.empty()) {
+            out += first ? "" : ",";
+            first = false;
+            std::snprintf(number, sizeof(number),
+                          "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%ld,\"tid\":%u,\"args\":{\"name\":",
+                          pid, buffer->tid);
+            out += number;
+            append_json_string(out, buffer->name);
+            out += "}}";
+        }
+
+        size_t end = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = buffer->begin; i < end; ++i) {
+            const SpanEvent& event = buffer->chunks[i / CHUNK_SIZE].load(std::memory_order_acquire)[i % CHUNK_SIZE];
+            out += first ? "" : ",";
+            first = false;
+            out += "{\"ph\":\"X\",\"name\":";
+            append_json_string(out, event.name);
+            out += ",\"cat\":";
+            append_json_string(out, event.category ? event.category : "");
+            // Chrome trace timestamps are microseconds; keep ns precision as decimals
+            std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%u",
+                          event.start_ns / 1000.0, event.duration_ns / 1000.0, pid, buffer->tid);
+            out += number;
+            if (event.id != 0) {
+                std::snprintf(number, sizeof(number), ",\"args\":{\"id\":%llu}",
+                              static_cast<unsigned long long>(event.id));
+                out += number;
+            }
+            out += '}';
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool Tracer::write_chrome_trace(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    std::string json = chrome_trace_json();
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(out);
+}
+
+} // namespace bedrock
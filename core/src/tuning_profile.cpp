@@ -0,0 +1,214 @@
+#include "bedrock/tuning_profile.hpp"
+#include "bedrock/cpu_topology.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace bedrock {
+
+namespace {
+
+struct ProfileState {
+    std::mutex mutex;
+    std::shared_ptr<const TuningProfile> active;
+    std::map<std::string, TunableKernel> kernels;
+};
+
+ProfileState& state() {
+    static ProfileState instance;
+    return instance;
+}
+
+void set_error(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace
+
+const KernelTuning* TuningProfile::find(const std::string& kernel) const {
+    const auto it = kernels.find(kernel);
+    return it == kernels.end() ? nullptr : &it->second;
+}
+
+std::string TuningProfile::serialize() const {
+    std::ostringstream out;
+    out << "# bedrock tuning profile\n";
+    out << "version " << FORMAT_VERSION << "\n";
+    out << "cpu_model " << cpu_model << "\n";
+    out << "usable_threads " << usable_threads << "\n";
+    for (const auto& [name, tuning] : kernels) {
+        out << "kernel " << name << " threads " << tuning.threads << " grain " << tuning.grain << " items "
+            << tuning.items << " time_ms " << std::fixed << std::setprecision(3) << tuning.time_ms << "\n";
+    }
+    return out.str();
+}
+
+std::optional<TuningProfile> TuningProfile::parse(const std::string& text, std::string* error) {
+    TuningProfile profile;
+    int version = 0;
+    std::istringstream lines(text);
+    std::string line;
+    int line_number = 0;
+    while (std::getline(lines, line)) {
+        ++line_number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "version") {
+            fields >> version;
+            if (version != FORMAT_VERSION) {
+                set_error(error, "unsupported profile version " + std::to_string(version));
+                return std::nullopt;
+            }
+        } else if (key == "cpu_model") {
+            profile.cpu_model = trim(line.substr(key.size()));
+        } else if (key == "usable_threads") {
+            fields >> profile.usable_threads;
+        } else if (key == "kernel") {
+            std::string name, threads_key, grain_key, items_key, time_key;
+            KernelTuning tuning;
+            fields >> name >> threads_key >> tuning.threads >> grain_key >> tuning.grain >> items_key >> tuning.items
+                >> time_key >> tuning.time_ms;
+            if (!fields || threads_key != "threads" || grain_key != "grain" || items_key != "items" ||
+                time_key != "time_ms" || tuning.threads < 1 || tuning.grain < 1) {
+                set_error(error, "malformed kernel entry on line " + std::to_string(line_number));
+                return std::nullopt;
+            }
+            profile.kernels[name] = tuning;
+        }
+        // Unknown keys are skipped so newer writers can add fields within a version
+    }
+    if (version == 0) {
+        set_error(error, "missing version line");
+        return std::nullopt;
+    }
+    return profile;
+}
+
+bool TuningProfile::save(const std::string& path) const {
+    std::error_code ec;
+    const std::filesystem::path file(path);
+    if (file.has_parent_path()) {
+        std::filesystem::create_directories(file.parent_path(), ec);
+    }
+    // Write a sibling and rename, so a concurrently starting server never reads half a profile
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << serialize();
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, file, ec);
+    return !ec;
+}
+
+std::optional<TuningProfile> TuningProfile::load(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        set_error(error, "cannot open " + path);
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    auto profile = parse(buffer.str(), error);
+    if (!profile) {
+        return std::nullopt;
+    }
+    const std::string model = current_cpu_model();
+    if (profile->cpu_model != model) {
+        set_error(error, "profile was measured on \"" + profile->cpu_model + "\", this CPU is \"" + model + "\"");
+        return std::nullopt;
+    }
+    return profile;
+}
+
+std::string TuningProfile::current_cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                return trim(line.substr(colon + 1));
+            }
+        }
+    }
+    return "unknown";
+}
+
+std::string TuningProfile::default_path() {
+    if (const char* path = std::getenv("BEDROCK_TUNING_PROFILE"); path && *path) {
+        return path;
+    }
+    if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache) {
+        return std::string(cache) + "/bedrock/tuning_profile.txt";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/bedrock/tuning_profile.txt";
+    }
+    return "bedrock_tuning_profile.txt";
+}
+
+void TuningProfile::install(TuningProfile profile) {
+    auto installed = std::make_shared<const TuningProfile>(std::move(profile));
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().active = std::move(installed);
+}
+
+std::shared_ptr<const TuningProfile> TuningProfile::active() {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().active;
+}
+
+KernelTuning TuningProfile::lookup(const std::string& kernel) {
+    const auto profile = active();
+    const KernelTuning* tuning = profile ? profile->find(kernel) : nullptr;
+    if (!tuning) {
+        return {};
+    }
+    KernelTuning result = *tuning;
+    // Same CPU model, but possibly a tighter container quota than when measured
+    result.threads = std::min(result.threads, CpuResources::detect().usable_threads);
+    return result;
+}
+
+void register_tunable_kernel(TunableKernel kernel) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().kernels[kernel.name] = std::move(kernel);
+}
+
+std::vector<TunableKernel> tunable_kernels() {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    std::vector<TunableKernel> kernels;
+    for (const auto& [name, kernel] : state().kernels) {
+        kernels.push_back(kernel);
+    }
+    return kernels;
+}
+
+} // namespace bedrock
@@ -5,24 +5,88 @@
 #include "palantir/capabilities.pb.h"
 #endif
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace bedrock {
 namespace palantir {
 
+// Reply metadata keys on a CapabilitiesResponse (server -> client)
+// The Capabilities message only carries version and features, so capacity rides
+// in the envelope metadata:
+//   queue_depth:    compute work waiting to start (held by a handler's concurrency
+//                   limit or queued in a pool)
+//   active_jobs:    compute work executing now (disjoint from queue_depth)
+//   worker_count:   compute workers
+//   simd_level:     widest vector ISA the server was built for (e.g. "avx2", "neon", "scalar")
+//   encodings:      comma-separated payload encodings the server accepts
+//   mem_<subsystem>_bytes, mem_<subsystem>_peak_bytes:
+//                   bytes attributed to a subsystem now and at most since start
+//                   (transport, protobuf, compute_scratch, cache, other); present
+//                   for subsystems that have allocated (see bedrock::MemoryTracker)
+static constexpr const char* META_QUEUE_DEPTH = "queue_depth";
+static constexpr const char* META_ACTIVE_JOBS = "active_jobs";
+static constexpr const char* META_WORKER_COUNT = "worker_count";
+static constexpr const char* META_SIMD_LEVEL = "simd_level";
+static constexpr const char* META_ENCODINGS = "encodings";
+static constexpr const char* META_MEMORY_PREFIX = "mem_";
+
+// SubsystemMemory: one subsystem's tracked bytes
+struct SubsystemMemory {
+    std::string subsystem;
+    int64_t currentBytes = 0;
+    int64_t peakBytes = 0;
+};
+
+// ServerLoad: live counters sampled when a capabilities request is answered
+struct ServerLoad {
+    int queueDepth = 0;
+    int activeJobs = 0;
+    int workers = 0;
+    std::vector<SubsystemMemory> memory;
+};
+
 // CapabilitiesService - In-process API for generating CapabilitiesResponse
-// WP1: Simple, deterministic implementation without networking
-// Future: Will be integrated into Palantir IPC server
+// Features are registered by the code that implements them, so the response lists
+// exactly what this build can serve. The response is built once and reused until the
+// feature set changes; only the load metadata is produced per request.
+// Not thread-safe: owned by the server's event loop thread.
 class CapabilitiesService {
 public:
+    // Starts with no features; each registered handler adds its own
+    CapabilitiesService() = default;
+
+    // Adds a feature (ignored if already present)
+    void addFeature(const std::string& feature);
+    bool hasFeature(const std::string& feature) const;
+    const std::vector<std::string>& features() const { return features_; }
+
+    // "bedrock-<project version>"
+    static std::string serverVersion();
+    // Compile-time vector ISA of this build
+    static const char* simdLevel();
+
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
     // Get server capabilities
-    // Returns a CapabilitiesResponse with server version and supported features
-    ::palantir::CapabilitiesResponse getCapabilities() const;
+    // Returns the cached CapabilitiesResponse with server version and supported features
+    const ::palantir::CapabilitiesResponse& getCapabilities() const;
 #else
-    // When transport deps are OFF, this class is a no-op
-    // (proto types not available)
+    // When transport deps are OFF, the proto response is unavailable
+    // (features and load metadata still work)
 #endif
+
+    // Reply metadata describing current capacity (see META_* keys above)
+    std::map<std::string, std::string> loadMetadata(const ServerLoad& load) const;
+
+private:
+    // Defined in the .cpp so the layout does not depend on BEDROCK_WITH_TRANSPORT_DEPS
+    struct CachedResponse;
+
+    std::vector<std::string> features_;
+    mutable std::shared_ptr<CachedResponse> cached_;  // Reset when features change
 };
 
 } // namespace palantir
 } // namespace bedrock
-
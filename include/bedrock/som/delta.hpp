@@ -0,0 +1,86 @@
+#pragma once
+#include "bedrock/som/types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bedrock::som {
+
+// One edit to SystemModel::elements. `index` refers to the element list as it
+// stands when the edit is applied (edits apply in order).
+struct ElementEdit {
+  enum class Op { Insert, Replace, Erase };
+
+  Op op{Op::Replace};
+  std::size_t index{0};
+  TwoSurfaceElement element{};  // Unused for Erase
+
+  bool operator==(const ElementEdit&) const = default;
+};
+
+// SomDelta: the change from model version `base_version` to the next version.
+// Clients send deltas instead of the full model once it is resident on the server.
+struct SomDelta {
+  std::uint64_t base_version{0};
+  std::optional<LengthUnits> units;  // Set only when the units change
+  std::vector<ElementEdit> edits;
+
+  [[nodiscard]] bool empty() const noexcept { return !units && edits.empty(); }
+  bool operator==(const SomDelta&) const = default;
+};
+
+// Applies `delta` to `model` in place. On an out-of-range edit the model is left
+// unchanged and false is returned (with a reason in `error` if given).
+[[nodiscard]] inline bool ApplyDelta(SystemModel& model, const SomDelta& delta,
+                                     std::string* error = nullptr) {
+  SystemModel edited = model;
+  if (delta.units) edited.units = *delta.units;
+  for (std::size_t i = 0; i < delta.edits.size(); ++i) {
+    const ElementEdit& edit = delta.edits[i];
+    auto& elements = edited.elements;
+    const std::size_t limit = edit.op == ElementEdit::Op::Insert ? elements.size() + 1 : elements.size();
+    if (edit.index >= limit) {
+      if (error) {
+        *error = "edit " + std::to_string(i) + ": element index " + std::to_string(edit.index) +
+                 " out of range (" + std::to_string(elements.size()) + " elements)";
+      }
+      return false;
+    }
+    auto at = elements.begin() + static_cast<std::ptrdiff_t>(edit.index);
+    switch (edit.op) {
+      case ElementEdit::Op::Insert:  elements.insert(at, edit.element); break;
+      case ElementEdit::Op::Replace: *at = edit.element; break;
+      case ElementEdit::Op::Erase:   elements.erase(at); break;
+    }
+  }
+  model = std::move(edited);
+  return true;
+}
+
+// Computes a delta taking `from` (at version `from_version`) to `to`: changed
+// elements are replaced in place, then elements are appended or trimmed at the end.
+[[nodiscard]] inline SomDelta Diff(const SystemModel& from, const SystemModel& to,
+                                   std::uint64_t from_version) {
+  SomDelta delta;
+  delta.base_version = from_version;
+  if (from.units != to.units) delta.units = to.units;
+
+  const std::size_t common = std::min(from.elements.size(), to.elements.size());
+  for (std::size_t i = 0; i < common; ++i) {
+    if (!(from.elements[i] == to.elements[i])) {
+      delta.edits.push_back({ElementEdit::Op::Replace, i, to.elements[i]});
+    }
+  }
+  for (std::size_t i = common; i < to.elements.size(); ++i) {
+    delta.edits.push_back({ElementEdit::Op::Insert, i, to.elements[i]});
+  }
+  for (std::size_t i = from.elements.size(); i > common; --i) {
+    delta.edits.push_back({ElementEdit::Op::Erase, i - 1, {}});
+  }
+  return delta;
+}
+
+} // namespace bedrock::som
@@ -0,0 +1,154 @@
+#pragma once
+#include "bedrock/som/delta.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace bedrock::som {
+
+// Compact binary form of a SomDelta for change notifications. Integers are
+// LEB128 varints, doubles are raw little-endian IEEE-754, strings are
+// length-prefixed. A one-radius edit encodes in well under 100 bytes.
+//
+//   delta   := version:varint flags:u8 [units:u8] count:varint edit*
+//   edit    := op:u8 index:varint [element]          (no element for Erase)
+//   element := name:str material:str surface surface
+//   surface := name:str radius:f64 thickness:f64 diameter:f64 is_stop:u8
+namespace detail {
+
+inline void PutVarint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+inline void PutDouble(std::string& out, double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+}
+
+inline void PutString(std::string& out, const std::string& value) {
+  PutVarint(out, value.size());
+  out += value;
+}
+
+inline void PutSurface(std::string& out, const Surface& s) {
+  PutString(out, s.name);
+  PutDouble(out, s.radius);
+  PutDouble(out, s.thickness);
+  PutDouble(out, s.diameter);
+  out.push_back(s.is_stop ? 1 : 0);
+}
+
+class Reader {
+public:
+  Reader(const char* data, std::size_t size) : p_(data), end_(data + size) {}
+
+  bool Varint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (p_ == end_) return false;
+      const auto byte = static_cast<std::uint8_t>(*p_++);
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return true;
+    }
+    return false;
+  }
+  bool Byte(std::uint8_t& value) {
+    if (p_ == end_) return false;
+    value = static_cast<std::uint8_t>(*p_++);
+    return true;
+  }
+  bool Double(double& value) {
+    if (end_ - p_ < 8) return false;
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(p_[i])) << (8 * i);
+    std::memcpy(&value, &bits, sizeof(value));
+    p_ += 8;
+    return true;
+  }
+  bool String(std::string& value) {
+    std::uint64_t size = 0;
+    if (!Varint(size) || size > static_cast<std::uint64_t>(end_ - p_)) return false;
+    value.assign(p_, static_cast<std::size_t>(size));
+    p_ += size;
+    return true;
+  }
+  bool Surface(som::Surface& s) {
+    std::uint8_t stop = 0;
+    if (!String(s.name) || !Double(s.radius) || !Double(s.thickness) || !Double(s.diameter) || !Byte(stop)) {
+      return false;
+    }
+    s.is_stop = stop != 0;
+    return true;
+  }
+  bool AtEnd() const { return p_ == end_; }
+
+private:
+  const char* p_;
+  const char* end_;
+};
+
+} // namespace detail
+
+[[nodiscard]] inline std::string EncodeDelta(const SomDelta& delta) {
+  std::string out;
+  detail::PutVarint(out, delta.base_version);
+  out.push_back(delta.units ? 1 : 0);
+  if (delta.units) out.push_back(static_cast<char>(*delta.units));
+  detail::PutVarint(out, delta.edits.size());
+  for (const ElementEdit& edit : delta.edits) {
+    out.push_back(static_cast<char>(edit.op));
+    detail::PutVarint(out, edit.index);
+    if (edit.op == ElementEdit::Op::Erase) continue;
+    detail::PutString(out, edit.element.name);
+    detail::PutString(out, edit.element.material);
+    detail::PutSurface(out, edit.element.s1);
+    detail::PutSurface(out, edit.element.s2);
+  }
+  return out;
+}
+
+// Returns false (with a reason in `error` if given) on truncated or malformed input
+[[nodiscard]] inline bool DecodeDelta(const char* data, std::size_t size, SomDelta& delta,
+                                      std::string* error = nullptr) {
+  auto fail = [error](const char* what) {
+    if (error) *error = std::string("malformed SomDelta: ") + what;
+    return false;
+  };
+  detail::Reader in(data, size);
+  SomDelta out;
+  std::uint8_t flags = 0;
+  if (!in.Varint(out.base_version) || !in.Byte(flags)) return fail("truncated header");
+  if (flags & 1) {
+    std::uint8_t units = 0;
+    if (!in.Byte(units) || units > static_cast<std::uint8_t>(LengthUnits::m)) return fail("bad units");
+    out.units = static_cast<LengthUnits>(units);
+  }
+  std::uint64_t count = 0;
+  if (!in.Varint(count)) return fail("truncated edit count");
+  for (std::uint64_t i = 0; i < count; ++i) {
+    ElementEdit edit;
+    std::uint8_t op = 0;
+    std::uint64_t index = 0;
+    if (!in.Byte(op) || op > static_cast<std::uint8_t>(ElementEdit::Op::Erase)) return fail("bad edit op");
+    if (!in.Varint(index)) return fail("truncated edit index");
+    edit.op = static_cast<ElementEdit::Op>(op);
+    edit.index = static_cast<std::size_t>(index);
+    if (edit.op != ElementEdit::Op::Erase) {
+      if (!in.String(edit.element.name) || !in.String(edit.element.material) ||
+          !in.Surface(edit.element.s1) || !in.Surface(edit.element.s2)) {
+        return fail("truncated element");
+      }
+    }
+    out.edits.push_back(std::move(edit));
+  }
+  if (!in.AtEnd()) return fail("trailing bytes");
+  delta = std::move(out);
+  return true;
+}
+
+} // namespace bedrock::som
@@ -12,6 +12,8 @@ struct Surface {
   double thickness{0.0};   // mm to next surface
   double diameter{0.0};    // mm clear aperture
   bool   is_stop{false};
+
+  bool operator==(const Surface&) const = default;
 };
 
 struct TwoSurfaceElement {
@@ -19,11 +21,15 @@ struct TwoSurfaceElement {
   Surface s1{};
   Surface s2{};
   std::string material{"N-BK7"};
+
+  bool operator==(const TwoSurfaceElement&) const = default;
 };
 
 struct SystemModel {
   LengthUnits units{LengthUnits::mm};
   std::vector<TwoSurfaceElement> elements;
+
+  bool operator==(const SystemModel&) const = default;
 };
 
 } // namespace bedrock::som
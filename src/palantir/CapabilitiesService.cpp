@@ -1,24 +1,95 @@
 #include "CapabilitiesService.hpp"
 
-#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+#include <algorithm>
+
+// Set from the CMake project version
+#ifndef BEDROCK_VERSION
+#define BEDROCK_VERSION "unknown"
+#endif
 
 namespace bedrock {
 namespace palantir {
 
-::palantir::CapabilitiesResponse CapabilitiesService::getCapabilities() const {
+namespace {
+
+// Envelope payloads (protobuf, envelope v1); add an encoding only once a handler accepts it
+constexpr const char* SUPPORTED_ENCODINGS = "protobuf";
+
+} // namespace
+
+struct CapabilitiesService::CachedResponse {
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
     ::palantir::CapabilitiesResponse response;
-    auto* caps = response.mutable_capabilities();
-    
-    // Hard-coded capabilities (future: may be dynamic based on available features)
-    // Future: May read from configuration or detect dynamically
-    caps->set_server_version("bedrock-0.3.0");
-    caps->add_supported_features("xy_sine");
-    
-    return response;
+#endif
+};
+
+void CapabilitiesService::addFeature(const std::string& feature)
+{
+    if (!hasFeature(feature)) {
+        features_.push_back(feature);
+        cached_.reset();
+    }
 }
 
-} // namespace palantir
-} // namespace bedrock
+bool CapabilitiesService::hasFeature(const std::string& feature) const
+{
+    return std::find(features_.begin(), features_.end(), feature) != features_.end();
+}
 
+std::string CapabilitiesService::serverVersion()
+{
+    return std::string("bedrock-") + BEDROCK_VERSION;
+}
+
+const char* CapabilitiesService::simdLevel()
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE4_2__)
+    return "sse4.2";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+const ::palantir::CapabilitiesResponse& CapabilitiesService::getCapabilities() const {
+    if (!cached_) {
+        cached_ = std::make_shared<CachedResponse>();
+        auto* caps = cached_->response.mutable_capabilities();
+        caps->set_server_version(serverVersion());
+        for (const std::string& feature : features_) {
+            caps->add_supported_features(feature);
+        }
+    }
+    return cached_->response;
+}
 #endif // BEDROCK_WITH_TRANSPORT_DEPS
 
+std::map<std::string, std::string> CapabilitiesService::loadMetadata(const ServerLoad& load) const
+{
+    std::map<std::string, std::string> metadata = {
+        {META_QUEUE_DEPTH, std::to_string(load.queueDepth)},
+        {META_ACTIVE_JOBS, std::to_string(load.activeJobs)},
+        {META_WORKER_COUNT, std::to_string(load.workers)},
+        {META_SIMD_LEVEL, simdLevel()},
+        {META_ENCODINGS, SUPPORTED_ENCODINGS},
+    };
+    for (const SubsystemMemory& memory : load.memory) {
+        const std::string prefix = META_MEMORY_PREFIX + memory.subsystem;
+        metadata[prefix + "_bytes"] = std::to_string(memory.currentBytes);
+        metadata[prefix + "_peak_bytes"] = std::to_string(memory.peakBytes);
+    }
+    return metadata;
+}
+
+} // namespace palantir
+} // namespace bedrock
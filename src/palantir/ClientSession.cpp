@@ -0,0 +1,88 @@
+#include "ClientSession.hpp"
+
+#include "bedrock/memory_tracking.hpp"
+
+#include <utility>
+
+namespace bedrock::palantir {
+
+ClientSession::ClientSession(QLocalSocket* socket, uint32_t connectionId)
+    : socket_(socket)
+    , connectionId_(connectionId)
+{
+}
+
+ClientSession::~ClientSession()
+{
+    bedrock::MemoryTracker::record_deallocation(bedrock::MemorySubsystem::Transport,
+                                                static_cast<size_t>(accountedReadBytes_));
+}
+
+void ClientSession::accountReadBuffer()
+{
+    const int64_t bytes = readBuffer_.capacity();
+    if (bytes > accountedReadBytes_) {
+        bedrock::MemoryTracker::record_allocation(bedrock::MemorySubsystem::Transport,
+                                                  static_cast<size_t>(bytes - accountedReadBytes_));
+    } else if (bytes < accountedReadBytes_) {
+        bedrock::MemoryTracker::record_deallocation(bedrock::MemorySubsystem::Transport,
+                                                    static_cast<size_t>(accountedReadBytes_ - bytes));
+    }
+    accountedReadBytes_ = bytes;
+}
+
+std::shared_ptr<PendingReply> ClientSession::reserveReply()
+{
+    auto slot = std::make_shared<PendingReply>();
+    replies_.push_back(slot);
+    return slot;
+}
+
+void ClientSession::queueReply(std::string frame)
+{
+    auto slot = std::make_shared<PendingReply>();
+    slot->frame = std::move(frame);
+    slot->ready = true;
+    replies_.push_back(std::move(slot));
+}
+
+void ClientSession::beginRequest(const RequestControl& control)
+{
+    inFlight_.insert(control.cancelled);
+    if (control.supersedeKey.empty()) {
+        return;
+    }
+    auto& token = newestByKey_[control.supersedeKey];
+    if (token) {
+        token->store(true);  // Older request with the same key is still running
+    }
+    token = control.cancelled;
+}
+
+void ClientSession::endRequest(const RequestControl& control)
+{
+    inFlight_.erase(control.cancelled);
+    if (control.supersedeKey.empty()) {
+        return;
+    }
+    auto it = newestByKey_.find(control.supersedeKey);
+    if (it != newestByKey_.end() && it->second == control.cancelled) {
+        newestByKey_.erase(it);
+    }
+}
+
+std::set<QString> ClientSession::close()
+{
+    open_ = false;
+    for (const auto& token : inFlight_) {
+        token->store(true);  // Nobody is left to read the result
+    }
+    inFlight_.clear();
+    newestByKey_.clear();
+    replies_.clear();
+    readBuffer_.clear();
+    accountReadBuffer();
+    return std::exchange(jobs_, {});
+}
+
+} // namespace bedrock::palantir
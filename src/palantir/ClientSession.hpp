@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include "RequestControl.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+class QLocalSocket;
+
+namespace bedrock::palantir {
+
+// PendingReply: one reply slot in a connection's ordered write queue
+// Reserved when work is handed to the compute pool; filled when its frame comes back
+struct PendingReply {
+    bool ready = false;
+    std::string frame;
+};
+
+// ClientSession: all server-side state of one connection
+// Created on accept and bound to the socket's signal connections, so handlers get
+// their session without a map lookup or lock. Event loop thread only; workers hold
+// a weak_ptr to route their completion back and never dereference it themselves.
+class ClientSession : public std::enable_shared_from_this<ClientSession> {
+public:
+    struct Stats {
+        uint64_t bytesReceived = 0;
+        uint64_t bytesSent = 0;
+        uint64_t requests = 0;        // Envelopes extracted
+        uint64_t replies = 0;         // Frames written (including errors)
+        uint64_t dropped = 0;         // Superseded or past their deadline
+        uint64_t protocolErrors = 0;  // Malformed or oversize frames
+    };
+
+    ClientSession(QLocalSocket* socket, uint32_t connectionId);
+    ~ClientSession();
+
+    ClientSession(const ClientSession&) = delete;
+    ClientSession& operator=(const ClientSession&) = delete;
+
+    QLocalSocket* socket() const { return socket_; }
+    uint32_t connectionId() const { return connectionId_; }
+
+    // False once the client disconnected or the server stopped
+    bool isOpen() const { return open_; }
+
+    // Unparsed bytes received from the client
+    QByteArray& readBuffer() { return readBuffer_; }
+    // Charges the read buffer's capacity to MemorySubsystem::Transport; call after it grows or
+    // is consumed (Qt allocates it with malloc, which the allocation hook does not see)
+    void accountReadBuffer();
+
+    // Ordered write queue: non-empty only while pool work for this connection is outstanding
+    bool hasPendingReplies() const { return !replies_.empty(); }
+    std::shared_ptr<PendingReply> reserveReply();
+    void queueReply(std::string frame);
+    // Removes the ready prefix of the queue, concatenated; onFrame sees each frame first
+    template<typename OnFrame>
+    std::string takeReadyReplies(OnFrame&& onFrame);
+
+    // In-flight tracking: every dispatched request is registered until its reply is queued,
+    // so close() can cancel it. A request carrying a supersede key also cancels the
+    // in-flight request with the same key on this connection.
+    void beginRequest(const RequestControl& control);
+    void endRequest(const RequestControl& control);
+    size_t inFlightCount() const { return inFlight_.size(); }
+
+    // Long-running jobs owned by this connection (job ids)
+    std::set<QString>& jobs() { return jobs_; }
+
+    Stats& stats() { return stats_; }
+    const Stats& stats() const { return stats_; }
+
+    // Cancel everything in flight and drop queued replies; returns the job ids to cancel
+    std::set<QString> close();
+
+private:
+    QLocalSocket* socket_;
+    uint32_t connectionId_;
+    bool open_ = true;
+    QByteArray readBuffer_;
+    int64_t accountedReadBytes_ = 0;
+    std::deque<std::shared_ptr<PendingReply>> replies_;
+    std::set<CancelToken> inFlight_;                   // Every request not yet completed
+    std::map<std::string, CancelToken> newestByKey_;  // Supersede key -> token of the newest request
+    std::set<QString> jobs_;
+    Stats stats_;
+};
+
+template<typename OnFrame>
+std::string ClientSession::takeReadyReplies(OnFrame&& onFrame)
+{
+    std::string batch;
+    while (!replies_.empty() && replies_.front()->ready) {
+        std::string& frame = replies_.front()->frame;
+        onFrame(frame);
+        if (batch.empty()) {
+            batch = std::move(frame);
+        } else {
+            batch += frame;
+        }
+        replies_.pop_front();
+    }
+    return batch;
+}
+
+} // namespace bedrock::palantir
@@ -0,0 +1,66 @@
+#include "CompletionQueue.hpp"
+
+#include <QMetaObject>
+#include <QSocketNotifier>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace bedrock::palantir {
+
+CompletionNotifier::CompletionNotifier(QObject* context, std::function<void()> onWake)
+    : context_(context)
+    , onWake_(std::move(onWake))
+{
+#ifdef __linux__
+    eventFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd_ >= 0) {
+        auto* notifier = new QSocketNotifier(eventFd_, QSocketNotifier::Read, context_);
+        QObject::connect(notifier, &QSocketNotifier::activated, context_, [this]() {
+            uint64_t count = 0;
+            [[maybe_unused]] auto n = ::read(eventFd_, &count, sizeof(count));
+            wake();
+        });
+        notifier_ = notifier;
+    }
+#endif
+}
+
+CompletionNotifier::~CompletionNotifier()
+{
+    delete notifier_;
+#ifdef __linux__
+    if (eventFd_ >= 0) {
+        ::close(eventFd_);
+    }
+#endif
+}
+
+void CompletionNotifier::notify()
+{
+    // Producers publish their item before this exchange; the consumer clears the
+    // flag before draining, so an item is either seen by the current drain or
+    // its producer observes the cleared flag and signals again.
+    if (pending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+#ifdef __linux__
+    if (eventFd_ >= 0) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(eventFd_, &one, sizeof(one));
+        return;
+    }
+#endif
+    QMetaObject::invokeMethod(context_, [this]() { wake(); }, Qt::QueuedConnection);
+}
+
+void CompletionNotifier::wake()
+{
+    // RMW (not a plain store) so it synchronizes with the producers' exchange in notify()
+    pending_.exchange(false, std::memory_order_acq_rel);
+    onWake_();
+}
+
+} // namespace bedrock::palantir
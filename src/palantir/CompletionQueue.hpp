@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QObject>
+
+#include "bedrock/coroutine.hpp"
+#include "bedrock/mpsc_queue.hpp"
+
+#include <atomic>
+#include <functional>
+#include <utility>
+
+namespace bedrock::palantir {
+
+// CompletionNotifier: wakes the event loop of the thread that owns `context`
+// from any thread. Wake-ups are coalesced: only the first notify() after the
+// owner last woke does a syscall (Linux: eventfd watched by QSocketNotifier;
+// elsewhere: one queued invoke per batch instead of one per event).
+class CompletionNotifier {
+public:
+    CompletionNotifier(QObject* context, std::function<void()> onWake);
+    ~CompletionNotifier();
+
+    CompletionNotifier(const CompletionNotifier&) = delete;
+    CompletionNotifier& operator=(const CompletionNotifier&) = delete;
+
+    // Any thread
+    void notify();
+
+    // True when backed by an eventfd (for diagnostics)
+    bool usesEventFd() const { return eventFd_ >= 0; }
+
+private:
+    void wake();
+
+    QObject* context_;
+    std::function<void()> onWake_;
+    std::atomic<bool> pending_{false};
+    int eventFd_ = -1;
+    QObject* notifier_ = nullptr;  // QSocketNotifier, parented to context_
+};
+
+// CompletionQueue: lock-free MPSC handoff from worker threads to the I/O thread
+// Workers push(); the I/O thread's drain callback runs on its event loop and
+// pops everything available in one batch.
+template<typename T>
+class CompletionQueue {
+public:
+    CompletionQueue(QObject* context, std::function<void(CompletionQueue&)> onReady)
+        : onReady_(std::move(onReady))
+        , notifier_(context, [this]() { onReady_(*this); }) {}
+
+    // Any thread
+    void push(T value) {
+        queue_.push(std::move(value));
+        notifier_.notify();
+    }
+
+    // I/O thread only
+    std::optional<T> tryPop() { return queue_.try_pop(); }
+
+    bool usesEventFd() const { return notifier_.usesEventFd(); }
+
+private:
+    bedrock::MpscQueue<T> queue_;
+    std::function<void(CompletionQueue&)> onReady_;
+    CompletionNotifier notifier_;
+};
+
+// EventLoopExecutor: bedrock::Executor that runs work on the event loop of the
+// thread owning `context`. Coroutine pipelines continue there with
+// co_await bedrock::resume_on(executor) to touch sessions and sockets.
+// Owned by the context's object: work still queued when it is destroyed is dropped.
+class EventLoopExecutor : public bedrock::Executor {
+public:
+    explicit EventLoopExecutor(QObject* context)
+        : queue_([this]() { notifier_.notify(); })
+        , notifier_(context, [this]() { queue_.run_pending(); }) {}
+
+    // Any thread
+    void post(std::function<void()> work) override { queue_.post(std::move(work)); }
+
+    bool usesEventFd() const { return notifier_.usesEventFd(); }
+
+private:
+    bedrock::QueueExecutor queue_;
+    CompletionNotifier notifier_;
+};
+
+} // namespace bedrock::palantir
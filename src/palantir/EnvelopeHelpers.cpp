@@ -2,6 +2,7 @@
 
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
 
+#include <cstring>
 #include <optional>
 #include <sstream>
 
@@ -41,7 +42,16 @@ bool parseEnvelope(
     ::palantir::MessageEnvelope& outEnvelope,
     std::string* outError)
 {
-    if (buffer.empty()) {
+    return parseEnvelope(buffer.data(), buffer.size(), outEnvelope, outError);
+}
+
+bool parseEnvelope(
+    const char* data,
+    size_t size,
+    ::palantir::MessageEnvelope& outEnvelope,
+    std::string* outError)
+{
+    if (size == 0) {
         if (outError) {
             *outError = "Empty buffer";
         }
@@ -49,7 +59,8 @@ bool parseEnvelope(
     }
     
     // Parse envelope from buffer
-    if (!outEnvelope.ParseFromString(buffer)) {
+    if (size > static_cast<size_t>(INT32_MAX) ||
+        !outEnvelope.ParseFromArray(data, static_cast<int>(size))) {
         if (outError) {
             *outError = "Failed to parse MessageEnvelope";
         }
@@ -93,6 +104,75 @@ bool parseEnvelope(
     return true;
 }
 
+bool appendFrame(
+    const ::palantir::MessageEnvelope& envelope,
+    std::string& out,
+    uint32_t maxEnvelopeSize,
+    std::string* outError,
+    size_t* outEnvelopeSize)
+{
+    size_t envelopeSize = envelope.ByteSizeLong();
+    if (outEnvelopeSize) {
+        *outEnvelopeSize = envelopeSize;
+    }
+    if (envelopeSize > maxEnvelopeSize) {
+        if (outError) {
+            std::ostringstream oss;
+            oss << "Envelope size " << envelopeSize << " exceeds limit " << maxEnvelopeSize;
+            *outError = oss.str();
+        }
+        return false;
+    }
+    
+    // Serialize straight into the output buffer after the length prefix
+    size_t frameStart = out.size();
+    out.resize(frameStart + FRAME_HEADER_SIZE + envelopeSize);
+    uint32_t length = static_cast<uint32_t>(envelopeSize);
+    std::memcpy(&out[frameStart], &length, FRAME_HEADER_SIZE);  // little-endian hosts only
+    if (!envelope.SerializeToArray(&out[frameStart + FRAME_HEADER_SIZE], static_cast<int>(envelopeSize))) {
+        out.resize(frameStart);
+        if (outError) {
+            *outError = "Failed to serialize MessageEnvelope";
+        }
+        return false;
+    }
+    
+    return true;
+}
+
+FrameStatus peekFrame(
+    const char* data,
+    size_t size,
+    uint32_t maxEnvelopeSize,
+    size_t& outFrameSize,
+    std::string* outError)
+{
+    // Need at least the length prefix
+    if (size < FRAME_HEADER_SIZE) {
+        return FrameStatus::Incomplete;
+    }
+    
+    uint32_t envelopeLength;
+    std::memcpy(&envelopeLength, data, FRAME_HEADER_SIZE);
+    
+    // Check size limit before waiting for the payload
+    if (envelopeLength > maxEnvelopeSize) {
+        if (outError) {
+            std::ostringstream oss;
+            oss << "Envelope length " << envelopeLength << " exceeds limit " << maxEnvelopeSize;
+            *outError = oss.str();
+        }
+        return FrameStatus::Error;
+    }
+    
+    if (size < FRAME_HEADER_SIZE + envelopeLength) {
+        return FrameStatus::Incomplete;
+    }
+    
+    outFrameSize = FRAME_HEADER_SIZE + envelopeLength;
+    return FrameStatus::Complete;
+}
+
 } // namespace bedrock::palantir
 
 #endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -5,6 +5,8 @@
 #include "palantir/envelope.pb.h"
 #include "palantir/error.pb.h"
 #include <google/protobuf/message.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <optional>
@@ -14,6 +16,16 @@ namespace bedrock::palantir {
 // Constants
 static constexpr uint32_t PROTOCOL_VERSION = 1;
 
+// Wire format: [4-byte little-endian length][serialized MessageEnvelope]
+static constexpr size_t FRAME_HEADER_SIZE = 4;
+
+// Result of looking for a frame at the start of a receive buffer
+enum class FrameStatus {
+    Complete,    // A whole frame is available
+    Incomplete,  // Need more data
+    Error        // Hard error (e.g. length exceeds limit); outError is set
+};
+
 /**
  * Create a MessageEnvelope from an inner message.
  * 
@@ -42,6 +54,51 @@ bool parseEnvelope(
     ::palantir::MessageEnvelope& outEnvelope,
     std::string* outError = nullptr);
 
+/**
+ * Parse a MessageEnvelope from raw bytes without copying them first.
+ * Same validation as the std::string overload.
+ */
+bool parseEnvelope(
+    const char* data,
+    size_t size,
+    ::palantir::MessageEnvelope& outEnvelope,
+    std::string* outError = nullptr);
+
+/**
+ * Serialize an envelope and append it to out as a length-prefixed frame.
+ * 
+ * @param envelope Envelope to frame
+ * @param out Buffer the frame is appended to (left unchanged on failure)
+ * @param maxEnvelopeSize Reject envelopes larger than this
+ * @param outError Optional error string output
+ * @param outEnvelopeSize Optional serialized envelope size (set on success and failure)
+ * @return true on success, false on failure
+ */
+bool appendFrame(
+    const ::palantir::MessageEnvelope& envelope,
+    std::string& out,
+    uint32_t maxEnvelopeSize,
+    std::string* outError = nullptr,
+    size_t* outEnvelopeSize = nullptr);
+
+/**
+ * Check whether [data, data + size) starts with a complete frame.
+ * Does not parse the envelope; on Complete the envelope bytes are
+ * data + FRAME_HEADER_SIZE with length outFrameSize - FRAME_HEADER_SIZE.
+ * 
+ * @param data Start of receive buffer
+ * @param size Bytes available
+ * @param maxEnvelopeSize Declared lengths above this are a hard error (fail fast, prevent DoS)
+ * @param outFrameSize Total frame size including header (set on Complete)
+ * @param outError Optional error string output (set on Error)
+ */
+FrameStatus peekFrame(
+    const char* data,
+    size_t size,
+    uint32_t maxEnvelopeSize,
+    size_t& outFrameSize,
+    std::string* outError = nullptr);
+
 } // namespace bedrock::palantir
 
 #endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,134 @@
+#include "FeatureRegistry.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+namespace bedrock::palantir {
+
+const char* executorName(ExecutorKind kind)
+{
+    switch (kind) {
+        case ExecutorKind::Inline:      return "inline";
+        case ExecutorKind::ComputePool: return "compute_pool";
+        case ExecutorKind::LongJob:     return "long_job";
+    }
+    return "unknown";
+}
+
+FeatureResult FeatureResult::reply(::palantir::MessageType type, std::shared_ptr<const google::protobuf::Message> message,
+                                   std::map<std::string, std::string> metadata)
+{
+    FeatureResult result;
+    result.type = type;
+    result.message = std::move(message);
+    result.metadata = std::move(metadata);
+    return result;
+}
+
+FeatureResult FeatureResult::failure(::palantir::ErrorCode code, std::string error, std::string details)
+{
+    FeatureResult result;
+    result.errorCode = code;
+    result.error = std::move(error);
+    result.details = std::move(details);
+    return result;
+}
+
+FeatureResult FeatureResult::dropped(const char* reason)
+{
+    FeatureResult result;
+    result.droppedReason = reason;
+    return result;
+}
+
+FeaturePlan FeaturePlan::run(FeatureWork work, bool runInline)
+{
+    FeaturePlan plan;
+    plan.work = std::move(work);
+    plan.runInline = runInline;
+    return plan;
+}
+
+FeaturePlan FeaturePlan::reject(FeatureResult rejection)
+{
+    FeaturePlan plan;
+    plan.rejection = std::move(rejection);
+    return plan;
+}
+
+ModelStore::Status resolveRequestModel(const FeatureHandler& handler, const ModelStore& models,
+                                       const RequestControl& control, std::shared_ptr<const ModelSnapshot>& out)
+{
+    out.reset();
+    if (!handler.usesModel || !control.modelRef) {
+        return ModelStore::Status::Ok;
+    }
+    ModelSnapshot snapshot;
+    const auto status = models.resolve(*control.modelRef, snapshot);
+    if (status == ModelStore::Status::Ok) {
+        out = std::make_shared<const ModelSnapshot>(std::move(snapshot));
+    }
+    return status;
+}
+
+void ConcurrencyGate::submit(std::function<void()> start)
+{
+    if (limit_ > 0 && running_ >= limit_) {
+        queued_.push_back(std::move(start));
+        return;
+    }
+    ++running_;
+    start();
+}
+
+void ConcurrencyGate::finished()
+{
+    if (running_ > 0) {
+        --running_;
+    }
+    if (!queued_.empty() && (limit_ <= 0 || running_ < limit_)) {
+        auto next = std::move(queued_.front());
+        queued_.pop_front();
+        ++running_;
+        next();
+    }
+}
+
+size_t ConcurrencyGate::dropQueued()
+{
+    const size_t dropped = queued_.size();
+    queued_.clear();
+    return dropped;
+}
+
+bool FeatureRegistry::add(FeatureHandler handler)
+{
+    const int type = static_cast<int>(handler.requestType);
+    if (byType_.count(type) != 0 || !handler.prepare) {
+        return false;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->gate = ConcurrencyGate(handler.maxConcurrent);
+    entry->handler = std::move(handler);
+    byType_[type] = static_cast<int>(entries_.size());
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+int FeatureRegistry::find(::palantir::MessageType type) const
+{
+    auto it = byType_.find(static_cast<int>(type));
+    return it == byType_.end() ? -1 : it->second;
+}
+
+size_t FeatureRegistry::dropQueued()
+{
+    size_t dropped = 0;
+    for (auto& entry : entries_) {
+        dropped += entry->gate.dropQueued();
+    }
+    return dropped;
+}
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,158 @@
+#pragma once
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include "palantir/envelope.pb.h"
+#include "palantir/error.pb.h"
+#include "JobUsage.hpp"
+#include "ModelStore.hpp"
+#include "RequestControl.hpp"
+
+#include <google/protobuf/message.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bedrock::palantir {
+
+// Where a handler's work runs
+//   Inline:      on the event loop thread (cheap requests; no handoff cost)
+//   ComputePool: on the server's compute pool, reply delivered in request order
+//   LongJob:     on a separate pool so long analyses cannot starve short compute
+enum class ExecutorKind {
+    Inline,
+    ComputePool,
+    LongJob,
+};
+
+const char* executorName(ExecutorKind kind);
+
+// FeatureResult: outcome of a handler's work, turned into a reply frame by the server
+// Exactly one of: a reply message, an error, or a dropped reason.
+struct FeatureResult {
+    ::palantir::MessageType type = ::palantir::MessageType::ERROR_RESPONSE;
+    std::shared_ptr<const google::protobuf::Message> message;
+    std::map<std::string, std::string> metadata;  // Merged into the reply metadata
+
+    ::palantir::ErrorCode errorCode = ::palantir::ErrorCode::ERROR_CODE_UNSPECIFIED;
+    std::string error;
+    std::string details;
+
+    const char* droppedReason = nullptr;  // REASON_SUPERSEDED / REASON_DEADLINE_EXCEEDED
+
+    JobUsage usage;  // Handler reports peakBytes/items; the server fills in the times
+
+    static FeatureResult reply(::palantir::MessageType type, std::shared_ptr<const google::protobuf::Message> message,
+                               std::map<std::string, std::string> metadata = {});
+    static FeatureResult failure(::palantir::ErrorCode code, std::string error, std::string details = {});
+    static FeatureResult dropped(const char* reason);
+};
+
+// Computes the result; runs on the handler's executor (any thread for pool executors)
+using FeatureWork = std::function<FeatureResult(const RequestControl&)>;
+
+// FeaturePlan: what prepare() decided for one request
+// Either work to run, or a rejection answered immediately (parse/validation errors).
+struct FeaturePlan {
+    FeatureWork work;
+    FeatureResult rejection;  // Used when work is empty
+    bool runInline = false;   // Small request: run on the event loop despite the handler's executor
+
+    static FeaturePlan run(FeatureWork work, bool runInline = false);
+    static FeaturePlan reject(FeatureResult rejection);
+};
+
+// FeatureHandler: one request type served by the server
+// prepare() runs on the event loop thread: it parses and validates the payload and
+// returns the work to schedule. Keep it cheap; the work itself goes to the executor.
+struct FeatureHandler {
+    using Prepare = std::function<FeaturePlan(const char* payload, size_t size, const RequestControl& control)>;
+
+    std::string feature;  // Advertised in capabilities; empty for protocol requests
+    ::palantir::MessageType requestType = ::palantir::MessageType::MESSAGE_TYPE_UNSPECIFIED;
+    ExecutorKind executor = ExecutorKind::Inline;
+    int maxConcurrent = 0;  // Executions of this handler at once (0: bounded only by the executor)
+    // The server resolves the request's som_handle before prepare() and sets control.model;
+    // an unknown handle or stale som_version is rejected without reaching the handler
+    bool usesModel = false;
+    Prepare prepare;
+};
+
+// Snapshot a request runs against: null when the handler does not use a model or the
+// request names none. A non-Ok status means the request must be rejected unanswered by
+// the handler. Event loop thread (reads the store).
+ModelStore::Status resolveRequestModel(const FeatureHandler& handler, const ModelStore& models,
+                                       const RequestControl& control, std::shared_ptr<const ModelSnapshot>& out);
+
+// Builds a Prepare that parses the payload as Request first; malformed payloads are
+// rejected with PROTOBUF_PARSE_ERROR before `prepare` sees them
+template<typename Request>
+FeatureHandler::Prepare parseAs(std::function<FeaturePlan(const Request&, const RequestControl&)> prepare)
+{
+    return [prepare = std::move(prepare)](const char* payload, size_t size, const RequestControl& control) {
+        Request request;
+        if (!request.ParseFromArray(payload, static_cast<int>(size))) {
+            const std::string name(Request::descriptor()->name());
+            return FeaturePlan::reject(FeatureResult::failure(::palantir::ErrorCode::PROTOBUF_PARSE_ERROR,
+                                                              "Failed to parse " + name + ": malformed protobuf payload"));
+        }
+        return prepare(request, control);
+    };
+}
+
+// ConcurrencyGate: per-handler limit on executions in flight
+// Starts work immediately while under the limit, otherwise queues it (FIFO) until
+// a running execution finishes. Event loop thread only.
+class ConcurrencyGate {
+public:
+    explicit ConcurrencyGate(int limit = 0) : limit_(limit) {}
+
+    void submit(std::function<void()> start);
+    // One execution finished; starts the next queued one if any
+    void finished();
+    // Drops queued work (server stopping); returns how many were dropped
+    size_t dropQueued();
+
+    int limit() const { return limit_; }
+    int running() const { return running_; }
+    size_t queued() const { return queued_.size(); }
+
+private:
+    int limit_;
+    int running_ = 0;
+    std::deque<std::function<void()>> queued_;
+};
+
+// FeatureRegistry: handlers by request type, each with its concurrency gate
+// Populated before the server starts; read and gated on the event loop thread.
+class FeatureRegistry {
+public:
+    struct Entry {
+        FeatureHandler handler;
+        ConcurrencyGate gate;
+        UsageSummary usage;  // Every execution of this handler's work
+    };
+
+    // Returns false if the request type already has a handler
+    bool add(FeatureHandler handler);
+
+    // Index of the handler for a request type, or -1
+    int find(::palantir::MessageType type) const;
+    Entry& entry(int index) { return *entries_[static_cast<size_t>(index)]; }
+    const Entry& entry(int index) const { return *entries_[static_cast<size_t>(index)]; }
+    size_t size() const { return entries_.size(); }
+
+    // Drops queued work in every gate; returns how many were dropped
+    size_t dropQueued();
+
+private:
+    std::vector<std::unique_ptr<Entry>> entries_;  // Stable addresses; indices carried by completions
+    std::map<int, int> byType_;
+};
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,83 @@
+#include "JobUsage.hpp"
+
+#include "bedrock/thread_budget.hpp"
+#include "bedrock/trace.hpp"
+
+#include <algorithm>
+
+namespace bedrock::palantir {
+
+namespace {
+
+double meanMs(uint64_t totalNs, uint64_t count)
+{
+    return count == 0 ? 0.0 : static_cast<double>(totalNs) / 1e6 / static_cast<double>(count);
+}
+
+} // namespace
+
+void JobUsage::appendMetadata(std::map<std::string, std::string>& metadata) const
+{
+    metadata[META_JOB_WALL_US] = std::to_string(wallNs / 1000);
+    metadata[META_JOB_QUEUE_US] = std::to_string(queueNs / 1000);
+    metadata[META_JOB_CPU_US] = std::to_string(cpuNs / 1000);
+    metadata[META_JOB_PEAK_BYTES] = std::to_string(peakBytes);
+    metadata[META_JOB_ITEMS] = std::to_string(items);
+}
+
+JobMeter::JobMeter(uint64_t submittedNs)
+    : startNs_(Tracer::now_ns())
+    , startCpuNs_(ThreadBudget::thread_cpu_ns())
+    , queueNs_(submittedNs != 0 && startNs_ > submittedNs ? startNs_ - submittedNs : 0)
+    , budget_(ThreadBudget::current())
+    , startHelperCpuNs_(budget_ ? budget_->helper_cpu_ns() : 0)
+{
+}
+
+JobUsage JobMeter::finish(const JobUsage& reported) const
+{
+    JobUsage usage = reported;
+    usage.wallNs = Tracer::now_ns() - startNs_;
+    usage.queueNs = queueNs_;
+    const uint64_t cpuNs = ThreadBudget::thread_cpu_ns();
+    usage.cpuNs = cpuNs > startCpuNs_ ? cpuNs - startCpuNs_ : 0;
+    if (budget_) {
+        // Helpers finished their chunks before the work returned (parallel_for joins)
+        usage.cpuNs += budget_->helper_cpu_ns() - startHelperCpuNs_;
+    }
+    return usage;
+}
+
+void UsageSummary::add(const JobUsage& usage)
+{
+    ++jobs;
+    totalWallNs += usage.wallNs;
+    maxWallNs = std::max(maxWallNs, usage.wallNs);
+    totalQueueNs += usage.queueNs;
+    maxQueueNs = std::max(maxQueueNs, usage.queueNs);
+    totalCpuNs += usage.cpuNs;
+    maxPeakBytes = std::max(maxPeakBytes, usage.peakBytes);
+    totalItems += usage.items;
+}
+
+double UsageSummary::meanWallMs() const
+{
+    return meanMs(totalWallNs, jobs);
+}
+
+double UsageSummary::meanQueueMs() const
+{
+    return meanMs(totalQueueNs, jobs);
+}
+
+double UsageSummary::meanCpuMs() const
+{
+    return meanMs(totalCpuNs, jobs);
+}
+
+double UsageSummary::cpuUtilization() const
+{
+    return totalWallNs == 0 ? 0.0 : static_cast<double>(totalCpuNs) / static_cast<double>(totalWallNs);
+}
+
+} // namespace bedrock::palantir
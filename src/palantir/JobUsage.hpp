@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace bedrock {
+class ThreadBudget;
+}
+
+namespace bedrock::palantir {
+
+// Reply metadata keys with the resources one request consumed (server -> client)
+//   job_wall_us:    time the handler's work ran, microseconds
+//   job_queue_us:   time between dispatch and the work starting (gate + pool queue), microseconds
+//   job_cpu_us:     CPU time of the thread that ran the work plus its parallel helpers, microseconds
+//   job_peak_bytes: peak bytes the handler reported holding at once (0: not reported)
+//   job_items:      items the handler reported processing (samples, rays, ...)
+static constexpr const char* META_JOB_WALL_US = "job_wall_us";
+static constexpr const char* META_JOB_QUEUE_US = "job_queue_us";
+static constexpr const char* META_JOB_CPU_US = "job_cpu_us";
+static constexpr const char* META_JOB_PEAK_BYTES = "job_peak_bytes";
+static constexpr const char* META_JOB_ITEMS = "job_items";
+
+// JobUsage: resources consumed by one execution of a handler's work
+// Handlers fill peakBytes and items (they know what they allocate and process);
+// the server measures the times around the work.
+struct JobUsage {
+    uint64_t wallNs = 0;
+    uint64_t queueNs = 0;
+    uint64_t cpuNs = 0;     // Calling thread plus the helpers that ran its ThreadBudget's tasks
+    uint64_t peakBytes = 0;
+    uint64_t items = 0;
+
+    void appendMetadata(std::map<std::string, std::string>& metadata) const;
+};
+
+// JobMeter: measures one execution on the calling thread
+// Construct right before the work runs, call finish() right after, on the same thread.
+// Construct inside the job's ThreadBudget::Scope so the CPU time of helper threads
+// (parallel_for chunks run elsewhere) is counted too.
+class JobMeter {
+public:
+    // submittedNs: steady clock time (Tracer::now_ns()) the work was dispatched; 0 when run at once
+    explicit JobMeter(uint64_t submittedNs = 0);
+
+    // Times since construction, combined with what the handler reported
+    JobUsage finish(const JobUsage& reported) const;
+
+private:
+    uint64_t startNs_;
+    uint64_t startCpuNs_;
+    uint64_t queueNs_;
+    bedrock::ThreadBudget* budget_;  // Installed on the calling thread at construction, or null
+    uint64_t startHelperCpuNs_;
+};
+
+// UsageSummary: running totals over every execution of one handler
+// Event loop thread only; logged when the server stops for capacity planning.
+struct UsageSummary {
+    uint64_t jobs = 0;
+    uint64_t totalWallNs = 0;
+    uint64_t maxWallNs = 0;
+    uint64_t totalQueueNs = 0;
+    uint64_t maxQueueNs = 0;
+    uint64_t totalCpuNs = 0;
+    uint64_t maxPeakBytes = 0;
+    uint64_t totalItems = 0;
+
+    void add(const JobUsage& usage);
+
+    double meanWallMs() const;
+    double meanQueueMs() const;
+    double meanCpuMs() const;
+    // CPU time over wall time: ~1 for CPU-bound single-threaded work, lower when it waits
+    double cpuUtilization() const;
+};
+
+} // namespace bedrock::palantir
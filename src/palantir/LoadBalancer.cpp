@@ -0,0 +1,114 @@
+#include "LoadBalancer.hpp"
+
+#include <algorithm>
+
+namespace bedrock::palantir {
+
+LoadBalancer::LoadBalancer(size_t endpointCount)
+    : LoadBalancer(endpointCount, Options{})
+{
+}
+
+LoadBalancer::LoadBalancer(size_t endpointCount, Options options)
+    : options_(options)
+    , endpoints_(endpointCount)
+{
+}
+
+double LoadBalancer::score(const Endpoint& endpoint, Clock::time_point now) const
+{
+    // A fresh report already counts our own requests queued on that server, so
+    // only add what was sent since (and is still in flight); a stale one is
+    // dropped in favour of in-flight
+    int load = endpoint.inFlight;
+    if (endpoint.reportedLoad >= 0 && now - endpoint.reportedAt <= options_.loadStaleAfter) {
+        load = endpoint.reportedLoad + std::min(endpoint.sentSinceReport, endpoint.inFlight);
+    }
+    return static_cast<double>(load) / std::max(endpoint.workers, 1);
+}
+
+int LoadBalancer::pick(Clock::time_point now)
+{
+    const size_t count = endpoints_.size();
+    int best = -1;
+    double bestScore = 0.0;
+    // Scan starting after the last pick so equal scores rotate across endpoints
+    for (size_t n = 0; n < count; ++n) {
+        const size_t i = (nextTieBreak_ + n) % count;
+        const Endpoint& endpoint = endpoints_[i];
+        if (!endpoint.connected || now < endpoint.retryAt) {
+            continue;
+        }
+        const double s = score(endpoint, now);
+        if (best < 0 || s < bestScore) {
+            best = static_cast<int>(i);
+            bestScore = s;
+        }
+    }
+    if (best >= 0) {
+        nextTieBreak_ = static_cast<size_t>(best) + 1;
+    }
+    return best;
+}
+
+void LoadBalancer::onConnected(int endpoint)
+{
+    Endpoint& e = endpoints_[endpoint];
+    e.connected = true;
+    e.backoff = std::chrono::milliseconds{0};
+    e.retryAt = Clock::time_point{};
+}
+
+void LoadBalancer::onDisconnected(int endpoint)
+{
+    Endpoint& e = endpoints_[endpoint];
+    e.connected = false;
+    e.inFlight = 0;
+    e.sentSinceReport = 0;
+    e.reportedLoad = -1;
+}
+
+void LoadBalancer::onSent(int endpoint)
+{
+    Endpoint& e = endpoints_[endpoint];
+    ++e.inFlight;
+    ++e.sentSinceReport;
+    ++e.stats.sent;
+}
+
+void LoadBalancer::onReply(int endpoint, int load, int workers, Clock::time_point now)
+{
+    Endpoint& e = endpoints_[endpoint];
+    e.inFlight = std::max(e.inFlight - 1, 0);
+    ++e.stats.replies;
+    if (load >= 0) {
+        // The report includes everything we had sent when it was taken; later sends count on top
+        e.reportedLoad = load;
+        e.sentSinceReport = 0;
+        e.workers = std::max(workers, 1);
+        e.reportedAt = now;
+    }
+}
+
+void LoadBalancer::onFailure(int endpoint, Clock::time_point now)
+{
+    Endpoint& e = endpoints_[endpoint];
+    e.connected = false;
+    e.inFlight = 0;
+    e.sentSinceReport = 0;
+    e.reportedLoad = -1;
+    ++e.stats.failures;
+    e.backoff = e.backoff.count() == 0 ? options_.initialBackoff : std::min(e.backoff * 2, options_.maxBackoff);
+    e.retryAt = now + e.backoff;
+}
+
+std::chrono::milliseconds LoadBalancer::retryDelay(int endpoint, Clock::time_point now) const
+{
+    const Endpoint& e = endpoints_[endpoint];
+    if (now >= e.retryAt) {
+        return std::chrono::milliseconds{0};
+    }
+    return std::chrono::ceil<std::chrono::milliseconds>(e.retryAt - now);
+}
+
+} // namespace bedrock::palantir
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace bedrock::palantir {
+
+// LoadBalancer: picks which of several bedrock_server endpoints gets the next request
+// An endpoint's score is its last reported load (if still fresh) plus the requests
+// this client sent it since that report, else the requests in flight on it,
+// divided by its worker count; the lowest score
+// wins and ties rotate. Failed endpoints sit out an exponentially growing backoff.
+// Not thread-safe: owned by the client pool's thread.
+class LoadBalancer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::chrono::milliseconds initialBackoff{100};
+        std::chrono::milliseconds maxBackoff{5000};
+        std::chrono::milliseconds loadStaleAfter{2000};  // Older reports are ignored
+    };
+
+    struct EndpointStats {
+        uint64_t sent = 0;
+        uint64_t replies = 0;
+        uint64_t failures = 0;
+    };
+
+    explicit LoadBalancer(size_t endpointCount);
+    LoadBalancer(size_t endpointCount, Options options);
+
+    size_t size() const { return endpoints_.size(); }
+
+    // Least-loaded endpoint that is connected and out of backoff, or -1 if none is
+    int pick(Clock::time_point now = Clock::now());
+
+    // Connection state; an endpoint starts disconnected
+    void onConnected(int endpoint);
+    // Closed on purpose (no backoff); requests in flight there are no longer counted
+    void onDisconnected(int endpoint);
+    bool isConnected(int endpoint) const { return endpoints_[endpoint].connected; }
+
+    void onSent(int endpoint);
+    // A reply arrived; load/workers come from reply metadata (load < 0: not reported)
+    void onReply(int endpoint, int load, int workers, Clock::time_point now = Clock::now());
+    // Connection lost or refused: the endpoint backs off and its in-flight count resets
+    void onFailure(int endpoint, Clock::time_point now = Clock::now());
+
+    // Time until a failed endpoint may be retried (zero when it is usable)
+    std::chrono::milliseconds retryDelay(int endpoint, Clock::time_point now = Clock::now()) const;
+
+    int inFlight(int endpoint) const { return endpoints_[endpoint].inFlight; }
+    const EndpointStats& stats(int endpoint) const { return endpoints_[endpoint].stats; }
+
+private:
+    struct Endpoint {
+        bool connected = false;
+        int inFlight = 0;
+        int sentSinceReport = 0;  // Not yet included in reportedLoad
+        int reportedLoad = -1;
+        int workers = 1;
+        Clock::time_point reportedAt{};
+        Clock::time_point retryAt{};
+        std::chrono::milliseconds backoff{0};
+        EndpointStats stats;
+    };
+
+    double score(const Endpoint& endpoint, Clock::time_point now) const;
+
+    Options options_;
+    std::vector<Endpoint> endpoints_;
+    size_t nextTieBreak_ = 0;
+};
+
+} // namespace bedrock::palantir
@@ -0,0 +1,341 @@
+#include "ModelStore.hpp"
+
+#include "bedrock/memory_tracking.hpp"
+
+namespace bedrock::palantir {
+
+namespace {
+
+double millimetresPerUnit(bedrock::som::LengthUnits units)
+{
+    switch (units) {
+        case bedrock::som::LengthUnits::mm:   return 1.0;
+        case bedrock::som::LengthUnits::cm:   return 10.0;
+        case bedrock::som::LengthUnits::inch: return 25.4;
+        case bedrock::som::LengthUnits::m:    return 1000.0;
+    }
+    return 1.0;
+}
+
+ModelSnapshot makeSnapshot(uint64_t handle, uint64_t version, bedrock::som::SystemModel model)
+{
+    // The model was allocated by its parser; what the store builds around it is resident cache
+    bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Cache);
+    ModelSnapshot snapshot;
+    snapshot.handle = handle;
+    snapshot.version = version;
+    snapshot.prepared = std::make_shared<const PreparedSystem>(PreparedSystem::fromModel(model));
+    snapshot.model = std::make_shared<const bedrock::som::SystemModel>(std::move(model));
+    return snapshot;
+}
+
+} // namespace
+
+PreparedSystem PreparedSystem::fromModel(const bedrock::som::SystemModel& model)
+{
+    PreparedSystem prepared;
+    prepared.unitScale = millimetresPerUnit(model.units);
+    prepared.surfaces.reserve(model.elements.size() * 2);
+
+    double z = 0.0;
+    auto addSurface = [&](const bedrock::som::Surface& surface, size_t element) {
+        PreparedSurface out;
+        const double radius = surface.radius * prepared.unitScale;
+        out.curvature = radius != 0.0 ? 1.0 / radius : 0.0;
+        out.vertexZ = z;
+        out.semiDiameter = 0.5 * surface.diameter * prepared.unitScale;
+        out.isStop = surface.is_stop;
+        out.element = element;
+        if (surface.is_stop && prepared.stopSurface < 0) {
+            prepared.stopSurface = static_cast<int>(prepared.surfaces.size());
+        }
+        prepared.surfaces.push_back(out);
+        z += surface.thickness * prepared.unitScale;
+    };
+    for (size_t i = 0; i < model.elements.size(); ++i) {
+        addSurface(model.elements[i].s1, i);
+        addSurface(model.elements[i].s2, i);
+    }
+    prepared.totalTrack = prepared.surfaces.empty() ? 0.0 : prepared.surfaces.back().vertexZ;
+    return prepared;
+}
+
+ModelSnapshot ModelStore::upload(uint32_t owner, bedrock::som::SystemModel model)
+{
+    // Prepare outside the lock; only the handle assignment is serialized
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t handle = nextHandle_++;
+    lock.unlock();
+
+    ModelSnapshot snapshot = makeSnapshot(handle, 1, std::move(model));
+
+    lock.lock();
+    Entry& entry = models_[handle];
+    entry.owner = owner;
+    entry.current = snapshot;
+    byOwner_[owner].insert(handle);
+    return snapshot;
+}
+
+ModelStore::Status ModelStore::applyDelta(uint32_t owner, uint64_t handle, const bedrock::som::SomDelta& delta,
+                                          ModelSnapshot* out, std::string* error)
+{
+    ModelSnapshot current;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = models_.find(handle);
+        if (it == models_.end() || it->second.owner != owner) {
+            return Status::UnknownHandle;
+        }
+        current = it->second.current;
+    }
+    if (delta.base_version != current.version) {
+        if (error) {
+            *error = "delta base version " + std::to_string(delta.base_version) +
+                     " does not match current version " + std::to_string(current.version);
+        }
+        return Status::VersionMismatch;
+    }
+
+    // Edit a copy; readers of the current snapshot are unaffected
+    ModelSnapshot next;
+    {
+        bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Cache);  // The copy becomes the resident version
+        bedrock::som::SystemModel edited = *current.model;
+        if (!bedrock::som::ApplyDelta(edited, delta, error)) {
+            return Status::InvalidDelta;
+        }
+        next = makeSnapshot(handle, current.version + 1, std::move(edited));
+    }
+
+    std::vector<std::pair<ModelChangeListener, ModelChange>> notifications;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = models_.find(handle);
+        if (it == models_.end() || it->second.owner != owner) {
+            return Status::UnknownHandle;  // Released while the delta was applied
+        }
+        Entry& entry = it->second;
+        if (entry.current.version != current.version) {
+            if (error) {
+                *error = "model changed while the delta was applied";
+            }
+            return Status::VersionMismatch;
+        }
+        entry.history.push_back(std::move(entry.current));
+        if (entry.history.size() > HISTORY_DEPTH) {
+            entry.history.pop_front();
+        }
+        entry.current = next;
+        
+        notifications.reserve(entry.subscriptions.size());
+        for (auto& [id, subscription] : entry.subscriptions) {
+            notifications.emplace_back(subscription.listener, changeFrom(entry, subscription.lastSeen));
+            subscription.lastSeen = next.version;
+        }
+    }
+    
+    for (const auto& [listener, change] : notifications) {
+        listener(change);
+    }
+    if (out) {
+        *out = std::move(next);
+    }
+    return Status::Ok;
+}
+
+ModelChange ModelStore::changeFrom(const Entry& entry, uint64_t fromVersion)
+{
+    ModelChange change;
+    change.handle = entry.current.handle;
+    change.version = entry.current.version;
+    if (fromVersion == entry.current.version) {
+        change.delta.base_version = fromVersion;
+        return change;
+    }
+    for (const ModelSnapshot& old : entry.history) {
+        if (old.version == fromVersion) {
+            change.delta = bedrock::som::Diff(*old.model, *entry.current.model, fromVersion);
+            return change;
+        }
+    }
+    change.delta = bedrock::som::Diff(bedrock::som::SystemModel{}, *entry.current.model, 0);
+    change.full = true;
+    return change;
+}
+
+ModelStore::Status ModelStore::changesSince(uint64_t handle, uint64_t fromVersion, ModelChange& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(handle);
+    if (it == models_.end()) {
+        return Status::UnknownHandle;
+    }
+    if (fromVersion > it->second.current.version) {
+        return Status::VersionMismatch;
+    }
+    out = changeFrom(it->second, fromVersion);
+    return Status::Ok;
+}
+
+ModelStore::Status ModelStore::subscribe(uint32_t subscriber, uint64_t handle, uint64_t knownVersion,
+                                         ModelChangeListener listener, SubscriptionId* id, ModelChange* catchUp)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(handle);
+    if (it == models_.end()) {
+        return Status::UnknownHandle;
+    }
+    Entry& entry = it->second;
+    if (knownVersion > entry.current.version) {
+        return Status::VersionMismatch;
+    }
+    if (catchUp) {
+        *catchUp = changeFrom(entry, knownVersion);
+    }
+    const SubscriptionId subscription = nextSubscription_++;
+    entry.subscriptions[subscription] = Subscription{std::move(listener), entry.current.version, subscriber};
+    subscriptionHandles_[subscription] = handle;
+    if (id) {
+        *id = subscription;
+    }
+    return Status::Ok;
+}
+
+bool ModelStore::unsubscribe(SubscriptionId id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptionHandles_.find(id);
+    if (it == subscriptionHandles_.end()) {
+        return false;
+    }
+    auto modelIt = models_.find(it->second);
+    if (modelIt != models_.end()) {
+        modelIt->second.subscriptions.erase(id);
+    }
+    subscriptionHandles_.erase(it);
+    return true;
+}
+
+size_t ModelStore::subscriptionCount(uint64_t handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(handle);
+    return it == models_.end() ? 0 : it->second.subscriptions.size();
+}
+
+void ModelStore::eraseLocked(std::map<uint64_t, Entry>::iterator it)
+{
+    for (const auto& [id, subscription] : it->second.subscriptions) {
+        subscriptionHandles_.erase(id);
+    }
+    models_.erase(it);
+}
+
+ModelStore::Status ModelStore::resolve(const ModelRef& ref, ModelSnapshot& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(ref.handle);
+    if (it == models_.end()) {
+        return Status::UnknownHandle;
+    }
+    if (ref.version && *ref.version != it->second.current.version) {
+        return Status::VersionMismatch;
+    }
+    out = it->second.current;
+    return Status::Ok;
+}
+
+bool ModelStore::release(uint32_t owner, uint64_t handle)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(handle);
+    if (it == models_.end() || it->second.owner != owner) {
+        return false;
+    }
+    eraseLocked(it);
+    auto ownerIt = byOwner_.find(owner);
+    ownerIt->second.erase(handle);
+    if (ownerIt->second.empty()) {
+        byOwner_.erase(ownerIt);
+    }
+    return true;
+}
+
+size_t ModelStore::releaseOwner(uint32_t owner)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The connection's views of models it does not own
+    for (auto it = subscriptionHandles_.begin(); it != subscriptionHandles_.end();) {
+        auto modelIt = models_.find(it->second);
+        if (modelIt != models_.end() && modelIt->second.subscriptions.at(it->first).subscriber == owner) {
+            modelIt->second.subscriptions.erase(it->first);
+            it = subscriptionHandles_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    auto ownerIt = byOwner_.find(owner);
+    if (ownerIt == byOwner_.end()) {
+        return 0;
+    }
+    for (uint64_t handle : ownerIt->second) {
+        if (auto it = models_.find(handle); it != models_.end()) {
+            eraseLocked(it);
+        }
+    }
+    const size_t released = ownerIt->second.size();
+    byOwner_.erase(ownerIt);
+    return released;
+}
+
+size_t ModelStore::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return models_.size();
+}
+
+const char* ModelStore::statusName(Status status)
+{
+    switch (status) {
+        case Status::Ok:              return "OK";
+        case Status::UnknownHandle:   return "UNKNOWN_HANDLE";
+        case Status::VersionMismatch: return "VERSION_MISMATCH";
+        case Status::InvalidDelta:    return "INVALID_DELTA";
+    }
+    return "UNKNOWN";
+}
+
+EngineModelBridge::EngineModelBridge(ModelStore& store)
+    : store_(store)
+{
+}
+
+bedrock::SomChangedFn EngineModelBridge::callback()
+{
+    return [this](int) {
+        if (engine_) {
+            publish(engine_->Som());
+        }
+    };
+}
+
+ModelStore::Status EngineModelBridge::publish(const bedrock::som::SystemModel& model, ModelSnapshot* out)
+{
+    if (handle_ != 0) {
+        ModelSnapshot current;
+        if (store_.resolve(ModelRef{handle_, std::nullopt}, current) == ModelStore::Status::Ok) {
+            return store_.applyDelta(ENGINE_OWNER, handle_, bedrock::som::Diff(*current.model, model, current.version),
+                                     out);
+        }
+    }
+    ModelSnapshot snapshot = store_.upload(ENGINE_OWNER, model);
+    handle_ = snapshot.handle;
+    if (out) {
+        *out = std::move(snapshot);
+    }
+    return ModelStore::Status::Ok;
+}
+
+} // namespace bedrock::palantir
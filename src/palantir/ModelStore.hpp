@@ -0,0 +1,167 @@
+#pragma once
+
+#include "bedrock/engine.hpp"
+#include "bedrock/som/delta.hpp"
+#include "bedrock/som/types.hpp"
+#include "RequestControl.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace bedrock::palantir {
+
+// PreparedSurface/PreparedSystem: flattened form of a SystemModel built once per
+// version, so analyses do not re-walk elements or recompute curvatures per request
+struct PreparedSurface {
+    double curvature = 0.0;     // 1/radius, 0 for flat (radius 0)
+    double vertexZ = 0.0;       // Vertex position along the axis, mm
+    double semiDiameter = 0.0;  // mm
+    bool isStop = false;
+    size_t element = 0;         // Index of the owning element
+};
+
+struct PreparedSystem {
+    std::vector<PreparedSurface> surfaces;
+    double unitScale = 1.0;     // Model units -> mm
+    double totalTrack = 0.0;    // First vertex to last vertex, mm
+    int stopSurface = -1;       // Index into surfaces, -1 if no stop is marked
+
+    static PreparedSystem fromModel(const bedrock::som::SystemModel& model);
+};
+
+// ModelSnapshot: one immutable version of a resident model
+// Edits publish a new snapshot; compute running against an older one keeps it alive.
+struct ModelSnapshot {
+    uint64_t handle = 0;
+    uint64_t version = 0;
+    std::shared_ptr<const bedrock::som::SystemModel> model;
+    std::shared_ptr<const PreparedSystem> prepared;
+};
+
+// ModelChange: notification that a model moved to a new version
+// `delta` takes the subscriber from the version it last saw to `version`; when that
+// version has aged out of the store's history, `full` is set and the delta is
+// against an empty model (base_version 0).
+struct ModelChange {
+    uint64_t handle = 0;
+    uint64_t version = 0;
+    bedrock::som::SomDelta delta;
+    bool full = false;
+};
+
+using ModelChangeListener = std::function<void(const ModelChange&)>;
+using SubscriptionId = uint64_t;
+
+// ModelStore: server-resident models, owned by the connection that uploaded them
+// Clients upload a SystemModel once, then reference it by handle and send edits as
+// SomDelta against the version they hold. Only the owner edits or releases a model;
+// any connection may read it by handle (several views of one model). Thread-safe:
+// handlers resolve on the event loop thread and compute pool workers keep the
+// snapshot they were given.
+//
+// Subscribers receive each new version as a delta against the version they last
+// saw, composed from the recent history (a value edited several times between
+// notifications is sent once). Listeners run on the thread that applied the
+// delta, after the store's lock is released.
+class ModelStore {
+public:
+    enum class Status {
+        Ok,
+        UnknownHandle,     // Never uploaded, released, or (for edits) owned by another connection
+        VersionMismatch,   // Delta base / requested version is not the current version
+        InvalidDelta,      // Delta does not apply to the current model
+    };
+
+    // Stores a model at version 1 and returns its snapshot (with a fresh handle)
+    ModelSnapshot upload(uint32_t owner, bedrock::som::SystemModel model);
+
+    // Applies a delta against the current version; on success `out` is the new snapshot
+    Status applyDelta(uint32_t owner, uint64_t handle, const bedrock::som::SomDelta& delta,
+                      ModelSnapshot* out = nullptr, std::string* error = nullptr);
+
+    // Delta from `fromVersion` to the current version (full when it left the history)
+    Status changesSince(uint64_t handle, uint64_t fromVersion, ModelChange& out) const;
+    
+    // Subscribes connection `subscriber` (any connection, not only the owner) to version
+    // changes of a model. `knownVersion` is the version the subscriber holds; if it is
+    // behind, `catchUp` receives the change to apply now.
+    Status subscribe(uint32_t subscriber, uint64_t handle, uint64_t knownVersion, ModelChangeListener listener,
+                     SubscriptionId* id = nullptr, ModelChange* catchUp = nullptr);
+    bool unsubscribe(SubscriptionId id);
+    size_t subscriptionCount(uint64_t handle) const;
+    
+    // Resolves a request's model reference to the current snapshot (from any connection)
+    Status resolve(const ModelRef& ref, ModelSnapshot& out) const;
+
+    bool release(uint32_t owner, uint64_t handle);
+    // On disconnect: drops every model owned by the connection (with all their subscriptions)
+    // and the connection's subscriptions to other owners' models; returns the models dropped
+    size_t releaseOwner(uint32_t owner);
+
+    size_t size() const;
+
+    static const char* statusName(Status status);
+    
+    // Previous versions kept per model for composing subscriber deltas
+    static constexpr size_t HISTORY_DEPTH = 32;
+
+private:
+    struct Subscription {
+        ModelChangeListener listener;
+        uint64_t lastSeen = 0;
+        uint32_t subscriber = 0;
+    };
+    struct Entry {
+        uint32_t owner = 0;
+        ModelSnapshot current;
+        std::deque<ModelSnapshot> history;  // Oldest first, at most HISTORY_DEPTH
+        std::map<SubscriptionId, Subscription> subscriptions;
+    };
+    
+    // Requires mutex_ held
+    static ModelChange changeFrom(const Entry& entry, uint64_t fromVersion);
+    void eraseLocked(std::map<uint64_t, Entry>::iterator it);
+
+    mutable std::mutex mutex_;
+    std::map<uint64_t, Entry> models_;
+    std::map<uint32_t, std::set<uint64_t>> byOwner_;  // Owner -> handles, for disconnect cleanup
+    std::map<SubscriptionId, uint64_t> subscriptionHandles_;  // Subscription -> model handle
+    uint64_t nextHandle_ = 1;
+    SubscriptionId nextSubscription_ = 1;
+};
+
+// EngineModelBridge: publishes an Engine's SOM into a ModelStore
+// Give callback() to the Engine as its SomChangedFn and attach() the engine: every
+// SOM bump is diffed against the resident version and applied as a delta, so the
+// store's subscribers are notified like for a client edit. The first bump uploads
+// the model. Owned by ENGINE_OWNER, which no connection id uses (connections never
+// edit or release it). Not thread-safe: call from the engine's thread.
+class EngineModelBridge {
+public:
+    static constexpr uint32_t ENGINE_OWNER = 0;
+
+    explicit EngineModelBridge(ModelStore& store);
+
+    void attach(const bedrock::Engine& engine) { engine_ = &engine; }
+    bedrock::SomChangedFn callback();
+
+    // Publishes `model` as the next version (uploads it the first time)
+    ModelStore::Status publish(const bedrock::som::SystemModel& model, ModelSnapshot* out = nullptr);
+
+    // Handle of the published model (0 until the first publish)
+    uint64_t handle() const { return handle_; }
+
+private:
+    ModelStore& store_;
+    const bedrock::Engine* engine_ = nullptr;
+    uint64_t handle_ = 0;
+};
+
+} // namespace bedrock::palantir
@@ -0,0 +1,310 @@
+#include "PalantirClientPool.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include "EnvelopeHelpers.hpp"
+#include "RequestControl.hpp"
+
+#include <QDebug>
+#include <QLocalSocket>
+
+#include <algorithm>
+#include <charconv>
+
+namespace bedrock::palantir {
+
+namespace {
+
+int metadataInt(const ::palantir::MessageEnvelope& envelope, const char* key, int fallback)
+{
+    auto it = envelope.metadata().find(key);
+    if (it == envelope.metadata().end()) {
+        return fallback;
+    }
+    int value = 0;
+    const std::string& text = it->second;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size() ? value : fallback;
+}
+
+} // namespace
+
+PalantirClientPool::PalantirClientPool(const QStringList& socketNames)
+    : PalantirClientPool(socketNames, Options{})
+{
+}
+
+PalantirClientPool::PalantirClientPool(const QStringList& socketNames, Options options)
+    : options_(options)
+    , endpoints_(static_cast<size_t>(socketNames.size()))
+    , balancer_(static_cast<size_t>(socketNames.size()), options.balancer)
+{
+    size_t i = 0;
+    for (const QString& name : socketNames) {
+        endpoints_[i++].name = name;
+    }
+
+    // Check often enough that an overdue reply is noticed within a quarter of the timeout
+    const auto interval = std::clamp(options_.requestTimeout / 4, std::chrono::milliseconds{10},
+                                     std::chrono::milliseconds{1000});
+    timeoutTimer_.setInterval(static_cast<int>(interval.count()));
+    QObject::connect(&timeoutTimer_, &QTimer::timeout, &context_, [this]() { checkTimeouts(); });
+}
+
+PalantirClientPool::~PalantirClientPool()
+{
+    running_ = false;
+    for (Endpoint& endpoint : endpoints_) {
+        closeSocket(endpoint);
+    }
+}
+
+void PalantirClientPool::start()
+{
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        connectEndpoint(static_cast<int>(i));
+    }
+    timeoutTimer_.start();
+}
+
+void PalantirClientPool::stop()
+{
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    timeoutTimer_.stop();
+
+    std::vector<std::shared_ptr<Call>> orphaned(waiting_.begin(), waiting_.end());
+    waiting_.clear();
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        Endpoint& endpoint = endpoints_[i];
+        closeSocket(endpoint);
+        balancer_.onDisconnected(static_cast<int>(i));
+        orphaned.insert(orphaned.end(), endpoint.inFlight.begin(), endpoint.inFlight.end());
+        endpoint.inFlight.clear();
+    }
+    for (const auto& call : orphaned) {
+        fail(call, "Client pool stopped");
+    }
+}
+
+bool PalantirClientPool::submit(::palantir::MessageType type, const google::protobuf::Message& message, Callback done,
+                                bool idempotent, const std::map<std::string, std::string>& metadata)
+{
+    // Ask every server for its load so each reply refreshes the balancer
+    std::map<std::string, std::string> requestMetadata = metadata;
+    requestMetadata[META_REPORT_LOAD] = "1";
+
+    std::string error;
+    auto envelope = makeEnvelope(type, message, requestMetadata, &error);
+    auto call = std::make_shared<Call>();
+    if (!envelope || !appendFrame(*envelope, call->frame, options_.maxEnvelopeSize, &error)) {
+        qDebug() << "[POOL] submit: cannot encode request:" << error.c_str();
+        return false;
+    }
+    call->done = std::move(done);
+    call->idempotent = idempotent;
+    call->submittedAt = LoadBalancer::Clock::now();
+    dispatch(std::move(call));
+    return true;
+}
+
+size_t PalantirClientPool::connectedCount() const
+{
+    return static_cast<size_t>(std::count_if(endpoints_.begin(), endpoints_.end(),
+                                             [](const Endpoint& endpoint) { return endpoint.connected; }));
+}
+
+size_t PalantirClientPool::outstanding() const
+{
+    size_t count = waiting_.size();
+    for (const Endpoint& endpoint : endpoints_) {
+        count += endpoint.inFlight.size();
+    }
+    return count;
+}
+
+void PalantirClientPool::connectEndpoint(int index)
+{
+    Endpoint& endpoint = endpoints_[index];
+    if (!running_ || endpoint.socket) {
+        return;
+    }
+
+    auto* socket = new QLocalSocket();
+    endpoint.socket = socket;
+    QObject::connect(socket, &QLocalSocket::connected, &context_, [this, index]() { onConnected(index); });
+    QObject::connect(socket, &QLocalSocket::readyRead, &context_, [this, index]() { onReadyRead(index); });
+    QObject::connect(socket, &QLocalSocket::disconnected, &context_,
+                     [this, index]() { onFailed(index, "Server closed the connection"); });
+    QObject::connect(socket, &QLocalSocket::errorOccurred, &context_, [this, index, socket]() {
+        onFailed(index, socket->errorString());
+    });
+    socket->connectToServer(endpoint.name);
+}
+
+void PalantirClientPool::onConnected(int index)
+{
+    Endpoint& endpoint = endpoints_[index];
+    endpoint.connected = true;
+    balancer_.onConnected(index);
+    qDebug() << "[POOL] connected to" << endpoint.name;
+    dispatchWaiting();
+}
+
+void PalantirClientPool::onReadyRead(int index)
+{
+    Endpoint& endpoint = endpoints_[index];
+    QLocalSocket* socket = endpoint.socket;
+    if (!socket) {
+        return;
+    }
+    const QByteArray data = socket->readAll();
+    endpoint.readBuffer.append(data.constData(), static_cast<size_t>(data.size()));
+
+    size_t offset = 0;
+    while (true) {
+        size_t frameSize = 0;
+        std::string error;
+        const FrameStatus status = peekFrame(endpoint.readBuffer.data() + offset, endpoint.readBuffer.size() - offset,
+                                             options_.maxEnvelopeSize, frameSize, &error);
+        if (status == FrameStatus::Incomplete) {
+            break;
+        }
+
+        Result result;
+        if (status == FrameStatus::Error ||
+            !parseEnvelope(endpoint.readBuffer.data() + offset + FRAME_HEADER_SIZE, frameSize - FRAME_HEADER_SIZE,
+                           result.envelope, &error)) {
+            onFailed(index, QString("Bad reply frame: %1").arg(error.c_str()));
+            return;
+        }
+        offset += frameSize;
+        if (endpoint.inFlight.empty()) {
+            onFailed(index, "Reply with no outstanding request");
+            return;
+        }
+
+        std::shared_ptr<Call> call = std::move(endpoint.inFlight.front());
+        endpoint.inFlight.pop_front();
+        balancer_.onReply(index, metadataInt(result.envelope, META_SERVER_LOAD, -1),
+                          metadataInt(result.envelope, META_SERVER_WORKERS, 1));
+        result.ok = true;
+        result.endpoint = index;
+        result.attempts = call->attempts;
+        call->done(result);
+
+        // The callback may have stopped the pool or failed this connection
+        if (endpoint.socket != socket) {
+            return;
+        }
+    }
+    endpoint.readBuffer.erase(0, offset);
+}
+
+void PalantirClientPool::onFailed(int index, const QString& reason)
+{
+    Endpoint& endpoint = endpoints_[index];
+    if (!endpoint.socket) {
+        return;  // Already handled (disconnected and errorOccurred both fire)
+    }
+    qDebug() << "[POOL]" << endpoint.name << "failed:" << reason << "in flight:" << endpoint.inFlight.size();
+    closeSocket(endpoint);
+    balancer_.onFailure(index);
+
+    std::deque<std::shared_ptr<Call>> orphaned;
+    orphaned.swap(endpoint.inFlight);
+    for (auto& call : orphaned) {
+        // The server may have run a non-idempotent request before the connection dropped
+        if (call->idempotent && call->attempts <= options_.maxRetries) {
+            dispatch(std::move(call));
+        } else {
+            fail(call, reason);
+        }
+    }
+
+    if (running_) {
+        const auto delay = balancer_.retryDelay(index);
+        QTimer::singleShot(static_cast<int>(delay.count()), &context_, [this, index]() { connectEndpoint(index); });
+    }
+}
+
+void PalantirClientPool::closeSocket(Endpoint& endpoint)
+{
+    if (!endpoint.socket) {
+        return;
+    }
+    QLocalSocket* socket = endpoint.socket;
+    endpoint.socket = nullptr;
+    endpoint.connected = false;
+    endpoint.readBuffer.clear();
+    QObject::disconnect(socket, nullptr, &context_, nullptr);
+    socket->abort();
+    socket->deleteLater();  // May be inside one of its own signals
+}
+
+void PalantirClientPool::dispatch(std::shared_ptr<Call> call)
+{
+    const int index = running_ ? balancer_.pick() : -1;
+    if (index < 0) {
+        waiting_.push_back(std::move(call));
+        return;
+    }
+    Endpoint& endpoint = endpoints_[index];
+    ++call->attempts;
+    call->endpoint = index;
+    call->sentAt = LoadBalancer::Clock::now();
+    balancer_.onSent(index);
+    const qint64 size = static_cast<qint64>(call->frame.size());
+    endpoint.inFlight.push_back(std::move(call));
+    if (endpoint.socket->write(endpoint.inFlight.back()->frame.data(), size) != size) {
+        onFailed(index, "Write failed");
+    }
+}
+
+void PalantirClientPool::dispatchWaiting()
+{
+    std::deque<std::shared_ptr<Call>> ready;
+    ready.swap(waiting_);
+    for (auto& call : ready) {
+        dispatch(std::move(call));
+    }
+}
+
+void PalantirClientPool::fail(const std::shared_ptr<Call>& call, const QString& reason)
+{
+    Result result;
+    result.error = reason;
+    result.endpoint = call->endpoint;
+    result.attempts = call->attempts;
+    call->done(result);
+}
+
+void PalantirClientPool::checkTimeouts()
+{
+    const auto now = LoadBalancer::Clock::now();
+
+    // A connection whose oldest reply is overdue is treated as failed; replies come
+    // back in order, so nothing behind it can complete first
+    for (size_t i = 0; i < endpoints_.size(); ++i) {
+        const Endpoint& endpoint = endpoints_[i];
+        if (!endpoint.inFlight.empty() && now - endpoint.inFlight.front()->sentAt > options_.requestTimeout) {
+            onFailed(static_cast<int>(i), "Reply timed out");
+        }
+    }
+
+    while (!waiting_.empty() && now - waiting_.front()->submittedAt > options_.requestTimeout) {
+        auto call = std::move(waiting_.front());
+        waiting_.pop_front();
+        fail(call, "No server available");
+    }
+}
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
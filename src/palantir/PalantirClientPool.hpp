@@ -0,0 +1,119 @@
+#pragma once
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "palantir/envelope.pb.h"
+#include "LoadBalancer.hpp"
+
+#include <google/protobuf/message.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class QLocalSocket;
+
+namespace bedrock::palantir {
+
+// PalantirClientPool: one connection to each of several bedrock_server instances
+// Requests go to the least-loaded live server (LoadBalancer, fed by the load the
+// servers report in reply metadata) and are pipelined; replies are matched in order
+// per connection, which the server guarantees. When a connection drops or a reply is
+// overdue, idempotent requests are resent elsewhere and the rest fail; the server is
+// reconnected after its backoff. Requests submitted while no server is reachable
+// wait until one is.
+//
+// Asynchronous: runs on the event loop of the thread that created it, and callbacks
+// are invoked there. Not thread-safe.
+class PalantirClientPool {
+public:
+    struct Options {
+        int maxRetries = 2;                                 // Resends of an idempotent request
+        std::chrono::milliseconds requestTimeout{30000};    // Overdue replies fail the connection
+        uint32_t maxEnvelopeSize = 10 * 1024 * 1024;        // Both directions; matches the server's limit
+        LoadBalancer::Options balancer;
+    };
+
+    struct Result {
+        bool ok = false;
+        ::palantir::MessageEnvelope envelope;  // Reply (may be an ErrorResponse) when ok
+        QString error;                         // Transport failure when !ok
+        int endpoint = -1;                     // Server that answered (or last tried)
+        int attempts = 0;
+    };
+    using Callback = std::function<void(const Result&)>;
+
+    explicit PalantirClientPool(const QStringList& socketNames);
+    PalantirClientPool(const QStringList& socketNames, Options options);
+    ~PalantirClientPool();
+
+    PalantirClientPool(const PalantirClientPool&) = delete;
+    PalantirClientPool& operator=(const PalantirClientPool&) = delete;
+
+    // Starts connecting to every server; submit() may be called before any is up
+    void start();
+    // Closes all connections and fails every outstanding request
+    // (the destructor closes them without calling back)
+    void stop();
+
+    // Queues a request; `done` runs exactly once. Returns false (without calling
+    // `done`) only if the request cannot be encoded.
+    bool submit(::palantir::MessageType type, const google::protobuf::Message& message, Callback done,
+                bool idempotent, const std::map<std::string, std::string>& metadata = {});
+
+    size_t endpointCount() const { return endpoints_.size(); }
+    size_t connectedCount() const;
+    // Requests sent or waiting for a server, not yet completed
+    size_t outstanding() const;
+    const LoadBalancer& balancer() const { return balancer_; }
+
+private:
+    struct Call {
+        std::string frame;  // Encoded once; resent as-is on retry
+        Callback done;
+        bool idempotent = false;
+        int attempts = 0;
+        int endpoint = -1;
+        LoadBalancer::Clock::time_point submittedAt;
+        LoadBalancer::Clock::time_point sentAt;
+    };
+
+    struct Endpoint {
+        QString name;
+        QLocalSocket* socket = nullptr;  // Null while waiting to reconnect
+        bool connected = false;
+        std::string readBuffer;
+        std::deque<std::shared_ptr<Call>> inFlight;  // Reply order
+    };
+
+    void connectEndpoint(int index);
+    void onConnected(int index);
+    void onReadyRead(int index);
+    void onFailed(int index, const QString& reason);
+    void closeSocket(Endpoint& endpoint);
+
+    void dispatch(std::shared_ptr<Call> call);
+    void dispatchWaiting();
+    void fail(const std::shared_ptr<Call>& call, const QString& reason);
+    void checkTimeouts();
+
+    Options options_;
+    QObject context_;  // Receiver for socket and timer connections; disconnects them on destruction
+    std::vector<Endpoint> endpoints_;
+    LoadBalancer balancer_;
+    std::deque<std::shared_ptr<Call>> waiting_;
+    QTimer timeoutTimer_;
+    bool running_ = false;
+};
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
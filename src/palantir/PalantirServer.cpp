@@ -5,26 +5,42 @@
 #include <QTimer>
 #include <QDebug>
 #include <QCoreApplication>
-#include <QThread>
 #include <QDateTime>
 #include <cmath>
 #include <algorithm>
+#include <vector>
+
+#include "bedrock/memory_tracking.hpp"
+#include "bedrock/threading.hpp"
+#include "bedrock/trace.hpp"
+#include "bedrock/tuning_profile.hpp"
 
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
 #include "palantir/xysine.pb.h"
 #include "palantir/envelope.pb.h"
 #include "palantir/error.pb.h"
 #include "EnvelopeHelpers.hpp"
+#include "XYSineFeature.hpp"
 #endif
 
 PalantirServer::PalantirServer(QObject *parent)
     : QObject(parent)
     , server_(std::make_unique<QLocalServer>(this))
     , running_(false)
-    , maxConcurrency_(QThread::idealThreadCount())
-    , supportedFeatures_({"xy_sine", "heat_diffusion"})
+    , maxConcurrency_(bedrock::ThreadingConfig::get_optimal_thread_count())  // Affinity and CPU quota aware
     , protocolVersion_("1.0")
+    , completions_(this, [this](auto& queue) { drainCompletions(queue); })
+    , transportExecutor_(this)
+    , cores_(maxConcurrency_)
+    , tuningProfilePath_(bedrock::TuningProfile::default_path())
 {
+    computePool_.setMaxThreadCount(maxConcurrency_);
+    longJobPool_.setMaxThreadCount(maxConcurrency_);
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    features_ = std::make_unique<bedrock::palantir::FeatureRegistry>();
+    registerBuiltinHandlers();
+#endif
+    
     // Connect server signals
     connect(server_.get(), &QLocalServer::newConnection, this, &PalantirServer::onNewConnection);
     
@@ -54,12 +70,33 @@ bool PalantirServer::startServer(const QString& socketName)
     }
     
     running_ = true;
+    loadTuningProfile();
     heartbeatTimer_.start();
+    bedrock::Tracer::set_thread_name("palantir-io");
     
     qDebug() << "Palantir server started on socket:" << socketName;
     return true;
 }
 
+void PalantirServer::setTuningProfilePath(const QString& path)
+{
+    tuningProfilePath_ = path.toStdString();
+}
+
+// loadTuningProfile: per-kernel threads and grains measured by bedrock_server --calibrate
+void PalantirServer::loadTuningProfile()
+{
+    std::string error;
+    auto profile = bedrock::TuningProfile::load(tuningProfilePath_, &error);
+    if (!profile) {
+        qDebug() << "[SERVER] No tuning profile used (" << error.c_str() << "); kernels use default grains";
+        return;
+    }
+    qDebug() << "[SERVER] Loaded tuning profile" << tuningProfilePath_.c_str() << "with" << profile->kernels.size()
+             << "kernel(s)";
+    bedrock::TuningProfile::install(std::move(*profile));
+}
+
 void PalantirServer::stopServer()
 {
     if (!running_) {
@@ -74,6 +111,32 @@ void PalantirServer::stopServer()
         }
     }
     
+    // Close sessions: cancels supersedable work so the compute pool finishes quickly
+    // (workers only touch completions_); their completions are discarded on drain.
+    // Clients see the connection drop, so pooled clients fail over at once.
+    for (auto& [client, session] : sessions_) {
+        session->close();
+        models_.releaseOwner(session->connectionId());
+        QObject::disconnect(client, nullptr, this, nullptr);
+        client->abort();
+        client->deleteLater();
+    }
+    sessions_.clear();
+    modelWatches_.clear();
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    const int dropped = static_cast<int>(features_->dropQueued());  // Gated work never started
+    pendingPoolWork_ -= dropped;
+    queuedPoolWork_.fetch_sub(dropped, std::memory_order_relaxed);
+#endif
+    computePool_.waitForDone();
+    longJobPool_.waitForDone();
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    // Completions still queued release their gate slots and pending count (their sessions
+    // are closed, so nothing is written); a restarted server starts from idle gates
+    drainCompletions(completions_);
+    logUsageSummary();
+#endif
+    
     // Wait for job threads to finish (thread-safe)
     {
         std::lock_guard<std::mutex> lock(jobMutex_);
@@ -87,16 +150,11 @@ void PalantirServer::stopServer()
         jobCancelled_.clear();
     }
     
-    // Clear client buffers (thread-safe)
-    {
-        std::lock_guard<std::mutex> lock(clientBuffersMutex_);
-        clientBuffers_.clear();
-    }
-    
     // Stop server
     server_->close();
     running_ = false;
     heartbeatTimer_.stop();
+    stopCapture();
     
     qDebug() << "Palantir server stopped";
 }
@@ -113,7 +171,102 @@ int PalantirServer::maxConcurrency() const
 
 QStringList PalantirServer::supportedFeatures() const
 {
-    return supportedFeatures_;
+    QStringList features;
+    for (const std::string& feature : capabilities_.features()) {
+        features.append(QString::fromStdString(feature));
+    }
+    return features;
+}
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+bool PalantirServer::registerHandler(bedrock::palantir::FeatureHandler handler)
+{
+    const std::string feature = handler.feature;
+    const char* executor = bedrock::palantir::executorName(handler.executor);
+    if (!features_->add(std::move(handler))) {
+        qWarning() << "[SERVER] registerHandler: request type already handled, feature" << feature.c_str();
+        return false;
+    }
+    if (!feature.empty()) {
+        capabilities_.addFeature(feature);
+    }
+    qDebug() << "[SERVER] registerHandler:" << (feature.empty() ? "(protocol)" : feature.c_str()) << "executor" << executor;
+    return true;
+}
+
+// logUsageSummary: per-feature cost of the work run so far (capacity planning)
+void PalantirServer::logUsageSummary() const
+{
+    for (size_t i = 0; i < features_->size(); ++i) {
+        const auto& entry = features_->entry(static_cast<int>(i));
+        const auto& usage = entry.usage;
+        if (usage.jobs == 0) {
+            continue;
+        }
+        const std::string& feature = entry.handler.feature;
+        qDebug() << "[SERVER] usage:" << (feature.empty() ? "(protocol)" : feature.c_str())
+                 << "jobs=" << usage.jobs
+                 << "wallMs(mean/max)=" << usage.meanWallMs() << "/" << usage.maxWallNs / 1e6
+                 << "queueMs(mean/max)=" << usage.meanQueueMs() << "/" << usage.maxQueueNs / 1e6
+                 << "cpuMs(mean)=" << usage.meanCpuMs() << "cpuUtil=" << usage.cpuUtilization()
+                 << "peakBytes(max)=" << usage.maxPeakBytes << "items=" << usage.totalItems;
+    }
+    qDebug().noquote() << bedrock::MemoryTracker::report().c_str();
+}
+
+// registerBuiltinHandlers: requests every server answers
+void PalantirServer::registerBuiltinHandlers()
+{
+    // Capabilities: answered inline from the cached response plus live load
+    bedrock::palantir::FeatureHandler capabilities;
+    capabilities.requestType = palantir::MessageType::CAPABILITIES_REQUEST;
+    capabilities.executor = bedrock::palantir::ExecutorKind::Inline;
+    capabilities.prepare = bedrock::palantir::parseAs<palantir::CapabilitiesRequest>(
+        [this](const palantir::CapabilitiesRequest&, const bedrock::palantir::RequestControl&) {
+            // CapabilitiesRequest has no fields, so no parameter validation is needed
+            return bedrock::palantir::FeaturePlan::run([this](const bedrock::palantir::RequestControl&) {
+                return capabilitiesResult();
+            });
+        });
+    registerHandler(std::move(capabilities));
+    
+    registerHandler(bedrock::palantir::makeXYSineHandler(maxConcurrency_));
+    bedrock::palantir::registerXYSineTuning();
+}
+#endif
+
+bool PalantirServer::startCapture(const QString& path)
+{
+    auto writer = std::make_unique<bedrock::palantir::TrafficCaptureWriter>();
+    std::string error;
+    if (!writer->open(path.toStdString(), &error)) {
+        emit errorOccurred(QString::fromStdString(error));
+        return false;
+    }
+    capture_ = std::move(writer);
+    qDebug() << "Palantir traffic capture enabled:" << path;
+    return true;
+}
+
+void PalantirServer::stopCapture()
+{
+    if (capture_) {
+        capture_->close();
+        qDebug() << "Palantir traffic capture stopped," << capture_->recordCount() << "records";
+        capture_.reset();
+    }
+}
+
+bool PalantirServer::isCapturing() const
+{
+    return capture_ != nullptr;
+}
+
+void PalantirServer::captureFrame(ClientSession& session, bedrock::palantir::CaptureKind kind, const char* data, size_t size)
+{
+    if (capture_) {
+        capture_->record(session.connectionId(), kind, data, size);
+    }
 }
 
 void PalantirServer::onNewConnection()
@@ -126,64 +279,69 @@ void PalantirServer::onNewConnection()
     
     qDebug() << "[SERVER] onNewConnection: new client" << client << ", state=" << client->state();
     
-    // Connect client signals
-    connect(client, &QLocalSocket::disconnected, this, &PalantirServer::onClientDisconnected);
-    connect(client, &QLocalSocket::readyRead, this, &PalantirServer::onClientReadyRead);
+    auto session = std::make_shared<ClientSession>(client, nextConnectionId_++);
+    sessions_[client] = session;
+    captureFrame(*session, bedrock::palantir::CaptureKind::Connect, nullptr, 0);
+    qDebug() << "[SERVER] onNewConnection: session" << session->connectionId() << "created, sessions=" << sessions_.size();
     
-    // Initialize client buffer (thread-safe)
-    {
-        std::lock_guard<std::mutex> lock(clientBuffersMutex_);
-        clientBuffers_[client] = QByteArray();
-        qDebug() << "[SERVER] onNewConnection: client added to buffers map, map size=" << clientBuffers_.size();
-    }
+    // Connect client signals; each handler is bound to its session (no per-message lookup)
+    std::weak_ptr<ClientSession> weakSession = session;
+    connect(client, &QLocalSocket::disconnected, this, [this, weakSession]() {
+        if (auto session = weakSession.lock()) {
+            onClientDisconnected(*session);
+        }
+    });
+    connect(client, &QLocalSocket::readyRead, this, [this, weakSession]() {
+        if (auto session = weakSession.lock()) {
+            onClientReadyRead(*session);
+        }
+    });
     
     emit clientConnected();
     qDebug() << "[SERVER] onNewConnection: Client connected signal emitted";
 }
 
-void PalantirServer::onClientDisconnected()
+void PalantirServer::onClientDisconnected(ClientSession& session)
 {
-    QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
-    if (!client) {
+    if (!session.isOpen()) {
         return;
     }
     
-    // Remove client from tracking (thread-safe)
-    {
-        std::lock_guard<std::mutex> lock(clientBuffersMutex_);
-        clientBuffers_.erase(client);
-    }
+    captureFrame(session, bedrock::palantir::CaptureKind::Disconnect, nullptr, 0);
     
-    // Cancel jobs for this client (thread-safe)
-    {
+    // Cancel this client's in-flight requests (nobody is left to read the result)
+    // and drop replies still owed to it
+    std::set<QString> jobs = session.close();
+    const size_t releasedModels = models_.releaseOwner(session.connectionId());  // Also ends its model watches
+    std::erase_if(modelWatches_, [id = session.connectionId()](const auto& watch) { return watch.first == id; });
+    
+    // Cancel jobs for this client (thread-safe); only its own jobs are visited
+    if (!jobs.empty()) {
         std::lock_guard<std::mutex> lock(jobMutex_);
-        for (auto it = jobClients_.begin(); it != jobClients_.end();) {
-            if (it->second == client) {
-                QString jobId = it->first;
-                jobCancelled_[jobId] = true;
-                jobClients_.erase(it++);
-            } else {
-                ++it;
-            }
+        for (const QString& jobId : jobs) {
+            jobCancelled_[jobId] = true;
+            jobClients_.erase(jobId);
         }
     }
     
-    // Qt will handle socket deletion via parent-child relationship
-    // No need to call deleteLater() explicitly - client is child of server
+    const auto& stats = session.stats();
+    qDebug() << "Client disconnected: connection" << session.connectionId()
+             << "requests=" << stats.requests << "replies=" << stats.replies
+             << "dropped=" << stats.dropped << "protocolErrors=" << stats.protocolErrors
+             << "bytesIn=" << stats.bytesReceived << "bytesOut=" << stats.bytesSent
+             << "modelsReleased=" << releasedModels;
+    
+    // The signal handler still holds a reference, so the session outlives this call
+    QLocalSocket* client = session.socket();
+    sessions_.erase(client);
+    client->deleteLater();  // Nothing refers to the socket once its session is gone
     emit clientDisconnected();
-    qDebug() << "Client disconnected";
 }
 
-void PalantirServer::onClientReadyRead()
+void PalantirServer::onClientReadyRead(ClientSession& session)
 {
-    QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
-    if (!client) {
-        qDebug() << "[SERVER] onClientReadyRead: ERROR - no client";
-        return;
-    }
-    
-    qDebug() << "[SERVER] onClientReadyRead: bytes available=" << client->bytesAvailable();
-    parseIncomingData(client);
+    qDebug() << "[SERVER] onClientReadyRead: bytes available=" << session.socket()->bytesAvailable();
+    parseIncomingData(session);
 }
 
 void PalantirServer::onHeartbeatTimer()
@@ -199,19 +357,19 @@ void PalantirServer::onHeartbeatTimer()
 // StartJob handler disabled (proto message not yet defined)
 // Future: Re-enable when StartJob proto is added
 /*
-void PalantirServer::handleStartJob(QLocalSocket* client, const palantir::StartJob& startJob)
+void PalantirServer::handleStartJob(ClientSession& session, const palantir::StartJob& startJob)
 {
     QString jobId = QString::fromStdString(startJob.job_id().id());
     palantir::ComputeSpec spec = startJob.spec();
     
     // Check if we can handle this job
     QString featureId = QString::fromStdString(spec.feature_id());
-    if (!supportedFeatures_.contains(featureId)) {
+    if (!capabilities_.hasFeature(featureId.toStdString())) {
         palantir::StartReply reply;
         reply.mutable_job_id()->set_id(jobId.toStdString());
         reply.set_status("UNIMPLEMENTED");
         reply.set_error_message("Feature not supported: " + featureId.toStdString());
-        sendMessage(client, reply);
+        sendMessage(session, reply);
         return;
     }
     
@@ -221,20 +379,21 @@ void PalantirServer::handleStartJob(QLocalSocket* client, const palantir::StartJ
         reply.mutable_job_id()->set_id(jobId.toStdString());
         reply.set_status("RESOURCE_EXHAUSTED");
         reply.set_error_message("Server at capacity");
-        sendMessage(client, reply);
+        sendMessage(session, reply);
         return;
     }
     
     // Start job
     activeJobs_[jobId] = spec;
-    jobClients_[jobId] = client;
+    jobClients_[jobId] = session.weak_from_this();
+    session.jobs().insert(jobId);
     jobCancelled_[jobId] = false;
     
     // Send start reply
     palantir::StartReply reply;
     reply.mutable_job_id()->set_id(jobId.toStdString());
     reply.set_status("OK");
-    sendMessage(client, reply);
+    sendMessage(session, reply);
     
     // Start job processing in separate thread
     std::thread jobThread([this, jobId, spec]() {
@@ -247,132 +406,120 @@ void PalantirServer::handleStartJob(QLocalSocket* client, const palantir::StartJ
 }
 */
 
-// handleCapabilitiesRequest: RPC handler for Capabilities query
-// Validation: CapabilitiesRequest has no fields (empty message), so no parameter validation needed
-// If protobuf parsing fails, error is returned in parseIncomingData() before this handler is called
-void PalantirServer::handleCapabilitiesRequest(QLocalSocket* client)
-{
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
-    qDebug() << "[SERVER] handleCapabilitiesRequest: starting";
-    bedrock::palantir::CapabilitiesService service;
-    palantir::CapabilitiesResponse response = service.getCapabilities();
-    qDebug() << "[SERVER] handleCapabilitiesRequest: got capabilities, server_version=" << response.capabilities().server_version().c_str();
-    qDebug() << "[SERVER] handleCapabilitiesRequest: calling sendMessage...";
-    sendMessage(client, palantir::MessageType::CAPABILITIES_RESPONSE, response);
-    qDebug() << "[SERVER] handleCapabilitiesRequest: sendMessage returned";
-#else
-    qWarning() << "Capabilities requested but transport deps disabled";
-#endif
-}
-
-// handleXYSineRequest: RPC handler for XY Sine computation
-// Validation rules (enforced at RPC boundary before compute logic):
-//   - samples: Must be >= 2 and <= 10,000,000 (DoS prevention)
-//   - frequency: Must be finite (no NaN/Inf), default 1.0 if 0.0
-//   - amplitude: Must be finite (no NaN/Inf), default 1.0 if 0.0
-//   - phase: Must be finite (no NaN/Inf), 0.0 is valid default
-// Error codes:
-//   - INVALID_PARAMETER_VALUE: Semantically invalid parameters (out of range, non-finite)
-//   - PROTOBUF_PARSE_ERROR: Returned in parseIncomingData() if protobuf parsing fails
-void PalantirServer::handleXYSineRequest(QLocalSocket* client, const palantir::XYSineRequest& request)
+// capabilitiesResult: cached CapabilitiesResponse with live load in the reply metadata
+bedrock::palantir::FeatureResult PalantirServer::capabilitiesResult()
 {
-#ifdef BEDROCK_WITH_TRANSPORT_DEPS
-    // Validate request parameters at RPC boundary
-    // Note: proto3 provides default values (0.0 for double, 0 for int32)
-    // We apply defaults and validate before calling compute logic
-    
-    // Validation: samples range (DoS prevention)
-    int samples = request.samples() != 0 ? request.samples() : 1000;
-    if (samples < 2) {
-        sendErrorResponse(client, palantir::ErrorCode::INVALID_PARAMETER_VALUE,
-                         QString("Samples must be between 2 and 10,000,000 (got %1)").arg(samples),
-                         QString("Received samples=%1").arg(samples));
-        return;
-    }
-    if (samples > 10000000) {  // 10M samples max (reasonable limit)
-        sendErrorResponse(client, palantir::ErrorCode::INVALID_PARAMETER_VALUE,
-                         QString("Samples must be between 2 and 10,000,000 (got %1)").arg(samples),
-                         QString("Received samples=%1").arg(samples));
-        return;
-    }
-    
-    // Validation: frequency, amplitude, phase must be finite (not NaN or Inf)
-    double frequency = request.frequency() != 0.0 ? request.frequency() : 1.0;
-    double amplitude = request.amplitude() != 0.0 ? request.amplitude() : 1.0;
-    double phase = request.phase();  // 0.0 is valid default
-    if (!std::isfinite(frequency) || !std::isfinite(amplitude) || !std::isfinite(phase)) {
-        sendErrorResponse(client, palantir::ErrorCode::INVALID_PARAMETER_VALUE,
-                         "Frequency, amplitude, and phase must be finite numbers",
-                         QString("frequency=%1, amplitude=%2, phase=%3")
-                         .arg(frequency).arg(amplitude).arg(phase));
-        return;
-    }
-    
-    // Compute XY Sine
-    std::vector<double> xValues, yValues;
-    computeXYSine(request, xValues, yValues);
-    
-    // Build response
-    palantir::XYSineResponse response;
-    response.mutable_x()->Reserve(static_cast<int>(xValues.size()));
-    response.mutable_y()->Reserve(static_cast<int>(yValues.size()));
-    for (double x : xValues) {
-        response.add_x(x);
-    }
-    for (double y : yValues) {
-        response.add_y(y);
+    const palantir::CapabilitiesResponse& response = capabilities_.getCapabilities();
+    qDebug() << "[SERVER] capabilitiesResult: server_version=" << response.capabilities().server_version().c_str();
+    
+    // Static capabilities come from the cache; live load is sampled from counters
+    bedrock::palantir::ServerLoad load;
+    load.queueDepth = queuedPoolWork_.load(std::memory_order_relaxed);
+    load.activeJobs = runningPoolWork_.load(std::memory_order_relaxed);
+    load.workers = maxConcurrency_;
+    for (const bedrock::MemoryUsage& memory : bedrock::MemoryTracker::snapshot()) {
+        if (memory.peak_bytes > 0) {
+            load.memory.push_back({memory.name, memory.current_bytes, memory.peak_bytes});
+        }
     }
-    response.set_status("OK");
-    
-    // Send response
-    sendMessage(client, palantir::MessageType::XY_SINE_RESPONSE, response);
-#else
-    qWarning() << "XY Sine requested but transport deps disabled";
+    return bedrock::palantir::FeatureResult::reply(palantir::MessageType::CAPABILITIES_RESPONSE,
+                                                   std::make_shared<palantir::CapabilitiesResponse>(response),
+                                                   capabilities_.loadMetadata(load));
+}
 #endif
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+// submitToExecutor: run a handler's work on its pool and deliver the frame in request order
+// A reply slot is reserved now so replies sent meanwhile on this connection queue behind it.
+// The handler's gate holds the start back while it is at its concurrency limit.
+void PalantirServer::submitToExecutor(ClientSession& session, const bedrock::palantir::RequestControl& control,
+                                      int handler, bedrock::palantir::FeatureWork work)
+{
+    auto slot = session.reserveReply();
+    ++pendingPoolWork_;
+    queuedPoolWork_.fetch_add(1, std::memory_order_relaxed);
+    
+    auto& entry = features_->entry(handler);
+    QThreadPool* pool = entry.handler.executor == bedrock::palantir::ExecutorKind::LongJob ? &longJobPool_ : &computePool_;
+    const char* threadName = entry.handler.executor == bedrock::palantir::ExecutorKind::LongJob ? "palantir-long-job"
+                                                                                             : "palantir-worker";
+    const uint64_t submittedNs = bedrock::Tracer::now_ns();  // Queue time: gate + pool wait
+    // Tuned thread count caps this job's share of cores (0 = untuned: a full share)
+    const int tunedThreads = bedrock::TuningProfile::lookup(entry.handler.feature).threads;
+    entry.gate.submit([this, pool, threadName, target = session.weak_from_this(), slot, control, handler,
+                       work = std::move(work), submittedNs, tunedThreads]() {
+        pool->start([this, threadName, target, slot, control, handler, work, submittedNs, tunedThreads]() {
+            static thread_local bool named = false;
+            if (!named) {
+                bedrock::Tracer::set_thread_name(threadName);
+                named = true;
+            }
+            if (bedrock::Tracer::is_enabled()) {
+                bedrock::Tracer::record("palantir", "pool_wait", submittedNs, bedrock::Tracer::now_ns(), control.sequence);
+            }
+            queuedPoolWork_.fetch_sub(1, std::memory_order_relaxed);
+            runningPoolWork_.fetch_add(1, std::memory_order_relaxed);
+            
+            Completion completion{target, slot, {}, control, handler, std::nullopt};
+            {
+                bedrock::TraceSpan span("palantir", "worker", control.sequence);
+                // Superseded or expired while gated or queued: skip the work
+                if (control.shouldStop()) {
+                    completion.frame = buildDroppedFrame(control, control.isCancelled()
+                                                                      ? bedrock::palantir::REASON_SUPERSEDED
+                                                                      : bedrock::palantir::REASON_DEADLINE_EXCEEDED);
+                } else {
+                    auto budget = cores_.acquire(tunedThreads);  // Fair share of the cores while this job runs
+                    bedrock::ThreadBudget::Scope scope(*budget);
+                    completion.frame = runMetered(work, control, submittedNs, completion.usage.emplace());
+                }
+            }
+            runningPoolWork_.fetch_sub(1, std::memory_order_relaxed);
+            completions_.push(std::move(completion));
+        });
+    });
 }
 
-void PalantirServer::computeXYSine(const palantir::XYSineRequest& request, std::vector<double>& xValues, std::vector<double>& yValues)
+// drainCompletions: I/O thread side of the worker handoff
+// Pops every finished reply, then writes each touched connection's ready replies in one write
+void PalantirServer::drainCompletions(bedrock::palantir::CompletionQueue<Completion>& queue)
 {
-    // Parse parameters from request (proto3 provides default values: 0.0 for double, 0 for int32)
-    // Use explicit defaults to match Phoenix behavior
-    double frequency = request.frequency() != 0.0 ? request.frequency() : 1.0;
-    double amplitude = request.amplitude() != 0.0 ? request.amplitude() : 1.0;
-    double phase = request.phase();  // 0.0 is valid default
-    int samples = request.samples() != 0 ? request.samples() : 1000;
-    
-    // Validate samples (minimum 2) - matches Phoenix behavior
-    if (samples < 2) {
-        samples = 2;
+    BEDROCK_TRACE_SPAN("palantir", "drain_completions");
+    std::vector<std::shared_ptr<ClientSession>> touched;
+    while (auto completion = queue.tryPop()) {
+        --pendingPoolWork_;
+        auto& entry = features_->entry(completion->handler);
+        if (completion->usage) {
+            entry.usage.add(*completion->usage);
+        }
+        entry.gate.finished();  // May start gated work
+        auto session = completion->session.lock();
+        if (!session || !session->isOpen()) {
+            continue;  // Client went away while the work ran
+        }
+        session->endRequest(completion->control);
+        completion->slot->frame = std::move(completion->frame);
+        completion->slot->ready = true;
+        if (std::find(touched.begin(), touched.end(), session) == touched.end()) {
+            touched.push_back(std::move(session));
+        }
     }
-    
-    // Compute sine wave using EXACT Phoenix algorithm
-    // t = i / (samples - 1) from 0 to 1
-    // x = t * 2π (0..2π domain)
-    // y = amplitude * sin(2π * frequency * t + phase)
-    xValues.clear();
-    yValues.clear();
-    xValues.reserve(samples);
-    yValues.reserve(samples);
-    
-    for (int i = 0; i < samples; ++i) {
-        double t = static_cast<double>(i) / (samples - 1.0);  // 0 to 1
-        double x = t * 2.0 * M_PI;  // Scale to 0..2π domain
-        double y = amplitude * std::sin(2.0 * M_PI * frequency * t + phase);
-        
-        xValues.push_back(x);
-        yValues.push_back(y);
+    for (const auto& session : touched) {
+        flushReplies(*session);
     }
 }
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
 
 // Ping/Pong handler disabled (proto message not yet defined)
 // Future: Re-enable when Pong proto is added
 /*
-void PalantirServer::handlePing(QLocalSocket* client)
+void PalantirServer::handlePing(ClientSession& session)
 {
     // Respond with pong
     palantir::Pong pong;
     pong.set_timestamp_ms(QDateTime::currentMSecsSinceEpoch());
-    sendMessage(client, pong);
+    sendMessage(session, pong);
 }
 */
 
@@ -450,14 +597,17 @@ void PalantirServer::sendProgress(const QString& jobId, double progress, const Q
         return;
     }
     
-    QLocalSocket* client = jobClients_[jobId];
+    auto session = jobClients_[jobId].lock();
+    if (!session) {
+        return;
+    }
     
     palantir::Progress progressMsg;
     progressMsg.mutable_job_id()->set_id(jobId.toStdString());
     progressMsg.set_progress_pct(progress);
     progressMsg.set_status(status.toStdString());
     
-    sendMessage(client, progressMsg);
+    sendMessage(session, progressMsg);
 }
 */
 
@@ -469,8 +619,11 @@ void PalantirServer::sendResult(const QString& jobId, const palantir::ResultMeta
         return;
     }
     
-    QLocalSocket* client = jobClients_[jobId];
-    sendMessage(client, meta);
+    auto session = jobClients_[jobId].lock();
+    if (!session) {
+        return;
+    }
+    sendMessage(session, meta);
 }
 */
 
@@ -482,7 +635,10 @@ void PalantirServer::sendDataChunk(const QString& jobId, const QByteArray& data,
         return;
     }
     
-    QLocalSocket* client = jobClients_[jobId];
+    auto session = jobClients_[jobId].lock();
+    if (!session) {
+        return;
+    }
     
     palantir::DataChunk chunk;
     chunk.mutable_job_id()->set_id(jobId.toStdString());
@@ -490,7 +646,7 @@ void PalantirServer::sendDataChunk(const QString& jobId, const QByteArray& data,
     chunk.set_total_chunks(totalChunks);
     chunk.set_data(data.data(), data.size());
     
-    sendMessage(client, chunk);
+    sendMessage(session, chunk);
 }
 */
 
@@ -541,77 +697,130 @@ void PalantirServer::computeXYSine(const palantir::ComputeSpec& spec, std::vecto
 */
 
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
-void PalantirServer::sendMessage(QLocalSocket* client, palantir::MessageType type, const google::protobuf::Message& message)
+void PalantirServer::sendMessage(ClientSession& session, palantir::MessageType type, const google::protobuf::Message& message,
+                                 const std::map<std::string, std::string>& metadata)
 {
-    if (!client) {
-        return;
-    }
-    
-    // Threading: This function runs on Qt event loop thread
-    // QLocalSocket operations are safe because we're on the socket's owner thread
-    // Note: QLocalSocket::state() is thread-safe for reading
-    if (client->state() != QLocalSocket::ConnectedState) {
-        qDebug() << "Attempted to send message to disconnected client";
-        return;
-    }
-    
-    // Note: Removed clientBuffers_ map check to avoid deadlock.
-    // We rely on socket state check above. If client is connected,
-    // it's safe to write to it.
-    
-    qDebug() << "[SERVER] sendMessage: type=" << static_cast<int>(type) << ", client=" << client;
+    qDebug() << "[SERVER] sendMessage: type=" << static_cast<int>(type) << ", connection=" << session.connectionId();
+    writeFrame(session, buildFrame(type, message, metadata));
+}
+
+// buildFrame: wrap a message in an envelope and serialize it as [4-byte length][MessageEnvelope]
+// Touches no socket or server state, so workers call it to serialize off the event loop.
+// Failures are turned into an ErrorResponse frame:
+//   - INTERNAL_ERROR: envelope creation or serialization failed
+//   - MESSAGE_TOO_LARGE: envelope exceeds MAX_MESSAGE_SIZE
+std::string PalantirServer::buildFrame(palantir::MessageType type, const google::protobuf::Message& message,
+                                       const std::map<std::string, std::string>& metadata)
+{
+    BEDROCK_TRACE_SPAN("palantir", "serialize");
+    bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Transport);  // Outbound frame
+    const bool isError = type == palantir::MessageType::ERROR_RESPONSE;  // Never recurse on error frames
     
     // Create envelope from message
     std::string envelopeError;
-    auto envelope = bedrock::palantir::makeEnvelope(type, message, {}, &envelopeError);
-    
+    auto envelope = bedrock::palantir::makeEnvelope(type, message, metadata, &envelopeError);
     if (!envelope.has_value()) {
-        qDebug() << "[SERVER] sendMessage: ERROR - failed to create envelope:" << envelopeError.c_str();
-        sendErrorResponse(client, palantir::ErrorCode::INTERNAL_ERROR, 
-                         QString("Failed to create envelope: %1").arg(envelopeError.c_str()));
-        return;
+        qDebug() << "[SERVER] buildFrame: ERROR - failed to create envelope:" << envelopeError.c_str();
+        return isError ? std::string() : buildErrorFrame(palantir::ErrorCode::INTERNAL_ERROR,
+                                                         QString("Failed to create envelope: %1").arg(envelopeError.c_str()),
+                                                         QString(), metadata);
     }
     
-    qDebug() << "[SERVER] sendMessage: envelope created, version=" << envelope->version() << ", type=" << static_cast<int>(envelope->type());
-    
-    // Serialize envelope
-    std::string serialized;
-    if (!envelope->SerializeToString(&serialized)) {
-        qDebug() << "[SERVER] sendMessage: ERROR - failed to serialize envelope";
-        sendErrorResponse(client, palantir::ErrorCode::INTERNAL_ERROR, 
-                         "Failed to serialize MessageEnvelope");
+    // Serialize into a length-prefixed frame: [4-byte length][serialized MessageEnvelope]
+    // appendFrame sizes the envelope once and reports it, so the limit check costs no extra pass
+    std::string frame;
+    std::string frameError;
+    size_t envelopeSize = 0;
+    if (!bedrock::palantir::appendFrame(*envelope, frame, MAX_MESSAGE_SIZE, &frameError, &envelopeSize)) {
+        if (envelopeSize > MAX_MESSAGE_SIZE) {
+            qDebug() << "[SERVER] buildFrame: ERROR - envelope too large:" << envelopeSize;
+            return isError ? std::string() : buildErrorFrame(palantir::ErrorCode::MESSAGE_TOO_LARGE,
+                                                             QString("Envelope size %1 exceeds limit %2")
+                                                             .arg(envelopeSize).arg(MAX_MESSAGE_SIZE),
+                                                             QString(), metadata);
+        }
+        qDebug() << "[SERVER] buildFrame: ERROR - failed to frame envelope:" << frameError.c_str();
+        return isError ? std::string() : buildErrorFrame(palantir::ErrorCode::INTERNAL_ERROR,
+                                                         "Failed to serialize MessageEnvelope", QString(), metadata);
+    }
+    return frame;
+}
+
+std::string PalantirServer::buildErrorFrame(palantir::ErrorCode errorCode, const QString& message, const QString& details,
+                                            const std::map<std::string, std::string>& metadata)
+{
+    palantir::ErrorResponse error;
+    error.set_error_code(errorCode);
+    error.set_message(message.toStdString());
+    if (!details.isEmpty()) {
+        error.set_details(details.toStdString());
+    }
+    return buildFrame(palantir::MessageType::ERROR_RESPONSE, error, metadata);
+}
+
+// writeFrame: send a serialized frame, keeping replies in request order per connection
+// While earlier pool work on this connection is outstanding, the frame waits in its reply queue
+void PalantirServer::writeFrame(ClientSession& session, std::string frame)
+{
+    if (!session.isOpen() || frame.empty()) {
         return;
     }
     
-    qDebug() << "[SERVER] sendMessage: serialized size=" << serialized.size();
-    
-    // Check size limit
-    if (serialized.size() > MAX_MESSAGE_SIZE) {
-        qDebug() << "[SERVER] sendMessage: ERROR - envelope too large:" << serialized.size();
-        sendErrorResponse(client, palantir::ErrorCode::MESSAGE_TOO_LARGE,
-                         QString("Envelope size %1 exceeds limit %2")
-                         .arg(serialized.size()).arg(MAX_MESSAGE_SIZE));
+    if (session.hasPendingReplies()) {
+        session.queueReply(std::move(frame));
         return;
     }
     
-    // Create length-prefixed message: [4-byte length][serialized MessageEnvelope]
-    QByteArray data;
-    uint32_t totalLength = static_cast<uint32_t>(serialized.size());
+    captureOutbound(session, frame);
+    writeToSocket(session, frame.data(), frame.size(), 1);
+}
+
+// flushReplies: write the ready prefix of a connection's reply queue as a single gathered write
+void PalantirServer::flushReplies(ClientSession& session)
+{
+    uint64_t frames = 0;
+    std::string batch = session.takeReadyReplies([this, &session, &frames](const std::string& frame) {
+        captureOutbound(session, frame);
+        ++frames;
+    });
+    if (!batch.empty()) {
+        writeToSocket(session, batch.data(), batch.size(), frames);
+    }
+}
+
+void PalantirServer::captureOutbound(ClientSession& session, const std::string& frame)
+{
+    captureFrame(session, bedrock::palantir::CaptureKind::Outbound,
+                 frame.data() + bedrock::palantir::FRAME_HEADER_SIZE,
+                 frame.size() - bedrock::palantir::FRAME_HEADER_SIZE);
+}
+
+void PalantirServer::writeToSocket(ClientSession& session, const char* data, size_t size, uint64_t frames)
+{
+    // Threading: This function runs on Qt event loop thread
+    // QLocalSocket operations are safe because we're on the socket's owner thread
+    QLocalSocket* client = session.socket();
+    if (client->state() != QLocalSocket::ConnectedState) {
+        qDebug() << "Attempted to send message to disconnected client";
+        return;
+    }
     
-    // Write length (little-endian, 4 bytes)
-    data.append(reinterpret_cast<const char*>(&totalLength), 4);
-    // Write serialized envelope
-    data.append(serialized.data(), serialized.size());
+    qDebug() << "[SERVER] writeToSocket: writing" << size << "bytes to client";
+    qint64 written;
+    {
+        BEDROCK_TRACE_SPAN("palantir", "write");
+        written = client->write(data, static_cast<qint64>(size));
+    }
     
-    qDebug() << "[SERVER] sendMessage: writing" << data.size() << "bytes to client";
-    // Send data
-    qint64 written = client->write(data);
-    qDebug() << "[SERVER] sendMessage: wrote" << written << "bytes";
+    if (written > 0) {
+        session.stats().bytesSent += static_cast<uint64_t>(written);
+    }
+    session.stats().replies += frames;
     
-    if (written != data.size()) {
-        qDebug() << "[SERVER] sendMessage: ERROR - failed to send complete message (wrote" << written << "of" << data.size() << "bytes)";
+    if (written != static_cast<qint64>(size)) {
+        qDebug() << "[SERVER] writeToSocket: ERROR - failed to send complete message (wrote" << written << "of" << size << "bytes)";
     } else {
-        qDebug() << "[SERVER] sendMessage: SUCCESS - message sent";
+        qDebug() << "[SERVER] writeToSocket: SUCCESS - message sent";
     }
 }
 
@@ -623,8 +832,10 @@ void PalantirServer::sendMessage(QLocalSocket* client, palantir::MessageType typ
 //   - PROTOBUF_PARSE_ERROR: Failed to parse request protobuf
 //   - UNKNOWN_MESSAGE_TYPE: Message type not recognized
 //   - INVALID_PARAMETER_VALUE: Request parameter validation failed (e.g., invalid samples)
-void PalantirServer::sendErrorResponse(QLocalSocket* client, palantir::ErrorCode errorCode, 
-                                       const QString& message, const QString& details)
+//   - TIMEOUT: Request dropped by deadline or supersede (see sendRequestDropped)
+void PalantirServer::sendErrorResponse(ClientSession& session, palantir::ErrorCode errorCode, 
+                                       const QString& message, const QString& details,
+                                       const std::map<std::string, std::string>& metadata)
 {
     palantir::ErrorResponse error;
     error.set_error_code(errorCode);
@@ -632,47 +843,68 @@ void PalantirServer::sendErrorResponse(QLocalSocket* client, palantir::ErrorCode
     if (!details.isEmpty()) {
         error.set_details(details.toStdString());
     }
-    sendMessage(client, palantir::MessageType::ERROR_RESPONSE, error);
+    sendMessage(session, palantir::MessageType::ERROR_RESPONSE, error, metadata);
+}
+
+// sendRequestDropped: reply for work skipped or abandoned because nobody will use it
+// Uses TIMEOUT (no dedicated DEADLINE_EXCEEDED code in error.proto); the precise reason
+// is in the message prefix and in the reply's error_reason metadata
+void PalantirServer::sendRequestDropped(ClientSession& session, const bedrock::palantir::RequestControl& control, const char* reason)
+{
+    writeFrame(session, buildDroppedFrame(control, reason));
+}
+
+std::string PalantirServer::buildDroppedFrame(const bedrock::palantir::RequestControl& control, const char* reason)
+{
+    bool superseded = std::string(reason) == bedrock::palantir::REASON_SUPERSEDED;
+    qDebug() << "[SERVER] dropping request" << control.requestId.c_str() << ":" << reason;
+    return buildErrorFrame(palantir::ErrorCode::TIMEOUT,
+                           QString("%1: %2").arg(reason, superseded ? "Superseded by a newer request"
+                                                                    : "Request deadline passed before completion"),
+                           control.supersedeKey.empty() ? QString()
+                                                        : QString("supersedes=%1").arg(control.supersedeKey.c_str()),
+                           control.replyMetadata(reason));
 }
 
-bool PalantirServer::extractMessage(QByteArray& buffer, palantir::MessageType& outType, QByteArray& outPayload, QString* outError)
+bool PalantirServer::extractMessage(QByteArray& buffer, palantir::MessageType& outType, QByteArray& outPayload, QString* outError,
+                                    std::map<std::string, std::string>* outMetadata)
 {
-    // Need at least 4 bytes for length prefix
-    if (buffer.size() < 4) {
+    // Locate a complete frame (length prefix checked against MAX_MESSAGE_SIZE first,
+    // so oversize messages are rejected before their payload arrives)
+    size_t frameSize = 0;
+    std::string frameError;
+    bedrock::palantir::FrameStatus status;
+    {
+        BEDROCK_TRACE_SPAN("palantir", "frame_extract");
+        status = bedrock::palantir::peekFrame(buffer.constData(), static_cast<size_t>(buffer.size()),
+                                              MAX_MESSAGE_SIZE, frameSize, &frameError);
+    }
+    if (status == bedrock::palantir::FrameStatus::Incomplete) {
         return false; // Incomplete frame, need more data
     }
-    
-    // Read length (little-endian)
-    uint32_t envelopeLength;
-    std::memcpy(&envelopeLength, buffer.data(), 4);
-    
-    // Check size limit before reading payload (fail fast, prevent DoS)
-    // MAX_MESSAGE_SIZE = 10MB - rejects oversize messages immediately
-    if (envelopeLength > MAX_MESSAGE_SIZE) {
+    if (status == bedrock::palantir::FrameStatus::Error) {
         if (outError) {
-            *outError = QString("Envelope length %1 exceeds limit %2")
-                       .arg(envelopeLength).arg(MAX_MESSAGE_SIZE);
+            *outError = QString::fromStdString(frameError);
         }
         buffer.clear(); // Clear buffer to prevent further parsing
         return false; // Hard error
     }
     
-    // Check if we have the complete envelope
-    if (buffer.size() < 4 + envelopeLength) {
-        return false; // Incomplete frame, need more data
-    }
-    
-    // Extract envelope bytes (after length prefix)
-    QByteArray envelopeBytes = buffer.mid(4, envelopeLength);
-    buffer.remove(0, 4 + envelopeLength);
-    
-    // Parse envelope
+    // Parse envelope directly from the receive buffer (no intermediate copy)
     ::palantir::MessageEnvelope envelope;
     std::string parseError;
-    if (!bedrock::palantir::parseEnvelope(
-            std::string(envelopeBytes.data(), envelopeBytes.size()),
+    bool parsed;
+    {
+        BEDROCK_TRACE_SPAN("palantir", "envelope_parse");
+        parsed = bedrock::palantir::parseEnvelope(
+            buffer.constData() + bedrock::palantir::FRAME_HEADER_SIZE,
+            frameSize - bedrock::palantir::FRAME_HEADER_SIZE,
             envelope,
-            &parseError)) {
+            &parseError);
+    }
+    buffer.remove(0, static_cast<qsizetype>(frameSize));
+    
+    if (!parsed) {
         if (outError) {
             *outError = QString("Malformed envelope: %1").arg(parseError.c_str());
         }
@@ -690,133 +922,284 @@ bool PalantirServer::extractMessage(QByteArray& buffer, palantir::MessageType& o
     // Extract type and payload
     outType = envelope.type();
     outPayload = QByteArray(envelope.payload().data(), envelope.payload().size());
+    if (outMetadata) {
+        outMetadata->clear();
+        outMetadata->insert(envelope.metadata().begin(), envelope.metadata().end());
+    }
     
     return true; // Success
 }
 
+// dispatchRequest: RPC boundary - route to the registered handler, which parses and validates
+// Error codes:
+//   - PROTOBUF_PARSE_ERROR: Protobuf deserialization failed (malformed payload)
+//   - INVALID_PARAMETER_VALUE: Handler validates and rejects semantically invalid parameters
+//   - UNKNOWN_MESSAGE_TYPE: No handler registered for the message type
+// Returns true when the reply was deferred to a pool executor
+bool PalantirServer::dispatchRequest(ClientSession& session, palantir::MessageType type, const QByteArray& payload,
+                                     const bedrock::palantir::RequestControl& control)
+{
+    if (type == palantir::MessageType::ERROR_RESPONSE) {
+        qDebug() << "Server received ErrorResponse (unexpected)";
+        return false;
+    }
+    const int handler = features_->find(type);
+    if (handler < 0) {
+        sendErrorResponse(session, palantir::ErrorCode::UNKNOWN_MESSAGE_TYPE,
+                         QString("Unknown message type: %1").arg(static_cast<int>(type)),
+                         QString(), control.replyMetadata());
+        return false;
+    }
+    
+    auto& entry = features_->entry(handler);
+    
+    // Model-backed handlers get the snapshot the request names, pinned while its work runs
+    std::shared_ptr<const bedrock::palantir::ModelSnapshot> model;
+    const auto status = bedrock::palantir::resolveRequestModel(entry.handler, models_, control, model);
+    if (status != bedrock::palantir::ModelStore::Status::Ok) {
+        sendErrorResponse(session, palantir::ErrorCode::INVALID_PARAMETER_VALUE,
+                          QString("Model %1: %2").arg(control.modelRef->handle)
+                          .arg(bedrock::palantir::ModelStore::statusName(status)),
+                          QString(), control.replyMetadata());
+        return false;
+    }
+    std::optional<bedrock::palantir::RequestControl> withModel;
+    if (model) {
+        watchModel(session, *model);
+        withModel = control;
+        withModel->model = std::move(model);
+    }
+    const bedrock::palantir::RequestControl& requestControl = withModel ? *withModel : control;
+    
+    // RPC boundary: the handler parses and validates before any work is scheduled
+    bedrock::palantir::FeaturePlan plan;
+    {
+        bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Protobuf);  // Parsed request
+        plan = entry.handler.prepare(payload.constData(), static_cast<size_t>(payload.size()), requestControl);
+    }
+    if (!plan.work) {
+        qDebug() << "[SERVER] dispatchRequest: rejected type" << static_cast<int>(type) << ":" << plan.rejection.error.c_str();
+        writeFrame(session, buildResultFrame(plan.rejection, requestControl));
+        return false;
+    }
+    if (plan.runInline || entry.handler.executor == bedrock::palantir::ExecutorKind::Inline) {
+        bedrock::palantir::JobUsage usage;
+        writeFrame(session, runMetered(plan.work, requestControl, 0, usage));
+        entry.usage.add(usage);
+        return false;
+    }
+    
+    // Pool executors: the reply comes back through completions_
+    submitToExecutor(session, requestControl, handler, std::move(plan.work));
+    return true;
+}
+
+void PalantirServer::watchModel(ClientSession& session, const bedrock::palantir::ModelSnapshot& snapshot)
+{
+    if (!modelWatches_.insert({session.connectionId(), snapshot.handle}).second) {
+        return;
+    }
+    // The listener runs on whichever thread applied the edit (a client's delta, the engine)
+    auto listener = [this, target = session.weak_from_this()](const bedrock::palantir::ModelChange& change) {
+        transportExecutor_.post([this, target, change]() {
+            if (auto session = target.lock(); session && session->isOpen()) {
+                pushModelChange(*session, change);
+            }
+        });
+    };
+    const auto status = models_.subscribe(session.connectionId(), snapshot.handle, snapshot.version, std::move(listener));
+    if (status != bedrock::palantir::ModelStore::Status::Ok) {
+        modelWatches_.erase({session.connectionId(), snapshot.handle});  // Released meanwhile
+    }
+}
+
+void PalantirServer::pushModelChange(ClientSession& session, const bedrock::palantir::ModelChange& change)
+{
+    // MODEL_CHANGED frame goes here: handle, version, full flag and change.delta
+    qDebug() << "[SERVER] Model" << change.handle << "now at version" << change.version << "for connection"
+             << session.connectionId() << "(" << change.delta.edits.size() << "edits," << (change.full ? "full" : "delta")
+             << ") - no push message in the protocol yet";
+}
+
+// runMetered: the handler's work with its resource usage attached to the reply metadata
+std::string PalantirServer::runMetered(const bedrock::palantir::FeatureWork& work,
+                                       const bedrock::palantir::RequestControl& control, uint64_t submittedNs,
+                                       bedrock::palantir::JobUsage& usage)
+{
+    bedrock::palantir::JobMeter meter(submittedNs);
+    bedrock::palantir::FeatureResult result;
+    {
+        // Handlers tag what they build for the reply as Protobuf themselves
+        bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::ComputeScratch);
+        result = work(control);
+    }
+    usage = meter.finish(result.usage);
+    usage.appendMetadata(result.metadata);
+    return buildResultFrame(result, control);
+}
+
+// buildResultFrame: serialize a handler's result as reply, error or dropped frame (any thread)
+std::string PalantirServer::buildResultFrame(const bedrock::palantir::FeatureResult& result,
+                                             const bedrock::palantir::RequestControl& control)
+{
+    if (result.droppedReason) {
+        return buildDroppedFrame(control, result.droppedReason);
+    }
+    std::map<std::string, std::string> metadata = control.replyMetadata();
+    if (!result.message) {
+        return buildErrorFrame(result.errorCode, QString::fromStdString(result.error),
+                               QString::fromStdString(result.details), metadata);
+    }
+    for (const auto& [key, value] : result.metadata) {
+        metadata.emplace(key, value);
+    }
+    return buildFrame(result.type, *result.message, metadata);
+}
+
 // extractMessage() implements envelope-based protocol only:
 // Wire format: [4-byte length][serialized MessageEnvelope]
 // No legacy [length][type][payload] format support
 #endif // BEDROCK_WITH_TRANSPORT_DEPS
 
-void PalantirServer::parseIncomingData(QLocalSocket* client)
+void PalantirServer::parseIncomingData(ClientSession& session)
 {
-    if (!client) {
-        qDebug() << "[SERVER] parseIncomingData: ERROR - no client";
+    if (!session.isOpen()) {
+        qDebug() << "[SERVER] parseIncomingData: ERROR - session closed";
         return;
     }
     
-    // Read all available data first
-    QByteArray newData = client->readAll();
-    qDebug() << "[SERVER] parseIncomingData: read" << newData.size() << "bytes from client";
+    // Read all available data straight into the session's buffer
+    QByteArray& buffer = session.readBuffer();
+    qint64 bytesRead;
+    {
+        BEDROCK_TRACE_SPAN("palantir", "read");
+        const qsizetype before = buffer.size();
+        buffer += session.socket()->readAll();
+        bytesRead = buffer.size() - before;
+        session.accountReadBuffer();
+    }
+    qDebug() << "[SERVER] parseIncomingData: read" << bytesRead << "bytes from client";
     
-    if (newData.isEmpty()) {
+    if (bytesRead == 0) {
         qDebug() << "[SERVER] parseIncomingData: no data available";
         return;
     }
+    session.stats().bytesReceived += static_cast<uint64_t>(bytesRead);
     
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
     // Parse envelope-based messages
     // Threading: This function runs on Qt event loop thread
-    // Lock scope is narrowed to buffer manipulation only; dispatch happens outside lock
-    // This prevents holding mutex during message dispatch (which may call sendMessage)
-    while (true) {
-        palantir::MessageType messageType;
+    // The buffer belongs to this session alone, so no lock is taken
+    //
+    // All complete frames are drained into a batch first. While a long request runs on
+    // the event loop, newer requests queue up in the socket; seeing them together lets
+    // superseded and expired requests be dropped before any CPU is spent on them.
+    struct IncomingRequest {
+        palantir::MessageType type = palantir::MessageType::MESSAGE_TYPE_UNSPECIFIED;
         QByteArray payload;
-        QString extractError;
+        QString error;
+        bedrock::palantir::RequestControl control;
+    };
+    std::vector<IncomingRequest> batch;
+    const auto receivedAt = bedrock::palantir::RequestControl::Clock::now();
+    const uint64_t receivedNs = bedrock::Tracer::is_enabled() ? bedrock::Tracer::now_ns() : 0;
+    
+    qDebug() << "[SERVER] parseIncomingData: buffer size now=" << buffer.size();
+    
+    while (true) {
+        // Record the raw envelope before extraction consumes it
+        if (capture_) {
+            size_t frameSize = 0;
+            if (bedrock::palantir::peekFrame(buffer.constData(), static_cast<size_t>(buffer.size()),
+                                             MAX_MESSAGE_SIZE, frameSize) == bedrock::palantir::FrameStatus::Complete) {
+                captureFrame(session, bedrock::palantir::CaptureKind::Inbound,
+                             buffer.constData() + bedrock::palantir::FRAME_HEADER_SIZE,
+                             frameSize - bedrock::palantir::FRAME_HEADER_SIZE);
+            }
+        }
         
-        // === CRITICAL SECTION: buffer manipulation only ===
-        // Lock protects clientBuffers_ map during append/extract operations
-        // Released before dispatch to avoid holding lock during handler execution
+        // Extract message from buffer
+        IncomingRequest request;
+        std::map<std::string, std::string> metadata;
+        bool extracted;
         {
-            std::lock_guard<std::mutex> lock(clientBuffersMutex_);
-            auto it = clientBuffers_.find(client);
-            if (it == clientBuffers_.end()) {
-                // Client not found (may have disconnected)
-                qDebug() << "[SERVER] parseIncomingData: ERROR - client not in buffers map";
-                return;
-            }
-            QByteArray& buffer = it->second;
-            
-            // Append new data only once per call
-            if (!newData.isEmpty()) {
-                buffer += newData;
-                newData.clear();
-                qDebug() << "[SERVER] parseIncomingData: buffer size now=" << buffer.size();
-            }
-            
-            // Extract message from buffer (no locking inside extractMessage)
-            qDebug() << "[SERVER] parseIncomingData: attempting to extract message...";
-            if (!extractMessage(buffer, messageType, payload, &extractError)) {
-                // Check if it's a hard error or just incomplete data
-                if (!extractError.isEmpty()) {
-                    // Hard error - will handle outside lock
-                    qDebug() << "[SERVER] parseIncomingData: extractMessage error:" << extractError;
-                } else {
-                    // Incomplete frame - need more data, wait for next readyRead
-                    qDebug() << "[SERVER] parseIncomingData: incomplete message, waiting for more data";
-                }
-                break; // Exit critical section
+            bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Protobuf);  // Envelope and metadata
+            extracted = extractMessage(buffer, request.type, request.payload, &request.error, &metadata);
+        }
+        if (!extracted) {
+            if (request.error.isEmpty()) {
+                // Incomplete frame - need more data, wait for next readyRead
+                qDebug() << "[SERVER] parseIncomingData: incomplete message, waiting for more data";
+                break;
             }
-            
-            qDebug() << "[SERVER] parseIncomingData: extracted message, type=" << static_cast<int>(messageType) << ", payload size=" << payload.size();
+            // Hard error - reported in order with the rest of the batch
+            qDebug() << "[SERVER] parseIncomingData: extractMessage error:" << request.error;
+            ++session.stats().protocolErrors;
+            batch.push_back(std::move(request));
+            continue; // Try to extract next message if available
+        }
+        
+        qDebug() << "[SERVER] parseIncomingData: extracted message, type=" << static_cast<int>(request.type) << ", payload size=" << request.payload.size();
+        request.control = bedrock::palantir::RequestControl::fromMetadata(metadata, receivedAt);
+        request.control.sequence = nextRequestSequence_++;
+        ++session.stats().requests;
+        batch.push_back(std::move(request));
+    }
+    session.accountReadBuffer();  // Extraction consumed the complete frames
+    
+    // Within a batch only the newest request per supersede key survives
+    std::map<std::string, size_t> newestByKey;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch[i].error.isEmpty() && !batch[i].control.supersedeKey.empty()) {
+            newestByKey[batch[i].control.supersedeKey] = i;
         }
-        // === LOCK RELEASED HERE ===
+    }
+    
+    for (size_t i = 0; i < batch.size(); ++i) {
+        IncomingRequest& request = batch[i];
         
-        // Handle extraction errors outside lock
-        if (!extractError.isEmpty()) {
-            if (extractError.contains("exceeds limit")) {
-                sendErrorResponse(client, palantir::ErrorCode::MESSAGE_TOO_LARGE, extractError);
+        // Report extraction errors in order with the replies
+        if (!request.error.isEmpty()) {
+            if (request.error.contains("exceeds limit")) {
+                sendErrorResponse(session, palantir::ErrorCode::MESSAGE_TOO_LARGE, request.error);
             } else {
-                sendErrorResponse(client, palantir::ErrorCode::INVALID_MESSAGE_FORMAT, extractError);
+                sendErrorResponse(session, palantir::ErrorCode::INVALID_MESSAGE_FORMAT, request.error);
             }
-            continue; // Try to extract next message if available
+            continue;
         }
         
-        // === DISPATCH WITHOUT HOLDING MUTEX ===
-        // RPC boundary: Parse protobuf and validate before calling handlers
-        // Error codes:
-        //   - PROTOBUF_PARSE_ERROR: Protobuf deserialization failed (malformed payload)
-        //   - INVALID_PARAMETER_VALUE: Handler validates and rejects semantically invalid parameters
-        switch (messageType) {
-            case palantir::MessageType::CAPABILITIES_REQUEST: {
-                qDebug() << "[SERVER] parseIncomingData: handling CAPABILITIES_REQUEST";
-                palantir::CapabilitiesRequest request;
-                if (request.ParseFromArray(payload.data(), payload.size())) {
-                    qDebug() << "[SERVER] parseIncomingData: parsed CapabilitiesRequest, calling handleCapabilitiesRequest";
-                    handleCapabilitiesRequest(client);
-                    qDebug() << "[SERVER] parseIncomingData: handleCapabilitiesRequest returned";
-                } else {
-                    qDebug() << "[SERVER] parseIncomingData: ERROR - failed to parse CapabilitiesRequest";
-                    sendErrorResponse(client, palantir::ErrorCode::PROTOBUF_PARSE_ERROR,
-                                     "Failed to parse CapabilitiesRequest: malformed protobuf payload");
-                }
-                continue;
-            }
-            case palantir::MessageType::XY_SINE_REQUEST: {
-                palantir::XYSineRequest request;
-                if (request.ParseFromArray(payload.data(), payload.size())) {
-                    // RPC boundary: Validation happens in handleXYSineRequest()
-                    handleXYSineRequest(client, request);
-                } else {
-                    qDebug() << "[SERVER] parseIncomingData: ERROR - failed to parse XYSineRequest";
-                    sendErrorResponse(client, palantir::ErrorCode::PROTOBUF_PARSE_ERROR,
-                                     "Failed to parse XYSineRequest: malformed protobuf payload");
-                }
-                continue;
-            }
-            case palantir::MessageType::ERROR_RESPONSE:
-                qDebug() << "Server received ErrorResponse (unexpected)";
-                continue;
-            default:
-                sendErrorResponse(client, palantir::ErrorCode::UNKNOWN_MESSAGE_TYPE,
-                                 QString("Unknown message type: %1").arg(static_cast<int>(messageType)));
-                continue;
+        // Load seen by this request: pool work queued or running ahead of it
+        if (request.control.reportLoad) {
+            request.control.serverLoad = pendingPoolWork_;
+            request.control.serverWorkers = maxConcurrency_;
+        }
+        
+        // Drop stale work before spending CPU on it
+        const auto& control = request.control;
+        if (!control.supersedeKey.empty() && newestByKey[control.supersedeKey] != i) {
+            ++session.stats().dropped;
+            sendRequestDropped(session, control, bedrock::palantir::REASON_SUPERSEDED);
+            continue;
+        }
+        if (control.expired()) {
+            ++session.stats().dropped;
+            sendRequestDropped(session, control, bedrock::palantir::REASON_DEADLINE_EXCEEDED);
+            continue;
+        }
+        
+        if (receivedNs != 0) {
+            bedrock::Tracer::record("palantir", "queue_wait", receivedNs, bedrock::Tracer::now_ns(), control.sequence);
+        }
+        bedrock::TraceSpan handleSpan("palantir", "handle", control.sequence);
+        session.beginRequest(control);
+        if (!dispatchRequest(session, request.type, request.payload, control)) {
+            session.endRequest(control);  // Deferred requests end in drainCompletions()
         }
     }
 #else
     // Transport deps disabled - envelope-based transport not available
     qDebug() << "Transport deps disabled - cannot process envelope-based messages";
+    buffer.clear();
 #endif
 }
 
@@ -6,25 +6,53 @@
 #include <QObject>
 #include <QByteArray>
 #include <QString>
+#include <QThreadPool>
+#include <functional>
 #include <memory>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <optional>
 
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
 #include "palantir/capabilities.pb.h"
 #include "palantir/xysine.pb.h"
 #include "palantir/envelope.pb.h"
 #include "palantir/error.pb.h"
-#include "CapabilitiesService.hpp"
 #endif
 
+#include "bedrock/thread_budget.hpp"
+
+#include "CapabilitiesService.hpp"
+#include "ClientSession.hpp"
+#include "CompletionQueue.hpp"
+#include "FeatureRegistry.hpp"
+#include "JobUsage.hpp"
+#include "ModelStore.hpp"
+#include "RequestControl.hpp"
+#include "TrafficCapture.hpp"
+
+namespace bedrock::palantir {
+class FeatureRegistry;
+}
+
 // PalantirServer: Qt-based IPC server for Palantir protocol
-// Threading: All operations run on Qt's event loop thread (main thread)
-// - Socket I/O, message parsing, and request handling execute synchronously on event loop thread
-// - Worker thread infrastructure exists but is currently disabled (commented out)
-// - Mutexes protect shared data structures for future multi-threading support
+// Threading: event loop thread for I/O and dispatch, worker pools for compute
+// - Socket I/O, frame parsing, prepare() (parse/validate) and all session, registry and
+//   gate state stay on Qt's event loop thread
+// - Per-connection state (read buffer, reply queue, in-flight requests, stats) lives in a
+//   ClientSession bound to the socket's signal connections
+// - Requests are routed through a FeatureRegistry; each handler names its executor and
+//   concurrency limit. Inline handlers (and small requests) run and reply on the event
+//   loop; ComputePool/LongJob work runs on computePool_/longJobPool_, which also
+//   serialize the reply frame. Workers push finished frames onto a lock-free completion
+//   queue (completions_); the event loop thread drains it and writes them in request order
+// - transportExecutor_ resumes coroutine continuations on the event loop thread
+// - The legacy StartJob path (jobThreads_, guarded by jobMutex_) is commented out; no job
+//   threads are started
 // See docs/THREADING.md for detailed threading model documentation
 class PalantirServer : public QObject
 {
@@ -42,6 +70,31 @@ public:
     int maxConcurrency() const;
     QStringList supportedFeatures() const;
 
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    // Adds a request handler (before startServer()); its feature is advertised in capabilities.
+    // Returns false if the request type is already handled.
+    bool registerHandler(bedrock::palantir::FeatureHandler handler);
+#endif
+
+    // Tuning profile (bedrock::TuningProfile) loaded by startServer(); defaults to
+    // TuningProfile::default_path(). A missing or stale profile leaves kernels on their defaults.
+    void setTuningProfilePath(const QString& path);
+
+    // Traffic capture (opt-in): records every framed envelope with timestamp and
+    // connection id to a binary log that bedrock_replay can play back
+    bool startCapture(const QString& path);
+    void stopCapture();
+    bool isCapturing() const;
+
+    // Executor for coroutine stages that must run on the event loop thread
+    // (replies, session state): co_await bedrock::resume_on(server.transportExecutor())
+    bedrock::Executor& transportExecutor() { return transportExecutor_; }
+
+    // Server-resident models. An embedding host publishes its Engine's SOM here
+    // (EngineModelBridge); connections that read a model are told about its new
+    // versions. Stop publishing before the server is destroyed.
+    bedrock::palantir::ModelStore& modelStore() { return models_; }
+
 signals:
     void clientConnected();
     void clientDisconnected();
@@ -49,21 +102,37 @@ signals:
 
 private slots:
     void onNewConnection();
-    void onClientDisconnected();
-    void onClientReadyRead();
     void onHeartbeatTimer();
 
 private:
+    using ClientSession = bedrock::palantir::ClientSession;
+    
+    // Connection events (wired per socket in onNewConnection)
+    void onClientDisconnected(ClientSession& session);
+    void onClientReadyRead(ClientSession& session);
+    
     // Message handling (envelope-based protocol only)
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
-    void handleCapabilitiesRequest(QLocalSocket* client);
-    void handleXYSineRequest(QLocalSocket* client, const palantir::XYSineRequest& request);
-    void computeXYSine(const palantir::XYSineRequest& request, std::vector<double>& xValues, std::vector<double>& yValues);
+    // dispatchRequest returns true when the reply was deferred to a pool executor
+    bool dispatchRequest(ClientSession& session, palantir::MessageType type, const QByteArray& payload,
+                         const bedrock::palantir::RequestControl& control);
+    void registerBuiltinHandlers();
+    bedrock::palantir::FeatureResult capabilitiesResult();
+    // Runs a handler's work under a JobMeter and serializes the reply with its usage (any thread)
+    static std::string runMetered(const bedrock::palantir::FeatureWork& work, const bedrock::palantir::RequestControl& control,
+                                  uint64_t submittedNs, bedrock::palantir::JobUsage& usage);
+    void logUsageSummary() const;
+    // Subscribes the connection to version changes of a model it read (once per model)
+    void watchModel(ClientSession& session, const bedrock::palantir::ModelSnapshot& snapshot);
+    // Push hook for a model's new version (event loop thread): the wire protocol has no
+    // model-change message yet; build and write that frame here once envelope.proto has one
+    void pushModelChange(ClientSession& session, const bedrock::palantir::ModelChange& change);
 #endif
+    void loadTuningProfile();
     // Future: Add StartJob, Cancel, Ping handlers when proto messages are defined
-    // void handleStartJob(QLocalSocket* client, const palantir::StartJob& startJob);
-    // void handleCancel(QLocalSocket* client, const palantir::Cancel& cancel);
-    // void handlePing(QLocalSocket* client);
+    // void handleStartJob(ClientSession& session, const palantir::StartJob& startJob);
+    // void handleCancel(ClientSession& session, const palantir::Cancel& cancel);
+    // void handlePing(ClientSession& session);
     
     // Job processing (disabled - proto messages not yet defined)
     // Future: Re-enable when ComputeSpec, ResultMeta, etc. are defined
@@ -72,39 +141,77 @@ private:
     // void sendResult(const QString& jobId, const palantir::ResultMeta& meta);
     // void sendDataChunk(const QString& jobId, const QByteArray& data, int chunkIndex, int totalChunks);
     
-    // XY Sine computation (implemented via handleXYSineRequest)
-    // void computeXYSine(const palantir::ComputeSpec& spec, std::vector<double>& xValues, std::vector<double>& yValues);
-    
     // Protocol helpers
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
-    void sendMessage(QLocalSocket* client, palantir::MessageType type, const google::protobuf::Message& message);
-    void sendErrorResponse(QLocalSocket* client, palantir::ErrorCode errorCode, const QString& message, const QString& details = QString());
+    void sendMessage(ClientSession& session, palantir::MessageType type, const google::protobuf::Message& message,
+                     const std::map<std::string, std::string>& metadata = {});
+    void sendErrorResponse(ClientSession& session, palantir::ErrorCode errorCode, const QString& message, const QString& details = QString(),
+                           const std::map<std::string, std::string>& metadata = {});
+    // Reply to a request dropped by its deadline or a superseding request (TIMEOUT + error_reason metadata)
+    void sendRequestDropped(ClientSession& session, const bedrock::palantir::RequestControl& control, const char* reason);
+    // Frame builders: no socket or server state, safe on worker threads
+    static std::string buildFrame(palantir::MessageType type, const google::protobuf::Message& message,
+                                  const std::map<std::string, std::string>& metadata = {});
+    static std::string buildErrorFrame(palantir::ErrorCode errorCode, const QString& message, const QString& details,
+                                       const std::map<std::string, std::string>& metadata);
+    static std::string buildDroppedFrame(const bedrock::palantir::RequestControl& control, const char* reason);
+    static std::string buildResultFrame(const bedrock::palantir::FeatureResult& result,
+                                        const bedrock::palantir::RequestControl& control);
     // extractMessage() implements envelope-based protocol only:
     // Wire format: [4-byte length][serialized MessageEnvelope]
     // No legacy [length][type][payload] format support
-    bool extractMessage(QByteArray& buffer, palantir::MessageType& outType, QByteArray& outPayload, QString* outError = nullptr);
+    bool extractMessage(QByteArray& buffer, palantir::MessageType& outType, QByteArray& outPayload, QString* outError = nullptr,
+                        std::map<std::string, std::string>* outMetadata = nullptr);
+#endif
+    void parseIncomingData(ClientSession& session);
+    
+    // Reply delivery (event loop thread)
+    // Replies leave each connection in request order: while pool work is outstanding,
+    // later replies wait in that session's reply queue
+    struct Completion {
+        std::weak_ptr<ClientSession> session;   // Expired once the client is gone
+        std::shared_ptr<bedrock::palantir::PendingReply> slot;  // Reserved when the work was submitted
+        std::string frame;                      // Serialized reply, built on the worker
+        bedrock::palantir::RequestControl control;
+        int handler = -1;                       // Registry index, releases its concurrency slot
+        std::optional<bedrock::palantir::JobUsage> usage;  // Unset when the work was skipped
+    };
+    void writeFrame(ClientSession& session, std::string frame);
+    void flushReplies(ClientSession& session);
+    void captureOutbound(ClientSession& session, const std::string& frame);
+    // frames: replies contained in [data, data + size), counted in the session stats
+    void writeToSocket(ClientSession& session, const char* data, size_t size, uint64_t frames);
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    void submitToExecutor(ClientSession& session, const bedrock::palantir::RequestControl& control, int handler,
+                          bedrock::palantir::FeatureWork work);
 #endif
-    void parseIncomingData(QLocalSocket* client);
+    void drainCompletions(bedrock::palantir::CompletionQueue<Completion>& queue);
+    
+    // Capture helper (no-op unless startCapture() succeeded)
+    void captureFrame(ClientSession& session, bedrock::palantir::CaptureKind kind, const char* data, size_t size);
     
     // Constants
     static constexpr uint32_t MAX_MESSAGE_SIZE = 10 * 1024 * 1024; // 10MB
+    static_assert(MAX_MESSAGE_SIZE + 4 <= bedrock::palantir::CAPTURE_MAX_RECORD_SIZE,
+                  "capture readers must accept every envelope the server frames");
     
     // Server state
     std::unique_ptr<QLocalServer> server_;
     QTimer heartbeatTimer_;
     std::atomic<bool> running_;
     
-    // Client management (thread-safe access required)
-    // clientBuffersMutex_ protects clientBuffers_ map
-    // Invariant: When locked, clientBuffers_ map is in consistent state
-    // Currently all accesses are from event loop thread, but mutex provides:
-    // - Future-proofing for worker threads
-    // - Defensive programming
-    // - Clear documentation of shared data
-    std::map<QLocalSocket*, QByteArray> clientBuffers_;
-    std::mutex clientBuffersMutex_;  // Protects clientBuffers_ access
+    // Client sessions, event loop thread only
+    // Touched on connect, disconnect and stop; request handling reaches its session
+    // through the socket's signal connection instead of looking it up here
+    std::unordered_map<QLocalSocket*, std::shared_ptr<ClientSession>> sessions_;
+    
+    // Server-resident SOM models, owned by the uploading connection (released on disconnect)
+    bedrock::palantir::ModelStore models_;
+    // (connection id, model handle) pairs subscribed by watchModel(), event loop thread only
+    std::set<std::pair<uint32_t, uint64_t>> modelWatches_;
     
-    std::map<QString, QLocalSocket*> jobClients_;
+    // Job id -> owning session (the session also lists its job ids for disconnect cleanup)
+    std::map<QString, std::weak_ptr<ClientSession>> jobClients_;
     
     // Job tracking (disabled - proto messages not yet defined)
     // std::map<QString, palantir::ComputeSpec> activeJobs_;
@@ -120,10 +227,39 @@ private:
     std::map<QString, std::thread> jobThreads_;
     std::mutex jobMutex_;  // Protects jobClients_, jobCancelled_, jobThreads_
     
+    // Request sequence numbers (trace span ids), event loop thread only
+    uint64_t nextRequestSequence_ = 1;
+    
+    // Traffic capture
+    // Connection ids are assigned on accept and kept in the session
+    std::unique_ptr<bedrock::palantir::TrafficCaptureWriter> capture_;
+    uint32_t nextConnectionId_ = 1;
+    
+    // Request handlers by message type, with per-handler concurrency gates and usage totals
+    // (event loop thread only)
+    std::unique_ptr<bedrock::palantir::FeatureRegistry> features_;
+    
     // Capabilities
     int maxConcurrency_;
-    QStringList supportedFeatures_;
+    bedrock::palantir::CapabilitiesService capabilities_;  // Cached response; load added per request
     QString protocolVersion_;
+    
+    // Worker -> event loop handoff
+    // Workers touch only completions_ (lock-free); reply queues live in the sessions
+    // Declared before computePool_ so the pool is drained before the queue is destroyed
+    bedrock::palantir::CompletionQueue<Completion> completions_;
+    bedrock::palantir::EventLoopExecutor transportExecutor_;  // Coroutine continuations onto the event loop
+    QThreadPool computePool_;
+    QThreadPool longJobPool_;  // LongJob handlers: separate threads so long analyses cannot starve computePool_
+    // Cores divided among the jobs running on both pools: each job's parallel loops and
+    // OpenMP regions run within its ThreadBudget instead of fanning out to every core
+    bedrock::CoreAllocator cores_;
+    int pendingPoolWork_ = 0;  // Submitted (or gated) but not yet drained (event loop thread only)
+    // Load signals (capabilities replies): pool work waiting to start (gated or queued in a
+    // pool) and pool work executing now; disjoint, so the two counts never overlap
+    std::atomic<int> queuedPoolWork_{0};
+    std::atomic<int> runningPoolWork_{0};
+    std::string tuningProfilePath_;
 };
 
 
@@ -0,0 +1,105 @@
+#include "RequestControl.hpp"
+
+#include <charconv>
+
+namespace bedrock::palantir {
+
+namespace {
+
+bool parseInt64(const std::string& text, int64_t& out)
+{
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+bool parseUint64(const std::string& text, uint64_t& out)
+{
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+// base + ms for ms >= 0, saturating at the clock's maximum (INT64_MAX means "no deadline"
+// to some clients; the plain sum overflows the nanosecond count)
+RequestControl::Clock::time_point addMillis(RequestControl::Clock::time_point base, int64_t ms)
+{
+    using Clock = RequestControl::Clock;
+    const int64_t headroomMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::time_point::max() - base).count();
+    return ms >= headroomMs ? Clock::time_point::max() : base + std::chrono::milliseconds(ms);
+}
+
+} // namespace
+
+std::optional<ModelRef> ModelRef::fromMetadata(const std::map<std::string, std::string>& metadata)
+{
+    auto handleIt = metadata.find(META_SOM_HANDLE);
+    ModelRef ref;
+    if (handleIt == metadata.end() || !parseUint64(handleIt->second, ref.handle) || ref.handle == 0) {
+        return std::nullopt;
+    }
+    uint64_t version = 0;
+    if (auto it = metadata.find(META_SOM_VERSION); it != metadata.end() && parseUint64(it->second, version)) {
+        ref.version = version;
+    }
+    return ref;
+}
+
+RequestControl RequestControl::fromMetadata(const std::map<std::string, std::string>& metadata,
+                                            Clock::time_point receivedAt)
+{
+    RequestControl control;
+
+    if (auto it = metadata.find(META_REQUEST_ID); it != metadata.end()) {
+        control.requestId = it->second;
+    }
+    if (auto it = metadata.find(META_SUPERSEDES); it != metadata.end()) {
+        control.supersedeKey = it->second;
+    }
+    control.reportLoad = metadata.count(META_REPORT_LOAD) != 0;
+    control.modelRef = ModelRef::fromMetadata(metadata);
+
+    auto tighten = [&control](Clock::time_point candidate) {
+        if (!control.hasDeadline || candidate < control.deadline) {
+            control.deadline = candidate;
+            control.hasDeadline = true;
+        }
+    };
+
+    int64_t value = 0;
+    if (auto it = metadata.find(META_TIMEOUT_MS); it != metadata.end() && parseInt64(it->second, value) && value >= 0) {
+        tighten(addMillis(receivedAt, value));
+    }
+    if (auto it = metadata.find(META_DEADLINE_MS); it != metadata.end() && parseInt64(it->second, value)) {
+        // Map the wall-clock deadline onto the steady clock (client and server share a host)
+        int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        auto now = Clock::now();
+        tighten(value <= nowMs ? now : addMillis(now, value - nowMs));  // value - nowMs cannot overflow here
+    }
+
+    return control;
+}
+
+std::map<std::string, std::string> RequestControl::replyMetadata() const
+{
+    std::map<std::string, std::string> metadata;
+    if (!requestId.empty()) {
+        metadata[META_REQUEST_ID] = requestId;
+    }
+    if (reportLoad && serverLoad >= 0) {
+        metadata[META_SERVER_LOAD] = std::to_string(serverLoad);
+        metadata[META_SERVER_WORKERS] = std::to_string(serverWorkers);
+    }
+    return metadata;
+}
+
+std::map<std::string, std::string> RequestControl::replyMetadata(const char* errorReason) const
+{
+    auto metadata = replyMetadata();
+    metadata[META_ERROR_REASON] = errorReason;
+    return metadata;
+}
+
+} // namespace bedrock::palantir
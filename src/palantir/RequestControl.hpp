@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace bedrock::palantir {
+
+// Envelope metadata keys for request lifetime control (client -> server)
+//   request_id:  opaque client id, echoed back in the reply envelope metadata
+//   deadline_ms: absolute deadline, Unix epoch milliseconds
+//   timeout_ms:  deadline relative to server receipt, milliseconds (replay-friendly)
+//   supersedes:  supersede key; a newer request with the same key on the same
+//                connection replaces any older one that has not completed
+//   report_load: any value; the reply carries server_load/server_workers (used by
+//                client-side load balancing across several servers)
+static constexpr const char* META_REQUEST_ID = "request_id";
+static constexpr const char* META_DEADLINE_MS = "deadline_ms";
+static constexpr const char* META_TIMEOUT_MS = "timeout_ms";
+static constexpr const char* META_SUPERSEDES = "supersedes";
+static constexpr const char* META_REPORT_LOAD = "report_load";
+
+// Envelope metadata keys referencing a server-resident model (client -> server)
+//   som_handle:  handle returned when the model was uploaded (any connection may read it)
+//   som_version: version the client computed against; the request fails if the
+//                server's model has moved on (omit to use the latest version)
+// Replies of model-backed handlers echo both, naming the version actually used.
+static constexpr const char* META_SOM_HANDLE = "som_handle";
+static constexpr const char* META_SOM_VERSION = "som_version";
+
+// Reply metadata key set when a request was dropped (server -> client)
+//   error_reason: "DEADLINE_EXCEEDED" or "SUPERSEDED"
+static constexpr const char* META_ERROR_REASON = "error_reason";
+static constexpr const char* REASON_DEADLINE_EXCEEDED = "DEADLINE_EXCEEDED";
+static constexpr const char* REASON_SUPERSEDED = "SUPERSEDED";
+
+// Reply metadata keys when the request asked for report_load (server -> client)
+//   server_load:    requests outstanding on the server when this one was dispatched
+//   server_workers: compute workers the server runs
+static constexpr const char* META_SERVER_LOAD = "server_load";
+static constexpr const char* META_SERVER_WORKERS = "server_workers";
+
+// Shared flag set when a newer request supersedes this one or its client goes away
+using CancelToken = std::shared_ptr<std::atomic<bool>>;
+
+// ModelRef: model reference carried by a request's metadata
+struct ModelRef {
+    uint64_t handle = 0;
+    std::optional<uint64_t> version;
+
+    // Returns nullopt when no (or a malformed) som_handle is present
+    static std::optional<ModelRef> fromMetadata(const std::map<std::string, std::string>& metadata);
+};
+
+struct ModelSnapshot;  // ModelStore.hpp
+
+// RequestControl: deadline, supersede key and cancellation for one request
+// Built from envelope metadata on receipt; compute code polls shouldStop()
+// at coarse intervals to abandon work nobody will look at.
+struct RequestControl {
+    using Clock = std::chrono::steady_clock;
+
+    std::string requestId;
+    std::string supersedeKey;
+    uint64_t sequence = 0;  // Server-assigned, correlates trace spans
+    bool hasDeadline = false;
+    Clock::time_point deadline{};
+    CancelToken cancelled = std::make_shared<std::atomic<bool>>(false);
+    bool reportLoad = false;
+    int serverLoad = -1;    // Filled in by the server at dispatch when reportLoad is set
+    int serverWorkers = 0;
+    std::optional<ModelRef> modelRef;
+    // Filled in by the server at dispatch for model-backed handlers; pins that version
+    // for as long as the request's work holds this control
+    std::shared_ptr<const ModelSnapshot> model;
+
+    // Parse control keys; malformed values are ignored (request runs without that control)
+    static RequestControl fromMetadata(const std::map<std::string, std::string>& metadata,
+                                       Clock::time_point receivedAt = Clock::now());
+
+    bool expired(Clock::time_point now = Clock::now()) const {
+        return hasDeadline && now >= deadline;
+    }
+    bool isCancelled() const {
+        return cancelled->load(std::memory_order_relaxed);
+    }
+    bool shouldStop() const {
+        return isCancelled() || expired();
+    }
+    void cancel() const {
+        cancelled->store(true, std::memory_order_relaxed);
+    }
+
+    // Metadata for the reply envelope (echoes request_id, adds load when requested)
+    std::map<std::string, std::string> replyMetadata() const;
+    std::map<std::string, std::string> replyMetadata(const char* errorReason) const;
+};
+
+} // namespace bedrock::palantir
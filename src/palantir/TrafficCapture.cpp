@@ -0,0 +1,161 @@
+#include "TrafficCapture.hpp"
+
+#include <cstring>
+
+namespace bedrock::palantir {
+
+namespace {
+
+constexpr size_t RECORD_HEADER_SIZE = 20;
+constexpr size_t STREAM_BUFFER_SIZE = 1 << 20;  // Keep capture off the syscall path
+
+template <typename T>
+void putLE(char* dst, T value)
+{
+    std::memcpy(dst, &value, sizeof(T));  // little-endian hosts only
+}
+
+template <typename T>
+T getLE(const char* src)
+{
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+TrafficCaptureWriter::~TrafficCaptureWriter()
+{
+    close();
+}
+
+bool TrafficCaptureWriter::open(const std::string& path, std::string* outError)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.close();
+    }
+
+    streamBuffer_.resize(STREAM_BUFFER_SIZE);
+    out_.rdbuf()->pubsetbuf(streamBuffer_.data(), static_cast<std::streamsize>(streamBuffer_.size()));
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        if (outError) {
+            *outError = "Failed to open capture file: " + path;
+        }
+        return false;
+    }
+
+    start_ = std::chrono::steady_clock::now();
+    uint64_t startUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    char header[24];
+    std::memcpy(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    putLE<uint32_t>(header + 8, CAPTURE_FORMAT_VERSION);
+    putLE<uint32_t>(header + 12, 0);
+    putLE<uint64_t>(header + 16, startUs);
+    out_.write(header, sizeof(header));
+    recordCount_ = 0;
+    return static_cast<bool>(out_);
+}
+
+void TrafficCaptureWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.flush();
+        out_.close();
+    }
+}
+
+bool TrafficCaptureWriter::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return out_.is_open();
+}
+
+uint64_t TrafficCaptureWriter::recordCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return recordCount_;
+}
+
+void TrafficCaptureWriter::record(uint32_t connectionId, CaptureKind kind, const char* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!out_.is_open()) {
+        return;
+    }
+
+    // Stamp under the lock so records land in the file in timestamp order
+    auto now = std::chrono::steady_clock::now();
+
+    char header[RECORD_HEADER_SIZE] = {};
+    putLE<uint64_t>(header, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count()));
+    putLE<uint32_t>(header + 8, connectionId);
+    header[12] = static_cast<char>(kind);
+    putLE<uint32_t>(header + 16, static_cast<uint32_t>(size));
+    out_.write(header, sizeof(header));
+    if (size > 0) {
+        out_.write(data, static_cast<std::streamsize>(size));
+    }
+    ++recordCount_;
+}
+
+bool TrafficCaptureReader::open(const std::string& path, std::string* outError)
+{
+    in_.open(path, std::ios::binary);
+    if (!in_.is_open()) {
+        if (outError) {
+            *outError = "Failed to open capture file: " + path;
+        }
+        return false;
+    }
+
+    char header[24];
+    if (!in_.read(header, sizeof(header)) ||
+        std::memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+        if (outError) {
+            *outError = "Not a Bedrock capture file: " + path;
+        }
+        return false;
+    }
+
+    uint32_t version = getLE<uint32_t>(header + 8);
+    if (version != CAPTURE_FORMAT_VERSION) {
+        if (outError) {
+            *outError = "Unsupported capture format version: " + std::to_string(version);
+        }
+        return false;
+    }
+
+    captureStartUs_ = getLE<uint64_t>(header + 16);
+    return true;
+}
+
+bool TrafficCaptureReader::next(CaptureRecord& outRecord)
+{
+    char header[RECORD_HEADER_SIZE];
+    if (!in_.read(header, sizeof(header))) {
+        return false;
+    }
+
+    outRecord.timestampUs = getLE<uint64_t>(header);
+    outRecord.connectionId = getLE<uint32_t>(header + 8);
+    outRecord.kind = static_cast<CaptureKind>(static_cast<uint8_t>(header[12]));
+    uint32_t length = getLE<uint32_t>(header + 16);
+    if (length > CAPTURE_MAX_RECORD_SIZE) {
+        return false;  // Corrupt length; do not allocate for it
+    }
+
+    outRecord.envelope.resize(length);
+    if (length > 0 && !in_.read(outRecord.envelope.data(), length)) {
+        return false;  // Truncated record (e.g. server killed mid-write)
+    }
+    return true;
+}
+
+} // namespace bedrock::palantir
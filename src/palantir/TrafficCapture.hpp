@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bedrock::palantir {
+
+// Traffic capture log for performance reproduction
+//
+// File layout (little-endian):
+//   Header:  [8-byte magic "BRCAPLOG"][uint32 format version][uint32 reserved][uint64 capture start, µs since epoch]
+//   Records: [uint64 µs since capture start][uint32 connection id][uint8 kind][3 bytes reserved][uint32 length][length bytes]
+//
+// Inbound/Outbound records hold one serialized MessageEnvelope (the frame without its
+// 4-byte length prefix). Connect/Disconnect records have no body.
+
+static constexpr char CAPTURE_MAGIC[8] = {'B', 'R', 'C', 'A', 'P', 'L', 'O', 'G'};
+static constexpr uint32_t CAPTURE_FORMAT_VERSION = 1;
+// Largest record body a reader accepts: PalantirServer::MAX_MESSAGE_SIZE plus the 4-byte
+// frame header. A longer length field means a corrupt log, not a record to allocate for.
+static constexpr uint32_t CAPTURE_MAX_RECORD_SIZE = 10 * 1024 * 1024 + 4;
+
+enum class CaptureKind : uint8_t {
+    Inbound = 0,     // Client -> server envelope
+    Outbound = 1,    // Server -> client envelope
+    Connect = 2,
+    Disconnect = 3
+};
+
+struct CaptureRecord {
+    uint64_t timestampUs = 0;  // Relative to capture start
+    uint32_t connectionId = 0;
+    CaptureKind kind = CaptureKind::Inbound;
+    std::string envelope;      // Empty for Connect/Disconnect
+};
+
+// TrafficCaptureWriter: appends records to a capture log
+// Thread-safety: all members may be called from any thread (serialized by an internal mutex)
+class TrafficCaptureWriter {
+public:
+    TrafficCaptureWriter() = default;
+    ~TrafficCaptureWriter();
+
+    TrafficCaptureWriter(const TrafficCaptureWriter&) = delete;
+    TrafficCaptureWriter& operator=(const TrafficCaptureWriter&) = delete;
+
+    // Create (truncate) the log and write its header
+    bool open(const std::string& path, std::string* outError = nullptr);
+    void close();
+    bool isOpen() const;
+
+    // Append one record timestamped now (timestamps are non-decreasing in file order)
+    void record(uint32_t connectionId, CaptureKind kind, const char* data = nullptr, size_t size = 0);
+
+    uint64_t recordCount() const;
+
+private:
+    std::ofstream out_;
+    std::vector<char> streamBuffer_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t recordCount_ = 0;
+    mutable std::mutex mutex_;
+};
+
+// TrafficCaptureReader: sequential reader for a capture log
+class TrafficCaptureReader {
+public:
+    bool open(const std::string& path, std::string* outError = nullptr);
+
+    // Read the next record; returns false at end of file, on a truncated record or on a
+    // length above CAPTURE_MAX_RECORD_SIZE
+    bool next(CaptureRecord& outRecord);
+
+    // Wall-clock start of the capture (µs since epoch)
+    uint64_t captureStartUs() const { return captureStartUs_; }
+
+private:
+    std::ifstream in_;
+    uint64_t captureStartUs_ = 0;
+};
+
+} // namespace bedrock::palantir
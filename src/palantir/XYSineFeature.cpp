@@ -0,0 +1,167 @@
+#include "XYSineFeature.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include "ModelStore.hpp"
+
+#include "bedrock/memory_tracking.hpp"
+#include "bedrock/profiler.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/trace.hpp"
+#include "bedrock/tuning_profile.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <string>
+
+namespace bedrock::palantir {
+
+namespace {
+
+// Validation rules (enforced at the RPC boundary before compute logic):
+//   - samples: Must be >= 2 and <= 10,000,000 (DoS prevention)
+//   - frequency: Must be finite (no NaN/Inf), default 1.0 if 0.0
+//   - amplitude: Must be finite (no NaN/Inf), default 1.0 if 0.0
+//   - phase: Must be finite (no NaN/Inf), 0.0 is valid default
+// Error codes:
+//   - INVALID_PARAMETER_VALUE: Semantically invalid parameters (out of range, non-finite)
+//   - PROTOBUF_PARSE_ERROR: Malformed payload (rejected by parseAs before this runs)
+//   - TIMEOUT (error_reason metadata): Deadline passed or request superseded during compute
+FeaturePlan prepareXYSine(const ::palantir::XYSineRequest& request, const RequestControl&)
+{
+    // Note: proto3 provides default values (0.0 for double, 0 for int32)
+    // We apply defaults and validate before calling compute logic
+    const int samples = request.samples() != 0 ? request.samples() : 1000;
+    if (samples < 2 || samples > 10000000) {  // 10M samples max (reasonable limit)
+        return FeaturePlan::reject(FeatureResult::failure(
+            ::palantir::ErrorCode::INVALID_PARAMETER_VALUE,
+            "Samples must be between 2 and 10,000,000 (got " + std::to_string(samples) + ")",
+            "Received samples=" + std::to_string(samples)));
+    }
+
+    const double frequency = request.frequency() != 0.0 ? request.frequency() : 1.0;
+    const double amplitude = request.amplitude() != 0.0 ? request.amplitude() : 1.0;
+    const double phase = request.phase();  // 0.0 is valid default
+    if (!std::isfinite(frequency) || !std::isfinite(amplitude) || !std::isfinite(phase)) {
+        return FeaturePlan::reject(FeatureResult::failure(
+            ::palantir::ErrorCode::INVALID_PARAMETER_VALUE,
+            "Frequency, amplitude, and phase must be finite numbers",
+            "frequency=" + std::to_string(frequency) + ", amplitude=" + std::to_string(amplitude) +
+                ", phase=" + std::to_string(phase)));
+    }
+
+    auto work = [request](const RequestControl& control) {
+        // Abandoned cooperatively if the deadline passes or a newer request supersedes it
+        // (sample vectors are charged to the server's ComputeScratch tag, the response to Protobuf)
+        std::vector<double> xValues, yValues;
+        bool completed;
+        {
+            BEDROCK_TRACE_SPAN("palantir", "compute");
+            completed = computeXYSine(request, xValues, yValues, &control);
+        }
+        if (!completed) {
+            return FeatureResult::dropped(control.isCancelled() ? REASON_SUPERSEDED : REASON_DEADLINE_EXCEEDED);
+        }
+
+        bedrock::MemoryTagScope memoryTag(bedrock::MemorySubsystem::Protobuf);
+        auto response = std::make_shared<::palantir::XYSineResponse>();
+        response->mutable_x()->Reserve(static_cast<int>(xValues.size()));
+        response->mutable_y()->Reserve(static_cast<int>(yValues.size()));
+        for (double x : xValues) {
+            response->add_x(x);
+        }
+        for (double y : yValues) {
+            response->add_y(y);
+        }
+        response->set_status("OK");
+
+        // Peak is reached here: both sample vectors and the response are alive
+        JobUsage usage;
+        usage.items = xValues.size();
+        usage.peakBytes = (xValues.capacity() + yValues.capacity()) * sizeof(double) + response->SpaceUsedLong();
+        FeatureResult result = FeatureResult::reply(::palantir::MessageType::XY_SINE_RESPONSE, std::move(response));
+        result.usage = usage;
+        return result;
+    };
+    return FeaturePlan::run(std::move(work), samples < XY_SINE_OFFLOAD_THRESHOLD);
+}
+
+} // namespace
+
+FeatureHandler makeXYSineHandler(int maxConcurrent)
+{
+    FeatureHandler handler;
+    handler.feature = "xy_sine";
+    handler.requestType = ::palantir::MessageType::XY_SINE_REQUEST;
+    handler.executor = ExecutorKind::ComputePool;
+    handler.maxConcurrent = maxConcurrent;
+    handler.prepare = parseAs<::palantir::XYSineRequest>(prepareXYSine);
+    return handler;
+}
+
+bool computeXYSine(const ::palantir::XYSineRequest& request, std::vector<double>& xValues, std::vector<double>& yValues,
+                   const RequestControl* control, int64_t grain)
+{
+    BEDROCK_PROFILE_ZONE("xy_sine");
+    
+    // Parse parameters from request (proto3 provides default values: 0.0 for double, 0 for int32)
+    // Use explicit defaults to match Phoenix behavior
+    double frequency = request.frequency() != 0.0 ? request.frequency() : 1.0;
+    double amplitude = request.amplitude() != 0.0 ? request.amplitude() : 1.0;
+    double phase = request.phase();  // 0.0 is valid default
+    int samples = request.samples() != 0 ? request.samples() : 1000;
+
+    // Validate samples (minimum 2) - matches Phoenix behavior
+    if (samples < 2) {
+        samples = 2;
+    }
+
+    // Compute sine wave using EXACT Phoenix algorithm
+    // t = i / (samples - 1) from 0 to 1
+    // x = t * 2π (0..2π domain)
+    // y = amplitude * sin(2π * frequency * t + phase)
+    // Every sample depends only on its index, so chunks give the serial loop's exact values
+    xValues.assign(samples, 0.0);
+    yValues.assign(samples, 0.0);
+    if (grain <= 0) {
+        grain = bedrock::TuningProfile::lookup("xy_sine").grain;
+    }
+    if (grain <= 0) {
+        grain = XY_SINE_DEFAULT_GRAIN;
+    }
+
+    std::atomic<bool> stopped{false};
+    bedrock::parallel_for(0, samples, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+            // Cooperative cancellation: poll every 64K samples to keep the check off the hot path
+            if (control && (i == begin || (i & 0xFFFF) == 0) &&
+                (stopped.load(std::memory_order_relaxed) || control->shouldStop())) {
+                stopped.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            double t = static_cast<double>(i) / (samples - 1.0);  // 0 to 1
+            double x = t * 2.0 * M_PI;  // Scale to 0..2π domain
+            double y = amplitude * std::sin(2.0 * M_PI * frequency * t + phase);
+
+            xValues[i] = x;
+            yValues[i] = y;
+        }
+    }, grain);
+    return !stopped.load();
+}
+
+void registerXYSineTuning()
+{
+    constexpr int samples = 1000000;
+    bedrock::register_tunable_kernel(bedrock::TunableKernel{"xy_sine", samples, [](int64_t grain) {
+        ::palantir::XYSineRequest request;
+        request.set_samples(samples);
+        std::vector<double> xValues, yValues;
+        computeXYSine(request, xValues, yValues, nullptr, grain);
+    }});
+}
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
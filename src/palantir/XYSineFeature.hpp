@@ -0,0 +1,34 @@
+#pragma once
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include "palantir/xysine.pb.h"
+#include "FeatureRegistry.hpp"
+#include "RequestControl.hpp"
+
+#include <vector>
+
+namespace bedrock::palantir {
+
+// Smaller XY Sine requests stay inline (cheaper than a handoff to the compute pool)
+static constexpr int XY_SINE_OFFLOAD_THRESHOLD = 100000;
+
+// Samples per chunk when no tuning profile covers "xy_sine"
+static constexpr int64_t XY_SINE_DEFAULT_GRAIN = 65536;
+
+// Handler for XY_SINE_REQUEST (feature "xy_sine"), executed on the compute pool
+FeatureHandler makeXYSineHandler(int maxConcurrent = 0);
+
+// Computes the sine samples (Phoenix algorithm). Returns false if control requested a
+// stop before all samples were computed. Pure function: safe on any thread.
+// Chunks of grain samples run with bedrock::parallel_for (within the caller's ThreadBudget);
+// grain 0 takes the tuned "xy_sine" grain, else XY_SINE_DEFAULT_GRAIN.
+bool computeXYSine(const ::palantir::XYSineRequest& request, std::vector<double>& xValues, std::vector<double>& yValues,
+                   const RequestControl* control = nullptr, int64_t grain = 0);
+
+// Registers "xy_sine" for ThreadingBenchmark::calibrate_kernels() (a 1M-sample request)
+void registerXYSineTuning();
+
+} // namespace bedrock::palantir
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
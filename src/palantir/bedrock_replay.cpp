@@ -0,0 +1,384 @@
+// bedrock_replay: deterministic replay of a PalantirServer traffic capture
+//
+// Reads a log written by `bedrock_server --capture`, re-opens one connection per
+// captured connection id and sends every inbound envelope at its original
+// relative time (optionally accelerated). Replies are paired with requests by
+// the request_id the server echoes (requests captured without one are given a
+// unique id on replay) and the latency distribution is compared with the
+// latencies observed when the capture was taken. Absolute deadlines (deadline_ms)
+// are moved forward by how much later the replay sends each request, so a request
+// keeps the time budget its client gave it.
+//
+// Usage:
+//   bedrock_replay --socket palantir_bedrock slow_session.cap
+//   bedrock_replay --speed 10 --csv replay.csv slow_session.cap
+//   bedrock_replay --speed 0 slow_session.cap      # as fast as possible
+
+#include "TrafficCapture.hpp"
+#include "EnvelopeHelpers.hpp"
+#include "RequestControl.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLocalSocket>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using bedrock::palantir::CaptureKind;
+using bedrock::palantir::CaptureRecord;
+using bedrock::palantir::META_DEADLINE_MS;
+using bedrock::palantir::META_REQUEST_ID;
+
+constexpr uint32_t MAX_REPLY_SIZE = 10 * 1024 * 1024;  // Matches PalantirServer::MAX_MESSAGE_SIZE
+constexpr qint64 NS_PER_MS = 1000000;
+
+int64_t wallClockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Request {
+    int type;                  // palantir::MessageType of the request
+    double originalLatencyMs;  // < 0 when the capture holds no reply
+    double replayLatencyMs;    // < 0 until the replay reply arrives
+};
+
+// Outstanding requests keyed by request_id; a deque per id tolerates clients that reuse ids
+template <typename Time>
+class PendingRequests {
+public:
+    void add(const std::string& requestId, size_t index, Time sentAt) {
+        byId_[requestId].push_back({index, sentAt});
+    }
+
+    // Oldest outstanding request with this id, if any
+    bool take(const std::string& requestId, size_t& outIndex, Time& outSentAt) {
+        auto it = byId_.find(requestId);
+        if (it == byId_.end()) {
+            return false;
+        }
+        std::tie(outIndex, outSentAt) = it->second.front();
+        it->second.pop_front();
+        if (it->second.empty()) {
+            byId_.erase(it);
+        }
+        return true;
+    }
+
+    bool empty() const { return byId_.empty(); }
+
+private:
+    std::map<std::string, std::deque<std::pair<size_t, Time>>> byId_;
+};
+
+struct Connection {
+    std::unique_ptr<QLocalSocket> socket;
+    QByteArray rx;
+    PendingRequests<qint64> pending;  // request index and send time in ns, by request_id
+};
+
+std::string requestIdOf(const palantir::MessageEnvelope& envelope)
+{
+    auto it = envelope.metadata().find(META_REQUEST_ID);
+    return it == envelope.metadata().end() ? std::string() : it->second;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bedrock_replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a Palantir traffic capture and compare latencies");
+    parser.addHelpOption();
+    parser.addPositionalArgument("capture", "Capture log written by bedrock_server --capture");
+
+    QCommandLineOption socketOption("socket", "Server socket name", "socket", "palantir_bedrock");
+    QCommandLineOption speedOption("speed", "Time acceleration (1 = original pacing, 0 = as fast as possible)", "factor", "1");
+    QCommandLineOption timeoutOption("timeout", "Time to wait for outstanding replies in ms", "ms", "10000");
+    QCommandLineOption csvOption("csv", "Append per-type summary to CSV file instead of stdout", "path");
+    parser.addOptions({socketOption, speedOption, timeoutOption, csvOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(2);
+    }
+
+    const QString socketName = parser.value(socketOption);
+    const double speed = std::max(0.0, parser.value(speedOption).toDouble());
+    const int timeoutMs = parser.value(timeoutOption).toInt();
+
+    // Load the whole capture; replay must not stall on disk I/O
+    bedrock::palantir::TrafficCaptureReader reader;
+    std::string openError;
+    if (!reader.open(parser.positionalArguments().first().toStdString(), &openError)) {
+        std::fprintf(stderr, "%s\n", openError.c_str());
+        return 1;
+    }
+    std::vector<CaptureRecord> records;
+    for (CaptureRecord record; reader.next(record);) {
+        records.push_back(std::move(record));
+    }
+
+    // Original latencies: replies pair with requests by the request_id the server echoed.
+    // A request captured without an id can only be matched by a reply without one, oldest first.
+    std::vector<Request> requests;
+    std::vector<size_t> requestOfRecord(records.size(), SIZE_MAX);
+    std::vector<std::string> requestIds;  // Id each request is replayed with
+    std::vector<bool> hasDeadline;        // Carries deadline_ms, rewritten when sent
+    {
+        std::map<uint32_t, PendingRequests<uint64_t>> open;
+        palantir::MessageEnvelope envelope;
+        for (size_t i = 0; i < records.size(); ++i) {
+            CaptureRecord& r = records[i];
+            if (r.kind != CaptureKind::Inbound && r.kind != CaptureKind::Outbound) {
+                continue;
+            }
+            const bool parsed = envelope.ParseFromString(r.envelope);
+            const std::string requestId = parsed ? requestIdOf(envelope) : std::string();
+            if (r.kind == CaptureKind::Inbound) {
+                const size_t index = requests.size();
+                requestOfRecord[i] = index;
+                open[r.connectionId].add(requestId, index, r.timestampUs);
+                requests.push_back({parsed ? static_cast<int>(envelope.type()) : 0, -1.0, -1.0});
+
+                // Give id-less requests a unique id so their replay replies can be paired too
+                std::string replayId = requestId;
+                if (parsed && replayId.empty()) {
+                    replayId = "replay-" + std::to_string(index);
+                    (*envelope.mutable_metadata())[META_REQUEST_ID] = replayId;
+                    envelope.SerializeToString(&r.envelope);
+                }
+                requestIds.push_back(replayId);
+                hasDeadline.push_back(parsed && envelope.metadata().count(META_DEADLINE_MS) != 0);
+            } else {
+                size_t index = 0;
+                uint64_t sentUs = 0;
+                if (open[r.connectionId].take(requestId, index, sentUs)) {
+                    requests[index].originalLatencyMs = (r.timestampUs - sentUs) / 1000.0;
+                }
+            }
+        }
+    }
+
+    std::map<uint32_t, Connection> connections;
+    QElapsedTimer clock;
+    bool failed = false;
+
+    auto drainReplies = [&](Connection& conn) {
+        conn.rx += conn.socket->readAll();
+        while (true) {
+            size_t frameSize = 0;
+            auto status = bedrock::palantir::peekFrame(conn.rx.constData(), static_cast<size_t>(conn.rx.size()),
+                                                       MAX_REPLY_SIZE, frameSize);
+            if (status != bedrock::palantir::FrameStatus::Complete) {
+                return;
+            }
+            palantir::MessageEnvelope reply;
+            const bool parsed = bedrock::palantir::parseEnvelope(conn.rx.constData() + bedrock::palantir::FRAME_HEADER_SIZE,
+                                                                 frameSize - bedrock::palantir::FRAME_HEADER_SIZE, reply);
+            conn.rx.remove(0, static_cast<qsizetype>(frameSize));
+
+            // A reply whose id matches nothing outstanding (or that does not parse) is ignored;
+            // its request then counts as unanswered rather than stealing another one's latency
+            size_t index = 0;
+            qint64 sentNs = 0;
+            if (parsed && conn.pending.take(requestIdOf(reply), index, sentNs)) {
+                requests[index].replayLatencyMs = (clock.nsecsElapsed() - sentNs) / 1e6;
+            }
+        }
+    };
+
+    auto connectionFor = [&](uint32_t id) -> Connection& {
+        Connection& conn = connections[id];
+        if (!conn.socket) {
+            conn.socket = std::make_unique<QLocalSocket>();
+            conn.socket->connectToServer(socketName);
+            if (!conn.socket->waitForConnected(5000)) {
+                std::fprintf(stderr, "connection %u: failed to connect to %s\n", id, qPrintable(socketName));
+                failed = true;
+            }
+        }
+        return conn;
+    };
+
+    // Reads replies until untilNs (clock time), blocking in waitForReadyRead rather than
+    // polling. With several connections awaiting replies each wait is capped at 1 ms, so
+    // no connection's reply is timestamped more than that late.
+    auto pump = [&](qint64 untilNs) {
+        std::vector<Connection*> waiting;
+        for (auto& [id, conn] : connections) {
+            if (conn.socket && conn.socket->state() == QLocalSocket::ConnectedState && !conn.pending.empty()) {
+                waiting.push_back(&conn);
+            }
+        }
+        const qint64 remainingMs = std::max<qint64>(0, (untilNs - clock.nsecsElapsed()) / NS_PER_MS);
+        if (waiting.empty()) {
+            QThread::msleep(static_cast<unsigned long>(remainingMs));  // Nothing to read until the next send
+            return;
+        }
+        const int waitMs = static_cast<int>(waiting.size() == 1 ? remainingMs : std::min<qint64>(remainingMs, 1));
+        for (Connection* conn : waiting) {
+            if (conn->socket->waitForReadyRead(waitMs)) {
+                drainReplies(*conn);
+            }
+        }
+    };
+
+    auto waitForPending = [&](Connection& conn, qint64 deadlineMs) {
+        while (!conn.pending.empty() && clock.elapsed() < deadlineMs) {
+            pump(deadlineMs * NS_PER_MS);
+        }
+    };
+
+    clock.start();
+    const int64_t replayStartMs = wallClockMs();
+    const int64_t captureStartMs = static_cast<int64_t>(reader.captureStartUs() / 1000);
+    for (size_t i = 0; i < records.size() && !failed; ++i) {
+        const CaptureRecord& r = records[i];
+        if (r.kind == CaptureKind::Outbound) {
+            continue;
+        }
+
+        // Hold original pacing (scaled); speed 0 sends back-to-back
+        if (speed > 0.0) {
+            qint64 dueNs = static_cast<qint64>(r.timestampUs * 1000.0 / speed);
+            while (clock.nsecsElapsed() < dueNs) {
+                pump(dueNs);
+            }
+        }
+
+        if (r.kind == CaptureKind::Connect) {
+            connectionFor(r.connectionId);
+        } else if (r.kind == CaptureKind::Inbound) {
+            Connection& conn = connectionFor(r.connectionId);
+            const size_t index = requestOfRecord[i];
+            std::string body = r.envelope;
+            if (hasDeadline[index]) {
+                // Same budget as captured: shift by how much later than the original this is sent
+                // (replay start - capture start at speed 1)
+                palantir::MessageEnvelope envelope;
+                envelope.ParseFromString(r.envelope);
+                auto& metadata = *envelope.mutable_metadata();
+                const int64_t originalSentMs = captureStartMs + static_cast<int64_t>(r.timestampUs / 1000);
+                const int64_t sentMs = replayStartMs + clock.elapsed();
+                const std::string& text = metadata[META_DEADLINE_MS];
+                int64_t deadlineMs = 0;
+                auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), deadlineMs);
+                if (ec == std::errc() && end == text.data() + text.size()) {
+                    metadata[META_DEADLINE_MS] = std::to_string(deadlineMs + (sentMs - originalSentMs));
+                    envelope.SerializeToString(&body);
+                }
+            }
+            uint32_t length = static_cast<uint32_t>(body.size());
+            QByteArray frame(reinterpret_cast<const char*>(&length), 4);
+            frame.append(body.data(), static_cast<qsizetype>(body.size()));
+            conn.pending.add(requestIds[index], index, clock.nsecsElapsed());
+            conn.socket->write(frame);
+            conn.socket->flush();
+        } else if (r.kind == CaptureKind::Disconnect) {
+            auto it = connections.find(r.connectionId);
+            if (it != connections.end()) {
+                // Let in-flight replies land before hanging up, as the original client did
+                waitForPending(it->second, clock.elapsed() + timeoutMs);
+                it->second.socket->disconnectFromServer();
+                connections.erase(it);
+            }
+        }
+    }
+
+    qint64 deadline = clock.elapsed() + timeoutMs;
+    for (auto& [id, conn] : connections) {
+        waitForPending(conn, deadline);
+    }
+    double replaySeconds = clock.elapsed() / 1000.0;
+
+    // Summarize per request type and overall
+    std::map<int, std::pair<std::vector<double>, std::vector<double>>> byType;
+    size_t unanswered = 0;
+    for (const Request& req : requests) {
+        if (req.replayLatencyMs < 0.0) {
+            ++unanswered;
+            continue;
+        }
+        for (int key : {req.type, -1}) {
+            if (req.originalLatencyMs >= 0.0) {
+                byType[key].first.push_back(req.originalLatencyMs);
+            }
+            byType[key].second.push_back(req.replayLatencyMs);
+        }
+    }
+
+    const QString header = "message_type,speed,requests,unanswered,replay_s,"
+                           "orig_p50_ms,orig_p99_ms,replay_p50_ms,replay_p99_ms,delta_p50_ms,delta_p99_ms";
+    QStringList rows;
+    for (auto& [type, latencies] : byType) {
+        double origP50 = percentile(latencies.first, 0.50);
+        double origP99 = percentile(latencies.first, 0.99);
+        double replayP50 = percentile(latencies.second, 0.50);
+        double replayP99 = percentile(latencies.second, 0.99);
+        rows << QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11")
+                    .arg(type < 0 ? QString("all") : QString::number(type))
+                    .arg(speed, 0, 'f', 2)
+                    .arg(latencies.second.size())
+                    .arg(type < 0 ? unanswered : 0)
+                    .arg(replaySeconds, 0, 'f', 3)
+                    .arg(origP50, 0, 'f', 3).arg(origP99, 0, 'f', 3)
+                    .arg(replayP50, 0, 'f', 3).arg(replayP99, 0, 'f', 3)
+                    .arg(replayP50 - origP50, 0, 'f', 3).arg(replayP99 - origP99, 0, 'f', 3);
+    }
+
+    if (parser.isSet(csvOption)) {
+        QFile file(parser.value(csvOption));
+        bool writeHeader = !file.exists() || file.size() == 0;
+        if (!file.open(QIODevice::Append | QIODevice::Text)) {
+            std::fprintf(stderr, "Failed to open %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+        QTextStream out(&file);
+        if (writeHeader) {
+            out << header << '\n';
+        }
+        for (const QString& row : rows) {
+            out << row << '\n';
+        }
+    } else {
+        std::printf("%s\n", qPrintable(header));
+        for (const QString& row : rows) {
+            std::printf("%s\n", qPrintable(row));
+        }
+    }
+
+    return (failed || unanswered > 0) ? 1 : 0;
+}
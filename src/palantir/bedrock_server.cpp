@@ -5,6 +5,36 @@
 #include <QCommandLineParser>
 #include <QTimer>
 
+#include "bedrock/profiler.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/threading.hpp"
+#include "bedrock/trace.hpp"
+#include "bedrock/tuning_profile.hpp"
+
+#include <atomic>
+#include <csignal>
+#include <functional>
+#include <vector>
+
+namespace {
+
+// Signal handlers only set flags; a timer on the event loop acts on them
+std::atomic<bool> g_dumpRequested{false};
+std::atomic<bool> g_quitRequested{false};
+
+void onSignal(int signal)
+{
+#ifdef SIGUSR1
+    if (signal == SIGUSR1) {
+        g_dumpRequested = true;
+        return;
+    }
+#endif
+    g_quitRequested = true;
+}
+
+} // namespace
+
 int main(int argc, char** argv)
 {
     QCoreApplication app(argc, argv);
@@ -17,12 +47,68 @@ int main(int argc, char** argv)
     QCommandLineOption socketOption("socket", "Socket name", "socket", "palantir_bedrock");
     parser.addOption(socketOption);
     
+    QCommandLineOption captureOption("capture", "Record framed traffic to a capture log for bedrock_replay", "path");
+    parser.addOption(captureOption);
+    
+    QCommandLineOption traceOption("trace", "Record per-request spans; write Chrome trace JSON on exit (and on SIGUSR1)", "path");
+    parser.addOption(traceOption);
+    
+    QCommandLineOption profileOption("profile", "Write the per-zone timing report on exit (and on SIGUSR1)", "path");
+    parser.addOption(profileOption);
+    
+    QCommandLineOption perfCountersOption("perf-counters", "Add hardware counters (IPC, cache and branch misses) to profile zones");
+    parser.addOption(perfCountersOption);
+    
+    QCommandLineOption tuningOption("tuning-profile", "Per-kernel thread/grain profile to load (or write with --calibrate)",
+                                    "path", QString::fromStdString(bedrock::TuningProfile::default_path()));
+    parser.addOption(tuningOption);
+    
+    QCommandLineOption pinningOption("pinning", "Pin task scheduler workers: none, compact, scatter or cores (default: $BEDROCK_PINNING, else none)",
+                                     "policy");
+    parser.addOption(pinningOption);
+    
+    QCommandLineOption calibrateOption("calibrate", "Measure the registered kernels, save the tuning profile and exit");
+    parser.addOption(calibrateOption);
+    
+    QCommandLineOption scalingOption("scaling", "Measure each registered kernel's thread scaling, write JSON (or .csv) and exit", "path");
+    parser.addOption(scalingOption);
+    
     parser.process(app);
     
     QString socketName = parser.value(socketOption);
     
-    // Create server
+    // Before anything starts the global scheduler's workers
+    if (parser.isSet(pinningOption)) {
+        const auto pinning = bedrock::parse_pinning_policy(parser.value(pinningOption).toStdString());
+        if (!pinning) {
+            qDebug() << "Unknown pinning policy:" << parser.value(pinningOption);
+            return 1;
+        }
+        bedrock::TaskScheduler::set_global_pinning(*pinning);
+    }
+    
+    // Create server (registers its handlers' tunable kernels)
     PalantirServer server;
+    server.setTuningProfilePath(parser.value(tuningOption));
+    
+    if (parser.isSet(calibrateOption)) {
+        const std::string report = bedrock::ThreadingBenchmark::calibrate_system(parser.value(tuningOption).toStdString());
+        qDebug().noquote() << report.c_str();
+        return 0;
+    }
+    
+    if (parser.isSet(scalingOption)) {
+        const auto results = bedrock::ThreadingBenchmark::measure_registered_scaling();
+        for (const auto& result : results) {
+            qDebug().noquote() << result.report().c_str();
+        }
+        const std::string scalingPath = parser.value(scalingOption).toStdString();
+        if (!bedrock::ThreadingBenchmark::save_scaling(scalingPath, results)) {
+            qDebug() << "Failed to write scaling results to" << scalingPath.c_str();
+            return 1;
+        }
+        return 0;
+    }
     
     // Connect signals
     QObject::connect(&server, &PalantirServer::clientConnected, []() {
@@ -43,8 +129,79 @@ int main(int argc, char** argv)
         return 1;
     }
     
+    if (parser.isSet(captureOption) && !server.startCapture(parser.value(captureOption))) {
+        qDebug() << "Failed to start traffic capture";
+        return 1;
+    }
+    
+    // Trace spans (Chrome trace JSON) and the zone profile are written on demand (SIGUSR1) and at shutdown
+    std::vector<std::function<void()>> dumps;
+    if (parser.isSet(traceOption)) {
+        const std::string tracePath = parser.value(traceOption).toStdString();
+        bedrock::Tracer::set_enabled(true);
+        
+        // Each dump covers the spans since the previous one, so per-thread buffers never stay full
+        dumps.push_back([tracePath]() {
+            const size_t spans = bedrock::Tracer::span_count();
+            if (bedrock::Tracer::write_chrome_trace(tracePath)) {
+                qDebug() << "Wrote" << spans << "trace spans to" << tracePath.c_str();
+            } else {
+                qDebug() << "Failed to write trace to" << tracePath.c_str();
+            }
+            bedrock::Tracer::clear();
+        });
+    }
+    if (parser.isSet(profileOption)) {
+        const std::string profilePath = parser.value(profileOption).toStdString();
+        if (parser.isSet(perfCountersOption)) {
+            // Events this machine does not permit show as "-" in the report
+            bedrock::Profiler::set_hardware_counters(true);
+            qDebug().noquote() << "Hardware counters:\n" << bedrock::PerfCounters::describe_support().c_str();
+        }
+        
+        dumps.push_back([profilePath]() {
+            if (bedrock::Profiler::write_report(profilePath)) {
+                qDebug() << "Wrote zone profile to" << profilePath.c_str();
+            } else {
+                qDebug() << "Failed to write zone profile to" << profilePath.c_str();
+            }
+        });
+    }
+    
+    // SIGINT/SIGTERM quit through the event loop whenever something must be flushed
+    // on exit: the dumps, or capture records still buffered in the writer
+    QTimer signalTimer;
+    if (!dumps.empty() || server.isCapturing()) {
+        auto writeDumps = [dumps]() {
+            for (const auto& dump : dumps) {
+                dump();
+            }
+        };
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [&server, writeDumps]() {
+            writeDumps();
+            server.stopServer();  // Drains the pools, then closes the capture
+        });
+        
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+#ifdef SIGUSR1
+        std::signal(SIGUSR1, onSignal);
+#endif
+        QObject::connect(&signalTimer, &QTimer::timeout, [writeDumps]() {
+            if (g_dumpRequested.exchange(false)) {
+                writeDumps();
+            }
+            if (g_quitRequested.exchange(false)) {
+                QCoreApplication::quit();
+            }
+        });
+        signalTimer.start(200);
+    }
+    
     qDebug() << "Bedrock server running on socket:" << socketName;
     qDebug() << "Max concurrency:" << server.maxConcurrency();
+    qDebug() << "Worker pinning:" << bedrock::pinning_policy_name(bedrock::TaskScheduler::global_pinning()) << "("
+             << bedrock::TaskScheduler::global().pinned_workers() << "workers pinned)";
     qDebug() << "Supported features:" << server.supportedFeatures();
     
     return app.exec();
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "bedrock/adaptive_grain.hpp"
+#include "bedrock/thread_budget.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+// Spins for about @p ns; sleeping would be rounded up by the OS
+void spin_for(int64_t ns) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+} // namespace
+
+TEST(AdaptiveGrain, VisitsEveryIndexOnceWithinBounds) {
+    bedrock::TaskScheduler scheduler(4);
+    bedrock::AdaptiveGrain control(std::chrono::microseconds(20), 4, 64);
+
+    std::vector<std::atomic<int>> visits(10007);
+    std::atomic<int64_t> largest{0};
+    bedrock::parallel_for_adaptive(0, static_cast<int64_t>(visits.size()), [&](int64_t begin, int64_t end) {
+        int64_t seen = largest.load();
+        while (end - begin > seen && !largest.compare_exchange_weak(seen, end - begin)) {
+        }
+        for (int64_t i = begin; i < end; ++i) {
+            visits[static_cast<size_t>(i)].fetch_add(1, std::memory_order_relaxed);
+        }
+    }, control, scheduler);
+    for (const auto& count : visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+    EXPECT_LE(largest.load(), 64);
+
+    const auto stats = control.stats();
+    EXPECT_EQ(stats.loops, 1);
+    EXPECT_EQ(stats.items, 10007);
+    EXPECT_GE(stats.chunks, 10007 / 64);
+    EXPECT_GE(stats.grain, 4);
+    EXPECT_LE(stats.grain, 64);
+
+    bedrock::parallel_for_adaptive(7, 7, [](int64_t) { FAIL(); }, control, scheduler);
+    EXPECT_EQ(control.stats().loops, 1);
+}
+
+TEST(AdaptiveGrain, ConvergesTowardTheTargetChunkDuration) {
+    bedrock::TaskScheduler scheduler(1);  // Chunk timings are wall time; keep other workers from preempting them
+    bedrock::AdaptiveGrain control(std::chrono::microseconds(200));
+
+    // ~2 us per index: the target is about 100 indices per chunk
+    for (int loop = 0; loop < 4; ++loop) {
+        bedrock::parallel_for_adaptive(0, 2000, [](int64_t) { spin_for(2000); }, control, scheduler);
+    }
+    const int64_t heavy_grain = control.grain();
+    EXPECT_GE(heavy_grain, 20);
+    EXPECT_LE(heavy_grain, 400);
+
+    // The same controller follows a cheaper input to much larger chunks
+    for (int loop = 0; loop < 4; ++loop) {
+        bedrock::parallel_for_adaptive(0, 200000, [](int64_t) { spin_for(20); }, control, scheduler);
+    }
+    EXPECT_GT(control.grain(), heavy_grain * 4);
+    EXPECT_GT(control.stats().ns_per_item, 0.0);
+    EXPECT_EQ(control.stats().loops, 8);
+}
+
+TEST(AdaptiveGrain, StaysWithinTheJobBudget) {
+    bedrock::TaskScheduler scheduler(4);
+    bedrock::ThreadBudget budget(1);  // No helpers: the caller runs every chunk
+    bedrock::AdaptiveGrain control;
+    std::atomic<int64_t> sum{0};
+    {
+        bedrock::ThreadBudget::Scope scope(budget);
+        bedrock::parallel_for_adaptive(0, 1000, [&](int64_t i) { sum.fetch_add(i); }, control, scheduler);
+    }
+    EXPECT_EQ(sum.load(), 999 * 1000 / 2);
+    EXPECT_EQ(control.stats().helper_joins, 0);
+    EXPECT_EQ(control.stats().idle_ratio, 0.0);
+    EXPECT_EQ(budget.available(), 0);
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "bedrock/coroutine.hpp"
+#include "bedrock/thread_budget.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bedrock::CancellationSource;
+using bedrock::CancellationToken;
+using bedrock::Executor;
+using bedrock::Task;
+
+namespace {
+
+Task<int> square(Executor& executor, int x) {
+    co_await bedrock::resume_on(executor);
+    co_return x * x;
+}
+
+Task<int> sum_of_squares(Executor& executor, int n) {
+    int sum = 0;
+    for (int i = 1; i <= n; ++i) {
+        sum += co_await square(executor, i);
+    }
+    co_return sum;
+}
+
+Task<int> fail_after_hop(Executor& executor) {
+    co_await bedrock::resume_on(executor);
+    throw std::runtime_error("stage failed");
+}
+
+Task<void> fail_void_after_hop(Executor& executor) {
+    co_await bedrock::resume_on(executor);
+    throw std::runtime_error("child failed");
+}
+
+// Event loop stand-in: one thread draining a QueueExecutor until stopped
+class TransportThread {
+public:
+    TransportThread()
+        : m_executor([this]() {
+              std::lock_guard<std::mutex> lock(m_mutex);
+              m_wake = true;
+              m_cv.notify_one();
+          })
+        , m_thread([this]() { loop(); }) {}
+
+    ~TransportThread() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_cv.notify_one();
+        }
+        m_thread.join();
+    }
+
+    bedrock::QueueExecutor& executor() { return m_executor; }
+    std::thread::id id() const { return m_thread.get_id(); }
+
+private:
+    void loop() {
+        while (true) {
+            m_executor.run_pending();
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_wake || m_stop; });
+            if (m_stop) {
+                break;
+            }
+            m_wake = false;
+        }
+        m_executor.run_pending();
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_wake = false;
+    bool m_stop = false;
+    bedrock::QueueExecutor m_executor;
+    std::thread m_thread;
+};
+
+} // namespace
+
+TEST(Coroutine, NestedTasksReturnValuesAndRethrow) {
+    for (int threads : {1, 4}) {
+        bedrock::TaskScheduler scheduler(threads);
+        bedrock::SchedulerExecutor pool(scheduler);
+        EXPECT_EQ(bedrock::sync_wait(sum_of_squares(pool, 10), scheduler), 385);
+        EXPECT_THROW(bedrock::sync_wait(fail_after_hop(pool), scheduler), std::runtime_error);
+    }
+
+    // Many synchronous completions in a row do not grow the stack
+    auto immediate = []() -> Task<int> { co_return 1; };
+    auto many = [&]() -> Task<int> {
+        int total = 0;
+        for (int i = 0; i < 100000; ++i) {
+            total += co_await immediate();
+        }
+        co_return total;
+    };
+    EXPECT_EQ(bedrock::sync_wait(many()), 100000);
+}
+
+TEST(Coroutine, WhenAllFansOutAndKeepsOrder) {
+    bedrock::TaskScheduler scheduler(4);
+    bedrock::SchedulerExecutor pool(scheduler);
+
+    std::vector<Task<int>> stages;
+    for (int i = 0; i < 64; ++i) {
+        stages.push_back(square(pool, i));
+    }
+    const std::vector<int> results = bedrock::sync_wait(bedrock::when_all(std::move(stages), pool), scheduler);
+    ASSERT_EQ(results.size(), 64u);
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(results[static_cast<size_t>(i)], i * i);
+    }
+
+    // Every child runs even when one fails; the failure surfaces at the join
+    std::atomic<int> ran{0};
+    auto count = [&]() -> Task<void> {
+        ran.fetch_add(1);
+        co_return;
+    };
+    std::vector<Task<void>> mixed;
+    mixed.push_back(count());
+    mixed.push_back(fail_void_after_hop(pool));
+    mixed.push_back(count());
+    EXPECT_THROW(bedrock::sync_wait(bedrock::when_all(std::move(mixed), pool), scheduler), std::runtime_error);
+    EXPECT_EQ(ran.load(), 2);
+
+    EXPECT_TRUE(bedrock::sync_wait(bedrock::when_all(std::vector<Task<int>>{}, pool), scheduler).empty());
+}
+
+TEST(Coroutine, CancellationStopsAtTheNextHop) {
+    bedrock::TaskScheduler scheduler(2);
+    bedrock::SchedulerExecutor pool(scheduler);
+    CancellationSource source;
+
+    std::atomic<int> batches{0};
+    auto pipeline = [&](CancellationToken token) -> Task<void> {
+        for (int batch = 0; batch < 100; ++batch) {
+            co_await bedrock::resume_on(pool, token);
+            if (batches.fetch_add(1) == 4) {
+                source.cancel();
+            }
+        }
+    };
+    EXPECT_THROW(bedrock::sync_wait(pipeline(source.token()), scheduler), bedrock::OperationCancelled);
+    EXPECT_EQ(batches.load(), 5);
+
+    // A default token never cancels; a shared flag (as RequestControl carries) does
+    EXPECT_FALSE(CancellationToken().is_cancelled());
+    auto flag = std::make_shared<std::atomic<bool>>(false);
+    CancellationToken shared(flag);
+    flag->store(true);
+    EXPECT_TRUE(shared.is_cancelled());
+    EXPECT_THROW(shared.throw_if_cancelled(), bedrock::OperationCancelled);
+}
+
+TEST(Coroutine, ContinuesOnTheTransportThread) {
+    bedrock::TaskScheduler scheduler(2);
+    bedrock::SchedulerExecutor pool(scheduler);
+    TransportThread transport;
+
+    std::mutex mutex;
+    std::condition_variable delivered;
+    std::string reply;
+    std::thread::id reply_thread;
+
+    // Launched from the transport thread, computes on the pool, replies on the transport thread
+    auto request = [&]() -> Task<void> {
+        std::vector<Task<int>> parts;
+        for (int i = 1; i <= 4; ++i) {
+            parts.push_back(square(pool, i));
+        }
+        const std::vector<int> squares = co_await bedrock::when_all(std::move(parts), pool);
+        co_await bedrock::resume_on(transport.executor());
+        std::lock_guard<std::mutex> lock(mutex);
+        reply = std::to_string(squares[0] + squares[1] + squares[2] + squares[3]);
+        reply_thread = std::this_thread::get_id();
+        delivered.notify_one();
+    };
+    bedrock::start_detached(request(), transport.executor());
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(delivered.wait_for(lock, std::chrono::seconds(10), [&]() { return !reply.empty(); }));
+    EXPECT_EQ(reply, "30");
+    EXPECT_EQ(reply_thread, transport.id());
+}
+
+TEST(Coroutine, DetachedWorkRunsOnASingleThreadScheduler) {
+    bedrock::TaskScheduler scheduler(1);
+    bedrock::SchedulerExecutor pool(scheduler);
+
+    std::mutex mutex;
+    std::condition_variable delivered;
+    int result = 0;
+    bool had_budget = true;
+
+    auto job = [&]() -> Task<void> {
+        const int value = co_await sum_of_squares(pool, 10);
+        std::lock_guard<std::mutex> lock(mutex);
+        result = value;
+        had_budget = bedrock::ThreadBudget::current() != nullptr;
+        delivered.notify_one();
+    };
+    {
+        // A short-lived job posts the work; its budget must not travel with it
+        auto budget = std::make_unique<bedrock::ThreadBudget>(1);
+        bedrock::ThreadBudget::Scope scope(*budget);
+        bedrock::start_detached(job(), pool);
+    }
+
+    // Nobody helps the scheduler: the posted work has to run on its own
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(delivered.wait_for(lock, std::chrono::seconds(10), [&]() { return result != 0; }));
+    EXPECT_EQ(result, 385);
+    EXPECT_FALSE(had_budget);
+}
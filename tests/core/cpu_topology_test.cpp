@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include "bedrock/cpu_topology.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// Fake /proc and /sys tree for CpuResources::probe
+class FakeRoot {
+public:
+    explicit FakeRoot(const std::string& name)
+        : m_root(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(m_root);
+    }
+    ~FakeRoot() { std::filesystem::remove_all(m_root); }
+
+    void write(const std::string& path, const std::string& content) {
+        const std::filesystem::path file = m_root / path.substr(1);
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream(file) << content << "\n";
+    }
+
+    // 8 online CPUs, 2-way SMT: cpu N and N + 4 are siblings
+    void write_smt_machine() {
+        write("/sys/devices/system/cpu/online", "0-7");
+        for (int cpu = 0; cpu < 8; ++cpu) {
+            const int core = cpu % 4;
+            write("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list",
+                  std::to_string(core) + "," + std::to_string(core + 4));
+        }
+    }
+
+    // 2 packages / NUMA nodes with one L3 each, 2 cores per package, 2-way SMT:
+    // cpu 0-1 and 4-5 on package 0, 2-3 and 6-7 on package 1; cpu N and N + 4 are siblings
+    void write_two_socket_machine() {
+        write("/sys/devices/system/node/online", "0-1");
+        write("/sys/devices/system/node/node0/cpulist", "0-1,4-5");
+        write("/sys/devices/system/node/node1/cpulist", "2-3,6-7");
+        for (int cpu = 0; cpu < 8; ++cpu) {
+            const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+            const int package = (cpu % 4) / 2;
+            write(dir + "/topology/physical_package_id", std::to_string(package));
+            write(dir + "/topology/core_id", std::to_string(cpu % 2));
+            write(dir + "/cache/index0/level", "1");
+            write(dir + "/cache/index0/type", "Instruction");
+            write(dir + "/cache/index0/shared_cpu_list", std::to_string(cpu % 4) + "," + std::to_string(cpu % 4 + 4));
+            write(dir + "/cache/index1/level", "3");
+            write(dir + "/cache/index1/type", "Unified");
+            write(dir + "/cache/index1/shared_cpu_list", package == 0 ? "0-1,4-5" : "2-3,6-7");
+        }
+    }
+
+    std::string path() const { return m_root.string(); }
+
+private:
+    std::filesystem::path m_root;
+};
+
+} // namespace
+
+TEST(CpuTopology, ParsesKernelFormats) {
+    using namespace bedrock::cpu_detail;
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parse_cpu_list("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(parse_cpu_list("3-1").empty());
+    EXPECT_TRUE(parse_cpu_list("x").empty());
+
+    EXPECT_FALSE(parse_cpu_max("max 100000").has_value());
+    EXPECT_DOUBLE_EQ(*parse_cpu_max("150000 100000"), 1.5);
+    EXPECT_FALSE(parse_cfs_quota("-1", "100000").has_value());
+    EXPECT_DOUBLE_EQ(*parse_cfs_quota("200000", "100000"), 2.0);
+}
+
+TEST(CpuTopology, CgroupV2QuotaLimitsUsableThreads) {
+    FakeRoot root("bedrock_cpu_v2");
+    root.write_smt_machine();
+    root.write("/proc/self/status", "Name:\tbedrock\nCpus_allowed_list:\t0-5\n");
+    root.write("/proc/self/cgroup", "0::/pod/app\n");
+    root.write("/sys/fs/cgroup/pod/app/cpu.max", "max 100000");
+    root.write("/sys/fs/cgroup/pod/cpu.max", "250000 100000");  // Parent limit applies
+
+    const auto resources = bedrock::CpuResources::probe(root.path());
+    EXPECT_EQ(resources.online_cpus, 8);
+    EXPECT_EQ(resources.allowed.size(), 6u);
+    EXPECT_EQ(resources.physical_cores, 4);  // 0-5 covers cores 0..3 (4 and 5 are siblings of 0 and 1)
+    EXPECT_DOUBLE_EQ(resources.quota_cpus, 2.5);
+    EXPECT_NE(resources.quota_source.find("/pod/cpu.max"), std::string::npos);
+    EXPECT_EQ(resources.usable_threads, 3);  // ceil(2.5)
+}
+
+TEST(CpuTopology, CgroupV1QuotaAndAffinity) {
+    FakeRoot root("bedrock_cpu_v1");
+    root.write_smt_machine();
+    root.write("/proc/self/status", "Cpus_allowed_list:\t2\n");
+    root.write("/proc/self/cgroup", "4:memory:/job\n2:cpu,cpuacct:/job\n");
+    root.write("/sys/fs/cgroup/cpu,cpuacct/job/cpu.cfs_quota_us", "400000");
+    root.write("/sys/fs/cgroup/cpu,cpuacct/job/cpu.cfs_period_us", "100000");
+
+    const auto resources = bedrock::CpuResources::probe(root.path());
+    EXPECT_DOUBLE_EQ(resources.quota_cpus, 4.0);
+    EXPECT_EQ(resources.usable_threads, 1);  // Affinity is tighter than the quota
+    EXPECT_EQ(resources.physical_cores, 1);
+
+    // No quota and no topology files: every online CPU is usable
+    FakeRoot bare("bedrock_cpu_bare");
+    bare.write("/sys/devices/system/cpu/online", "0-3");
+    const auto unlimited = bedrock::CpuResources::probe(bare.path());
+    EXPECT_EQ(unlimited.quota_cpus, 0.0);
+    EXPECT_EQ(unlimited.usable_threads, 4);
+    EXPECT_NE(unlimited.describe().find("CPU Quota: none"), std::string::npos);
+}
+
+TEST(CpuTopology, DetectsThisProcess) {
+    const auto& resources = bedrock::CpuResources::detect();
+    EXPECT_GE(resources.usable_threads, 1);
+    EXPECT_LE(static_cast<size_t>(resources.usable_threads), resources.allowed.size());
+    EXPECT_EQ(&resources, &bedrock::CpuResources::detect());
+
+    // A requested maximum above what the process may use is clamped to it
+    bedrock::ThreadingConfig::initialize(1 << 20);
+    EXPECT_LE(bedrock::ThreadingConfig::get_optimal_thread_count(), resources.usable_threads);
+}
+
+TEST(CpuTopology, ReadsPackagesNodesAndCaches) {
+    FakeRoot root("bedrock_cpu_topology");
+    root.write_two_socket_machine();
+
+    const auto topology = bedrock::CpuTopology::probe({0, 1, 2, 3, 4, 5, 6, 7}, root.path());
+    ASSERT_EQ(topology.cpus.size(), 8u);
+    EXPECT_EQ(topology.packages, 2);
+    EXPECT_EQ(topology.numa_nodes, 2);
+    EXPECT_EQ(topology.l3_domains, 2);
+    EXPECT_EQ(topology.physical_cores, 4);
+    EXPECT_EQ(topology.cpus[6].package, 1);
+    EXPECT_EQ(topology.cpus[6].numa_node, 1);
+    EXPECT_EQ(topology.cpus[6].l3_group, 2);
+    EXPECT_EQ(topology.cpus[6].l2_group, -1);  // Only an instruction cache below L3
+
+    // A restricted affinity mask only sees its own CPUs
+    const auto subset = bedrock::CpuTopology::probe({0, 4}, root.path());
+    EXPECT_EQ(subset.packages, 1);
+    EXPECT_EQ(subset.physical_cores, 1);
+}
+
+TEST(CpuTopology, PinningPlans) {
+    using bedrock::PinningPolicy;
+    FakeRoot root("bedrock_cpu_pinning");
+    root.write_two_socket_machine();
+    const auto topology = bedrock::CpuTopology::probe({0, 1, 2, 3, 4, 5, 6, 7}, root.path());
+
+    // Siblings first, then the other core of the package
+    EXPECT_EQ(bedrock::pinning_plan(topology, PinningPolicy::Compact, 8), (std::vector<int>{0, 4, 1, 5, 2, 6, 3, 7}));
+    // Alternate packages, one thread per core before siblings
+    EXPECT_EQ(bedrock::pinning_plan(topology, PinningPolicy::Scatter, 4), (std::vector<int>{0, 2, 1, 3}));
+    EXPECT_EQ(bedrock::pinning_plan(topology, PinningPolicy::PhysicalCores, 6), (std::vector<int>{0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(bedrock::pinning_plan(topology, PinningPolicy::Compact, 10).back(), 4);  // Wraps around
+    EXPECT_TRUE(bedrock::pinning_plan(topology, PinningPolicy::None, 4).empty());
+
+    EXPECT_EQ(bedrock::parse_pinning_policy("scatter"), PinningPolicy::Scatter);
+    EXPECT_EQ(bedrock::parse_pinning_policy(bedrock::pinning_policy_name(PinningPolicy::PhysicalCores)),
+              PinningPolicy::PhysicalCores);
+    EXPECT_FALSE(bedrock::parse_pinning_policy("spread").has_value());
+}
+
+TEST(CpuTopology, PinnedSchedulerAndLocalBuffers) {
+    const auto& topology = bedrock::CpuTopology::detect();
+    ASSERT_FALSE(topology.cpus.empty());
+    EXPECT_EQ(&topology, &bedrock::CpuTopology::detect());
+
+    bedrock::TaskScheduler scheduler(3, bedrock::PinningPolicy::Compact);
+    std::atomic<int> sum{0};
+    bedrock::parallel_for(0, 100, [&](int64_t i) {
+        EXPECT_LT(bedrock::TaskScheduler::worker_index(), 2);
+        sum.fetch_add(static_cast<int>(i));
+    }, 1, scheduler);
+    EXPECT_EQ(sum.load(), 4950);
+    EXPECT_LE(scheduler.pinned_workers(), 2);
+    EXPECT_EQ(bedrock::TaskScheduler::worker_index(), -1);
+
+    bedrock::NumaLocalBuffer buffer(10000);
+    EXPECT_EQ(buffer.size(), 10000u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % 4096, 0u);
+    const int* values = buffer.as<int>();
+    EXPECT_TRUE(std::all_of(values, values + 2500, [](int v) { return v == 0; }));
+}
+
+TEST(CpuTopology, GlobalSchedulerPinningIsFixedAtStart) {
+    bedrock::TaskScheduler& global = bedrock::TaskScheduler::global();
+    const bedrock::PinningPolicy applied = bedrock::TaskScheduler::global_pinning();
+    if (applied == bedrock::PinningPolicy::None) {
+        EXPECT_EQ(global.pinned_workers(), 0);
+    }
+
+    // Too late once the workers run: the policy in use is reported unchanged
+    const auto other = applied == bedrock::PinningPolicy::Scatter ? bedrock::PinningPolicy::Compact
+                                                                  : bedrock::PinningPolicy::Scatter;
+    EXPECT_FALSE(bedrock::TaskScheduler::set_global_pinning(other));
+    EXPECT_EQ(bedrock::TaskScheduler::global_pinning(), applied);
+}
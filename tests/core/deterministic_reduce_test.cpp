@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "bedrock/deterministic_reduce.hpp"
+#include "bedrock/thread_budget.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using bedrock::SumAccuracy;
+
+namespace {
+
+// Wide dynamic range and mixed signs, so any change in addition order shows in the last bits
+std::vector<double> ill_conditioned(size_t count) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-20, 20);
+    std::vector<double> values(count);
+    for (double& v : values) {
+        v = std::ldexp(mantissa(rng), exponent(rng));
+    }
+    return values;
+}
+
+bool same_bits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+TEST(DeterministicReduce, BitIdenticalForAnyThreadCount) {
+    const std::vector<double> a = ill_conditioned(100003);
+    const std::vector<double> b = ill_conditioned(100003);
+
+    bedrock::TaskScheduler serial(1);
+    const double sum = bedrock::deterministic_sum(a, SumAccuracy::Pairwise, serial);
+    const double compensated = bedrock::deterministic_sum(a, SumAccuracy::Compensated, serial);
+    const double dot = bedrock::deterministic_dot(a.data(), b.data(), static_cast<int64_t>(a.size()),
+                                                  SumAccuracy::Pairwise, serial);
+
+    for (int threads : {2, 3, 4, 8}) {
+        bedrock::TaskScheduler scheduler(threads);
+        for (int run = 0; run < 3; ++run) {
+            EXPECT_TRUE(same_bits(sum, bedrock::deterministic_sum(a, SumAccuracy::Pairwise, scheduler)));
+            EXPECT_TRUE(same_bits(compensated, bedrock::deterministic_sum(a, SumAccuracy::Compensated, scheduler)));
+            EXPECT_TRUE(same_bits(dot, bedrock::deterministic_dot(a.data(), b.data(), static_cast<int64_t>(a.size()),
+                                                                  SumAccuracy::Pairwise, scheduler)));
+        }
+
+        // Budgeted loops hand out blocks from a shared counter instead of splitting
+        bedrock::ThreadBudget budget(2);
+        bedrock::ThreadBudget::Scope scope(budget);
+        EXPECT_TRUE(same_bits(sum, bedrock::deterministic_sum(a, SumAccuracy::Pairwise, scheduler)));
+    }
+
+    // The generic form with the same map gives the same tree
+    const double mapped = bedrock::deterministic_sum_of(0, static_cast<int64_t>(a.size()),
+                                                        [&a](int64_t i) { return a[static_cast<size_t>(i)]; });
+    EXPECT_TRUE(same_bits(sum, mapped));
+}
+
+TEST(DeterministicReduce, CompensatedSumIsExactWhereNaiveIsNot) {
+    // 1 + 1e-16 * n: each tiny term is lost against 1.0 in a plain running sum
+    std::vector<double> values(50000, 1e-16);
+    values[0] = 1.0;
+    values.push_back(-1.0);
+    const double exact = 1e-16 * 49999;
+
+    const double compensated = bedrock::deterministic_sum(values, SumAccuracy::Compensated);
+    EXPECT_NEAR(compensated, exact, exact * 1e-12);
+
+    double naive = 0.0;
+    for (double v : values) {
+        naive += v;
+    }
+    EXPECT_GT(std::abs(naive - exact), std::abs(compensated - exact));
+
+    // Cancellation: sums to exactly zero
+    std::vector<double> cancel = ill_conditioned(30000);
+    const size_t half = cancel.size();
+    for (size_t i = 0; i < half; ++i) {
+        cancel.push_back(-cancel[i]);
+    }
+    EXPECT_EQ(bedrock::deterministic_sum(cancel, SumAccuracy::Compensated), 0.0);
+}
+
+TEST(DeterministicReduce, MinMaxPreferLowestIndexAndSkipNaN) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> values(20000, 5.0);
+    values[0] = nan;
+    values[7] = -3.0;
+    values[9000] = -3.0;   // Tie in a later block: the first one wins
+    values[12] = 9.0;
+    values[15000] = 9.0;
+    values[19999] = nan;
+
+    bedrock::TaskScheduler scheduler(4);
+    const auto min = bedrock::deterministic_min(values.data(), static_cast<int64_t>(values.size()), scheduler);
+    EXPECT_EQ(min.index, 7);
+    EXPECT_EQ(min.value, -3.0);
+    const auto max = bedrock::deterministic_max(values.data(), static_cast<int64_t>(values.size()), scheduler);
+    EXPECT_EQ(max.index, 12);
+    EXPECT_EQ(max.value, 9.0);
+
+    // A block of only NaN contributes nothing; an all-NaN or empty range finds nothing
+    std::vector<double> mostly_nan(10000, nan);
+    mostly_nan[9999] = 1.0;
+    EXPECT_EQ(bedrock::deterministic_min(mostly_nan.data(), 10000, scheduler).index, 9999);
+    EXPECT_FALSE(bedrock::deterministic_max(mostly_nan.data(), 9999, scheduler).found());
+    EXPECT_FALSE(bedrock::deterministic_min(values.data(), 0, scheduler).found());
+    EXPECT_EQ(bedrock::deterministic_sum(values.data(), 0), 0.0);
+
+    // Infinities are values like any other
+    std::vector<double> infinite(100, std::numeric_limits<double>::infinity());
+    infinite[0] = nan;
+    const auto inf_min = bedrock::deterministic_min(infinite.data(), 100, scheduler);
+    EXPECT_EQ(inf_min.index, 1);
+    EXPECT_EQ(inf_min.value, std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "bedrock/memory_tracking.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bedrock::MemorySubsystem;
+using bedrock::MemoryTagScope;
+using bedrock::MemoryTracker;
+
+// bedrock_tests links bedrock_allocation_hook, so operator new is attributed here
+
+TEST(MemoryTracking, HookChargesTheThreadsTag) {
+    ASSERT_TRUE(MemoryTracker::allocation_hook_installed());
+    const int64_t before = MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch);
+    {
+        std::unique_ptr<char[]> block;
+        {
+            MemoryTagScope scope(MemorySubsystem::ComputeScratch);
+            EXPECT_EQ(MemoryTracker::current_tag(), MemorySubsystem::ComputeScratch);
+            {
+                MemoryTagScope nested(MemorySubsystem::Protobuf);
+                EXPECT_EQ(MemoryTracker::current_tag(), MemorySubsystem::Protobuf);
+            }
+            block = std::make_unique<char[]>(1 << 20);
+        }
+        EXPECT_EQ(MemoryTracker::current_tag(), MemorySubsystem::Other);
+        EXPECT_GE(MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch) - before, 1 << 20);
+        EXPECT_GE(MemoryTracker::peak_bytes(MemorySubsystem::ComputeScratch), before + (1 << 20));
+    }
+    // Freed outside the scope, still credited to the subsystem that allocated it
+    EXPECT_EQ(MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch), before);
+}
+
+TEST(MemoryTracking, FreeOnAnotherThreadAndOverAlignedBlocks) {
+    struct alignas(128) Wide {
+        double values[32];
+    };
+    const int64_t before = MemoryTracker::current_bytes(MemorySubsystem::Cache);
+    std::vector<int>* cached = nullptr;
+    Wide* wide = nullptr;
+    {
+        MemoryTagScope scope(MemorySubsystem::Cache);
+        cached = new std::vector<int>(4096);
+        wide = new Wide();
+    }
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(wide) % alignof(Wide), 0u);
+    EXPECT_GE(MemoryTracker::current_bytes(MemorySubsystem::Cache) - before,
+              static_cast<int64_t>(4096 * sizeof(int) + sizeof(Wide)));
+
+    std::thread([cached, wide]() {
+        delete cached;
+        delete wide;
+    }).join();
+    EXPECT_EQ(MemoryTracker::current_bytes(MemorySubsystem::Cache), before);
+}
+
+TEST(MemoryTracking, PmrResourcesAndReport) {
+    const int64_t before = MemoryTracker::current_bytes(MemorySubsystem::Transport);
+    {
+        std::pmr::vector<double> buffer(MemoryTracker::resource(MemorySubsystem::Transport));
+        buffer.resize(10000);
+        EXPECT_GE(MemoryTracker::current_bytes(MemorySubsystem::Transport) - before,
+                  static_cast<int64_t>(10000 * sizeof(double)));
+    }
+    EXPECT_EQ(MemoryTracker::current_bytes(MemorySubsystem::Transport), before);
+
+    // Over an upstream the hook cannot see, the resource counts by itself
+    const int64_t scratch_before = MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch);
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        bedrock::TaggedMemoryResource tagged(MemorySubsystem::ComputeScratch, &arena);
+        void* block = tagged.allocate(4096, 64);
+        EXPECT_EQ(MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch) - scratch_before, 4096);
+        tagged.deallocate(block, 4096, 64);
+    }
+    EXPECT_EQ(MemoryTracker::current_bytes(MemorySubsystem::ComputeScratch), scratch_before);
+
+    MemoryTracker::reset_peaks();
+    EXPECT_EQ(MemoryTracker::peak_bytes(MemorySubsystem::Transport), MemoryTracker::current_bytes(MemorySubsystem::Transport));
+
+    const auto usage = MemoryTracker::snapshot();
+    ASSERT_EQ(usage.size(), bedrock::MEMORY_SUBSYSTEM_COUNT);
+    EXPECT_STREQ(usage[static_cast<size_t>(MemorySubsystem::Protobuf)].name, "protobuf");
+    const std::string report = MemoryTracker::report();
+    EXPECT_NE(report.find("compute_scratch"), std::string::npos);
+    EXPECT_EQ(report.find("not linked"), std::string::npos);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "bedrock/mpsc_queue.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpscQueue, SingleThreadFifo) {
+    bedrock::MpscQueue<int> queue;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.try_pop().has_value());
+
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+    }
+    EXPECT_FALSE(queue.empty());
+    for (int i = 0; i < 10; ++i) {
+        auto value = queue.try_pop();
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, MoveOnlyValuesAndCleanup) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        bedrock::MpscQueue<std::unique_ptr<std::shared_ptr<int>>> queue;
+        queue.push(std::make_unique<std::shared_ptr<int>>(tracker));
+        queue.push(std::make_unique<std::shared_ptr<int>>(tracker));
+        auto value = queue.try_pop();
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(tracker.use_count(), 3);
+    }
+    // Popped value and the element left in the queue are both destroyed
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(MpscQueue, MultipleProducersPreservePerProducerOrder) {
+    constexpr int kProducers = 4;
+    constexpr int kItemsPerProducer = 50000;
+    bedrock::MpscQueue<std::pair<int, int>> queue;
+    std::atomic<int> started{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            started.fetch_add(1);
+            while (started.load() < kProducers) {
+            }
+            for (int i = 0; i < kItemsPerProducer; ++i) {
+                queue.push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    while (received < kProducers * kItemsPerProducer) {
+        auto item = queue.try_pop();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto [producer, sequence] = *item;
+        ASSERT_EQ(sequence, next[producer]) << "producer " << producer;
+        ++next[producer];
+        ++received;
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "bedrock/perf_counters.hpp"
+#include "bedrock/profiler.hpp"
+
+#include <cmath>
+#include <string>
+
+using bedrock::PerfCounterValues;
+using bedrock::PerfCounters;
+using bedrock::PerfEvent;
+
+namespace {
+
+double spin(int iterations) {
+    volatile double x = 1.0;
+    for (int i = 0; i < iterations; ++i) {
+        x = std::sqrt(x + i);
+    }
+    return x;
+}
+
+} // namespace
+
+TEST(PerfCounterValues, RatesNeedBothEvents) {
+    PerfCounterValues start;
+    PerfCounterValues end;
+    start.mask = bedrock::ALL_PERF_EVENTS;
+    end.mask = bedrock::perf_event_bit(PerfEvent::Cycles) | bedrock::perf_event_bit(PerfEvent::Instructions) |
+               bedrock::perf_event_bit(PerfEvent::LLCMisses);
+    start[PerfEvent::Cycles] = 1000;
+    end[PerfEvent::Cycles] = 3000;
+    end[PerfEvent::Instructions] = 5000;
+    end[PerfEvent::LLCMisses] = 10;
+
+    const PerfCounterValues delta = end.since(start);
+    EXPECT_EQ(delta.mask, end.mask);
+    EXPECT_EQ(delta[PerfEvent::Cycles], 2000u);
+    EXPECT_DOUBLE_EQ(delta.ipc(), 2.5);
+    EXPECT_DOUBLE_EQ(delta.per_kilo_instruction(PerfEvent::LLCMisses), 2.0);
+    EXPECT_LT(delta.per_kilo_instruction(PerfEvent::BranchMisses), 0.0);  // Not counted
+
+    PerfCounterValues no_cycles;
+    no_cycles.mask = bedrock::perf_event_bit(PerfEvent::Instructions);
+    no_cycles[PerfEvent::Instructions] = 100;
+    EXPECT_LT(no_cycles.ipc(), 0.0);
+}
+
+// Whatever this machine permits, construction and reads never fail hard
+TEST(PerfCounters, DegradesToWhateverIsPermitted) {
+    PerfCounters counters;
+    if (counters.events() != bedrock::ALL_PERF_EVENTS) {
+        EXPECT_FALSE(counters.error().empty());
+    }
+
+    PerfCounterValues start;
+    PerfCounterValues end;
+    ASSERT_EQ(counters.read(start), counters.ok());
+    spin(200000);
+    ASSERT_EQ(counters.read(end), counters.ok());
+    if (!counters.ok()) {
+        EXPECT_EQ(start.mask, 0u);
+        return;
+    }
+    EXPECT_EQ(start.mask, counters.events());
+    const PerfCounterValues delta = end.since(start);
+    if (delta.has(PerfEvent::Instructions)) {
+        EXPECT_GT(delta[PerfEvent::Instructions], 200000u);
+    }
+    if (delta.has(PerfEvent::TaskClock)) {
+        EXPECT_GT(delta[PerfEvent::TaskClock], 0u);
+    }
+
+    const std::string support = PerfCounters::describe_support();
+    EXPECT_NE(support.find("cycles"), std::string::npos);
+    EXPECT_NE(support.find("task_clock"), std::string::npos);
+
+    PerfCounters none(0);
+    EXPECT_FALSE(none.ok());
+    EXPECT_FALSE(none.read(start));
+}
+
+TEST(PerfCounters, ProfilerZonesCarryCounters) {
+    bedrock::Profiler::reset();
+    bedrock::Profiler::set_hardware_counters(true);
+    for (int i = 0; i < 3; ++i) {
+        BEDROCK_PROFILE_ZONE("counted_spin");
+        spin(100000);
+    }
+    bedrock::Profiler::set_hardware_counters(false);
+    {
+        BEDROCK_PROFILE_ZONE("uncounted_spin");
+        spin(1000);
+    }
+
+    const auto zones = bedrock::Profiler::snapshot();
+    const bedrock::ProfileZoneStats* counted = nullptr;
+    const bedrock::ProfileZoneStats* uncounted = nullptr;
+    for (const auto& zone : zones) {
+        if (zone.path == "counted_spin") {
+            counted = &zone;
+        } else if (zone.path == "uncounted_spin") {
+            uncounted = &zone;
+        }
+    }
+    ASSERT_NE(counted, nullptr);
+    ASSERT_NE(uncounted, nullptr);
+    EXPECT_EQ(uncounted->counted, 0u);
+
+    const std::string report = bedrock::Profiler::report();
+    if (PerfCounters::this_thread().ok()) {
+        EXPECT_EQ(counted->counted, 3u);
+        EXPECT_EQ(counted->counters.mask, PerfCounters::this_thread().events());
+        EXPECT_NE(report.find("IPC"), std::string::npos);
+    } else {
+        // No counters here: zones are still timed, the report keeps its plain columns
+        EXPECT_EQ(counted->counted, 0u);
+        EXPECT_EQ(counted->count, 3u);
+        EXPECT_EQ(report.find("IPC"), std::string::npos);
+    }
+    bedrock::Profiler::reset();
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "bedrock/profiler.hpp"
+#include "bedrock/threading.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Profiler is process-global; each test starts from an empty, enabled profiler
+class ProfilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        bedrock::Profiler::set_enabled(true);
+        bedrock::Profiler::reset();
+    }
+    void TearDown() override {
+        bedrock::Profiler::set_enabled(true);
+        bedrock::Profiler::reset();
+    }
+};
+
+const bedrock::ProfileZoneStats* find_path(const std::vector<bedrock::ProfileZoneStats>& zones, const std::string& path) {
+    for (const auto& zone : zones) {
+        if (zone.path == path) {
+            return &zone;
+        }
+    }
+    return nullptr;
+}
+
+void inner_work() {
+    BEDROCK_PROFILE_ZONE("inner");
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+} // namespace
+
+TEST(PerformanceCounter, KeepsElapsedTimeAfterStop) {
+    bedrock::PerformanceCounter counter("stopwatch");
+    counter.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    counter.stop();
+    const double first = counter.get_elapsed_ms();
+    EXPECT_GE(first, 2.0);
+    EXPECT_EQ(counter.get_elapsed_ms(), first);  // Stopped: no longer advancing
+
+    counter.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    counter.stop();
+    EXPECT_GE(counter.get_elapsed_ms(), first + 1.0);  // Accumulates
+    counter.reset();
+    EXPECT_EQ(counter.get_elapsed_ms(), 0.0);
+}
+
+TEST_F(ProfilerTest, NestedZonesFormAHierarchy) {
+    for (int i = 0; i < 3; ++i) {
+        BEDROCK_PROFILE_ZONE("outer");
+        inner_work();
+        inner_work();
+    }
+    inner_work();  // Same zone, different parent: its own path
+
+    const auto zones = bedrock::Profiler::snapshot();
+    const auto* outer = find_path(zones, "outer");
+    const auto* nested = find_path(zones, "outer/inner");
+    const auto* top = find_path(zones, "inner");
+    ASSERT_NE(outer, nullptr);
+    ASSERT_NE(nested, nullptr);
+    ASSERT_NE(top, nullptr);
+    EXPECT_EQ(outer->count, 3u);
+    EXPECT_EQ(nested->count, 6u);
+    EXPECT_EQ(nested->depth, 1);
+    EXPECT_EQ(top->count, 1u);
+    EXPECT_GE(outer->total_ns, nested->total_ns);
+    EXPECT_GE(nested->min_ns, 50000u);
+    EXPECT_LE(nested->min_ns, nested->max_ns);
+    EXPECT_GE(nested->percentile_ns(0.99), nested->min_ns);
+
+    uint64_t samples = 0;
+    for (uint64_t bucket : nested->histogram) {
+        samples += bucket;
+    }
+    EXPECT_EQ(samples, 6u);
+
+    const std::string report = bedrock::Profiler::report();
+    EXPECT_NE(report.find("outer"), std::string::npos);
+    EXPECT_NE(report.find("  inner"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, MergesThreadsAndResets) {
+    constexpr int kThreads = 4;
+    constexpr int kZonesPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < kZonesPerThread; ++i) {
+                BEDROCK_TIMER("timed_kernel");  // Profiler zone, no output
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto zones = bedrock::Profiler::snapshot();
+    const auto* zone = find_path(zones, "timed_kernel");
+    ASSERT_NE(zone, nullptr);
+    EXPECT_EQ(zone->count, static_cast<uint64_t>(kThreads * kZonesPerThread));
+
+    bedrock::Profiler::reset();
+    EXPECT_EQ(find_path(bedrock::Profiler::snapshot(), "timed_kernel"), nullptr);
+
+    bedrock::Profiler::set_enabled(false);
+    {
+        BEDROCK_PROFILE_ZONE("disabled");
+    }
+    EXPECT_EQ(find_path(bedrock::Profiler::snapshot(), "disabled"), nullptr);
+    EXPECT_EQ(bedrock::Profiler::dropped_count(), 0u);
+}
+
+TEST_F(ProfilerTest, ExitedThreadsAreFoldedAndFreed) {
+    const size_t trees = bedrock::Profiler::tree_count();
+    for (int t = 0; t < 8; ++t) {
+        std::thread([] {
+            BEDROCK_PROFILE_ZONE("outer");
+            inner_work();
+        }).join();
+    }
+    EXPECT_EQ(bedrock::Profiler::tree_count(), trees);  // Nothing kept per exited thread
+
+    {
+        BEDROCK_PROFILE_ZONE("outer");  // Live thread merges with the exited ones by path
+    }
+    const auto zones = bedrock::Profiler::snapshot();
+    const auto* outer = find_path(zones, "outer");
+    const auto* inner = find_path(zones, "outer/inner");
+    ASSERT_NE(outer, nullptr);
+    ASSERT_NE(inner, nullptr);
+    EXPECT_EQ(outer->count, 9u);
+    EXPECT_EQ(inner->count, 8u);
+
+    bedrock::Profiler::reset();
+    EXPECT_EQ(find_path(bedrock::Profiler::snapshot(), "outer"), nullptr);
+}
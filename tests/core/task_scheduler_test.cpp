@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "bedrock/task_scheduler.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+TEST(TaskScheduler, ParallelForVisitsEveryIndexOnce) {
+    bedrock::TaskScheduler scheduler(4);
+    EXPECT_EQ(scheduler.thread_count(), 4);
+
+    std::vector<std::atomic<int>> visits(10007);
+    bedrock::parallel_for(0, static_cast<int64_t>(visits.size()), [&](int64_t i) {
+        visits[static_cast<size_t>(i)].fetch_add(1, std::memory_order_relaxed);
+    }, 0, scheduler);
+    for (const auto& count : visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+
+    // Chunk form with an explicit grain
+    std::atomic<int64_t> covered{0};
+    bedrock::parallel_for(5, 105, [&](int64_t begin, int64_t end) {
+        EXPECT_LE(end - begin, 7);
+        covered.fetch_add(end - begin);
+    }, 7, scheduler);
+    EXPECT_EQ(covered.load(), 100);
+
+    bedrock::parallel_for(3, 3, [](int64_t) { FAIL(); }, 0, scheduler);
+}
+
+TEST(TaskScheduler, ParallelReduceMatchesSerial) {
+    bedrock::TaskScheduler scheduler(3);
+    const int64_t n = 100000;
+    const int64_t sum = bedrock::parallel_reduce<int64_t>(
+        0, n, 0,
+        [](int64_t begin, int64_t end) {
+            int64_t partial = 0;
+            for (int64_t i = begin; i < end; ++i) {
+                partial += i;
+            }
+            return partial;
+        },
+        [](int64_t a, int64_t b) { return a + b; }, 0, scheduler);
+    EXPECT_EQ(sum, n * (n - 1) / 2);
+
+    EXPECT_EQ(bedrock::parallel_reduce<int>(4, 4, 42, [](int64_t, int64_t) { return 0; },
+                                            [](int a, int b) { return a + b; }, 0, scheduler), 42);
+}
+
+TEST(TaskScheduler, NestedAndSkewedWorkCompletes) {
+    bedrock::TaskScheduler scheduler(4);
+    // Outer iterations of very different cost, each running an inner parallel loop
+    std::vector<double> results(64, 0.0);
+    bedrock::parallel_for(0, 64, [&](int64_t outer) {
+        const int64_t inner = (outer % 8 == 0) ? 20000 : 100;
+        results[static_cast<size_t>(outer)] = bedrock::parallel_reduce<double>(
+            0, inner, 0.0,
+            [](int64_t begin, int64_t end) {
+                double partial = 0.0;
+                for (int64_t i = begin; i < end; ++i) {
+                    partial += std::sqrt(static_cast<double>(i));
+                }
+                return partial;
+            },
+            [](double a, double b) { return a + b; }, 64, scheduler);
+    }, 1, scheduler);
+
+    for (int64_t outer = 0; outer < 64; ++outer) {
+        EXPECT_GT(results[static_cast<size_t>(outer)], 0.0);
+    }
+}
+
+TEST(TaskScheduler, TaskGroupJoinsAndPropagatesExceptions) {
+    bedrock::TaskScheduler scheduler(2);
+    std::atomic<int> ran{0};
+    {
+        bedrock::TaskGroup group(scheduler);
+        for (int i = 0; i < 100; ++i) {
+            group.run([&ran]() { ran.fetch_add(1); });
+        }
+        group.wait();
+        EXPECT_EQ(ran.load(), 100);
+    }
+
+    bedrock::TaskGroup failing(scheduler);
+    failing.run([]() { throw std::runtime_error("task failed"); });
+    failing.run([&ran]() { ran.fetch_add(1); });
+    EXPECT_THROW(failing.wait(), std::runtime_error);
+    EXPECT_EQ(ran.load(), 101);  // Other tasks still ran
+
+    // Single-threaded scheduler: the waiting caller runs everything
+    bedrock::TaskScheduler serial(1);
+    int count = 0;
+    bedrock::parallel_for(0, 50, [&count](int64_t) { ++count; }, 4, serial);
+    EXPECT_EQ(count, 50);
+}
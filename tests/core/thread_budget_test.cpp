@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/thread_budget.hpp"
+#include "bedrock/threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Tracks how many loop bodies run at once
+struct ConcurrencyProbe {
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+
+    void enter() {
+        const int now = running.fetch_add(1) + 1;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        running.fetch_sub(1);
+    }
+};
+
+} // namespace
+
+TEST(ThreadBudget, TokensAndResizing) {
+    bedrock::ThreadBudget budget(4);
+    EXPECT_EQ(budget.available(), 3);
+    EXPECT_EQ(budget.try_acquire(2), 2);
+    EXPECT_EQ(budget.try_acquire(5), 1);
+    EXPECT_EQ(budget.try_acquire(1), 0);
+
+    budget.set_threads(2);  // Shrink while all helpers are out
+    EXPECT_EQ(budget.threads(), 2);
+    budget.release(3);
+    EXPECT_EQ(budget.available(), 1);
+
+    EXPECT_EQ(bedrock::ThreadBudget::current(), nullptr);
+    {
+        bedrock::ThreadBudget::Scope scope(budget);
+        EXPECT_EQ(bedrock::ThreadBudget::current(), &budget);
+        EXPECT_EQ(bedrock::ThreadBudget::current_threads(), 2);
+        EXPECT_LE(bedrock::ThreadingConfig::get_thread_count(), 2);
+    }
+    EXPECT_EQ(bedrock::ThreadBudget::current(), nullptr);
+}
+
+TEST(ThreadBudget, AllocatorSharesCoresAmongJobs) {
+    bedrock::CoreAllocator cores(8);
+    auto first = cores.acquire();
+    EXPECT_EQ(first->threads(), 8);  // Alone: every core
+
+    auto second = cores.acquire();
+    EXPECT_EQ(first->threads(), 4);
+    EXPECT_EQ(second->threads(), 4);
+
+    auto small = cores.acquire(1);  // Asks for less than a share; the rest split the remainder
+    EXPECT_EQ(small->threads(), 1);
+    EXPECT_EQ(first->threads() + second->threads(), 7);
+    EXPECT_EQ(cores.in_use(), 8);
+    EXPECT_EQ(cores.active_jobs(), 3);
+
+    second.reset();
+    small.reset();
+    EXPECT_EQ(first->threads(), 8);
+    EXPECT_EQ(cores.active_jobs(), 1);
+
+    // More jobs than cores: every job still keeps its own thread
+    bedrock::CoreAllocator one(1);
+    auto a = one.acquire();
+    auto b = one.acquire();
+    EXPECT_EQ(a->threads(), 1);
+    EXPECT_EQ(b->threads(), 1);
+}
+
+TEST(ThreadBudget, NestedLoopsStayWithinTheJobBudget) {
+    bedrock::TaskScheduler scheduler(6);
+    bedrock::ThreadBudget budget(2);
+    ConcurrencyProbe probe;
+    {
+        bedrock::ThreadBudget::Scope scope(budget);
+        bedrock::parallel_for(0, 8, [&](int64_t) {
+            bedrock::parallel_for(0, 8, [&](int64_t) { probe.enter(); }, 1, scheduler);
+        }, 1, scheduler);
+
+        const int64_t sum = bedrock::parallel_reduce<int64_t>(
+            0, 1000, 0, [](int64_t begin, int64_t end) {
+                int64_t partial = 0;
+                for (int64_t i = begin; i < end; ++i) {
+                    partial += i;
+                }
+                return partial;
+            },
+            [](int64_t a, int64_t b) { return a + b; }, 10, scheduler);
+        EXPECT_EQ(sum, 999 * 1000 / 2);
+    }
+    EXPECT_LE(probe.peak.load(), 2);
+    EXPECT_EQ(budget.available(), 1);  // Every helper token came back
+}
+
+TEST(ThreadBudget, HelpersChargeTheirCpuTimeToTheJob) {
+    bedrock::TaskScheduler scheduler(2);
+    bedrock::ThreadBudget budget(2);
+    std::atomic<bool> done{false};
+    {
+        bedrock::ThreadBudget::Scope scope(budget);
+        bedrock::TaskGroup group(scheduler);
+        group.run([&]() {
+            const uint64_t start = bedrock::ThreadBudget::thread_cpu_ns();
+            while (bedrock::ThreadBudget::thread_cpu_ns() - start < 2000000) {
+            }
+            done = true;
+        });
+        // Leave the task to the worker instead of helping, so it runs on another thread
+        while (!done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        group.wait();
+    }
+    EXPECT_GE(budget.helper_cpu_ns(), 2000000u);
+
+    // Tasks the job's own thread runs are already in its thread CPU time
+    bedrock::TaskScheduler inline_scheduler(1);
+    bedrock::ThreadBudget own(1);
+    {
+        bedrock::ThreadBudget::Scope scope(own);
+        bedrock::parallel_for(0, 4, [](int64_t) {}, 1, inline_scheduler);
+    }
+    EXPECT_EQ(own.helper_cpu_ns(), 0u);
+}
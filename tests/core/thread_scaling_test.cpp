@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "bedrock/threading.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using bedrock::SampleStats;
+using bedrock::ScalingOptions;
+using bedrock::ScalingResult;
+using bedrock::ThreadingBenchmark;
+
+namespace {
+
+double spin(int iterations) {
+    volatile double x = 1.0;
+    for (int i = 0; i < iterations; ++i) {
+        x = std::sqrt(x + i);
+    }
+    return x;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+} // namespace
+
+TEST(ThreadScaling, SampleStatsUseOrderStatistics) {
+    std::vector<double> samples{9, 3, 15, 1, 7, 12, 5, 14, 2, 8, 11, 4, 13, 6, 10};
+    const SampleStats stats = SampleStats::from_samples(samples);
+    EXPECT_EQ(stats.count, 15);
+    EXPECT_DOUBLE_EQ(stats.median_ms, 8.0);
+    EXPECT_DOUBLE_EQ(stats.mean_ms, 8.0);
+    EXPECT_DOUBLE_EQ(stats.min_ms, 1.0);
+    EXPECT_DOUBLE_EQ(stats.max_ms, 15.0);
+    EXPECT_NEAR(stats.stddev_ms, std::sqrt(20.0), 1e-12);
+    // n = 15: ranks 4 and 12
+    EXPECT_DOUBLE_EQ(stats.ci_low_ms, 4.0);
+    EXPECT_DOUBLE_EQ(stats.ci_high_ms, 12.0);
+
+    // One slow outlier moves the mean, not the median or its interval
+    samples[2] = 1000.0;
+    const SampleStats outlier = SampleStats::from_samples(samples);
+    EXPECT_DOUBLE_EQ(outlier.median_ms, 8.0);
+    EXPECT_DOUBLE_EQ(outlier.ci_high_ms, 12.0);
+    EXPECT_GT(outlier.mean_ms, 70.0);
+
+    const SampleStats few = SampleStats::from_samples({3.0, 1.0, 2.0, 4.0});
+    EXPECT_DOUBLE_EQ(few.median_ms, 2.5);
+    EXPECT_DOUBLE_EQ(few.ci_low_ms, 1.0);
+    EXPECT_DOUBLE_EQ(few.ci_high_ms, 4.0);
+    EXPECT_EQ(SampleStats::from_samples({}).count, 0);
+}
+
+TEST(ThreadScaling, MeasuresEveryThreadCountAgainstOneThread) {
+    ScalingOptions options;
+    options.thread_counts = {2, 64, 2};  // Clamped to the usable threads, deduplicated, 1 added
+    options.warmup_runs = 1;
+    options.samples = 7;
+    options.iterations = 2;
+
+    std::atomic<int> calls{0};
+    const ScalingResult result = ThreadingBenchmark::measure_scaling("spin", [&calls]() {
+        calls.fetch_add(1);
+        spin(20000);
+    }, options);
+
+    ASSERT_FALSE(result.points.empty());
+    EXPECT_EQ(result.name, "spin");
+    EXPECT_EQ(result.points.front().threads, 1);
+    EXPECT_DOUBLE_EQ(result.points.front().speedup, 1.0);
+    for (size_t i = 0; i < result.points.size(); ++i) {
+        const auto& point = result.points[i];
+        if (i > 0) {
+            EXPECT_GT(point.threads, result.points[i - 1].threads);
+        }
+        EXPECT_EQ(point.time.count, 7);
+        EXPECT_GT(point.time.median_ms, 0.0);
+        EXPECT_LE(point.time.ci_low_ms, point.time.median_ms);
+        EXPECT_GE(point.time.ci_high_ms, point.time.median_ms);
+        EXPECT_DOUBLE_EQ(point.efficiency, point.speedup / point.threads);
+    }
+    const int counts = static_cast<int>(result.points.size());
+    EXPECT_EQ(calls.load(), counts * (1 + 7 * 2));
+    EXPECT_NE(result.report().find("Speedup"), std::string::npos);
+
+    // The template shorthand instantiates outside threading.cpp
+    const auto times = ThreadingBenchmark::benchmark_thread_scaling([]() { spin(1000); }, 2);
+    ASSERT_FALSE(times.empty());
+    EXPECT_EQ(times.front().first, 1);
+}
+
+TEST(ThreadScaling, WritesJsonAndCsv) {
+    ScalingResult result;
+    result.name = "xy \"sine\", 1M";
+    bedrock::ScalingPoint one;
+    one.threads = 1;
+    one.time = SampleStats::from_samples({2.0, 2.0, 2.0});
+    one.speedup = 1.0;
+    one.efficiency = 1.0;
+    bedrock::ScalingPoint two = one;
+    two.threads = 2;
+    two.time = SampleStats::from_samples({1.25, 1.25, 1.25});
+    two.speedup = 1.6;
+    two.efficiency = 0.8;
+    result.points = {one, two};
+
+    const std::string json = ThreadingBenchmark::scaling_to_json({result});
+    EXPECT_NE(json.find("\"usable_threads\": "), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"xy \\\"sine\\\", 1M\""), std::string::npos);
+    EXPECT_NE(json.find("\"threads\": 2, \"samples\": 3, \"median_ms\": 1.25"), std::string::npos);
+    EXPECT_NE(json.find("\"efficiency\": 0.8}"), std::string::npos);
+
+    const std::string csv = ThreadingBenchmark::scaling_to_csv({result});
+    EXPECT_EQ(csv.find("kernel,threads,samples,median_ms"), 0u);
+    EXPECT_NE(csv.find("\"xy \"\"sine\"\", 1M\",2,3,1.25,"), std::string::npos);
+
+    const auto dir = std::filesystem::temp_directory_path() / "bedrock_scaling_test";
+    std::filesystem::create_directories(dir);
+    ASSERT_TRUE(ThreadingBenchmark::save_scaling((dir / "scaling.csv").string(), {result}));
+    ASSERT_TRUE(ThreadingBenchmark::save_scaling((dir / "scaling.json").string(), {result}));
+    EXPECT_EQ(read_file(dir / "scaling.csv"), csv);
+    EXPECT_EQ(read_file(dir / "scaling.json"), json);
+    std::filesystem::remove_all(dir);
+
+    EXPECT_NE(ThreadingBenchmark::scaling_to_json({}).find("\"kernels\": []"), std::string::npos);
+}
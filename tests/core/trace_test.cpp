@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "bedrock/trace.hpp"
+#include "bedrock/threading.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Tracer is process-global; each test starts from an empty, enabled tracer
+class TracerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        bedrock::Tracer::clear();
+        bedrock::Tracer::set_enabled(true);
+    }
+    void TearDown() override {
+        bedrock::Tracer::set_enabled(false);
+        bedrock::Tracer::clear();
+    }
+};
+
+} // namespace
+
+TEST_F(TracerTest, DisabledRecordsNothing) {
+    bedrock::Tracer::set_enabled(false);
+    {
+        BEDROCK_TRACE_SPAN("test", "ignored");
+    }
+    EXPECT_EQ(bedrock::Tracer::span_count(), 0u);
+}
+
+TEST_F(TracerTest, ScopedSpansAndTimerAreRecorded) {
+    {
+        BEDROCK_TRACE_SPAN("palantir", "compute");
+        BEDROCK_TIMER("inner_kernel");
+    }
+    EXPECT_EQ(bedrock::Tracer::span_count(), 2u);
+
+    std::string json = bedrock::Tracer::chrome_trace_json();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"compute\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"inner_kernel\""), std::string::npos);
+    EXPECT_NE(json.find("\"cat\":\"kernel\""), std::string::npos);
+}
+
+TEST_F(TracerTest, ExplicitSpanCarriesIdAndEscapedName) {
+    uint64_t start = bedrock::Tracer::now_ns();
+    bedrock::Tracer::record("palantir", "queue \"wait\"", start, start + 1500, 42);
+
+    std::string json = bedrock::Tracer::chrome_trace_json();
+    EXPECT_NE(json.find("\"name\":\"queue \\\"wait\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"dur\":1.500"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"id\":42}"), std::string::npos);
+}
+
+TEST_F(TracerTest, ThreadsRecordIntoSeparateBuffers) {
+    constexpr int kThreads = 4;
+    constexpr int kSpansPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            bedrock::Tracer::set_thread_name("worker-" + std::to_string(t));
+            for (int i = 0; i < kSpansPerThread; ++i) {
+                BEDROCK_TRACE_SPAN("test", "span");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(bedrock::Tracer::span_count(), static_cast<size_t>(kThreads * kSpansPerThread));
+    EXPECT_EQ(bedrock::Tracer::dropped_count(), 0u);
+    std::string json = bedrock::Tracer::chrome_trace_json();
+    EXPECT_NE(json.find("\"thread_name\""), std::string::npos);
+    EXPECT_NE(json.find("worker-3"), std::string::npos);
+}
+
+TEST_F(TracerTest, ClearDiscardsRecordedSpans) {
+    {
+        BEDROCK_TRACE_SPAN("test", "before_clear");
+    }
+    bedrock::Tracer::clear();
+    EXPECT_EQ(bedrock::Tracer::span_count(), 0u);
+    EXPECT_EQ(bedrock::Tracer::chrome_trace_json().find("before_clear"), std::string::npos);
+}
+
+TEST_F(TracerTest, FullBufferRecordsAgainAfterClear) {
+    const uint64_t start = bedrock::Tracer::now_ns();
+    for (size_t i = 0; i < bedrock::Tracer::MAX_SPANS_PER_THREAD + 5; ++i) {
+        bedrock::Tracer::record("test", "fill", start, start + 1);
+    }
+    EXPECT_EQ(bedrock::Tracer::span_count(), bedrock::Tracer::MAX_SPANS_PER_THREAD);
+    EXPECT_EQ(bedrock::Tracer::dropped_count(), 5u);
+
+    // As after an on-demand dump: the next window starts empty and records again
+    bedrock::Tracer::clear();
+    bedrock::Tracer::record("test", "after_clear", start, start + 1);
+    EXPECT_EQ(bedrock::Tracer::span_count(), 1u);
+    EXPECT_EQ(bedrock::Tracer::dropped_count(), 0u);
+    EXPECT_NE(bedrock::Tracer::chrome_trace_json().find("after_clear"), std::string::npos);
+}
+
+TEST_F(TracerTest, ExitedThreadBuffersAreReleasedOrReused) {
+    bedrock::Tracer::record("test", "main", 1, 2);  // Main thread's buffer
+    const size_t live = bedrock::Tracer::buffer_count();
+
+    // An exited thread's spans stay exportable until the next clear()
+    std::thread([] {
+        bedrock::Tracer::set_thread_name("expired-pool-thread");
+        BEDROCK_TRACE_SPAN("test", "from_exited_thread");
+    }).join();
+    EXPECT_EQ(bedrock::Tracer::buffer_count(), live + 1);
+    EXPECT_NE(bedrock::Tracer::chrome_trace_json().find("from_exited_thread"), std::string::npos);
+    bedrock::Tracer::clear();
+    EXPECT_EQ(bedrock::Tracer::buffer_count(), live);
+
+    // Threads that come and go without leaving spans behind share one buffer
+    for (int i = 0; i < 8; ++i) {
+        std::thread([] { bedrock::Tracer::set_thread_name("respawned"); }).join();
+    }
+    EXPECT_EQ(bedrock::Tracer::buffer_count(), live + 1);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "bedrock/cpu_topology.hpp"
+#include "bedrock/task_scheduler.hpp"
+#include "bedrock/threading.hpp"
+#include "bedrock/tuning_profile.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+bedrock::TuningProfile sample_profile() {
+    bedrock::TuningProfile profile;
+    profile.cpu_model = bedrock::TuningProfile::current_cpu_model();
+    profile.usable_threads = 4;
+    profile.kernels["xy_sine"] = bedrock::KernelTuning{2, 32768, 1000000, 2.5};
+    profile.kernels["trace_rays"] = bedrock::KernelTuning{4, 512, 50000, 10.25};
+    return profile;
+}
+
+} // namespace
+
+TEST(TuningProfile, SerializesAndParses) {
+    const auto profile = sample_profile();
+    std::string error;
+    const auto parsed = bedrock::TuningProfile::parse(profile.serialize(), &error);
+    ASSERT_TRUE(parsed.has_value()) << error;
+    EXPECT_EQ(parsed->cpu_model, profile.cpu_model);
+    EXPECT_EQ(parsed->usable_threads, 4);
+    ASSERT_NE(parsed->find("xy_sine"), nullptr);
+    EXPECT_EQ(parsed->find("xy_sine")->threads, 2);
+    EXPECT_EQ(parsed->find("xy_sine")->grain, 32768);
+    EXPECT_DOUBLE_EQ(parsed->find("trace_rays")->time_ms, 10.25);
+    EXPECT_EQ(parsed->find("missing"), nullptr);
+
+    EXPECT_FALSE(bedrock::TuningProfile::parse("version 99\n", &error).has_value());
+    EXPECT_NE(error.find("version"), std::string::npos);
+    EXPECT_FALSE(bedrock::TuningProfile::parse("cpu_model x\n").has_value());
+    EXPECT_FALSE(bedrock::TuningProfile::parse("version 1\nkernel k threads 0 grain 1 items 1 time_ms 1\n").has_value());
+}
+
+TEST(TuningProfile, LoadsOnlyOnTheSameCpuModel) {
+    const auto dir = std::filesystem::temp_directory_path() / "bedrock_tuning_profile";
+    std::filesystem::remove_all(dir);
+    const std::string path = (dir / "nested" / "profile.txt").string();
+
+    auto profile = sample_profile();
+    ASSERT_TRUE(profile.save(path));
+    const auto loaded = bedrock::TuningProfile::load(path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->kernels.size(), 2u);
+
+    profile.cpu_model = "Some Other CPU";
+    ASSERT_TRUE(profile.save(path));
+    std::string error;
+    EXPECT_FALSE(bedrock::TuningProfile::load(path, &error).has_value());
+    EXPECT_NE(error.find("Some Other CPU"), std::string::npos);
+    EXPECT_FALSE(bedrock::TuningProfile::load((dir / "absent.txt").string()).has_value());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(TuningProfile, CalibratesRegisteredKernelsAndInstalls) {
+    std::atomic<int64_t> runs{0};
+    bedrock::register_tunable_kernel(bedrock::TunableKernel{"test_kernel", 1 << 14, [&runs](int64_t grain) {
+        std::vector<double> out(1 << 14);
+        bedrock::parallel_for(0, static_cast<int64_t>(out.size()), [&out](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+                out[static_cast<size_t>(i)] = std::sin(static_cast<double>(i));
+            }
+        }, grain);
+        runs.fetch_add(1);
+    }});
+
+    const std::string report = bedrock::ThreadingBenchmark::calibrate_system();
+    EXPECT_NE(report.find("Kernel test_kernel"), std::string::npos);
+    EXPECT_GT(runs.load(), 1);
+
+    const auto tuning = bedrock::TuningProfile::lookup("test_kernel");
+    EXPECT_GE(tuning.threads, 1);
+    EXPECT_LE(tuning.threads, bedrock::CpuResources::detect().usable_threads);
+    EXPECT_GE(tuning.grain, 1);
+    EXPECT_LE(tuning.grain, 1 << 14);
+    EXPECT_EQ(tuning.items, 1 << 14);
+    EXPECT_EQ(bedrock::TuningProfile::lookup("missing").threads, 0);
+}
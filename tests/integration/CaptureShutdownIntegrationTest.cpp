@@ -0,0 +1,81 @@
+#include "IntegrationTestClient.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+#include <gtest/gtest.h>
+#include "palantir/TrafficCapture.hpp"
+#include "palantir/envelope.pb.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QThread>
+#include <QUuid>
+
+#include <string>
+#include <vector>
+
+// bedrock_server with only --capture: SIGTERM must still stop the server cleanly,
+// so the records buffered in the capture writer reach the file
+TEST(CaptureShutdownIntegrationTest, SigtermFlushesTheCapture) {
+    if (!QCoreApplication::instance()) {
+        static int argc = 1;
+        static char* argv[] = { const_cast<char*>("integration_tests"), nullptr };
+        static QCoreApplication app(argc, argv);
+    }
+
+    const QString id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const QString socketName = QString("palantir_capture_%1").arg(id);
+    const QString capturePath = QDir::temp().filePath(QString("bedrock_capture_%1.bin").arg(id));
+
+    QProcess server;
+    server.start(QString(BEDROCK_SERVER_PATH), {"--socket", socketName, "--capture", capturePath});
+    ASSERT_TRUE(server.waitForStarted(5000)) << server.errorString().toStdString();
+
+    IntegrationTestClient client;
+    QElapsedTimer timer;
+    timer.start();
+    while (!client.connect(socketName) && timer.elapsed() < 10000) {
+        QThread::msleep(50);
+    }
+    ASSERT_TRUE(client.isConnected()) << "bedrock_server did not start listening";
+
+    palantir::CapabilitiesResponse response;
+    QString error;
+    ASSERT_TRUE(client.getCapabilities(response, error)) << error.toStdString();
+
+    server.terminate();  // SIGTERM
+    ASSERT_TRUE(server.waitForFinished(10000));
+    EXPECT_EQ(server.exitStatus(), QProcess::NormalExit);
+    EXPECT_EQ(server.exitCode(), 0);
+    client.disconnect();
+
+    bedrock::palantir::TrafficCaptureReader reader;
+    std::string openError;
+    ASSERT_TRUE(reader.open(capturePath.toStdString(), &openError)) << openError;
+    std::vector<bedrock::palantir::CaptureRecord> records;
+    bedrock::palantir::CaptureRecord record;
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+    QFile::remove(capturePath);
+
+    // The reply is the last envelope the server wrote before the signal
+    const bedrock::palantir::CaptureRecord* lastOutbound = nullptr;
+    for (const auto& candidate : records) {
+        if (candidate.kind == bedrock::palantir::CaptureKind::Outbound) {
+            lastOutbound = &candidate;
+        }
+    }
+    ASSERT_NE(lastOutbound, nullptr) << "capture holds " << records.size() << " records, no reply";
+    palantir::MessageEnvelope envelope;
+    ASSERT_TRUE(envelope.ParseFromString(lastOutbound->envelope));
+    EXPECT_EQ(envelope.type(), palantir::MessageType::CAPABILITIES_RESPONSE);
+}
+
+#else
+#include <gtest/gtest.h>
+TEST(CaptureShutdownIntegrationTest, DISABLED_RequiresTransportDeps) {
+    GTEST_SKIP() << "Integration tests require BEDROCK_WITH_TRANSPORT_DEPS=ON";
+}
+#endif
@@ -0,0 +1,113 @@
+#include "IntegrationTestServerFixture.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+#include <gtest/gtest.h>
+#include "palantir/PalantirClientPool.hpp"
+#include "palantir/capabilities.pb.h"
+#include "palantir/xysine.pb.h"
+#include <QCoreApplication>
+#include <QTest>
+#include <QDebug>
+#include <functional>
+#include <memory>
+
+using bedrock::palantir::PalantirClientPool;
+
+class ClientPoolIntegrationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!QCoreApplication::instance()) {
+            static int argc = 1;
+            static char* argv[] = { const_cast<char*>("integration_tests"), nullptr };
+            app_ = std::make_unique<QCoreApplication>(argc, argv);
+        }
+        ASSERT_TRUE(first_.startServer()) << "Failed to start first server";
+        ASSERT_TRUE(second_.startServer()) << "Failed to start second server";
+        QCoreApplication::processEvents();
+    }
+
+    void TearDown() override {
+        first_.stopServer();
+        second_.stopServer();
+        QCoreApplication::processEvents();
+    }
+
+    // Spins the event loop until done() or the timeout
+    static bool waitFor(const std::function<bool()>& done, int timeoutMs = 5000) {
+        for (int elapsed = 0; elapsed < timeoutMs && !done(); elapsed += 10) {
+            QTest::qWait(10);
+        }
+        return done();
+    }
+
+    IntegrationTestServerFixture first_;
+    IntegrationTestServerFixture second_;
+    std::unique_ptr<QCoreApplication> app_;
+};
+
+TEST_F(ClientPoolIntegrationTest, SpreadsRequestsAcrossServers) {
+    PalantirClientPool pool({first_.socketPath(), second_.socketPath()});
+    pool.start();
+    ASSERT_TRUE(waitFor([&pool]() { return pool.connectedCount() == 2; }));
+
+    const int requests = 20;
+    int succeeded = 0;
+    int reportedLoad = 0;
+    palantir::XYSineRequest request;
+    request.set_samples(100);
+    for (int i = 0; i < requests; ++i) {
+        ASSERT_TRUE(pool.submit(palantir::MessageType::XY_SINE_REQUEST, request,
+            [&](const PalantirClientPool::Result& result) {
+                EXPECT_TRUE(result.ok) << result.error.toStdString();
+                EXPECT_EQ(result.envelope.type(), palantir::MessageType::XY_SINE_RESPONSE);
+                succeeded += result.ok ? 1 : 0;
+                reportedLoad += result.envelope.metadata().count(bedrock::palantir::META_SERVER_LOAD) ? 1 : 0;
+            }, true));
+    }
+    ASSERT_TRUE(waitFor([&]() { return succeeded == requests; }));
+    EXPECT_EQ(reportedLoad, requests);
+    EXPECT_EQ(pool.outstanding(), 0u);
+
+    // Pipelined with equal load, both servers take a share
+    EXPECT_GT(pool.balancer().stats(0).replies, 0u);
+    EXPECT_GT(pool.balancer().stats(1).replies, 0u);
+}
+
+TEST_F(ClientPoolIntegrationTest, FailsOverWhenAServerStops) {
+    PalantirClientPool::Options options;
+    options.balancer.initialBackoff = std::chrono::milliseconds(50);
+    PalantirClientPool pool({first_.socketPath(), second_.socketPath()}, options);
+    pool.start();
+    ASSERT_TRUE(waitFor([&pool]() { return pool.connectedCount() == 2; }));
+
+    first_.stopServer();
+    ASSERT_TRUE(waitFor([&pool]() { return pool.connectedCount() == 1; }));
+
+    int succeeded = 0;
+    int failed = 0;
+    palantir::CapabilitiesRequest request;
+    for (int i = 0; i < 10; ++i) {
+        pool.submit(palantir::MessageType::CAPABILITIES_REQUEST, request,
+            [&](const PalantirClientPool::Result& result) {
+                (result.ok ? succeeded : failed)++;
+                if (result.ok) {
+                    EXPECT_EQ(result.endpoint, 1);
+                }
+            }, true);
+    }
+    ASSERT_TRUE(waitFor([&]() { return succeeded + failed == 10; }));
+    EXPECT_EQ(succeeded, 10);
+    EXPECT_GE(pool.balancer().stats(0).failures, 1u);
+
+    // Once nothing is reachable, requests wait and fail when stopped
+    second_.stopServer();
+    ASSERT_TRUE(waitFor([&pool]() { return pool.connectedCount() == 0; }));
+    QString lastError;
+    pool.submit(palantir::MessageType::CAPABILITIES_REQUEST, request,
+        [&](const PalantirClientPool::Result& result) { lastError = result.error; }, true);
+    EXPECT_EQ(pool.outstanding(), 1u);
+    pool.stop();
+    EXPECT_FALSE(lastError.isEmpty());
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
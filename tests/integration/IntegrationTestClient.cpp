@@ -5,6 +5,7 @@
 #include <QDebug>
 #include <QCoreApplication>
 #include <QTest>
+#include <QElapsedTimer>
 #include <cstring>
 #include "palantir/xysine.pb.h"
 
@@ -52,7 +53,8 @@ bool IntegrationTestClient::isConnected() const
     return socket_ && socket_->state() == QLocalSocket::ConnectedState;
 }
 
-bool IntegrationTestClient::sendEnvelope(palantir::MessageType type, const google::protobuf::Message& message, QString& outError)
+bool IntegrationTestClient::sendEnvelope(palantir::MessageType type, const google::protobuf::Message& message, QString& outError,
+                                         const std::map<std::string, std::string>& metadata)
 {
     qDebug() << "[CLIENT] sendEnvelope: type=" << static_cast<int>(type) << ", connected=" << isConnected();
     
@@ -64,7 +66,7 @@ bool IntegrationTestClient::sendEnvelope(palantir::MessageType type, const googl
     
     // Create envelope using the live transport helper
     std::string envelopeError;
-    auto envelope = bedrock::palantir::makeEnvelope(type, message, {}, &envelopeError);
+    auto envelope = bedrock::palantir::makeEnvelope(type, message, metadata, &envelopeError);
     
     if (!envelope.has_value()) {
         outError = QString("Failed to create envelope: %1").arg(envelopeError.c_str());
@@ -204,6 +206,55 @@ bool IntegrationTestClient::receiveEnvelope(palantir::MessageEnvelope& outEnvelo
     return true;
 }
 
+bool IntegrationTestClient::sendRequest(palantir::MessageType type, const google::protobuf::Message& message,
+                                        const std::map<std::string, std::string>& metadata, QString& outError)
+{
+    return sendEnvelope(type, message, outError, metadata);
+}
+
+bool IntegrationTestClient::waitForEnvelope(palantir::MessageEnvelope& outEnvelope, int timeoutMs, QString& outError)
+{
+    outError.clear();
+    if (!isConnected() && rxBuffer_.size() < 4) {
+        outError = "Not connected";
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    while (true) {
+        // Drain whatever the socket already holds before blocking
+        rxBuffer_ += socket_->readAll();
+        
+        if (rxBuffer_.size() >= 4) {
+            uint32_t length;
+            std::memcpy(&length, rxBuffer_.constData(), 4);
+            if (rxBuffer_.size() >= 4 + static_cast<qsizetype>(length)) {
+                std::string parseError;
+                bool parsed = bedrock::palantir::parseEnvelope(
+                    std::string(rxBuffer_.constData() + 4, length), outEnvelope, &parseError);
+                rxBuffer_.remove(0, 4 + static_cast<qsizetype>(length));
+                if (!parsed) {
+                    outError = QString("Failed to parse MessageEnvelope: %1").arg(parseError.c_str());
+                    return false;
+                }
+                return true;
+            }
+        }
+        
+        qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0) {
+            return false;  // Plain timeout, outError stays empty
+        }
+        if (!socket_->waitForReadyRead(static_cast<int>(remaining))) {
+            if (socket_->state() != QLocalSocket::ConnectedState) {
+                outError = "Connection closed";
+                return false;
+            }
+        }
+    }
+}
+
 bool IntegrationTestClient::getCapabilities(palantir::CapabilitiesResponse& outResponse, QString& outError)
 {
     // Send CapabilitiesRequest
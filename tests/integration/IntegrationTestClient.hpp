@@ -10,7 +10,9 @@
 #include "palantir/xysine.pb.h"
 #include "palantir/EnvelopeHelpers.hpp"
 #include <QLocalSocket>
+#include <map>
 #include <memory>
+#include <string>
 #endif
 
 /**
@@ -59,18 +61,45 @@ public:
      */
     bool sendXYSineRequest(const palantir::XYSineRequest& request, palantir::XYSineResponse& outResponse, QString& outError);
 
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+    /**
+     * Send envelope-encoded request without waiting for the reply.
+     * Used by pipelined callers (e.g. bedrock_loadgen) that match replies themselves.
+     * @param type Message type
+     * @param message Inner message to wrap
+     * @param metadata Envelope metadata (e.g. request_id)
+     * @param outError Output error message
+     * @return true on success, false on failure
+     */
+    bool sendRequest(palantir::MessageType type, const google::protobuf::Message& message,
+                     const std::map<std::string, std::string>& metadata, QString& outError);
+
+    /**
+     * Wait for the next complete envelope without spinning the Qt event loop.
+     * Safe to call from threads that own the client but run no event loop.
+     * @param outEnvelope Output envelope (populated on success)
+     * @param timeoutMs Maximum time to wait
+     * @param outError Output error message (empty on plain timeout)
+     * @return true if an envelope was received, false on timeout or failure
+     */
+    bool waitForEnvelope(palantir::MessageEnvelope& outEnvelope, int timeoutMs, QString& outError);
+#endif
+
 private:
 #ifdef BEDROCK_WITH_TRANSPORT_DEPS
     std::unique_ptr<QLocalSocket> socket_;
+    QByteArray rxBuffer_;  // Partial frames buffered by waitForEnvelope()
     
     /**
      * Send envelope-encoded message.
      * @param type Message type
      * @param message Inner message to wrap
      * @param outError Output error message
+     * @param metadata Optional envelope metadata
      * @return true on success, false on failure
      */
-    bool sendEnvelope(palantir::MessageType type, const google::protobuf::Message& message, QString& outError);
+    bool sendEnvelope(palantir::MessageType type, const google::protobuf::Message& message, QString& outError,
+                      const std::map<std::string, std::string>& metadata = {});
     
     /**
      * Receive and parse envelope-encoded message.
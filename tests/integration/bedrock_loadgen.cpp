@@ -0,0 +1,415 @@
+// bedrock_loadgen: multi-client throughput/latency load generator for PalantirServer
+//
+// Drives N concurrent connections (one IntegrationTestClient per thread) with a
+// weighted request mix, optional open-loop arrival rate and per-connection
+// pipelining depth. Reports throughput and p50/p99/p999 latency as CSV.
+//
+// Latency is measured from the *intended* send time when an arrival rate is set,
+// so a backed-up server is not hidden by the generator slowing down
+// (coordinated omission).
+//
+// Usage:
+//   bedrock_loadgen --spawn-server --connections 8 --depth 4 --duration 10
+//   bedrock_loadgen --socket palantir_bedrock --rate 2000 --mix caps=1,xysine_small=8,xysine_large=1 --csv out.csv
+
+#include "IntegrationTestClient.hpp"
+
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+#include "palantir/PalantirServer.hpp"
+#include "palantir/capabilities.pb.h"
+#include "palantir/xysine.pb.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QTimer>
+#include <QUuid>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RequestKind {
+    QString name;
+    palantir::MessageType type;
+    palantir::MessageType expectedResponse;
+    int samples;      // XY Sine only
+    double weight;
+};
+
+struct Sample {
+    int kind;
+    double latencyMs;
+    bool ok;
+};
+
+struct LoadConfig {
+    QString socketName;
+    int connections = 4;
+    int depth = 1;
+    double durationSec = 10.0;
+    double targetRps = 0.0;   // 0 = closed loop (send whenever depth allows)
+    int timeoutMs = 10000;
+    std::vector<RequestKind> kinds;
+};
+
+struct Pending {
+    int kind;
+    Clock::time_point intended;
+};
+
+struct WorkerResult {
+    std::vector<Sample> samples;
+    QString error;
+};
+
+bool parseMix(const QString& spec, int smallSamples, int largeSamples, std::vector<RequestKind>& out, QString& error)
+{
+    for (const QString& entry : spec.split(',', Qt::SkipEmptyParts)) {
+        QStringList kv = entry.split('=');
+        QString name = kv.value(0).trimmed();
+        double weight = kv.size() > 1 ? kv[1].toDouble() : 1.0;
+        if (weight <= 0.0) {
+            continue;
+        }
+        if (name == "caps") {
+            out.push_back({name, palantir::MessageType::CAPABILITIES_REQUEST,
+                           palantir::MessageType::CAPABILITIES_RESPONSE, 0, weight});
+        } else if (name == "xysine_small") {
+            out.push_back({name, palantir::MessageType::XY_SINE_REQUEST,
+                           palantir::MessageType::XY_SINE_RESPONSE, smallSamples, weight});
+        } else if (name == "xysine_large") {
+            out.push_back({name, palantir::MessageType::XY_SINE_REQUEST,
+                           palantir::MessageType::XY_SINE_RESPONSE, largeSamples, weight});
+        } else {
+            error = QString("Unknown request kind in --mix: %1").arg(name);
+            return false;
+        }
+    }
+    if (out.empty()) {
+        error = "--mix selects no requests";
+        return false;
+    }
+    return true;
+}
+
+void runConnection(const LoadConfig& config, int index, WorkerResult& result)
+{
+    // Client (and its QLocalSocket) must be created on the thread that uses it
+    IntegrationTestClient client;
+    if (!client.connect(config.socketName)) {
+        result.error = QString("connection %1: failed to connect to %2").arg(index).arg(config.socketName);
+        return;
+    }
+
+    std::mt19937_64 rng(0x5eed0000ULL + static_cast<uint64_t>(index));
+    std::vector<double> weights;
+    for (const auto& kind : config.kinds) {
+        weights.push_back(kind.weight);
+    }
+    std::discrete_distribution<int> pickKind(weights.begin(), weights.end());
+
+    const bool openLoop = config.targetRps > 0.0;
+    std::exponential_distribution<double> interArrival(
+        openLoop ? config.targetRps / config.connections : 1.0);
+
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config.durationSec));
+    const auto drainEnd = end + std::chrono::milliseconds(config.timeoutMs);
+    auto nextArrival = start;
+
+    // Prebuilt requests; only metadata changes per send
+    palantir::CapabilitiesRequest capsRequest;
+    std::vector<palantir::XYSineRequest> sineRequests(config.kinds.size());
+    for (size_t k = 0; k < config.kinds.size(); ++k) {
+        sineRequests[k].set_samples(config.kinds[k].samples);
+        sineRequests[k].set_frequency(1.0);
+        sineRequests[k].set_amplitude(1.0);
+        sineRequests[k].set_phase(0.0);
+    }
+
+    std::map<std::string, Pending> inFlightById;
+    std::deque<std::string> inFlightOrder;  // FIFO fallback when replies carry no request_id
+    uint64_t sequence = 0;
+
+    while (true) {
+        auto now = Clock::now();
+        if (now >= drainEnd || (now >= end && inFlightById.empty())) {
+            break;
+        }
+
+        // Issue every request that is due and fits in the pipeline
+        while (now < end && static_cast<int>(inFlightById.size()) < config.depth
+               && (!openLoop || nextArrival <= now)) {
+            int kind = pickKind(rng);
+            const RequestKind& rk = config.kinds[kind];
+            std::string requestId = std::to_string(index) + ":" + std::to_string(sequence++);
+
+            QString error;
+            const google::protobuf::Message& message =
+                rk.type == palantir::MessageType::CAPABILITIES_REQUEST
+                    ? static_cast<const google::protobuf::Message&>(capsRequest)
+                    : sineRequests[kind];
+            if (!client.sendRequest(rk.type, message, {{"request_id", requestId}}, error)) {
+                result.error = QString("connection %1: %2").arg(index).arg(error);
+                return;
+            }
+
+            inFlightById[requestId] = {kind, openLoop ? nextArrival : now};
+            inFlightOrder.push_back(requestId);
+            if (openLoop) {
+                nextArrival += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(interArrival(rng)));
+            }
+            now = Clock::now();
+        }
+
+        // Wait for a reply, but no longer than the next scheduled arrival
+        int waitMs = 50;
+        if (openLoop && now < end && static_cast<int>(inFlightById.size()) < config.depth) {
+            auto untilNext = std::chrono::duration_cast<std::chrono::milliseconds>(nextArrival - now).count();
+            waitMs = static_cast<int>(std::clamp<int64_t>(untilNext, 0, 50));
+        }
+        if (inFlightById.empty()) {
+            if (waitMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+            }
+            continue;
+        }
+
+        palantir::MessageEnvelope envelope;
+        QString error;
+        if (!client.waitForEnvelope(envelope, waitMs, error)) {
+            if (!error.isEmpty()) {
+                result.error = QString("connection %1: %2").arg(index).arg(error);
+                return;
+            }
+            continue;
+        }
+        auto received = Clock::now();
+
+        auto idIt = envelope.metadata().find("request_id");
+        std::string requestId = idIt != envelope.metadata().end() ? idIt->second : std::string();
+        if (requestId.empty() || !inFlightById.count(requestId)) {
+            while (!inFlightOrder.empty() && !inFlightById.count(inFlightOrder.front())) {
+                inFlightOrder.pop_front();
+            }
+            if (inFlightOrder.empty()) {
+                continue;  // Unsolicited message
+            }
+            requestId = inFlightOrder.front();
+        }
+
+        Pending pending = inFlightById[requestId];
+        inFlightById.erase(requestId);
+        double latencyMs = std::chrono::duration<double, std::milli>(received - pending.intended).count();
+        bool ok = envelope.type() == config.kinds[pending.kind].expectedResponse;
+        result.samples.push_back({pending.kind, latencyMs, ok});
+    }
+
+    // Anything still in flight after the drain window counts as an error
+    for (const auto& [id, pending] : inFlightById) {
+        result.samples.push_back({pending.kind, static_cast<double>(config.timeoutMs), false});
+    }
+    client.disconnect();
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+QString csvRow(const QString& label, const QString& kind, const LoadConfig& config,
+               std::vector<double> latencies, size_t errors)
+{
+    std::sort(latencies.begin(), latencies.end());
+    double mean = 0.0;
+    for (double l : latencies) {
+        mean += l;
+    }
+    mean = latencies.empty() ? 0.0 : mean / latencies.size();
+    double throughput = latencies.size() / config.durationSec;
+
+    return QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11,%12,%13,%14")
+        .arg(label).arg(kind)
+        .arg(config.connections).arg(config.depth)
+        .arg(config.targetRps, 0, 'f', 1).arg(config.durationSec, 0, 'f', 1)
+        .arg(latencies.size() + errors).arg(errors)
+        .arg(throughput, 0, 'f', 1)
+        .arg(mean, 0, 'f', 3)
+        .arg(percentile(latencies, 0.50), 0, 'f', 3)
+        .arg(percentile(latencies, 0.99), 0, 'f', 3)
+        .arg(percentile(latencies, 0.999), 0, 'f', 3)
+        .arg(latencies.empty() ? 0.0 : latencies.back(), 0, 'f', 3);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bedrock_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Palantir multi-client throughput/latency load generator");
+    parser.addHelpOption();
+
+    QCommandLineOption socketOption("socket", "Server socket name", "socket", "palantir_bedrock");
+    QCommandLineOption spawnOption("spawn-server", "Run an in-process PalantirServer on a private socket");
+    QCommandLineOption connectionsOption("connections", "Concurrent connections", "n", "4");
+    QCommandLineOption depthOption("depth", "Max in-flight requests per connection (pipelining depth)", "n", "1");
+    QCommandLineOption durationOption("duration", "Measurement duration in seconds", "seconds", "10");
+    QCommandLineOption rateOption("rate", "Open-loop aggregate arrival rate in req/s (0 = closed loop)", "rps", "0");
+    QCommandLineOption mixOption("mix", "Weighted request mix", "spec", "caps=1,xysine_small=8,xysine_large=1");
+    QCommandLineOption smallOption("small-samples", "Samples for xysine_small", "n", "1000");
+    QCommandLineOption largeOption("large-samples", "Samples for xysine_large", "n", "250000");
+    QCommandLineOption timeoutOption("timeout", "Per-request drain timeout in ms", "ms", "10000");
+    QCommandLineOption labelOption("label", "Value for the CSV label column", "label", "loadgen");
+    QCommandLineOption csvOption("csv", "Append results to CSV file instead of stdout", "path");
+    QCommandLineOption verboseOption("verbose", "Keep client/server debug logging enabled");
+    parser.addOptions({socketOption, spawnOption, connectionsOption, depthOption, durationOption,
+                       rateOption, mixOption, smallOption, largeOption, timeoutOption,
+                       labelOption, csvOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) {
+        // Per-message qDebug() output would dominate the measurement
+        QLoggingCategory::setFilterRules("*.debug=false");
+    }
+
+    LoadConfig config;
+    config.socketName = parser.value(socketOption);
+    config.connections = std::max(1, parser.value(connectionsOption).toInt());
+    config.depth = std::max(1, parser.value(depthOption).toInt());
+    config.durationSec = std::max(0.1, parser.value(durationOption).toDouble());
+    config.targetRps = std::max(0.0, parser.value(rateOption).toDouble());
+    config.timeoutMs = std::max(1, parser.value(timeoutOption).toInt());
+
+    QString mixError;
+    if (!parseMix(parser.value(mixOption), parser.value(smallOption).toInt(),
+                  parser.value(largeOption).toInt(), config.kinds, mixError)) {
+        std::fprintf(stderr, "%s\n", qPrintable(mixError));
+        return 2;
+    }
+
+    std::unique_ptr<PalantirServer> server;
+    if (parser.isSet(spawnOption)) {
+        server = std::make_unique<PalantirServer>();
+        config.socketName = QString("palantir_loadgen_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+        if (!server->startServer(config.socketName)) {
+            std::fprintf(stderr, "Failed to start in-process server\n");
+            return 1;
+        }
+    }
+
+    // One thread per connection; the main thread keeps the (optional) server's event loop running
+    std::vector<WorkerResult> results(config.connections);
+    std::vector<std::thread> workers;
+    std::atomic<int> finished{0};
+    for (int i = 0; i < config.connections; ++i) {
+        workers.emplace_back([&config, &results, &finished, i]() {
+            runConnection(config, i, results[i]);
+            finished.fetch_add(1);
+        });
+    }
+
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &app, [&]() {
+        if (finished.load() == config.connections) {
+            app.quit();
+        }
+    });
+    poll.start(20);
+    app.exec();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (server) {
+        server->stopServer();
+    }
+
+    // Aggregate per request kind and overall
+    std::vector<std::vector<double>> latencies(config.kinds.size());
+    std::vector<size_t> errors(config.kinds.size(), 0);
+    std::vector<double> allLatencies;
+    size_t allErrors = 0;
+    bool failed = false;
+    for (const auto& r : results) {
+        if (!r.error.isEmpty()) {
+            std::fprintf(stderr, "%s\n", qPrintable(r.error));
+            failed = true;
+        }
+        for (const auto& s : r.samples) {
+            if (s.ok) {
+                latencies[s.kind].push_back(s.latencyMs);
+                allLatencies.push_back(s.latencyMs);
+            } else {
+                ++errors[s.kind];
+                ++allErrors;
+            }
+        }
+    }
+
+    const QString header = "label,kind,connections,depth,target_rps,duration_s,requests,errors,"
+                           "throughput_rps,mean_ms,p50_ms,p99_ms,p999_ms,max_ms";
+    const QString label = parser.value(labelOption);
+    QStringList rows;
+    for (size_t k = 0; k < config.kinds.size(); ++k) {
+        rows << csvRow(label, config.kinds[k].name, config, latencies[k], errors[k]);
+    }
+    rows << csvRow(label, "all", config, allLatencies, allErrors);
+
+    if (parser.isSet(csvOption)) {
+        QFile file(parser.value(csvOption));
+        bool writeHeader = !file.exists() || file.size() == 0;
+        if (!file.open(QIODevice::Append | QIODevice::Text)) {
+            std::fprintf(stderr, "Failed to open %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+        QTextStream out(&file);
+        if (writeHeader) {
+            out << header << '\n';
+        }
+        for (const QString& row : rows) {
+            out << row << '\n';
+        }
+    } else {
+        std::printf("%s\n", qPrintable(header));
+        for (const QString& row : rows) {
+            std::printf("%s\n", qPrintable(row));
+        }
+    }
+
+    return failed ? 1 : 0;
+}
+
+#else
+#include <cstdio>
+
+int main()
+{
+    std::fprintf(stderr, "bedrock_loadgen requires BEDROCK_WITH_TRANSPORT_DEPS=ON\n");
+    return 1;
+}
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -8,20 +8,56 @@ using namespace bedrock::palantir;
 
 TEST(CapabilitiesServiceTest, GetCapabilities) {
     CapabilitiesService service;
+    EXPECT_EQ(service.getCapabilities().capabilities().supported_features_size(), 0);  // Nothing hard-coded
+    service.addFeature("xy_sine");  // As registering its handler does
     auto response = service.getCapabilities();
-    
+
     // Verify response structure
     ASSERT_TRUE(response.has_capabilities());
-    
+
     const auto& caps = response.capabilities();
-    
-    // Verify server version
-    EXPECT_EQ(caps.server_version(), "bedrock-0.0.1");
-    
-    // Verify supported features
+
+    // Verify server version (tracks the project version)
+    EXPECT_EQ(caps.server_version(), CapabilitiesService::serverVersion());
+    EXPECT_EQ(caps.server_version().rfind("bedrock-", 0), 0u);
+
+    // Verify supported features: only what this build implements
     EXPECT_EQ(caps.supported_features_size(), 1);
     EXPECT_EQ(caps.supported_features(0), "xy_sine");
 }
 
-#endif // BEDROCK_WITH_TRANSPORT_DEPS
+TEST(CapabilitiesServiceTest, RegisteredFeaturesRefreshTheCachedResponse) {
+    CapabilitiesService service;
+    service.addFeature("xy_sine");
+    const auto* first = &service.getCapabilities();
+    EXPECT_EQ(first, &service.getCapabilities());  // Reused while features are unchanged
 
+    service.addFeature("ray_trace");
+    service.addFeature("xy_sine");  // Duplicate is ignored
+    const auto& caps = service.getCapabilities().capabilities();
+    ASSERT_EQ(caps.supported_features_size(), 2);
+    EXPECT_EQ(caps.supported_features(1), "ray_trace");
+    EXPECT_TRUE(service.hasFeature("ray_trace"));
+}
+
+TEST(CapabilitiesServiceTest, LoadMetadata) {
+    CapabilitiesService service;
+    ServerLoad load;
+    load.queueDepth = 5;
+    load.activeJobs = 1;
+    load.workers = 8;
+    auto metadata = service.loadMetadata(load);
+    EXPECT_EQ(metadata[META_QUEUE_DEPTH], "5");
+    EXPECT_EQ(metadata[META_ACTIVE_JOBS], "1");
+    EXPECT_EQ(metadata[META_WORKER_COUNT], "8");
+    EXPECT_EQ(metadata[META_SIMD_LEVEL], CapabilitiesService::simdLevel());
+    EXPECT_EQ(metadata[META_ENCODINGS], "protobuf");  // Only encodings some handler accepts
+    EXPECT_EQ(metadata.count("mem_transport_bytes"), 0u);  // Only subsystems the server reports
+
+    load.memory.push_back({"transport", 4096, 65536});
+    metadata = service.loadMetadata(load);
+    EXPECT_EQ(metadata["mem_transport_bytes"], "4096");
+    EXPECT_EQ(metadata["mem_transport_peak_bytes"], "65536");
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,90 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/ClientSession.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace bedrock::palantir;
+
+namespace {
+
+RequestControl supersedable(const std::string& key) {
+    return RequestControl::fromMetadata({{META_SUPERSEDES, key}});
+}
+
+} // namespace
+
+TEST(ClientSessionTest, RepliesLeaveInOrderBehindReservedSlot) {
+    ClientSession session(nullptr, 7);
+    EXPECT_EQ(session.connectionId(), 7u);
+    EXPECT_FALSE(session.hasPendingReplies());
+
+    auto slot = session.reserveReply();
+    session.queueReply("B");
+    session.queueReply("C");
+
+    std::vector<std::string> seen;
+    auto collect = [&seen](const std::string& frame) { seen.push_back(frame); };
+
+    // Nothing leaves while the first reply is outstanding
+    EXPECT_TRUE(session.takeReadyReplies(collect).empty());
+    EXPECT_TRUE(session.hasPendingReplies());
+
+    slot->frame = "A";
+    slot->ready = true;
+    EXPECT_EQ(session.takeReadyReplies(collect), "ABC");
+    EXPECT_EQ(seen, (std::vector<std::string>{"A", "B", "C"}));
+    EXPECT_FALSE(session.hasPendingReplies());
+}
+
+TEST(ClientSessionTest, NewerRequestCancelsOlderWithSameKey) {
+    ClientSession session(nullptr, 1);
+    auto first = supersedable("plot");
+    auto second = supersedable("plot");
+    auto other = supersedable("table");
+
+    session.beginRequest(first);
+    session.beginRequest(other);
+    session.beginRequest(second);
+    EXPECT_TRUE(first.isCancelled());
+    EXPECT_FALSE(second.isCancelled());
+    EXPECT_FALSE(other.isCancelled());
+    EXPECT_EQ(session.inFlightCount(), 3u);  // The superseded one runs until it notices
+
+    // A late end for the superseded request must not drop the newer one
+    session.endRequest(first);
+    EXPECT_EQ(session.inFlightCount(), 2u);
+    auto third = supersedable("plot");
+    session.beginRequest(third);
+    EXPECT_TRUE(second.isCancelled());
+    session.endRequest(second);
+    session.endRequest(third);
+    session.endRequest(other);
+    EXPECT_EQ(session.inFlightCount(), 0u);
+}
+
+TEST(ClientSessionTest, CloseCancelsInFlightAndReturnsJobs) {
+    ClientSession session(nullptr, 1);
+    auto control = supersedable("plot");
+    auto unkeyed = RequestControl::fromMetadata({});
+    session.beginRequest(control);
+    session.beginRequest(unkeyed);
+    session.reserveReply();
+    session.readBuffer().append("partial", 7);
+    session.jobs().insert("job-1");
+    session.jobs().insert("job-2");
+
+    auto jobs = session.close();
+    EXPECT_FALSE(session.isOpen());
+    EXPECT_TRUE(control.isCancelled());
+    EXPECT_TRUE(unkeyed.isCancelled());  // Plain pool work stops too
+    EXPECT_EQ(jobs.size(), 2u);
+    EXPECT_TRUE(session.jobs().empty());
+    EXPECT_FALSE(session.hasPendingReplies());
+    EXPECT_TRUE(session.readBuffer().isEmpty());
+    EXPECT_EQ(session.inFlightCount(), 0u);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
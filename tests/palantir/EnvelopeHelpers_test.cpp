@@ -5,6 +5,7 @@
 #include "palantir/capabilities.pb.h"
 #include "palantir/xysine.pb.h"
 #include "palantir/envelope.pb.h"
+#include "palantir/error.pb.h"
 
 using namespace bedrock::palantir;
 
@@ -381,5 +382,68 @@ TEST(EnvelopeHelpersTest, MetadataRoundTripEmpty) {
     EXPECT_EQ(parsed.metadata().size(), 0u);
 }
 
-#endif // BEDROCK_WITH_TRANSPORT_DEPS
+TEST(EnvelopeHelpersTest, FrameRoundTrip) {
+    palantir::XYSineRequest request;
+    request.set_samples(42);
+    auto envelope = makeEnvelope(palantir::MessageType::XY_SINE_REQUEST, request);
+    ASSERT_TRUE(envelope.has_value());
+    
+    // Two frames back to back, as they arrive in a receive buffer
+    std::string buffer;
+    ASSERT_TRUE(appendFrame(*envelope, buffer, 10 * 1024 * 1024));
+    size_t firstFrameSize = buffer.size();
+    ASSERT_TRUE(appendFrame(*envelope, buffer, 10 * 1024 * 1024));
+    EXPECT_EQ(buffer.size(), 2 * firstFrameSize);
+    
+    size_t frameSize = 0;
+    ASSERT_EQ(peekFrame(buffer.data(), buffer.size(), 10 * 1024 * 1024, frameSize), FrameStatus::Complete);
+    EXPECT_EQ(frameSize, firstFrameSize);
+    
+    palantir::MessageEnvelope parsed;
+    ASSERT_TRUE(parseEnvelope(buffer.data() + FRAME_HEADER_SIZE, frameSize - FRAME_HEADER_SIZE, parsed));
+    palantir::XYSineRequest decoded;
+    ASSERT_TRUE(decoded.ParseFromString(parsed.payload()));
+    EXPECT_EQ(decoded.samples(), 42);
+}
 
+TEST(EnvelopeHelpersTest, PeekFrameIncomplete) {
+    palantir::CapabilitiesResponse response;
+    response.mutable_capabilities()->set_server_version("test-1.0");
+    auto envelope = makeEnvelope(palantir::MessageType::CAPABILITIES_RESPONSE, response);
+    ASSERT_TRUE(envelope.has_value());
+    
+    std::string buffer;
+    ASSERT_TRUE(appendFrame(*envelope, buffer, 1024));
+    
+    size_t frameSize = 0;
+    // Partial length prefix
+    EXPECT_EQ(peekFrame(buffer.data(), 2, 1024, frameSize), FrameStatus::Incomplete);
+    // Length prefix present, envelope truncated
+    EXPECT_EQ(peekFrame(buffer.data(), buffer.size() - 1, 1024, frameSize), FrameStatus::Incomplete);
+}
+
+TEST(EnvelopeHelpersTest, FrameSizeLimits) {
+    palantir::ErrorResponse error;
+    error.set_details(std::string(2048, 'x'));
+    auto envelope = makeEnvelope(palantir::MessageType::ERROR_RESPONSE, error);
+    ASSERT_TRUE(envelope.has_value());
+    
+    // appendFrame refuses oversize envelopes and leaves the buffer untouched
+    std::string buffer = "prefix";
+    std::string appendError;
+    size_t envelopeSize = 0;
+    EXPECT_FALSE(appendFrame(*envelope, buffer, 1024, &appendError, &envelopeSize));
+    EXPECT_EQ(buffer, "prefix");
+    EXPECT_EQ(envelopeSize, envelope->ByteSizeLong());
+    EXPECT_NE(appendError.find("exceeds limit"), std::string::npos);
+    
+    // peekFrame rejects an oversize declared length from the header alone
+    std::string frame;
+    ASSERT_TRUE(appendFrame(*envelope, frame, 1024 * 1024));
+    size_t frameSize = 0;
+    std::string peekError;
+    EXPECT_EQ(peekFrame(frame.data(), FRAME_HEADER_SIZE, 1024, frameSize, &peekError), FrameStatus::Error);
+    EXPECT_NE(peekError.find("exceeds limit"), std::string::npos);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,180 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/FeatureRegistry.hpp"
+#include "palantir/XYSineFeature.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace bedrock::palantir;
+
+namespace {
+
+FeaturePlan prepareXYSine(const ::palantir::XYSineRequest& request) {
+    std::string payload;
+    request.SerializeToString(&payload);
+    return makeXYSineHandler().prepare(payload.data(), payload.size(), RequestControl::fromMetadata({}));
+}
+
+// Model-backed test handler: replies with the version of the snapshot it was given
+FeatureHandler makeModelVersionHandler() {
+    FeatureHandler handler;
+    handler.feature = "model_version";
+    handler.requestType = ::palantir::MessageType::XY_SINE_REQUEST;
+    handler.usesModel = true;
+    handler.prepare = [](const char*, size_t, const RequestControl& control) {
+        if (!control.model) {
+            return FeaturePlan::reject(FeatureResult::failure(::palantir::ErrorCode::INVALID_PARAMETER_VALUE, "no model"));
+        }
+        const uint64_t version = control.model->version;
+        return FeaturePlan::run([version](const RequestControl&) {
+            return FeatureResult::reply(::palantir::MessageType::XY_SINE_RESPONSE, nullptr,
+                                        {{META_SOM_VERSION, std::to_string(version)}});
+        });
+    };
+    return handler;
+}
+
+bedrock::som::SystemModel singlet() {
+    bedrock::som::TwoSurfaceElement tse;
+    tse.s1 = {"S1", 50.0, 5.0, 25.0, true};
+    tse.s2 = {"S2", -100.0, 0.0, 25.0, false};
+    bedrock::som::SystemModel model;
+    model.elements = {tse};
+    return model;
+}
+
+RequestControl modelControl(uint64_t handle, uint64_t version = 0) {
+    std::map<std::string, std::string> metadata = {{META_SOM_HANDLE, std::to_string(handle)}};
+    if (version != 0) {
+        metadata[META_SOM_VERSION] = std::to_string(version);
+    }
+    return RequestControl::fromMetadata(metadata);
+}
+
+} // namespace
+
+TEST(FeatureRegistryTest, FindsHandlersByRequestType) {
+    FeatureRegistry registry;
+    EXPECT_EQ(registry.find(::palantir::MessageType::XY_SINE_REQUEST), -1);
+
+    ASSERT_TRUE(registry.add(makeXYSineHandler(2)));
+    EXPECT_FALSE(registry.add(makeXYSineHandler()));  // Type already handled
+
+    const int index = registry.find(::palantir::MessageType::XY_SINE_REQUEST);
+    ASSERT_EQ(index, 0);
+    EXPECT_EQ(registry.entry(index).handler.feature, "xy_sine");
+    EXPECT_EQ(registry.entry(index).handler.executor, ExecutorKind::ComputePool);
+    EXPECT_EQ(registry.entry(index).gate.limit(), 2);
+}
+
+TEST(FeatureRegistryTest, GateQueuesBeyondLimitInOrder) {
+    ConcurrencyGate gate(2);
+    std::vector<int> started;
+    for (int i = 0; i < 4; ++i) {
+        gate.submit([&started, i]() { started.push_back(i); });
+    }
+    EXPECT_EQ(started, (std::vector<int>{0, 1}));
+    EXPECT_EQ(gate.running(), 2);
+    EXPECT_EQ(gate.queued(), 2u);
+
+    gate.finished();
+    EXPECT_EQ(started, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(gate.running(), 2);
+
+    EXPECT_EQ(gate.dropQueued(), 1u);
+    gate.finished();
+    gate.finished();
+    EXPECT_EQ(gate.running(), 0);
+    EXPECT_EQ(started.size(), 3u);
+
+    ConcurrencyGate unlimited;
+    for (int i = 0; i < 10; ++i) {
+        unlimited.submit([]() {});
+    }
+    EXPECT_EQ(unlimited.running(), 10);
+}
+
+TEST(FeatureRegistryTest, ParseAsRejectsMalformedPayload) {
+    const std::string garbage = "\xff\xff\xff";
+    FeaturePlan plan = makeXYSineHandler().prepare(garbage.data(), garbage.size(), RequestControl::fromMetadata({}));
+    EXPECT_FALSE(plan.work);
+    EXPECT_EQ(plan.rejection.errorCode, ::palantir::ErrorCode::PROTOBUF_PARSE_ERROR);
+    EXPECT_EQ(plan.rejection.error, "Failed to parse XYSineRequest: malformed protobuf payload");
+}
+
+TEST(FeatureRegistryTest, XYSineValidatesAndPicksExecutor) {
+    ::palantir::XYSineRequest request;
+    request.set_samples(1);
+    FeaturePlan rejected = prepareXYSine(request);
+    EXPECT_FALSE(rejected.work);
+    EXPECT_EQ(rejected.rejection.errorCode, ::palantir::ErrorCode::INVALID_PARAMETER_VALUE);
+
+    request.set_samples(100);
+    FeaturePlan small = prepareXYSine(request);
+    ASSERT_TRUE(small.work);
+    EXPECT_TRUE(small.runInline);
+    FeatureResult result = small.work(RequestControl::fromMetadata({}));
+    ASSERT_TRUE(result.message);
+    EXPECT_EQ(result.type, ::palantir::MessageType::XY_SINE_RESPONSE);
+    const auto& response = static_cast<const ::palantir::XYSineResponse&>(*result.message);
+    EXPECT_EQ(response.x_size(), 100);
+    EXPECT_EQ(result.usage.items, 100u);
+    EXPECT_GE(result.usage.peakBytes, 2 * 100 * sizeof(double));
+
+    request.set_samples(XY_SINE_OFFLOAD_THRESHOLD);
+    EXPECT_FALSE(prepareXYSine(request).runInline);
+
+    // Cancelled work reports why it stopped instead of a reply
+    auto control = RequestControl::fromMetadata({});
+    control.cancel();
+    EXPECT_STREQ(small.work(control).droppedReason, REASON_SUPERSEDED);
+}
+
+TEST(FeatureRegistryTest, ResolvesModelOnlyForModelBackedHandlers) {
+    ModelStore store;
+    const ModelSnapshot uploaded = store.upload(1, singlet());
+    const FeatureHandler handler = makeModelVersionHandler();
+
+    // The handler sees the snapshot the request names
+    RequestControl control = modelControl(uploaded.handle);
+    std::shared_ptr<const ModelSnapshot> model;
+    ASSERT_EQ(resolveRequestModel(handler, store, control, model), ModelStore::Status::Ok);
+    ASSERT_TRUE(model);
+    EXPECT_EQ(model->handle, uploaded.handle);
+    control.model = model;
+    FeaturePlan plan = handler.prepare(nullptr, 0, control);
+    ASSERT_TRUE(plan.work);
+    EXPECT_EQ(plan.work(control).metadata[META_SOM_VERSION], "1");
+
+    // Unknown handles and stale versions never reach the handler
+    EXPECT_EQ(resolveRequestModel(handler, store, modelControl(uploaded.handle + 1), model),
+              ModelStore::Status::UnknownHandle);
+    EXPECT_FALSE(model);
+    EXPECT_EQ(resolveRequestModel(handler, store, modelControl(uploaded.handle, 2), model),
+              ModelStore::Status::VersionMismatch);
+
+    // No reference: nothing to resolve, the handler decides
+    EXPECT_EQ(resolveRequestModel(handler, store, RequestControl::fromMetadata({}), model), ModelStore::Status::Ok);
+    EXPECT_FALSE(model);
+
+    // XY Sine reads no model, so a som_handle it cannot use is not an error
+    EXPECT_EQ(resolveRequestModel(makeXYSineHandler(), store, modelControl(uploaded.handle + 1), model),
+              ModelStore::Status::Ok);
+    EXPECT_FALSE(model);
+}
+
+TEST(FeatureRegistryTest, XYSineChunkingKeepsSerialValues) {
+    ::palantir::XYSineRequest request;
+    request.set_samples(10007);
+    request.set_frequency(3.0);
+    std::vector<double> x1, y1, x2, y2;
+    ASSERT_TRUE(computeXYSine(request, x1, y1, nullptr, 10007));  // One chunk: the serial loop
+    ASSERT_TRUE(computeXYSine(request, x2, y2, nullptr, 97));
+    EXPECT_EQ(x1, x2);
+    EXPECT_EQ(y1, y2);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
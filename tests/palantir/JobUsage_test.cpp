@@ -0,0 +1,85 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/JobUsage.hpp"
+#include "bedrock/thread_budget.hpp"
+#include "bedrock/trace.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace bedrock::palantir;
+
+TEST(JobUsageTest, MeterSeparatesQueueWallAndCpuTime) {
+    const uint64_t submittedNs = bedrock::Tracer::now_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    JobMeter meter(submittedNs);
+    volatile double sink = 0.0;
+    for (int i = 0; i < 2000000; ++i) {
+        sink = sink + i * 0.5;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    JobUsage reported;
+    reported.items = 42;
+    reported.peakBytes = 4096;
+    const JobUsage usage = meter.finish(reported);
+
+    EXPECT_GE(usage.queueNs, 5000000u);
+    EXPECT_GE(usage.wallNs, 5000000u);
+    EXPECT_LE(usage.cpuNs, usage.wallNs);  // Sleeping costs wall time, not CPU
+    EXPECT_EQ(usage.items, 42u);
+    EXPECT_EQ(usage.peakBytes, 4096u);
+
+    std::map<std::string, std::string> metadata;
+    usage.appendMetadata(metadata);
+    EXPECT_EQ(metadata[META_JOB_ITEMS], "42");
+    EXPECT_EQ(metadata[META_JOB_PEAK_BYTES], "4096");
+    EXPECT_EQ(metadata[META_JOB_WALL_US], std::to_string(usage.wallNs / 1000));
+
+    EXPECT_EQ(JobMeter(0).finish({}).queueNs, 0u);  // Run at once: no queue time
+}
+
+TEST(JobUsageTest, MeterIncludesHelperCpuTime) {
+    bedrock::ThreadBudget budget(4);
+    budget.add_helper_cpu_ns(1000000);  // Earlier jobs' helpers are not this job's
+    bedrock::ThreadBudget::Scope scope(budget);
+
+    JobMeter meter;
+    budget.add_helper_cpu_ns(7000000);  // What parallel_for helpers report while the work runs
+    const JobUsage usage = meter.finish({});
+
+    EXPECT_GE(usage.cpuNs, 7000000u);
+    EXPECT_LT(usage.cpuNs, 8000000u);
+}
+
+TEST(JobUsageTest, SummaryAggregatesPerHandler) {
+    UsageSummary summary;
+    EXPECT_EQ(summary.meanWallMs(), 0.0);
+    EXPECT_EQ(summary.cpuUtilization(), 0.0);
+
+    JobUsage a;
+    a.wallNs = 2000000;
+    a.queueNs = 1000000;
+    a.cpuNs = 2000000;
+    a.peakBytes = 100;
+    a.items = 10;
+    JobUsage b;
+    b.wallNs = 6000000;
+    b.cpuNs = 2000000;
+    b.peakBytes = 300;
+    b.items = 5;
+    summary.add(a);
+    summary.add(b);
+
+    EXPECT_EQ(summary.jobs, 2u);
+    EXPECT_DOUBLE_EQ(summary.meanWallMs(), 4.0);
+    EXPECT_DOUBLE_EQ(summary.meanQueueMs(), 0.5);
+    EXPECT_EQ(summary.maxWallNs, 6000000u);
+    EXPECT_EQ(summary.maxPeakBytes, 300u);
+    EXPECT_EQ(summary.totalItems, 15u);
+    EXPECT_DOUBLE_EQ(summary.cpuUtilization(), 0.5);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,92 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/LoadBalancer.hpp"
+
+using namespace bedrock::palantir;
+using namespace std::chrono_literals;
+
+TEST(LoadBalancerTest, PrefersLeastLoadedAndRotatesTies) {
+    LoadBalancer balancer(3);
+    const auto now = LoadBalancer::Clock::now();
+    EXPECT_EQ(balancer.pick(now), -1);  // Nothing connected yet
+
+    for (int i = 0; i < 3; ++i) {
+        balancer.onConnected(i);
+    }
+    // Idle endpoints take turns
+    EXPECT_EQ(balancer.pick(now), 0);
+    EXPECT_EQ(balancer.pick(now), 1);
+    EXPECT_EQ(balancer.pick(now), 2);
+
+    // Endpoint 0 reports a backlog, endpoint 1 has our requests in flight
+    balancer.onSent(0);
+    balancer.onReply(0, 6, 2, now);
+    balancer.onSent(1);
+    balancer.onSent(1);
+    EXPECT_EQ(balancer.pick(now), 2);
+    balancer.onSent(2);
+    balancer.onSent(2);
+    balancer.onSent(2);
+    EXPECT_EQ(balancer.pick(now), 1);  // 2 in flight beats 3 in flight and 6/2
+
+    // Once endpoint 0's report is stale only its in-flight count matters
+    EXPECT_EQ(balancer.pick(now + 3s), 0);
+    EXPECT_EQ(balancer.stats(0).replies, 1u);
+}
+
+TEST(LoadBalancerTest, FreshReportIsNotAddedToPipelinedRequests) {
+    LoadBalancer balancer(2);
+    const auto now = LoadBalancer::Clock::now();
+    balancer.onConnected(0);
+    balancer.onConnected(1);
+
+    // Four pipelined requests on endpoint 0; the first reply reports the other three queued
+    for (int i = 0; i < 4; ++i) {
+        balancer.onSent(0);
+    }
+    balancer.onReply(0, 3, 1, now);
+    EXPECT_EQ(balancer.inFlight(0), 3);
+    // Endpoint 1 is idle for us but busy with other clients' work
+    balancer.onSent(1);
+    balancer.onReply(1, 4, 1, now);
+
+    EXPECT_EQ(balancer.pick(now), 0);  // 3 (already in the report), not 3 + 3 in flight
+
+    // Sends after the report count on top of it
+    balancer.onSent(0);
+    balancer.onSent(0);
+    EXPECT_EQ(balancer.pick(now), 1);  // 3 + 2 > 4
+}
+
+TEST(LoadBalancerTest, FailedEndpointBacksOffExponentially) {
+    LoadBalancer::Options options;
+    options.initialBackoff = 100ms;
+    options.maxBackoff = 300ms;
+    LoadBalancer balancer(2, options);
+    balancer.onConnected(0);
+    balancer.onConnected(1);
+    auto now = LoadBalancer::Clock::now();
+
+    balancer.onSent(0);
+    balancer.onFailure(0, now);
+    EXPECT_FALSE(balancer.isConnected(0));
+    EXPECT_EQ(balancer.inFlight(0), 0);
+    EXPECT_EQ(balancer.retryDelay(0, now), 100ms);
+    EXPECT_EQ(balancer.pick(now), 1);
+
+    // Reconnect attempts that fail double the wait, up to the cap
+    balancer.onFailure(0, now);
+    EXPECT_EQ(balancer.retryDelay(0, now), 200ms);
+    balancer.onFailure(0, now);
+    EXPECT_EQ(balancer.retryDelay(0, now), 300ms);
+    EXPECT_EQ(balancer.stats(0).failures, 3u);
+
+    // A successful connection clears the backoff
+    balancer.onConnected(0);
+    EXPECT_EQ(balancer.retryDelay(0, now), 0ms);
+    balancer.onSent(1);
+    EXPECT_EQ(balancer.pick(now), 0);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
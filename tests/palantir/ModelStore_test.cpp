@@ -0,0 +1,248 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/ModelStore.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace bedrock::palantir;
+using bedrock::som::ElementEdit;
+using bedrock::som::SomDelta;
+using bedrock::som::SystemModel;
+using bedrock::som::TwoSurfaceElement;
+
+namespace {
+
+SystemModel singlet() {
+    TwoSurfaceElement tse;
+    tse.s1 = {"S1", 50.0, 5.0, 25.0, true};
+    tse.s2 = {"S2", -100.0, 0.0, 25.0, false};
+    SystemModel model;
+    model.elements = {tse};
+    return model;
+}
+
+} // namespace
+
+TEST(ModelStoreTest, UploadPreparesAndVersions) {
+    ModelStore store;
+    ModelSnapshot snapshot = store.upload(1, singlet());
+    EXPECT_NE(snapshot.handle, 0u);
+    EXPECT_EQ(snapshot.version, 1u);
+    ASSERT_TRUE(snapshot.prepared);
+    ASSERT_EQ(snapshot.prepared->surfaces.size(), 2u);
+    EXPECT_DOUBLE_EQ(snapshot.prepared->surfaces[0].curvature, 1.0 / 50.0);
+    EXPECT_DOUBLE_EQ(snapshot.prepared->surfaces[1].vertexZ, 5.0);
+    EXPECT_DOUBLE_EQ(snapshot.prepared->surfaces[0].semiDiameter, 12.5);
+    EXPECT_EQ(snapshot.prepared->stopSurface, 0);
+    EXPECT_DOUBLE_EQ(snapshot.prepared->totalTrack, 5.0);
+}
+
+TEST(ModelStoreTest, DeltaBumpsVersionAndKeepsOldSnapshot) {
+    ModelStore store;
+    ModelSnapshot v1 = store.upload(1, singlet());
+
+    SomDelta delta;
+    delta.base_version = 1;
+    TwoSurfaceElement edited = v1.model->elements[0];
+    edited.s1.radius = 40.0;
+    delta.edits.push_back({ElementEdit::Op::Replace, 0, edited});
+
+    ModelSnapshot v2;
+    ASSERT_EQ(store.applyDelta(1, v1.handle, delta, &v2), ModelStore::Status::Ok);
+    EXPECT_EQ(v2.version, 2u);
+    EXPECT_DOUBLE_EQ(v2.model->elements[0].s1.radius, 40.0);
+    EXPECT_DOUBLE_EQ(v2.prepared->surfaces[0].curvature, 1.0 / 40.0);
+    // Readers holding v1 are unaffected
+    EXPECT_DOUBLE_EQ(v1.model->elements[0].s1.radius, 50.0);
+
+    // Replaying the same delta is stale now
+    std::string error;
+    EXPECT_EQ(store.applyDelta(1, v1.handle, delta, nullptr, &error), ModelStore::Status::VersionMismatch);
+    EXPECT_FALSE(error.empty());
+
+    // Out-of-range edit is rejected without bumping the version
+    SomDelta bad;
+    bad.base_version = 2;
+    bad.edits.push_back({ElementEdit::Op::Erase, 3, {}});
+    EXPECT_EQ(store.applyDelta(1, v1.handle, bad), ModelStore::Status::InvalidDelta);
+
+    ModelSnapshot current;
+    ASSERT_EQ(store.resolve(ModelRef{v1.handle, std::nullopt}, current), ModelStore::Status::Ok);
+    EXPECT_EQ(current.version, 2u);
+    EXPECT_EQ(store.resolve(ModelRef{v1.handle, 1}, current), ModelStore::Status::VersionMismatch);
+}
+
+TEST(ModelStoreTest, OwnerEditsAndAnyConnectionReads) {
+    ModelStore store;
+    ModelSnapshot mine = store.upload(1, singlet());
+    store.upload(1, singlet());
+    ModelSnapshot theirs = store.upload(2, singlet());
+
+    // Another connection may read the model but not edit or release it
+    ModelSnapshot out;
+    EXPECT_EQ(store.resolve(ModelRef{mine.handle, std::nullopt}, out), ModelStore::Status::Ok);
+    EXPECT_EQ(out.handle, mine.handle);
+    SomDelta delta;
+    delta.base_version = 1;
+    EXPECT_EQ(store.applyDelta(2, mine.handle, delta), ModelStore::Status::UnknownHandle);
+    EXPECT_FALSE(store.release(2, mine.handle));
+
+    EXPECT_EQ(store.releaseOwner(1), 2u);
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.resolve(ModelRef{mine.handle, std::nullopt}, out), ModelStore::Status::UnknownHandle);
+    EXPECT_EQ(store.resolve(ModelRef{theirs.handle, std::nullopt}, out), ModelStore::Status::Ok);
+    EXPECT_TRUE(store.release(2, theirs.handle));
+    EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(ModelStoreTest, SubscribersGetComposedDeltaFromLastSeenVersion) {
+    ModelStore store;
+    ModelSnapshot v1 = store.upload(1, singlet());
+
+    std::vector<ModelChange> received;
+    SubscriptionId id = 0;
+    ModelChange catchUp;
+    ASSERT_EQ(store.subscribe(1, v1.handle, 1, [&received](const ModelChange& change) { received.push_back(change); },
+                              &id, &catchUp),
+              ModelStore::Status::Ok);
+    EXPECT_TRUE(catchUp.delta.empty());  // Already current
+
+    // Two edits of the same surface reach the subscriber as one Replace each time
+    for (uint64_t version = 1; version <= 2; ++version) {
+        ModelSnapshot current;
+        ASSERT_EQ(store.resolve(ModelRef{v1.handle, std::nullopt}, current), ModelStore::Status::Ok);
+        TwoSurfaceElement edited = current.model->elements[0];
+        edited.s1.radius += 1.0;
+        SomDelta delta;
+        delta.base_version = version;
+        delta.edits.push_back({ElementEdit::Op::Replace, 0, edited});
+        ASSERT_EQ(store.applyDelta(1, v1.handle, delta), ModelStore::Status::Ok);
+    }
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[1].version, 3u);
+    EXPECT_EQ(received[1].delta.base_version, 2u);
+    ASSERT_EQ(received[1].delta.edits.size(), 1u);
+    EXPECT_DOUBLE_EQ(received[1].delta.edits[0].element.s1.radius, 52.0);
+    EXPECT_FALSE(received[1].full);
+
+    // A late subscriber catches up from the version it holds in one delta
+    ModelChange late;
+    ASSERT_EQ(store.subscribe(1, v1.handle, 1, [](const ModelChange&) {}, nullptr, &late), ModelStore::Status::Ok);
+    EXPECT_EQ(late.delta.base_version, 1u);
+    EXPECT_EQ(late.delta.edits.size(), 1u);
+    EXPECT_EQ(store.subscriptionCount(v1.handle), 2u);
+
+    EXPECT_TRUE(store.unsubscribe(id));
+    EXPECT_FALSE(store.unsubscribe(id));
+    EXPECT_EQ(store.subscriptionCount(v1.handle), 1u);
+    store.releaseOwner(1);
+    EXPECT_EQ(store.subscriptionCount(v1.handle), 0u);
+}
+
+TEST(ModelStoreTest, ViewsOnOtherConnectionsStayInSync) {
+    ModelStore store;
+    ModelSnapshot v1 = store.upload(1, singlet());
+
+    // Connections 2 and 3 view the model connection 1 edits
+    std::vector<ModelChange> second, third;
+    SubscriptionId secondId = 0;
+    ASSERT_EQ(store.subscribe(2, v1.handle, 1, [&second](const ModelChange& c) { second.push_back(c); }, &secondId),
+              ModelStore::Status::Ok);
+    ASSERT_EQ(store.subscribe(3, v1.handle, 1, [&third](const ModelChange& c) { third.push_back(c); }),
+              ModelStore::Status::Ok);
+
+    SomDelta delta;
+    delta.base_version = 1;
+    TwoSurfaceElement edited = v1.model->elements[0];
+    edited.s1.radius = 45.0;
+    delta.edits.push_back({ElementEdit::Op::Replace, 0, edited});
+    ASSERT_EQ(store.applyDelta(1, v1.handle, delta), ModelStore::Status::Ok);
+    ASSERT_EQ(second.size(), 1u);
+    ASSERT_EQ(third.size(), 1u);
+    EXPECT_EQ(third[0].version, 2u);
+    SystemModel view = *v1.model;
+    ASSERT_TRUE(bedrock::som::ApplyDelta(view, third[0].delta));
+    EXPECT_DOUBLE_EQ(view.elements[0].s1.radius, 45.0);
+
+    // A viewer disconnecting drops only its own subscriptions
+    EXPECT_EQ(store.releaseOwner(2), 0u);
+    EXPECT_EQ(store.subscriptionCount(v1.handle), 1u);
+    EXPECT_FALSE(store.unsubscribe(secondId));
+    EXPECT_EQ(store.size(), 1u);
+
+    // The owner disconnecting drops the model and every view of it
+    EXPECT_EQ(store.releaseOwner(1), 1u);
+    EXPECT_EQ(store.subscriptionCount(v1.handle), 0u);
+}
+
+TEST(ModelStoreTest, ChangesBeyondHistoryAreSentInFull) {
+    ModelStore store;
+    ModelSnapshot snapshot = store.upload(1, singlet());
+    for (uint64_t version = 1; version <= ModelStore::HISTORY_DEPTH + 1; ++version) {
+        SomDelta delta;
+        delta.base_version = version;
+        TwoSurfaceElement edited = singlet().elements[0];
+        edited.s2.thickness = static_cast<double>(version);
+        delta.edits.push_back({ElementEdit::Op::Replace, 0, edited});
+        ASSERT_EQ(store.applyDelta(1, snapshot.handle, delta, &snapshot), ModelStore::Status::Ok);
+    }
+
+    ModelChange change;
+    ASSERT_EQ(store.changesSince(snapshot.handle, 1, change), ModelStore::Status::Ok);
+    EXPECT_TRUE(change.full);
+    EXPECT_EQ(change.delta.base_version, 0u);
+    SystemModel rebuilt;
+    ASSERT_TRUE(bedrock::som::ApplyDelta(rebuilt, change.delta));
+    EXPECT_EQ(rebuilt, *snapshot.model);
+
+    ASSERT_EQ(store.changesSince(snapshot.handle, snapshot.version - 1, change), ModelStore::Status::Ok);
+    EXPECT_FALSE(change.full);
+    EXPECT_EQ(store.changesSince(snapshot.handle, snapshot.version + 1, change), ModelStore::Status::VersionMismatch);
+}
+
+TEST(ModelStoreTest, ModelRefFromMetadata) {
+    EXPECT_FALSE(ModelRef::fromMetadata({}).has_value());
+    EXPECT_FALSE(ModelRef::fromMetadata({{META_SOM_HANDLE, "abc"}}).has_value());
+
+    auto ref = ModelRef::fromMetadata({{META_SOM_HANDLE, "42"}, {META_SOM_VERSION, "7"}});
+    ASSERT_TRUE(ref.has_value());
+    EXPECT_EQ(ref->handle, 42u);
+    ASSERT_TRUE(ref->version.has_value());
+    EXPECT_EQ(*ref->version, 7u);
+}
+
+TEST(ModelStoreTest, EngineBridgePublishesVersionsToSubscribers) {
+    ModelStore store;
+    EngineModelBridge bridge(store);
+    EXPECT_EQ(bridge.handle(), 0u);
+
+    ModelSnapshot v1;
+    ASSERT_EQ(bridge.publish(singlet(), &v1), ModelStore::Status::Ok);
+    ASSERT_NE(bridge.handle(), 0u);
+    EXPECT_EQ(v1.version, 1u);
+
+    // A connection viewing the engine's model hears about the next SOM bump
+    std::vector<ModelChange> seen;
+    ASSERT_EQ(store.subscribe(7, bridge.handle(), 1, [&seen](const ModelChange& change) { seen.push_back(change); }),
+              ModelStore::Status::Ok);
+
+    SystemModel edited = singlet();
+    edited.elements[0].s1.radius = 40.0;
+    ModelSnapshot v2;
+    ASSERT_EQ(bridge.publish(edited, &v2), ModelStore::Status::Ok);
+    EXPECT_EQ(v2.handle, bridge.handle());
+    EXPECT_EQ(v2.version, 2u);
+
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0].version, 2u);
+    ASSERT_EQ(seen[0].delta.edits.size(), 1u);  // Only the changed element
+    EXPECT_DOUBLE_EQ(seen[0].delta.edits[0].element.s1.radius, 40.0);
+
+    // Connections cannot edit or release the engine's model
+    EXPECT_FALSE(store.release(1, bridge.handle()));
+    EXPECT_EQ(store.releaseOwner(1), 0u);
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,122 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/RequestControl.hpp"
+
+#include <chrono>
+#include <string>
+
+using namespace bedrock::palantir;
+using namespace std::chrono_literals;
+
+namespace {
+
+int64_t nowUnixMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+TEST(RequestControlTest, NoMetadataMeansNoControl) {
+    auto control = RequestControl::fromMetadata({});
+    EXPECT_TRUE(control.requestId.empty());
+    EXPECT_TRUE(control.supersedeKey.empty());
+    EXPECT_FALSE(control.hasDeadline);
+    EXPECT_FALSE(control.modelRef.has_value());
+    EXPECT_FALSE(control.shouldStop());
+    EXPECT_TRUE(control.replyMetadata().empty());
+}
+
+TEST(RequestControlTest, TimeoutIsRelativeToReceipt) {
+    auto receivedAt = RequestControl::Clock::now();
+    auto control = RequestControl::fromMetadata({{META_TIMEOUT_MS, "50"}}, receivedAt);
+    ASSERT_TRUE(control.hasDeadline);
+    EXPECT_FALSE(control.expired(receivedAt + 49ms));
+    EXPECT_TRUE(control.expired(receivedAt + 50ms));
+}
+
+TEST(RequestControlTest, AbsoluteDeadlineInPastIsExpired) {
+    auto control = RequestControl::fromMetadata({{META_DEADLINE_MS, std::to_string(nowUnixMs() - 1000)}});
+    ASSERT_TRUE(control.hasDeadline);
+    EXPECT_TRUE(control.expired());
+    EXPECT_TRUE(control.shouldStop());
+}
+
+TEST(RequestControlTest, EarliestDeadlineWins) {
+    auto receivedAt = RequestControl::Clock::now();
+    auto control = RequestControl::fromMetadata(
+        {{META_TIMEOUT_MS, "10"}, {META_DEADLINE_MS, std::to_string(nowUnixMs() + 60000)}}, receivedAt);
+    ASSERT_TRUE(control.hasDeadline);
+    EXPECT_TRUE(control.expired(receivedAt + 10ms));
+}
+
+TEST(RequestControlTest, HugeValuesSaturateInsteadOfOverflowing) {
+    const std::string max = std::to_string(INT64_MAX);
+    auto receivedAt = RequestControl::Clock::now();
+    auto control = RequestControl::fromMetadata({{META_TIMEOUT_MS, max}}, receivedAt);
+    ASSERT_TRUE(control.hasDeadline);
+    EXPECT_EQ(control.deadline, RequestControl::Clock::time_point::max());
+    EXPECT_FALSE(control.expired(receivedAt + 24h * 365 * 100));
+
+    control = RequestControl::fromMetadata({{META_DEADLINE_MS, max}});
+    EXPECT_FALSE(control.shouldStop());
+    control = RequestControl::fromMetadata({{META_DEADLINE_MS, std::to_string(INT64_MIN)}});
+    EXPECT_TRUE(control.expired());
+}
+
+TEST(RequestControlTest, MalformedValuesAreIgnored) {
+    auto control = RequestControl::fromMetadata({{META_TIMEOUT_MS, "soon"}, {META_DEADLINE_MS, "12abc"}});
+    EXPECT_FALSE(control.hasDeadline);
+
+    control = RequestControl::fromMetadata({{META_TIMEOUT_MS, "-5"}});
+    EXPECT_FALSE(control.hasDeadline);
+}
+
+TEST(RequestControlTest, ModelReferenceIsParsed) {
+    auto control = RequestControl::fromMetadata({{META_SOM_HANDLE, "3"}, {META_SOM_VERSION, "12"}});
+    ASSERT_TRUE(control.modelRef.has_value());
+    EXPECT_EQ(control.modelRef->handle, 3u);
+    EXPECT_EQ(control.modelRef->version, 12u);
+    EXPECT_FALSE(control.model);  // Resolved by the server at dispatch
+
+    EXPECT_FALSE(RequestControl::fromMetadata({{META_SOM_HANDLE, "0"}}).modelRef.has_value());
+}
+
+TEST(RequestControlTest, CancelIsSharedWithCopies) {
+    auto control = RequestControl::fromMetadata({{META_SUPERSEDES, "slider/frequency"}});
+    EXPECT_EQ(control.supersedeKey, "slider/frequency");
+
+    RequestControl running = control;  // e.g. captured by the compute path
+    control.cancel();
+    EXPECT_TRUE(running.isCancelled());
+    EXPECT_TRUE(running.shouldStop());
+}
+
+TEST(RequestControlTest, ReplyMetadataEchoesRequestId) {
+    auto control = RequestControl::fromMetadata({{META_REQUEST_ID, "42"}});
+    auto reply = control.replyMetadata();
+    ASSERT_EQ(reply.size(), 1u);
+    EXPECT_EQ(reply[META_REQUEST_ID], "42");
+
+    auto dropped = control.replyMetadata(REASON_SUPERSEDED);
+    EXPECT_EQ(dropped[META_REQUEST_ID], "42");
+    EXPECT_EQ(dropped[META_ERROR_REASON], REASON_SUPERSEDED);
+}
+
+TEST(RequestControlTest, LoadIsReportedOnlyWhenRequested) {
+    auto plain = RequestControl::fromMetadata({});
+    plain.serverLoad = 3;
+    EXPECT_TRUE(plain.replyMetadata().empty());
+
+    auto control = RequestControl::fromMetadata({{META_REPORT_LOAD, "1"}});
+    EXPECT_TRUE(control.reportLoad);
+    EXPECT_TRUE(control.replyMetadata().empty());  // Server has not filled it in
+    control.serverLoad = 3;
+    control.serverWorkers = 8;
+    auto reply = control.replyMetadata();
+    EXPECT_EQ(reply[META_SERVER_LOAD], "3");
+    EXPECT_EQ(reply[META_SERVER_WORKERS], "8");
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
@@ -0,0 +1,125 @@
+#ifdef BEDROCK_WITH_TRANSPORT_DEPS
+
+#include <gtest/gtest.h>
+#include "palantir/TrafficCapture.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace bedrock::palantir;
+
+namespace {
+
+std::string tempCapturePath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEST(TrafficCaptureTest, WriteReadRoundTrip) {
+    const std::string path = tempCapturePath("bedrock_capture_roundtrip.cap");
+
+    TrafficCaptureWriter writer;
+    std::string error;
+    ASSERT_TRUE(writer.open(path, &error)) << error;
+    writer.record(1, CaptureKind::Connect);
+    writer.record(1, CaptureKind::Inbound, "request", 7);
+    writer.record(1, CaptureKind::Outbound, "response-bytes", 14);
+    writer.record(1, CaptureKind::Disconnect);
+    EXPECT_EQ(writer.recordCount(), 4u);
+    writer.close();
+
+    TrafficCaptureReader reader;
+    ASSERT_TRUE(reader.open(path, &error)) << error;
+    EXPECT_GT(reader.captureStartUs(), 0u);
+
+    std::vector<CaptureRecord> records;
+    for (CaptureRecord record; reader.next(record);) {
+        records.push_back(record);
+    }
+    ASSERT_EQ(records.size(), 4u);
+
+    EXPECT_EQ(records[0].kind, CaptureKind::Connect);
+    EXPECT_TRUE(records[0].envelope.empty());
+    EXPECT_EQ(records[1].kind, CaptureKind::Inbound);
+    EXPECT_EQ(records[1].connectionId, 1u);
+    EXPECT_EQ(records[1].envelope, "request");
+    EXPECT_EQ(records[2].kind, CaptureKind::Outbound);
+    EXPECT_EQ(records[2].envelope, "response-bytes");
+    EXPECT_EQ(records[3].kind, CaptureKind::Disconnect);
+
+    // Timestamps are monotonic
+    for (size_t i = 1; i < records.size(); ++i) {
+        EXPECT_GE(records[i].timestampUs, records[i - 1].timestampUs);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(TrafficCaptureTest, RejectsForeignFile) {
+    const std::string path = tempCapturePath("bedrock_capture_foreign.cap");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "definitely not a capture log";
+    }
+
+    TrafficCaptureReader reader;
+    std::string error;
+    EXPECT_FALSE(reader.open(path, &error));
+    EXPECT_NE(error.find("Not a Bedrock capture file"), std::string::npos);
+
+    std::remove(path.c_str());
+}
+
+TEST(TrafficCaptureTest, StopsAtTruncatedRecord) {
+    const std::string path = tempCapturePath("bedrock_capture_truncated.cap");
+
+    TrafficCaptureWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    writer.record(7, CaptureKind::Inbound, "complete", 8);
+    writer.record(7, CaptureKind::Inbound, "will-be-cut", 11);
+    writer.close();
+
+    // Drop the tail of the last record, as if the server died mid-write
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+    TrafficCaptureReader reader;
+    ASSERT_TRUE(reader.open(path));
+    CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.envelope, "complete");
+    EXPECT_FALSE(reader.next(record));
+
+    std::remove(path.c_str());
+}
+
+TEST(TrafficCaptureTest, StopsAtCorruptLength) {
+    const std::string path = tempCapturePath("bedrock_capture_corrupt.cap");
+
+    TrafficCaptureWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    writer.record(7, CaptureKind::Inbound, "complete", 8);
+    writer.record(7, CaptureKind::Inbound, "corrupted", 9);
+    writer.close();
+
+    // Overwrite the last record's length field (it precedes the 9 body bytes)
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-(9 + 4), std::ios::end);
+        const uint32_t length = 0xFFFFFFF0u;
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+
+    TrafficCaptureReader reader;
+    ASSERT_TRUE(reader.open(path));
+    CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.envelope, "complete");
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_LE(record.envelope.capacity(), CAPTURE_MAX_RECORD_SIZE);
+
+    std::remove(path.c_str());
+}
+
+#endif // BEDROCK_WITH_TRANSPORT_DEPS
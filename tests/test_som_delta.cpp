@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "bedrock/som/delta.hpp"
+#include "bedrock/som/delta_codec.hpp"
+
+using namespace bedrock::som;
+
+namespace {
+
+TwoSurfaceElement lens(const std::string& name, double r1, double r2) {
+  TwoSurfaceElement e;
+  e.name = name;
+  e.s1 = {"S1", r1, 5.0, 25.0, false};
+  e.s2 = {"S2", r2, 10.0, 25.0, false};
+  return e;
+}
+
+} // namespace
+
+TEST(SomDelta, DiffThenApplyReproducesTarget) {
+  SystemModel from;
+  from.elements = {lens("L1", 50, -100), lens("L2", 80, -80), lens("L3", 30, 0)};
+
+  SystemModel to = from;
+  to.units = LengthUnits::cm;
+  to.elements[1].s1.radius = 75;
+  to.elements.pop_back();
+  to.elements.push_back(lens("L4", 20, -20));
+  to.elements.push_back(lens("L5", 10, -10));
+
+  SomDelta delta = Diff(from, to, 3);
+  EXPECT_EQ(delta.base_version, 3u);
+  ASSERT_TRUE(delta.units.has_value());
+  // Only the changed element and the tail are sent
+  EXPECT_EQ(delta.edits.size(), 3u);
+
+  SystemModel applied = from;
+  ASSERT_TRUE(ApplyDelta(applied, delta));
+  EXPECT_EQ(applied, to);
+
+  SystemModel shrunk = from;
+  shrunk.elements.resize(1);
+  SystemModel trimmed = from;
+  ASSERT_TRUE(ApplyDelta(trimmed, Diff(from, shrunk, 0)));
+  EXPECT_EQ(trimmed, shrunk);
+}
+
+TEST(SomDelta, IdenticalModelsGiveEmptyDelta) {
+  SystemModel model;
+  model.elements = {lens("L1", 50, -100)};
+  EXPECT_TRUE(Diff(model, model, 1).empty());
+}
+
+TEST(SomDelta, OutOfRangeEditLeavesModelUnchanged) {
+  SystemModel model;
+  model.elements = {lens("L1", 50, -100)};
+  const SystemModel before = model;
+
+  SomDelta delta;
+  delta.units = LengthUnits::m;
+  delta.edits.push_back({ElementEdit::Op::Insert, 1, lens("L2", 1, 1)});  // Append: valid
+  delta.edits.push_back({ElementEdit::Op::Erase, 5, {}});                 // Invalid
+
+  std::string error;
+  EXPECT_FALSE(ApplyDelta(model, delta, &error));
+  EXPECT_NE(error.find("edit 1"), std::string::npos);
+  EXPECT_EQ(model, before);
+}
+
+TEST(SomDelta, EncodeDecodeRoundTrip) {
+  SystemModel from;
+  from.elements = {lens("L1", 50, -100), lens("L2", 80, -80)};
+  SystemModel to = from;
+  to.units = LengthUnits::inch;
+  to.elements[0].s1.is_stop = true;
+  to.elements.pop_back();
+
+  const SomDelta delta = Diff(from, to, 300);
+  const std::string bytes = EncodeDelta(delta);
+  // One element plus an erase: far smaller than resending the model
+  EXPECT_LT(bytes.size(), 100u);
+
+  SomDelta decoded;
+  ASSERT_TRUE(DecodeDelta(bytes.data(), bytes.size(), decoded));
+  EXPECT_EQ(decoded, delta);
+}
+
+TEST(SomDelta, DecodeRejectsTruncatedInput) {
+  SomDelta delta;
+  delta.base_version = 1;
+  delta.edits.push_back({ElementEdit::Op::Insert, 0, lens("L1", 50, -100)});
+  const std::string bytes = EncodeDelta(delta);
+
+  for (std::size_t size = 0; size < bytes.size(); ++size) {
+    SomDelta decoded;
+    EXPECT_FALSE(DecodeDelta(bytes.data(), size, decoded)) << "size " << size;
+  }
+  std::string padded = bytes + '\0';
+  SomDelta decoded;
+  std::string error;
+  EXPECT_FALSE(DecodeDelta(padded.data(), padded.size(), decoded, &error));
+  EXPECT_NE(error.find("trailing"), std::string::npos);
+}